@@ -13,6 +13,8 @@
 #include <stdlib.h>
 #include "cJSON.h"
 #include "json_aux.h"
+#include "cloud_codec_common.h"
+#include <json_writer.h>
 #include <date_time.h>
 
 #include <logging/log.h>
@@ -324,6 +326,7 @@ exit:
 	return 0;
 }
 
+#if !defined(CONFIG_CLOUD_CODEC_CBOR)
 static int ui_data_add(cJSON *parent, struct cloud_data_ui *data,
 		       bool batch_entry)
 {
@@ -366,6 +369,231 @@ exit:
 	return 0;
 }
 
+static void entry_start(struct json_writer *writer)
+{
+	json_writer_obj_start(writer);
+	json_writer_key(writer, OBJECT_VALUE);
+}
+
+static void entry_end(struct json_writer *writer, int64_t ts)
+{
+	json_writer_key_int(writer, OBJECT_TIMESTAMP, ts);
+	json_writer_obj_end(writer);
+}
+
+static int gps_data_write(struct json_writer *writer,
+			  const struct cloud_data_gps *data)
+{
+	int64_t ts;
+	int err = cloud_codec_timestamp_get(data->gps_ts, &ts);
+
+	if (err) {
+		return err;
+	}
+
+	entry_start(writer);
+	json_writer_obj_start(writer);
+	json_writer_key_number(writer, DATA_GPS_LONGITUDE, data->longi);
+	json_writer_key_number(writer, DATA_GPS_LATITUDE, data->lat);
+	json_writer_key_number(writer, DATA_MOVEMENT, data->acc);
+	json_writer_key_number(writer, DATA_GPS_ALTITUDE, data->alt);
+	json_writer_key_number(writer, DATA_GPS_SPEED, data->spd);
+	json_writer_key_number(writer, DATA_GPS_HEADING, data->hdg);
+	json_writer_obj_end(writer);
+	entry_end(writer, ts);
+
+	return 0;
+}
+
+static int sensor_data_write(struct json_writer *writer,
+			     const struct cloud_data_sensors *data)
+{
+	int64_t ts;
+	int err = cloud_codec_timestamp_get(data->env_ts, &ts);
+
+	if (err) {
+		return err;
+	}
+
+	entry_start(writer);
+	json_writer_obj_start(writer);
+	json_writer_key_number(writer, DATA_TEMPERATURE, data->temp);
+	json_writer_key_number(writer, DATA_HUMID, data->hum);
+	json_writer_obj_end(writer);
+	entry_end(writer, ts);
+
+	return 0;
+}
+
+static int ui_data_write(struct json_writer *writer,
+			 const struct cloud_data_ui *data)
+{
+	int64_t ts;
+	int err = cloud_codec_timestamp_get(data->btn_ts, &ts);
+
+	if (err) {
+		return err;
+	}
+
+	entry_start(writer);
+	json_writer_int(writer, data->btn);
+	entry_end(writer, ts);
+
+	return 0;
+}
+
+static int accel_data_write(struct json_writer *writer,
+			    const struct cloud_data_accelerometer *data)
+{
+	int64_t ts;
+	int err = cloud_codec_timestamp_get(data->ts, &ts);
+
+	if (err) {
+		return err;
+	}
+
+	entry_start(writer);
+	json_writer_obj_start(writer);
+	json_writer_key_number(writer, DATA_MOVEMENT_X, data->values[0]);
+	json_writer_key_number(writer, DATA_MOVEMENT_Y, data->values[1]);
+	json_writer_key_number(writer, DATA_MOVEMENT_Z, data->values[2]);
+	json_writer_obj_end(writer);
+	entry_end(writer, ts);
+
+	return 0;
+}
+
+static int bat_data_write(struct json_writer *writer,
+			  const struct cloud_data_battery *data)
+{
+	int64_t ts;
+	int err = cloud_codec_timestamp_get(data->bat_ts, &ts);
+
+	if (err) {
+		return err;
+	}
+
+	entry_start(writer);
+	json_writer_int(writer, data->bat);
+	entry_end(writer, ts);
+
+	return 0;
+}
+
+static int dynamic_modem_data_write(struct json_writer *writer,
+				    const struct cloud_data_modem_dynamic *data)
+{
+	int64_t ts;
+	int err = cloud_codec_timestamp_get(data->ts, &ts);
+
+	if (err) {
+		return err;
+	}
+
+	entry_start(writer);
+	json_writer_obj_start(writer);
+	json_writer_key_int(writer, MODEM_RSRP, data->rsrp);
+	json_writer_key_int(writer, MODEM_AREA_CODE, data->area);
+	json_writer_key_int(writer, MODEM_MCCMNC,
+			    strtol(data->mccmnc, NULL, 10));
+	json_writer_key_int(writer, MODEM_CELL_ID, data->cell);
+	json_writer_key_str(writer, MODEM_IP_ADDRESS, data->ip);
+	json_writer_obj_end(writer);
+	entry_end(writer, ts);
+
+	return 0;
+}
+
+/* Write the queued entries of a buffer as an array, if there are any. */
+#define QUEUED_ARRAY_WRITE(_writer, _key, _buf, _count, _write_fn) ({	\
+	bool _started = false;						\
+	int _err = 0;							\
+	for (size_t _i = 0; (_i < (_count)) && !_err; _i++) {		\
+		if (!(_buf)[_i].queued) {				\
+			continue;					\
+		}							\
+		if (!_started) {					\
+			json_writer_key(_writer, _key);			\
+			json_writer_arr_start(_writer);			\
+			_started = true;				\
+		}							\
+		_err = _write_fn(_writer, &(_buf)[_i]);			\
+	}								\
+	if (_started && !_err) {					\
+		json_writer_arr_end(_writer);				\
+	}								\
+	_err;								\
+})
+
+#define QUEUED_ANY(_buf, _count) ({					\
+	bool _queued = false;						\
+	for (size_t _i = 0; (_i < (_count)) && !_queued; _i++) {	\
+		_queued = (_buf)[_i].queued;				\
+	}								\
+	_queued;							\
+})
+
+static bool batch_data_queued(const struct batch_data *data)
+{
+	return QUEUED_ANY(data->gps_buf, data->gps_buf_count) ||
+	       QUEUED_ANY(data->sensor_buf, data->sensor_buf_count) ||
+	       QUEUED_ANY(data->ui_buf, data->ui_buf_count) ||
+	       QUEUED_ANY(data->accel_buf, data->accel_buf_count) ||
+	       QUEUED_ANY(data->bat_buf, data->bat_buf_count) ||
+	       QUEUED_ANY(data->modem_dyn_buf, data->modem_dyn_buf_count);
+}
+
+static int batch_data_write(struct json_writer *writer,
+			    const struct batch_data *data)
+{
+	int err;
+
+	json_writer_obj_start(writer);
+
+	err = QUEUED_ARRAY_WRITE(writer, DATA_GPS, data->gps_buf,
+				 data->gps_buf_count, gps_data_write);
+	if (err) {
+		return err;
+	}
+
+	err = QUEUED_ARRAY_WRITE(writer, DATA_ENVIRONMENTALS, data->sensor_buf,
+				 data->sensor_buf_count, sensor_data_write);
+	if (err) {
+		return err;
+	}
+
+	err = QUEUED_ARRAY_WRITE(writer, DATA_BUTTON, data->ui_buf,
+				 data->ui_buf_count, ui_data_write);
+	if (err) {
+		return err;
+	}
+
+	err = QUEUED_ARRAY_WRITE(writer, DATA_MOVEMENT, data->accel_buf,
+				 data->accel_buf_count, accel_data_write);
+	if (err) {
+		return err;
+	}
+
+	err = QUEUED_ARRAY_WRITE(writer, DATA_BATTERY, data->bat_buf,
+				 data->bat_buf_count, bat_data_write);
+	if (err) {
+		return err;
+	}
+
+	err = QUEUED_ARRAY_WRITE(writer, DATA_MODEM_DYNAMIC,
+				 data->modem_dyn_buf,
+				 data->modem_dyn_buf_count,
+				 dynamic_modem_data_write);
+	if (err) {
+		return err;
+	}
+
+	json_writer_obj_end(writer);
+
+	return 0;
+}
+#endif /* !defined(CONFIG_CLOUD_CODEC_CBOR) */
+
 static int bat_data_add(cJSON *parent, struct cloud_data_battery *data,
 			bool batch_entry)
 {
@@ -641,6 +869,7 @@ exit:
 	return err;
 }
 
+#if !defined(CONFIG_CLOUD_CODEC_CBOR)
 int cloud_codec_encode_ui_data(struct cloud_codec_data *output,
 			       struct cloud_data_ui *ui_buf)
 {
@@ -700,146 +929,68 @@ int cloud_codec_encode_batch_data(
 				size_t accel_buf_count,
 				size_t bat_buf_count)
 {
-	int err = 0;
+	int err;
 	char *buffer;
-	bool data_encoded = false;
-
-	cJSON *root_obj = cJSON_CreateObject();
-	cJSON *gps_obj = cJSON_CreateArray();
-	cJSON *sensor_obj = cJSON_CreateArray();
-	cJSON *modem_obj = cJSON_CreateArray();
-	cJSON *ui_obj = cJSON_CreateArray();
-	cJSON *accel_obj = cJSON_CreateArray();
-	cJSON *bat_obj = cJSON_CreateArray();
-
-	if (root_obj == NULL || gps_obj == NULL || sensor_obj == NULL ||
-	    modem_obj == NULL || ui_obj == NULL || accel_obj == NULL ||
-	    bat_obj == NULL) {
-		cJSON_Delete(root_obj);
-		cJSON_Delete(gps_obj);
-		cJSON_Delete(sensor_obj);
-		cJSON_Delete(modem_obj);
-		cJSON_Delete(ui_obj);
-		cJSON_Delete(accel_obj);
-		cJSON_Delete(bat_obj);
-		return -ENOMEM;
-	}
-
-	/* GPS data */
-	for (int i = 0; i < gps_buf_count; i++) {
-		if (gps_buf[i].queued) {
-			err += gps_data_add(gps_obj, &gps_buf[i], true);
-		}
-	}
-
-	if (cJSON_GetArraySize(gps_obj) > 0) {
-		err += json_add_obj(root_obj, DATA_GPS, gps_obj);
-		data_encoded = true;
-	} else {
-		cJSON_Delete(gps_obj);
-	}
-
-	/* Environmental sensor data */
-	for (int i = 0; i < sensor_buf_count; i++) {
-		if (sensor_buf[i].queued) {
-			err += sensor_data_add(sensor_obj,
-					       &sensor_buf[i],
-					       true);
-		}
-	}
-
-	if (cJSON_GetArraySize(sensor_obj) > 0) {
-		err += json_add_obj(root_obj, DATA_ENVIRONMENTALS, sensor_obj);
-		data_encoded = true;
-	} else {
-		cJSON_Delete(sensor_obj);
-	}
-
-	/* UI data */
-	for (int i = 0; i < ui_buf_count; i++) {
-		if (ui_buf[i].queued) {
-			err += ui_data_add(ui_obj, &ui_buf[i], true);
-		}
-	}
-
-	if (cJSON_GetArraySize(ui_obj) > 0) {
-		err += json_add_obj(root_obj, DATA_BUTTON, ui_obj);
-		data_encoded = true;
-	} else {
-		cJSON_Delete(ui_obj);
-	}
-
-	/* Movement data */
-	for (int i = 0; i < accel_buf_count; i++) {
-		if (accel_buf[i].queued) {
-			err += accel_data_add(accel_obj,
-					      &accel_buf[i],
-					      true);
-		}
+	size_t len;
+	struct json_writer writer;
+	const struct batch_data data = {
+		.gps_buf = gps_buf,
+		.sensor_buf = sensor_buf,
+		.modem_dyn_buf = modem_dyn_buf,
+		.ui_buf = ui_buf,
+		.accel_buf = accel_buf,
+		.bat_buf = bat_buf,
+		.gps_buf_count = gps_buf_count,
+		.sensor_buf_count = sensor_buf_count,
+		.modem_dyn_buf_count = modem_dyn_buf_count,
+		.ui_buf_count = ui_buf_count,
+		.accel_buf_count = accel_buf_count,
+		.bat_buf_count = bat_buf_count,
+	};
+
+	if (!batch_data_queued(&data)) {
+		return -ENODATA;
+	}
+
+	/* Get the length of the message first, then write it directly into
+	 * a buffer of the exact size.
+	 */
+	json_writer_init(&writer, NULL, 0);
+
+	err = batch_data_write(&writer, &data);
+	if (err) {
+		return err;
 	}
 
-	if (cJSON_GetArraySize(accel_obj) > 0) {
-		err += json_add_obj(root_obj, DATA_MOVEMENT, accel_obj);
-		data_encoded = true;
-	} else {
-		cJSON_Delete(accel_obj);
-	}
+	len = json_writer_len(&writer);
 
-	/* Battery data */
-	for (int i = 0; i < bat_buf_count; i++) {
-		if (bat_buf[i].queued) {
-			err += bat_data_add(bat_obj, &bat_buf[i], true);
-		}
+	buffer = cloud_codec_output_alloc(len + 1);
+	if (buffer == NULL) {
+		LOG_ERR("Failed to allocate memory for JSON string");
+		return -ENOMEM;
 	}
 
-	if (cJSON_GetArraySize(bat_obj) > 0) {
-		err += json_add_obj(root_obj, DATA_BATTERY, bat_obj);
-		data_encoded = true;
-	} else {
-		cJSON_Delete(bat_obj);
-	}
+	json_writer_init(&writer, buffer, len + 1);
 
-	/* Dynamic modem data */
-	for (int i = 0; i < modem_dyn_buf_count; i++) {
-		if (modem_dyn_buf[i].queued) {
-			err += dynamic_modem_data_add(modem_obj,
-						     &modem_dyn_buf[i],
-						     true);
-		}
-	}
-
-	if (cJSON_GetArraySize(modem_obj) > 0) {
-		err += json_add_obj(root_obj, DATA_MODEM_DYNAMIC, modem_obj);
-		data_encoded = true;
-	} else {
-		cJSON_Delete(modem_obj);
+	err = batch_data_write(&writer, &data);
+	if (!err) {
+		err = json_writer_finish(&writer);
 	}
 
 	if (err) {
-		goto exit;
-	} else if (!data_encoded) {
-		err = -ENODATA;
-		goto exit;
+		k_free(buffer);
+		return err;
 	}
 
-	buffer = cJSON_PrintUnformatted(root_obj);
-	if (buffer == NULL) {
-		LOG_ERR("Failed to allocate memory for JSON string");
-
-		err = -ENOMEM;
-		goto exit;
-	}
+	__ASSERT_NO_MSG(json_writer_len(&writer) == len);
 
-	if (IS_ENABLED(CONFIG_CLOUD_CODEC_LOG_LEVEL_DBG)) {
-		json_print_obj("Encoded batch message:\n", root_obj);
-	}
+	LOG_DBG("Encoded batch message: %s", log_strdup(buffer));
 
 	output->buf = buffer;
-	output->len = strlen(buffer);
+	output->len = len;
 
-exit:
-
-	cJSON_Delete(root_obj);
+	cloud_codec_batch_clear(&data);
 
-	return err;
+	return 0;
 }
+#endif /* !defined(CONFIG_CLOUD_CODEC_CBOR) */
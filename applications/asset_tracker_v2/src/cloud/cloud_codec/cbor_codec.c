@@ -0,0 +1,484 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <cloud_codec.h>
+#include <stdbool.h>
+#include <string.h>
+#include <zephyr.h>
+#include <zephyr/types.h>
+#include <stdlib.h>
+#include <tinycbor/cbor.h>
+#include <tinycbor/cbor_buf_writer.h>
+#include <tinycbor/cbor_cnt_writer.h>
+#include "cloud_codec_common.h"
+
+#include <logging/log.h>
+LOG_MODULE_DECLARE(cloud_codec, CONFIG_CLOUD_CODEC_LOG_LEVEL);
+
+#define MODEM_RSRP		"rsrp"
+#define MODEM_AREA_CODE		"area"
+#define MODEM_MCCMNC		"mccmnc"
+#define MODEM_CELL_ID		"cell"
+#define MODEM_IP_ADDRESS	"ip"
+
+#define OBJECT_VALUE		"v"
+#define OBJECT_TIMESTAMP	"ts"
+
+#define DATA_MODEM_DYNAMIC	"roam"
+#define DATA_BATTERY		"bat"
+#define DATA_TEMPERATURE	"temp"
+#define DATA_HUMID		"hum"
+#define DATA_ENVIRONMENTALS	"env"
+#define DATA_BUTTON		"btn"
+
+#define DATA_MOVEMENT		"acc"
+#define DATA_MOVEMENT_X		"x"
+#define DATA_MOVEMENT_Y		"y"
+#define DATA_MOVEMENT_Z		"z"
+
+#define DATA_GPS		"gps"
+#define DATA_GPS_LONGITUDE	"lng"
+#define DATA_GPS_LATITUDE	"lat"
+#define DATA_GPS_ALTITUDE	"alt"
+#define DATA_GPS_SPEED		"spd"
+#define DATA_GPS_HEADING	"hdg"
+
+/* Number of items in an encoded entry, value and timestamp. */
+#define ENTRY_ITEM_COUNT	2
+
+typedef int (*encode_fn)(CborEncoder *encoder, const void *data);
+
+/* Static functions */
+static int cbor_err_to_errno(CborError err)
+{
+	if (err & CborErrorOutOfMemory) {
+		return -ENOMEM;
+	}
+
+	return (err == CborNoError) ? 0 : -EINVAL;
+}
+
+static CborError entry_start(CborEncoder *parent, CborEncoder *entry,
+			     const char *key)
+{
+	CborError err = CborNoError;
+
+	if (key) {
+		err |= cbor_encode_text_stringz(parent, key);
+	}
+
+	err |= cbor_encoder_create_map(parent, entry, ENTRY_ITEM_COUNT);
+	err |= cbor_encode_text_stringz(entry, OBJECT_VALUE);
+
+	return err;
+}
+
+static CborError entry_end(CborEncoder *parent, CborEncoder *entry,
+			   int64_t ts)
+{
+	CborError err = CborNoError;
+
+	err |= cbor_encode_text_stringz(entry, OBJECT_TIMESTAMP);
+	err |= cbor_encode_int(entry, ts);
+	err |= cbor_encoder_close_container(parent, entry);
+
+	return err;
+}
+
+static CborError float_add(CborEncoder *map, const char *key, float value)
+{
+	CborError err = cbor_encode_text_stringz(map, key);
+
+	return err | cbor_encode_float(map, value);
+}
+
+static CborError double_add(CborEncoder *map, const char *key, double value)
+{
+	CborError err = cbor_encode_text_stringz(map, key);
+
+	return err | cbor_encode_double(map, value);
+}
+
+static CborError int_add(CborEncoder *map, const char *key, int64_t value)
+{
+	CborError err = cbor_encode_text_stringz(map, key);
+
+	return err | cbor_encode_int(map, value);
+}
+
+static int dynamic_modem_data_encode(CborEncoder *parent,
+				     const struct cloud_data_modem_dynamic *data,
+				     const char *key)
+{
+	CborEncoder entry;
+	CborEncoder value;
+	CborError err;
+	int64_t ts;
+
+	if (cloud_codec_timestamp_get(data->ts, &ts)) {
+		return -EINVAL;
+	}
+
+	err = entry_start(parent, &entry, key);
+	err |= cbor_encoder_create_map(&entry, &value, 5);
+	err |= int_add(&value, MODEM_RSRP, data->rsrp);
+	err |= int_add(&value, MODEM_AREA_CODE, data->area);
+	err |= int_add(&value, MODEM_MCCMNC, strtol(data->mccmnc, NULL, 10));
+	err |= int_add(&value, MODEM_CELL_ID, data->cell);
+	err |= cbor_encode_text_stringz(&value, MODEM_IP_ADDRESS);
+	err |= cbor_encode_text_stringz(&value, data->ip);
+	err |= cbor_encoder_close_container(&entry, &value);
+	err |= entry_end(parent, &entry, ts);
+
+	return cbor_err_to_errno(err);
+}
+
+static int sensor_data_encode(CborEncoder *parent,
+			      const struct cloud_data_sensors *data,
+			      const char *key)
+{
+	CborEncoder entry;
+	CborEncoder value;
+	CborError err;
+	int64_t ts;
+
+	if (cloud_codec_timestamp_get(data->env_ts, &ts)) {
+		return -EINVAL;
+	}
+
+	err = entry_start(parent, &entry, key);
+	err |= cbor_encoder_create_map(&entry, &value, 2);
+	err |= double_add(&value, DATA_TEMPERATURE, data->temp);
+	err |= double_add(&value, DATA_HUMID, data->hum);
+	err |= cbor_encoder_close_container(&entry, &value);
+	err |= entry_end(parent, &entry, ts);
+
+	return cbor_err_to_errno(err);
+}
+
+static int gps_data_encode(CborEncoder *parent,
+			   const struct cloud_data_gps *data,
+			   const char *key)
+{
+	CborEncoder entry;
+	CborEncoder value;
+	CborError err;
+	int64_t ts;
+
+	if (cloud_codec_timestamp_get(data->gps_ts, &ts)) {
+		return -EINVAL;
+	}
+
+	err = entry_start(parent, &entry, key);
+	err |= cbor_encoder_create_map(&entry, &value, 6);
+	err |= double_add(&value, DATA_GPS_LONGITUDE, data->longi);
+	err |= double_add(&value, DATA_GPS_LATITUDE, data->lat);
+	err |= float_add(&value, DATA_MOVEMENT, data->acc);
+	err |= float_add(&value, DATA_GPS_ALTITUDE, data->alt);
+	err |= float_add(&value, DATA_GPS_SPEED, data->spd);
+	err |= float_add(&value, DATA_GPS_HEADING, data->hdg);
+	err |= cbor_encoder_close_container(&entry, &value);
+	err |= entry_end(parent, &entry, ts);
+
+	return cbor_err_to_errno(err);
+}
+
+static int accel_data_encode(CborEncoder *parent,
+			     const struct cloud_data_accelerometer *data,
+			     const char *key)
+{
+	CborEncoder entry;
+	CborEncoder value;
+	CborError err;
+	int64_t ts;
+
+	if (cloud_codec_timestamp_get(data->ts, &ts)) {
+		return -EINVAL;
+	}
+
+	err = entry_start(parent, &entry, key);
+	err |= cbor_encoder_create_map(&entry, &value, 3);
+	err |= double_add(&value, DATA_MOVEMENT_X, data->values[0]);
+	err |= double_add(&value, DATA_MOVEMENT_Y, data->values[1]);
+	err |= double_add(&value, DATA_MOVEMENT_Z, data->values[2]);
+	err |= cbor_encoder_close_container(&entry, &value);
+	err |= entry_end(parent, &entry, ts);
+
+	return cbor_err_to_errno(err);
+}
+
+static int ui_data_encode(CborEncoder *parent,
+			  const struct cloud_data_ui *data,
+			  const char *key)
+{
+	CborEncoder entry;
+	CborError err;
+	int64_t ts;
+
+	if (cloud_codec_timestamp_get(data->btn_ts, &ts)) {
+		return -EINVAL;
+	}
+
+	err = entry_start(parent, &entry, key);
+	err |= cbor_encode_int(&entry, data->btn);
+	err |= entry_end(parent, &entry, ts);
+
+	return cbor_err_to_errno(err);
+}
+
+static int bat_data_encode(CborEncoder *parent,
+			   const struct cloud_data_battery *data,
+			   const char *key)
+{
+	CborEncoder entry;
+	CborError err;
+	int64_t ts;
+
+	if (cloud_codec_timestamp_get(data->bat_ts, &ts)) {
+		return -EINVAL;
+	}
+
+	err = entry_start(parent, &entry, key);
+	err |= cbor_encode_uint(&entry, data->bat);
+	err |= entry_end(parent, &entry, ts);
+
+	return cbor_err_to_errno(err);
+}
+
+/* Encode the queued entries of a buffer as an array, using the given
+ * entry encoder.
+ */
+#define QUEUED_COUNT(_buf, _count) ({					\
+	size_t _queued = 0;						\
+	for (size_t _i = 0; _i < (_count); _i++) {			\
+		_queued += (_buf)[_i].queued;				\
+	}								\
+	_queued;							\
+})
+
+#define QUEUED_ARRAY_ENCODE(_map, _key, _buf, _count, _encode_fn) ({	\
+	size_t _queued = QUEUED_COUNT(_buf, _count);			\
+	int _err = 0;							\
+	if (_queued > 0) {						\
+		CborEncoder _array;					\
+		CborError _cbor_err;					\
+		_cbor_err = cbor_encode_text_stringz(_map, _key);	\
+		_cbor_err |= cbor_encoder_create_array(_map, &_array,	\
+						       _queued);	\
+		_err = cbor_err_to_errno(_cbor_err);			\
+		for (size_t _i = 0; (_i < (_count)) && !_err; _i++) {	\
+			if ((_buf)[_i].queued) {			\
+				_err = _encode_fn(&_array, &(_buf)[_i],	\
+						  NULL);		\
+			}						\
+		}							\
+		if (!_err) {						\
+			_err = cbor_err_to_errno(			\
+				cbor_encoder_close_container(_map,	\
+							     &_array));	\
+		}							\
+	}								\
+	_err;								\
+})
+
+static size_t batch_array_count(const struct batch_data *data)
+{
+	return (QUEUED_COUNT(data->gps_buf, data->gps_buf_count) > 0) +
+	       (QUEUED_COUNT(data->sensor_buf, data->sensor_buf_count) > 0) +
+	       (QUEUED_COUNT(data->ui_buf, data->ui_buf_count) > 0) +
+	       (QUEUED_COUNT(data->accel_buf, data->accel_buf_count) > 0) +
+	       (QUEUED_COUNT(data->bat_buf, data->bat_buf_count) > 0) +
+	       (QUEUED_COUNT(data->modem_dyn_buf,
+			     data->modem_dyn_buf_count) > 0);
+}
+
+static int batch_data_encode(CborEncoder *encoder, const void *ctx)
+{
+	const struct batch_data *data = ctx;
+	CborEncoder root;
+	int err;
+
+	err = cbor_err_to_errno(cbor_encoder_create_map(encoder, &root,
+						batch_array_count(data)));
+	if (err) {
+		return err;
+	}
+
+	err = QUEUED_ARRAY_ENCODE(&root, DATA_GPS, data->gps_buf,
+				  data->gps_buf_count, gps_data_encode);
+	if (err) {
+		return err;
+	}
+
+	err = QUEUED_ARRAY_ENCODE(&root, DATA_ENVIRONMENTALS, data->sensor_buf,
+				  data->sensor_buf_count, sensor_data_encode);
+	if (err) {
+		return err;
+	}
+
+	err = QUEUED_ARRAY_ENCODE(&root, DATA_BUTTON, data->ui_buf,
+				  data->ui_buf_count, ui_data_encode);
+	if (err) {
+		return err;
+	}
+
+	err = QUEUED_ARRAY_ENCODE(&root, DATA_MOVEMENT, data->accel_buf,
+				  data->accel_buf_count, accel_data_encode);
+	if (err) {
+		return err;
+	}
+
+	err = QUEUED_ARRAY_ENCODE(&root, DATA_BATTERY, data->bat_buf,
+				  data->bat_buf_count, bat_data_encode);
+	if (err) {
+		return err;
+	}
+
+	err = QUEUED_ARRAY_ENCODE(&root, DATA_MODEM_DYNAMIC,
+				  data->modem_dyn_buf,
+				  data->modem_dyn_buf_count,
+				  dynamic_modem_data_encode);
+	if (err) {
+		return err;
+	}
+
+	return cbor_err_to_errno(cbor_encoder_close_container(encoder, &root));
+}
+
+static int ui_root_encode(CborEncoder *encoder, const void *ctx)
+{
+	const struct cloud_data_ui *data = ctx;
+	CborEncoder root;
+	int err;
+
+	err = cbor_err_to_errno(cbor_encoder_create_map(encoder, &root, 1));
+	if (err) {
+		return err;
+	}
+
+	err = ui_data_encode(&root, data, DATA_BUTTON);
+	if (err) {
+		return err;
+	}
+
+	return cbor_err_to_errno(cbor_encoder_close_container(encoder, &root));
+}
+
+/* Encode the data twice. The first pass only counts the encoded bytes,
+ * the second one encodes the data straight into an output buffer of the
+ * exact size. No intermediate representation of the data is built.
+ */
+static int encode(struct cloud_codec_data *output, encode_fn fn,
+		  const void *data)
+{
+	struct CborCntWriter cnt_writer;
+	struct cbor_buf_writer buf_writer;
+	CborEncoder encoder;
+	uint8_t *buffer;
+	size_t len;
+	int err;
+
+	cbor_cnt_writer_init(&cnt_writer);
+	cbor_encoder_init(&encoder, &cnt_writer.enc, 0);
+
+	err = fn(&encoder, data);
+	if (err) {
+		return err;
+	}
+
+	len = cnt_writer.enc.bytes_written;
+
+	buffer = cloud_codec_output_alloc(len);
+	if (buffer == NULL) {
+		LOG_ERR("Failed to allocate memory for CBOR output");
+		return -ENOMEM;
+	}
+
+	cbor_buf_writer_init(&buf_writer, buffer, len);
+	cbor_encoder_init(&encoder, &buf_writer.enc, 0);
+
+	err = fn(&encoder, data);
+	if (err) {
+		k_free(buffer);
+		return err;
+	}
+
+	__ASSERT_NO_MSG(cbor_buf_writer_buffer_size(&buf_writer, buffer) == len);
+
+	if (IS_ENABLED(CONFIG_CLOUD_CODEC_LOG_LEVEL_DBG)) {
+		LOG_HEXDUMP_DBG(buffer, len, "Encoded message:");
+	}
+
+	output->buf = (char *)buffer;
+	output->len = len;
+
+	return 0;
+}
+
+/* Public interface */
+int cloud_codec_encode_ui_data(struct cloud_codec_data *output,
+			       struct cloud_data_ui *ui_buf)
+{
+	int err;
+
+	if (!ui_buf->queued) {
+		return 0;
+	}
+
+	err = encode(output, ui_root_encode, ui_buf);
+	if (err) {
+		return err;
+	}
+
+	ui_buf->queued = false;
+
+	return 0;
+}
+
+int cloud_codec_encode_batch_data(
+				struct cloud_codec_data *output,
+				struct cloud_data_gps *gps_buf,
+				struct cloud_data_sensors *sensor_buf,
+				struct cloud_data_modem_dynamic *modem_dyn_buf,
+				struct cloud_data_ui *ui_buf,
+				struct cloud_data_accelerometer *accel_buf,
+				struct cloud_data_battery *bat_buf,
+				size_t gps_buf_count,
+				size_t sensor_buf_count,
+				size_t modem_dyn_buf_count,
+				size_t ui_buf_count,
+				size_t accel_buf_count,
+				size_t bat_buf_count)
+{
+	int err;
+	const struct batch_data data = {
+		.gps_buf = gps_buf,
+		.sensor_buf = sensor_buf,
+		.modem_dyn_buf = modem_dyn_buf,
+		.ui_buf = ui_buf,
+		.accel_buf = accel_buf,
+		.bat_buf = bat_buf,
+		.gps_buf_count = gps_buf_count,
+		.sensor_buf_count = sensor_buf_count,
+		.modem_dyn_buf_count = modem_dyn_buf_count,
+		.ui_buf_count = ui_buf_count,
+		.accel_buf_count = accel_buf_count,
+		.bat_buf_count = bat_buf_count,
+	};
+
+	if (batch_array_count(&data) == 0) {
+		return -ENODATA;
+	}
+
+	err = encode(output, batch_data_encode, &data);
+	if (err) {
+		return err;
+	}
+
+	cloud_codec_batch_clear(&data);
+
+	return 0;
+}
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr.h>
+#include <date_time.h>
+
+#include "cloud_codec_common.h"
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(cloud_codec_common, CONFIG_CLOUD_CODEC_LOG_LEVEL);
+
+#define QUEUED_CLEAR(_buf, _count) do {					\
+	for (size_t _i = 0; _i < (_count); _i++) {			\
+		(_buf)[_i].queued = false;				\
+	}								\
+} while (0)
+
+int cloud_codec_timestamp_get(int64_t uptime_ts, int64_t *unix_ts)
+{
+	/* The data is encoded twice and stays queued until it is encoded
+	 * successfully, so a copy of the timestamp is converted.
+	 */
+	*unix_ts = uptime_ts;
+
+	int err = date_time_uptime_to_unix_time_ms(unix_ts);
+
+	if (err) {
+		LOG_ERR("date_time_uptime_to_unix_time_ms, error: %d", err);
+	}
+
+	return err;
+}
+
+void *cloud_codec_output_alloc(size_t len)
+{
+	/* cloud_codec_release_data() frees the output with
+	 * cJSON_FreeString(), which releases memory to the kernel heap.
+	 */
+	return k_malloc(len);
+}
+
+void cloud_codec_batch_clear(const struct batch_data *data)
+{
+	QUEUED_CLEAR(data->gps_buf, data->gps_buf_count);
+	QUEUED_CLEAR(data->sensor_buf, data->sensor_buf_count);
+	QUEUED_CLEAR(data->modem_dyn_buf, data->modem_dyn_buf_count);
+	QUEUED_CLEAR(data->ui_buf, data->ui_buf_count);
+	QUEUED_CLEAR(data->accel_buf, data->accel_buf_count);
+	QUEUED_CLEAR(data->bat_buf, data->bat_buf_count);
+}
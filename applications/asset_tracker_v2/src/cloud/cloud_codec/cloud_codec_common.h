@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef CLOUD_CODEC_COMMON_H__
+#define CLOUD_CODEC_COMMON_H__
+
+#include <cloud_codec.h>
+
+/* Buffers passed to cloud_codec_encode_batch_data(). */
+struct batch_data {
+	struct cloud_data_gps *gps_buf;
+	struct cloud_data_sensors *sensor_buf;
+	struct cloud_data_modem_dynamic *modem_dyn_buf;
+	struct cloud_data_ui *ui_buf;
+	struct cloud_data_accelerometer *accel_buf;
+	struct cloud_data_battery *bat_buf;
+	size_t gps_buf_count;
+	size_t sensor_buf_count;
+	size_t modem_dyn_buf_count;
+	size_t ui_buf_count;
+	size_t accel_buf_count;
+	size_t bat_buf_count;
+};
+
+/* Convert the uptime of an entry to a UNIX timestamp. */
+int cloud_codec_timestamp_get(int64_t uptime_ts, int64_t *unix_ts);
+
+/* Allocate the buffer of an encoded message. */
+void *cloud_codec_output_alloc(size_t len);
+
+/* Mark all entries of the batch as sent. */
+void cloud_codec_batch_clear(const struct batch_data *data);
+
+#endif /* CLOUD_CODEC_COMMON_H__ */
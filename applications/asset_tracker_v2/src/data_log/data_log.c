@@ -0,0 +1,949 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <storage/flash_map.h>
+#include <sys/crc.h>
+#include <date_time.h>
+
+#include "data_log.h"
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(data_log, CONFIG_DATA_LOG_LOG_LEVEL);
+
+#define DATA_LOG_AREA_ID	FLASH_AREA_ID(data_log_storage)
+
+#define SECTOR_MAGIC		0x44544c47 /* DTLG */
+#define SECTORS_MAX		CONFIG_DATA_LOG_SECTORS_MAX
+
+#define RECORD_CURSOR		0x10
+#define RECORD_TYPE_MASK	0x7F
+/* Timestamp of the record is UNIX time, otherwise it is the uptime of the
+ * boot session stored in the record header.
+ */
+#define RECORD_TS_UNIX		0x80
+#define RECORD_ERASED		0xFF
+
+/* Write granularity is assumed to be at most this many bytes. */
+#define ALIGN_MAX		16
+
+struct sector_hdr {
+	uint32_t magic;
+	uint32_t seq;
+	uint32_t crc;
+} __packed;
+
+struct record_hdr {
+	uint8_t type;
+	uint8_t len;
+	uint16_t session;
+	uint32_t crc;
+} __packed;
+
+struct record_gps {
+	int64_t ts;
+	double longi;
+	double lat;
+	float alt;
+	float acc;
+	float spd;
+	float hdg;
+} __packed;
+
+struct record_sensors {
+	int64_t ts;
+	double temp;
+	double hum;
+} __packed;
+
+struct record_modem_dyn {
+	int64_t ts;
+	uint16_t area;
+	uint16_t cell;
+	uint16_t rsrp;
+	char ip[CONFIG_DATA_LOG_IP_LEN];
+	char mccmnc[CONFIG_DATA_LOG_MCCMNC_LEN];
+} __packed;
+
+struct record_ui {
+	int64_t ts;
+	int32_t btn;
+} __packed;
+
+struct record_accel {
+	int64_t ts;
+	double values[3];
+} __packed;
+
+struct record_bat {
+	int64_t ts;
+	uint16_t bat;
+} __packed;
+
+union record_payload {
+	struct record_gps gps;
+	struct record_sensors sensors;
+	struct record_modem_dyn modem_dyn;
+	struct record_ui ui;
+	struct record_accel accel;
+	struct record_bat bat;
+	struct data_log_pos cursor;
+};
+
+BUILD_ASSERT(sizeof(union record_payload) <= UINT8_MAX,
+	     "Record length must fit in the record header");
+
+static const struct flash_area *fa;
+static uint32_t sector_size;
+static uint32_t sector_count;
+static uint32_t write_align;
+
+/* Sequence number of the oldest sector that holds records. */
+static uint32_t oldest_seq;
+/* Position at which the next record is written. */
+static struct data_log_pos write_pos;
+/* Position of the next record to read. */
+static struct data_log_pos read_pos;
+/* Position up to which records have been delivered. */
+static struct data_log_pos commit_pos;
+/* Position up to which records that cannot be delivered have been counted
+ * as dropped. Records read again after a rewind are not counted twice.
+ */
+static struct data_log_pos drop_pos;
+/* Boot session, used for records without UNIX time. */
+static uint16_t session;
+
+static struct data_log_stats stats;
+
+static uint32_t hdr_size(void)
+{
+	return ROUND_UP(sizeof(struct sector_hdr), write_align);
+}
+
+static off_t pos_to_off(const struct data_log_pos *pos)
+{
+	return (pos->seq % sector_count) * sector_size + pos->offset;
+}
+
+static bool pos_before(const struct data_log_pos *a,
+		       const struct data_log_pos *b)
+{
+	return (a->seq < b->seq) ||
+	       ((a->seq == b->seq) && (a->offset < b->offset));
+}
+
+static struct data_log_pos sector_start(uint32_t seq)
+{
+	return (struct data_log_pos) {
+		.seq = seq,
+		.offset = hdr_size(),
+	};
+}
+
+static uint32_t sector_hdr_crc(const struct sector_hdr *hdr)
+{
+	return crc32_ieee((const uint8_t *)hdr, offsetof(struct sector_hdr, crc));
+}
+
+static uint32_t record_crc(const struct record_hdr *hdr, const void *payload)
+{
+	uint32_t crc = crc32_ieee((const uint8_t *)hdr,
+				  offsetof(struct record_hdr, crc));
+
+	return crc32_ieee_update(crc, payload, hdr->len);
+}
+
+/* Read the header of the sector at the given index. Returns false if the
+ * sector does not hold a valid header.
+ */
+static bool sector_hdr_read(uint32_t index, uint32_t *seq)
+{
+	struct sector_hdr hdr;
+	int err;
+
+	err = flash_area_read(fa, index * sector_size, &hdr, sizeof(hdr));
+	if (err) {
+		LOG_ERR("flash_area_read, error: %d", err);
+		return false;
+	}
+
+	if ((hdr.magic != SECTOR_MAGIC) || (hdr.crc != sector_hdr_crc(&hdr)) ||
+	    ((hdr.seq % sector_count) != index)) {
+		return false;
+	}
+
+	*seq = hdr.seq;
+
+	return true;
+}
+
+static int sector_open(uint32_t seq)
+{
+	uint8_t buf[ROUND_UP(sizeof(struct sector_hdr), ALIGN_MAX)];
+	struct sector_hdr hdr = {
+		.magic = SECTOR_MAGIC,
+		.seq = seq,
+	};
+	int err;
+
+	err = flash_area_erase(fa, (seq % sector_count) * sector_size,
+			       sector_size);
+	if (err) {
+		LOG_ERR("flash_area_erase, error: %d", err);
+		return err;
+	}
+
+	stats.erased++;
+
+	hdr.crc = sector_hdr_crc(&hdr);
+
+	memset(buf, RECORD_ERASED, sizeof(buf));
+	memcpy(buf, &hdr, sizeof(hdr));
+
+	err = flash_area_write(fa, (seq % sector_count) * sector_size, buf,
+			       hdr_size());
+	if (err) {
+		LOG_ERR("flash_area_write, error: %d", err);
+		return err;
+	}
+
+	stats.bytes_written += hdr_size();
+	write_pos = sector_start(seq);
+
+	return 0;
+}
+
+/* Read the record at the given position.
+ *
+ * Returns -ENOENT if there are no more records in the sector, -EBADMSG if
+ * the record is corrupted but can be skipped. The position is advanced to
+ * the next record in both the successful and the -EBADMSG case.
+ */
+static int record_read(struct data_log_pos *pos, struct record_hdr *hdr,
+		       union record_payload *payload)
+{
+	uint32_t end = (pos->seq == write_pos.seq) ? write_pos.offset :
+						     sector_size;
+	uint32_t total;
+	int err;
+
+	if (pos->offset + sizeof(*hdr) > end) {
+		return -ENOENT;
+	}
+
+	err = flash_area_read(fa, pos_to_off(pos), hdr, sizeof(*hdr));
+	if (err) {
+		LOG_ERR("flash_area_read, error: %d", err);
+		return err;
+	}
+
+	if ((hdr->type == RECORD_ERASED) && (hdr->len == RECORD_ERASED)) {
+		return -ENOENT;
+	}
+
+	total = ROUND_UP(sizeof(*hdr) + hdr->len, write_align);
+
+	if ((hdr->len > sizeof(*payload)) || (pos->offset + total > end)) {
+		/* Length is not trustworthy, nothing more can be read from
+		 * the sector.
+		 */
+		return -ENOENT;
+	}
+
+	err = flash_area_read(fa, pos_to_off(pos) + sizeof(*hdr), payload,
+			      hdr->len);
+	if (err) {
+		LOG_ERR("flash_area_read, error: %d", err);
+		return err;
+	}
+
+	pos->offset += total;
+
+	if (hdr->crc != record_crc(hdr, payload)) {
+		return -EBADMSG;
+	}
+
+	return 0;
+}
+
+/* Uptime from a previous boot is meaningless, such a record cannot be
+ * delivered.
+ */
+static bool record_stale(const struct record_hdr *hdr)
+{
+	return !(hdr->type & RECORD_TS_UNIX) && (hdr->session != session);
+}
+
+/* Count the records in the sector of the position, starting at the
+ * position. Used to account for records dropped when a sector is reused.
+ * Records that could not be delivered were counted when they were read.
+ */
+static uint32_t records_count(struct data_log_pos pos)
+{
+	struct record_hdr hdr;
+	union record_payload payload;
+	uint32_t count = 0;
+	int err;
+
+	do {
+		struct data_log_pos rec_pos = pos;
+
+		err = record_read(&pos, &hdr, &payload);
+		if ((err != 0) ||
+		    ((hdr.type & RECORD_TYPE_MASK) == RECORD_CURSOR)) {
+			continue;
+		}
+
+		if (!record_stale(&hdr) || !pos_before(&rec_pos, &drop_pos)) {
+			count++;
+		}
+	} while ((err == 0) || (err == -EBADMSG));
+
+	return count;
+}
+
+static int sector_advance(void)
+{
+	uint32_t seq = write_pos.seq + 1;
+
+	/* The log is full when the next sector still holds the oldest
+	 * records. They are dropped to make room for new ones.
+	 */
+	if (seq - oldest_seq >= sector_count) {
+		struct data_log_pos next = sector_start(oldest_seq + 1);
+
+		if (pos_before(&read_pos, &next)) {
+			uint32_t dropped = records_count(
+				pos_before(&read_pos, &commit_pos) ?
+				commit_pos : read_pos);
+
+			stats.dropped += dropped;
+			LOG_WRN("Log full, %u samples dropped", dropped);
+		}
+
+		if (pos_before(&commit_pos, &next)) {
+			commit_pos = next;
+		}
+
+		if (pos_before(&read_pos, &next)) {
+			read_pos = next;
+		}
+
+		oldest_seq++;
+	}
+
+	return sector_open(seq);
+}
+
+static int record_write(uint8_t type, const void *payload, size_t len)
+{
+	static uint8_t buf[ROUND_UP(sizeof(struct record_hdr) +
+				    sizeof(union record_payload), ALIGN_MAX)];
+	struct record_hdr hdr = {
+		.type = type,
+		.len = len,
+		.session = session,
+	};
+	uint32_t total = ROUND_UP(sizeof(hdr) + len, write_align);
+	int err;
+
+	if (fa == NULL) {
+		return -ENODEV;
+	}
+
+	if (write_pos.offset + total > sector_size) {
+		err = sector_advance();
+		if (err) {
+			return err;
+		}
+	}
+
+	hdr.crc = record_crc(&hdr, payload);
+
+	/* Padding is left erased. */
+	memset(buf, RECORD_ERASED, total);
+	memcpy(buf, &hdr, sizeof(hdr));
+	memcpy(&buf[sizeof(hdr)], payload, len);
+
+	err = flash_area_write(fa, pos_to_off(&write_pos), buf, total);
+	if (err) {
+		LOG_ERR("flash_area_write, error: %d", err);
+
+		/* The state of the remaining part of the sector is unknown,
+		 * continue in the next one.
+		 */
+		write_pos.offset = sector_size;
+		return err;
+	}
+
+	write_pos.offset += total;
+	stats.bytes_written += total;
+
+	return 0;
+}
+
+/* Recover the write position, the committed position and the boot session
+ * from the records in flash.
+ */
+static int log_recover(void)
+{
+	struct data_log_pos pos;
+	struct record_hdr hdr;
+	union record_payload payload;
+	uint32_t seq;
+	bool found = false;
+	bool session_found = false;
+	int err;
+
+	for (uint32_t i = 0; i < sector_count; i++) {
+		if (sector_hdr_read(i, &seq) && (!found || (seq > write_pos.seq))) {
+			write_pos.seq = seq;
+			found = true;
+		}
+	}
+
+	if (!found) {
+		LOG_INF("No log found, formatting");
+
+		oldest_seq = 0;
+		session = 0;
+		commit_pos = sector_start(0);
+		read_pos = commit_pos;
+		drop_pos = commit_pos;
+
+		return sector_open(0);
+	}
+
+	/* Sectors are used in sequence, the valid ones directly precede the
+	 * newest sector.
+	 */
+	oldest_seq = write_pos.seq;
+	while ((oldest_seq > 0) &&
+	       (write_pos.seq - (oldest_seq - 1) < sector_count) &&
+	       sector_hdr_read((oldest_seq - 1) % sector_count, &seq) &&
+	       (seq == oldest_seq - 1)) {
+		oldest_seq--;
+	}
+
+	write_pos.offset = sector_size;
+	commit_pos = sector_start(oldest_seq);
+
+	for (pos = sector_start(oldest_seq); pos.seq <= write_pos.seq;
+	     pos = sector_start(pos.seq + 1)) {
+		do {
+			err = record_read(&pos, &hdr, &payload);
+			if (err) {
+				continue;
+			}
+
+			if (!session_found ||
+			    (int16_t)(hdr.session - session) > 0) {
+				session = hdr.session;
+				session_found = true;
+			}
+
+			if (((hdr.type & RECORD_TYPE_MASK) == RECORD_CURSOR) &&
+			    !pos_before(&payload.cursor, &commit_pos)) {
+				commit_pos = payload.cursor;
+			}
+		} while ((err == 0) || (err == -EBADMSG));
+
+		if ((err != -ENOENT) && (err != 0)) {
+			return err;
+		}
+
+		if (pos.seq == write_pos.seq) {
+			break;
+		}
+	}
+
+	/* Continue writing after the last readable record. If the rest of
+	 * the sector is not erased, the next record goes to a new sector.
+	 */
+	write_pos.offset = pos.offset;
+	if (pos.offset + sizeof(hdr) <= sector_size) {
+		err = flash_area_read(fa, pos_to_off(&pos), &hdr, sizeof(hdr));
+		if (err) {
+			return err;
+		}
+
+		if ((hdr.type != RECORD_ERASED) || (hdr.len != RECORD_ERASED)) {
+			write_pos.offset = sector_size;
+		}
+	}
+
+	if (pos_before(&write_pos, &commit_pos)) {
+		commit_pos = write_pos;
+	}
+
+	read_pos = commit_pos;
+	drop_pos = commit_pos;
+	session = session_found ? session + 1 : 0;
+
+	LOG_DBG("Log recovered, sectors %u-%u, read from %u:%u",
+		oldest_seq, write_pos.seq, read_pos.seq, read_pos.offset);
+
+	return 0;
+}
+
+int data_log_init(void)
+{
+	struct flash_sector sectors[SECTORS_MAX];
+	uint32_t count = ARRAY_SIZE(sectors);
+	int err;
+
+	memset(&stats, 0, sizeof(stats));
+	fa = NULL;
+
+	err = flash_area_get_sectors(DATA_LOG_AREA_ID, &count, sectors);
+	if (err) {
+		LOG_ERR("flash_area_get_sectors, error: %d", err);
+		return err;
+	}
+
+	if (count < 2) {
+		LOG_ERR("The log needs at least two sectors");
+		return -EINVAL;
+	}
+
+	for (size_t i = 1; i < count; i++) {
+		if (sectors[i].fs_size != sectors[0].fs_size) {
+			LOG_ERR("Sectors of different sizes are not supported");
+			return -EINVAL;
+		}
+	}
+
+	err = flash_area_open(DATA_LOG_AREA_ID, &fa);
+	if (err) {
+		LOG_ERR("flash_area_open, error: %d", err);
+		return err;
+	}
+
+	sector_size = sectors[0].fs_size;
+	sector_count = count;
+	write_align = MAX(flash_area_align(fa), 1);
+
+	if ((write_align > ALIGN_MAX) || !IS_POWER_OF_TWO(write_align)) {
+		LOG_ERR("Unsupported write block size: %u", write_align);
+		fa = NULL;
+		return -EINVAL;
+	}
+
+	err = log_recover();
+	if (err) {
+		fa = NULL;
+		return err;
+	}
+
+	return 0;
+}
+
+/* Timestamp to store. UNIX time is stored when available, so that the
+ * sample can be sent also after a reboot.
+ */
+static int64_t ts_get(int64_t uptime_ts, uint8_t *flags)
+{
+	int64_t ts = uptime_ts;
+
+	if (date_time_is_valid() && !date_time_uptime_to_unix_time_ms(&ts)) {
+		*flags |= RECORD_TS_UNIX;
+		return ts;
+	}
+
+	return uptime_ts;
+}
+
+int data_log_append(enum data_log_type type, const void *data)
+{
+	union record_payload payload;
+	uint8_t flags = 0;
+	size_t len;
+	int err;
+
+	switch (type) {
+	case DATA_LOG_GPS: {
+		const struct cloud_data_gps *gps = data;
+
+		if (!gps->queued) {
+			return 0;
+		}
+
+		payload.gps = (struct record_gps) {
+			.ts = ts_get(gps->gps_ts, &flags),
+			.longi = gps->longi,
+			.lat = gps->lat,
+			.alt = gps->alt,
+			.acc = gps->acc,
+			.spd = gps->spd,
+			.hdg = gps->hdg,
+		};
+		len = sizeof(payload.gps);
+		break;
+	}
+	case DATA_LOG_SENSORS: {
+		const struct cloud_data_sensors *sensors = data;
+
+		if (!sensors->queued) {
+			return 0;
+		}
+
+		payload.sensors = (struct record_sensors) {
+			.ts = ts_get(sensors->env_ts, &flags),
+			.temp = sensors->temp,
+			.hum = sensors->hum,
+		};
+		len = sizeof(payload.sensors);
+		break;
+	}
+	case DATA_LOG_MODEM_DYNAMIC: {
+		const struct cloud_data_modem_dynamic *modem = data;
+
+		if (!modem->queued) {
+			return 0;
+		}
+
+		payload.modem_dyn = (struct record_modem_dyn) {
+			.ts = ts_get(modem->ts, &flags),
+			.area = modem->area,
+			.cell = modem->cell,
+			.rsrp = modem->rsrp,
+		};
+		if (modem->ip) {
+			strncpy(payload.modem_dyn.ip, modem->ip,
+				sizeof(payload.modem_dyn.ip) - 1);
+		}
+		if (modem->mccmnc) {
+			strncpy(payload.modem_dyn.mccmnc, modem->mccmnc,
+				sizeof(payload.modem_dyn.mccmnc) - 1);
+		}
+		len = sizeof(payload.modem_dyn);
+		break;
+	}
+	case DATA_LOG_UI: {
+		const struct cloud_data_ui *ui = data;
+
+		if (!ui->queued) {
+			return 0;
+		}
+
+		payload.ui = (struct record_ui) {
+			.ts = ts_get(ui->btn_ts, &flags),
+			.btn = ui->btn,
+		};
+		len = sizeof(payload.ui);
+		break;
+	}
+	case DATA_LOG_ACCEL: {
+		const struct cloud_data_accelerometer *accel = data;
+
+		if (!accel->queued) {
+			return 0;
+		}
+
+		payload.accel = (struct record_accel) {
+			.ts = ts_get(accel->ts, &flags),
+			.values = {
+				accel->values[0],
+				accel->values[1],
+				accel->values[2],
+			},
+		};
+		len = sizeof(payload.accel);
+		break;
+	}
+	case DATA_LOG_BATTERY: {
+		const struct cloud_data_battery *bat = data;
+
+		if (!bat->queued) {
+			return 0;
+		}
+
+		payload.bat = (struct record_bat) {
+			.ts = ts_get(bat->bat_ts, &flags),
+			.bat = bat->bat,
+		};
+		len = sizeof(payload.bat);
+		break;
+	}
+	default:
+		return -EINVAL;
+	}
+
+	err = record_write(type | flags, &payload, len);
+	if (err) {
+		return err;
+	}
+
+	stats.appended++;
+	stats.payload_bytes += len;
+
+	return 0;
+}
+
+/* Convert a stored timestamp to the uptime of this boot. Returns false if
+ * the timestamp cannot be converted.
+ */
+static bool ts_restore(const struct record_hdr *hdr, int64_t offset,
+		       int64_t *ts)
+{
+	if (hdr->type & RECORD_TS_UNIX) {
+		*ts -= offset;
+		return true;
+	}
+
+	return !record_stale(hdr);
+}
+
+/* Count a record that cannot be delivered, unless it was counted before the
+ * log was rewound.
+ */
+static void drop_count(const struct data_log_pos *pos)
+{
+	if (!pos_before(pos, &drop_pos)) {
+		stats.dropped++;
+	}
+}
+
+/* Add the record to the batch. Returns false if the buffer for its type
+ * is full.
+ */
+static bool batch_add(struct data_log_batch *batch,
+		      const struct record_hdr *hdr,
+		      union record_payload *payload, int64_t offset)
+{
+	size_t max = CONFIG_DATA_LOG_BATCH_ENTRIES;
+
+	switch (hdr->type & RECORD_TYPE_MASK) {
+	case DATA_LOG_GPS: {
+		const struct record_gps *rec = &payload->gps;
+		struct cloud_data_gps *entry;
+
+		if (batch->gps_count == max) {
+			return false;
+		}
+
+		entry = &batch->gps[batch->gps_count++];
+		*entry = (struct cloud_data_gps) {
+			.gps_ts = rec->ts,
+			.longi = rec->longi,
+			.lat = rec->lat,
+			.alt = rec->alt,
+			.acc = rec->acc,
+			.spd = rec->spd,
+			.hdg = rec->hdg,
+		};
+		entry->queued = ts_restore(hdr, offset, &entry->gps_ts);
+		break;
+	}
+	case DATA_LOG_SENSORS: {
+		const struct record_sensors *rec = &payload->sensors;
+		struct cloud_data_sensors *entry;
+
+		if (batch->sensors_count == max) {
+			return false;
+		}
+
+		entry = &batch->sensors[batch->sensors_count++];
+		*entry = (struct cloud_data_sensors) {
+			.env_ts = rec->ts,
+			.temp = rec->temp,
+			.hum = rec->hum,
+		};
+		entry->queued = ts_restore(hdr, offset, &entry->env_ts);
+		break;
+	}
+	case DATA_LOG_MODEM_DYNAMIC: {
+		const struct record_modem_dyn *rec = &payload->modem_dyn;
+		size_t i = batch->modem_dyn_count;
+		struct cloud_data_modem_dynamic *entry;
+
+		if (i == max) {
+			return false;
+		}
+
+		memcpy(batch->ip[i], rec->ip, sizeof(batch->ip[i]));
+		batch->ip[i][sizeof(batch->ip[i]) - 1] = '\0';
+		memcpy(batch->mccmnc[i], rec->mccmnc, sizeof(batch->mccmnc[i]));
+		batch->mccmnc[i][sizeof(batch->mccmnc[i]) - 1] = '\0';
+
+		entry = &batch->modem_dyn[batch->modem_dyn_count++];
+		*entry = (struct cloud_data_modem_dynamic) {
+			.ts = rec->ts,
+			.area = rec->area,
+			.cell = rec->cell,
+			.rsrp = rec->rsrp,
+			.ip = batch->ip[i],
+			.mccmnc = batch->mccmnc[i],
+		};
+		entry->queued = ts_restore(hdr, offset, &entry->ts);
+		break;
+	}
+	case DATA_LOG_UI: {
+		const struct record_ui *rec = &payload->ui;
+		struct cloud_data_ui *entry;
+
+		if (batch->ui_count == max) {
+			return false;
+		}
+
+		entry = &batch->ui[batch->ui_count++];
+		*entry = (struct cloud_data_ui) {
+			.btn_ts = rec->ts,
+			.btn = rec->btn,
+		};
+		entry->queued = ts_restore(hdr, offset, &entry->btn_ts);
+		break;
+	}
+	case DATA_LOG_ACCEL: {
+		const struct record_accel *rec = &payload->accel;
+		struct cloud_data_accelerometer *entry;
+
+		if (batch->accel_count == max) {
+			return false;
+		}
+
+		entry = &batch->accel[batch->accel_count++];
+		*entry = (struct cloud_data_accelerometer) {
+			.ts = rec->ts,
+			.values = { rec->values[0], rec->values[1],
+				    rec->values[2] },
+		};
+		entry->queued = ts_restore(hdr, offset, &entry->ts);
+		break;
+	}
+	case DATA_LOG_BATTERY: {
+		const struct record_bat *rec = &payload->bat;
+		struct cloud_data_battery *entry;
+
+		if (batch->bat_count == max) {
+			return false;
+		}
+
+		entry = &batch->bat[batch->bat_count++];
+		*entry = (struct cloud_data_battery) {
+			.bat_ts = rec->ts,
+			.bat = rec->bat,
+		};
+		entry->queued = ts_restore(hdr, offset, &entry->bat_ts);
+		break;
+	}
+	default:
+		/* Cursor records are not part of the batch. */
+		break;
+	}
+
+	return true;
+}
+
+int data_log_batch_read(struct data_log_batch *batch)
+{
+	struct data_log_pos pos = read_pos;
+	struct record_hdr hdr;
+	union record_payload payload;
+	size_t samples = 0;
+	int64_t offset;
+	int err;
+
+	if (fa == NULL) {
+		return -ENODEV;
+	}
+
+	/* The samples are sent with UNIX time, wait until it is known. */
+	if (!date_time_is_valid()) {
+		return -EAGAIN;
+	}
+
+	/* Offset between UNIX time and uptime, used to convert the stored
+	 * timestamps to the uptime expected by the cloud codec.
+	 */
+	err = date_time_now(&offset);
+	if (err) {
+		return err;
+	}
+
+	offset -= k_uptime_get();
+
+	batch->gps_count = 0;
+	batch->sensors_count = 0;
+	batch->modem_dyn_count = 0;
+	batch->ui_count = 0;
+	batch->accel_count = 0;
+	batch->bat_count = 0;
+
+	while (true) {
+		struct data_log_pos next = pos;
+
+		err = record_read(&next, &hdr, &payload);
+		if (err == -ENOENT) {
+			if (pos.seq == write_pos.seq) {
+				break;
+			}
+
+			pos = sector_start(pos.seq + 1);
+			continue;
+		} else if (err == -EBADMSG) {
+			LOG_WRN("Corrupted record at %u:%u skipped", pos.seq,
+				pos.offset);
+			drop_count(&pos);
+			pos = next;
+			continue;
+		} else if (err) {
+			return err;
+		}
+
+		if (!batch_add(batch, &hdr, &payload, offset)) {
+			break;
+		}
+
+		if ((hdr.type & RECORD_TYPE_MASK) != RECORD_CURSOR) {
+			if (record_stale(&hdr)) {
+				drop_count(&pos);
+			}
+
+			samples++;
+		}
+
+		pos = next;
+	}
+
+	if (pos_before(&drop_pos, &pos)) {
+		drop_pos = pos;
+	}
+
+	read_pos = pos;
+	batch->end = pos;
+
+	return (samples > 0) ? 0 : -ENODATA;
+}
+
+int data_log_commit(const struct data_log_pos *end)
+{
+	int err;
+
+	if (!pos_before(&commit_pos, end)) {
+		return 0;
+	}
+
+	err = record_write(RECORD_CURSOR, end, sizeof(*end));
+	if (err) {
+		return err;
+	}
+
+	commit_pos = *end;
+
+	return 0;
+}
+
+void data_log_rewind(void)
+{
+	read_pos = commit_pos;
+}
+
+void data_log_stats_get(struct data_log_stats *data_log_stats)
+{
+	*data_log_stats = stats;
+}
@@ -0,0 +1,161 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef DATA_LOG_H__
+#define DATA_LOG_H__
+
+#include <zephyr.h>
+#include <cloud_codec.h>
+
+/**@file
+ *
+ * @defgroup data_log Data log
+ * @brief    Persistent log of data samples that did not fit in the RAM
+ *	     buffers of the Data module.
+ *
+ * @details The log is stored in a dedicated flash partition, which is used
+ *	    as a ring of erase sectors. Samples are appended as CRC-protected
+ *	    records and never rewritten. When the log is full, the sector
+ *	    holding the oldest samples is erased and reused, so that all
+ *	    sectors are erased equally often.
+ *
+ *	    Samples are read in batches, starting at a read cursor. The
+ *	    position up to which samples have been delivered to cloud is
+ *	    committed by appending a small cursor record, so that delivered
+ *	    samples are not sent again after a reboot.
+ * @{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Data types stored in the log. */
+enum data_log_type {
+	DATA_LOG_GPS = 1,
+	DATA_LOG_SENSORS,
+	DATA_LOG_MODEM_DYNAMIC,
+	DATA_LOG_UI,
+	DATA_LOG_ACCEL,
+	DATA_LOG_BATTERY,
+};
+
+/** @brief Position in the log. */
+struct data_log_pos {
+	/** Sequence number of the sector. */
+	uint32_t seq;
+	/** Offset within the sector. */
+	uint32_t offset;
+};
+
+/** @brief Batch of samples read from the log.
+ *
+ * The buffers have the layout expected by cloud_codec_encode_batch_data().
+ * Timestamps are converted to the uptime of the current boot.
+ */
+struct data_log_batch {
+	struct cloud_data_gps gps[CONFIG_DATA_LOG_BATCH_ENTRIES];
+	struct cloud_data_sensors sensors[CONFIG_DATA_LOG_BATCH_ENTRIES];
+	struct cloud_data_modem_dynamic modem_dyn[CONFIG_DATA_LOG_BATCH_ENTRIES];
+	struct cloud_data_ui ui[CONFIG_DATA_LOG_BATCH_ENTRIES];
+	struct cloud_data_accelerometer accel[CONFIG_DATA_LOG_BATCH_ENTRIES];
+	struct cloud_data_battery bat[CONFIG_DATA_LOG_BATCH_ENTRIES];
+	/** Storage for the strings of the dynamic modem data. */
+	char ip[CONFIG_DATA_LOG_BATCH_ENTRIES][CONFIG_DATA_LOG_IP_LEN];
+	char mccmnc[CONFIG_DATA_LOG_BATCH_ENTRIES][CONFIG_DATA_LOG_MCCMNC_LEN];
+	size_t gps_count;
+	size_t sensors_count;
+	size_t modem_dyn_count;
+	size_t ui_count;
+	size_t accel_count;
+	size_t bat_count;
+	/** Position following the last record in the batch. */
+	struct data_log_pos end;
+};
+
+/** @brief Log statistics. */
+struct data_log_stats {
+	/** Number of samples appended since initialization. */
+	uint32_t appended;
+	/** Number of samples dropped since initialization. */
+	uint32_t dropped;
+	/** Number of sector erases since initialization. */
+	uint32_t erased;
+	/** Number of bytes written to flash since initialization. */
+	uint32_t bytes_written;
+	/** Number of payload bytes appended since initialization. */
+	uint32_t payload_bytes;
+};
+
+/**
+ * @brief Initialize the log and recover its state from flash.
+ *
+ * @return 0 on success, otherwise a negative error code.
+ */
+int data_log_init(void);
+
+/**
+ * @brief Append a sample to the log.
+ *
+ * Samples that are not queued are ignored.
+ *
+ * @param type Type of the sample.
+ * @param data Sample, a pointer to the cloud_data structure of the type.
+ *
+ * @return 0 on success, otherwise a negative error code.
+ */
+int data_log_append(enum data_log_type type, const void *data);
+
+/**
+ * @brief Read the next batch of samples.
+ *
+ * The read cursor is advanced past the samples in the batch. Reading stops
+ * when a buffer of the batch for the type of the next sample is full.
+ *
+ * @param batch Batch to fill.
+ *
+ * @retval 0 on success.
+ * @retval -ENODATA if there are no samples to read.
+ * @retval -EAGAIN if the time is not known yet.
+ * @return Otherwise a negative error code.
+ */
+int data_log_batch_read(struct data_log_batch *batch);
+
+/**
+ * @brief Commit a batch that has been delivered.
+ *
+ * The samples of the batch and all samples before it are not read again,
+ * also after a reboot.
+ *
+ * @param end End position of the delivered batch.
+ *
+ * @return 0 on success, otherwise a negative error code.
+ */
+int data_log_commit(const struct data_log_pos *end);
+
+/**
+ * @brief Move the read cursor back to the last committed position.
+ *
+ * Used when a batch that has been read could not be delivered.
+ */
+void data_log_rewind(void);
+
+/**
+ * @brief Get the log statistics.
+ *
+ * @param stats Statistics.
+ */
+void data_log_stats_get(struct data_log_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ *@}
+ */
+
+#endif /* DATA_LOG_H__ */
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr.h>
+#include <string.h>
+
+#include "data_sched.h"
+
+#include <logging/log.h>
+LOG_MODULE_REGISTER(data_sched, CONFIG_DATA_SCHED_LOG_LEVEL);
+
+#define MAX_AGE_MS (CONFIG_DATA_SCHED_MAX_AGE_SEC * MSEC_PER_SEC)
+
+static struct {
+	/* Number and total length of the held messages. */
+	size_t count;
+	size_t bytes;
+	/* Uptime at which the first held message was added. */
+	int64_t first_ts;
+
+	bool rrc_connected;
+	/* Uptime of the last RRC state change. */
+	int64_t rrc_ts;
+	bool rrc_known;
+	/* PSM active time [ms], -1 if PSM is not used. */
+	int64_t active_time_ms;
+
+	struct data_sched_stats stats;
+} sched;
+
+/* The radio is active while an RRC connection is open, and the modem stays
+ * synchronized to the cell during the PSM active time after it has been
+ * released. Publishing then does not wake the radio from PSM.
+ */
+static bool radio_active(int64_t now)
+{
+	if (sched.rrc_connected) {
+		return true;
+	}
+
+	return sched.rrc_known && (sched.active_time_ms > 0) &&
+	       ((now - sched.rrc_ts) < sched.active_time_ms);
+}
+
+void data_sched_init(void)
+{
+	memset(&sched, 0, sizeof(sched));
+	sched.active_time_ms = -1;
+}
+
+bool data_sched_add(size_t len, bool urgent, int64_t now)
+{
+	if (sched.count == 0) {
+		sched.first_ts = now;
+	}
+
+	sched.count++;
+	sched.bytes += len;
+	sched.stats.held++;
+
+	if (urgent || radio_active(now)) {
+		return true;
+	}
+
+	if (sched.bytes >= CONFIG_DATA_SCHED_MAX_BYTES) {
+		LOG_DBG("Size limit reached: %zu bytes", sched.bytes);
+		return true;
+	}
+
+	return false;
+}
+
+bool data_sched_rrc_update(bool connected, int64_t now)
+{
+	if (sched.rrc_known && (sched.rrc_connected == connected)) {
+		return false;
+	}
+
+	if (sched.rrc_connected) {
+		sched.stats.radio_on_ms += now - sched.rrc_ts;
+	}
+
+	sched.rrc_connected = connected;
+	sched.rrc_known = true;
+	sched.rrc_ts = now;
+
+	return connected && (sched.count > 0);
+}
+
+void data_sched_psm_update(int active_time)
+{
+	sched.active_time_ms = (active_time > 0) ?
+			       (int64_t)active_time * MSEC_PER_SEC : -1;
+}
+
+bool data_sched_timeout(int64_t now)
+{
+	return (sched.count > 0) && (now - sched.first_ts >= MAX_AGE_MS);
+}
+
+int64_t data_sched_deadline(void)
+{
+	return (sched.count > 0) ? sched.first_ts + MAX_AGE_MS : -1;
+}
+
+void data_sched_flushed(int64_t now)
+{
+	if (sched.count == 0) {
+		return;
+	}
+
+	/* Without the scheduler, every message could have needed a radio
+	 * wake-up. Only the first one does when the radio is not active.
+	 */
+	sched.stats.saved += radio_active(now) ? sched.count :
+						 sched.count - 1;
+	sched.stats.flushes++;
+
+	LOG_DBG("Publishing %zu held messages, %zu bytes", sched.count,
+		sched.bytes);
+
+	sched.count = 0;
+	sched.bytes = 0;
+}
+
+void data_sched_stats_get(struct data_sched_stats *stats, int64_t now)
+{
+	*stats = sched.stats;
+
+	if (sched.rrc_connected) {
+		stats->radio_on_ms += now - sched.rrc_ts;
+	}
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef DATA_SCHED_H__
+#define DATA_SCHED_H__
+
+#include <zephyr.h>
+
+/**@file
+ *
+ * @defgroup data_sched Publish scheduler
+ * @brief    Decides when encoded messages held by the Data module are
+ *	     published.
+ *
+ * @details Every publication that finds the radio idle pays for setting up
+ *	    an RRC connection. The scheduler holds encoded messages until
+ *	    the held data exceeds a size or age limit, and publishes them
+ *	    together. Held messages are published right away when the radio
+ *	    is already active: while an RRC connection is open, and during
+ *	    the PSM active time that follows it.
+ *
+ *	    The scheduler has no timers and does not publish itself. All
+ *	    functions take the current uptime and return whether the held
+ *	    messages are to be published now.
+ * @{
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Scheduler statistics. */
+struct data_sched_stats {
+	/** Number of messages that have been held. */
+	uint32_t held;
+	/** Number of times held messages have been published. */
+	uint32_t flushes;
+	/** Number of held messages that did not need a radio wake-up of
+	 *  their own, because they were published together with other
+	 *  messages or while the radio was active.
+	 */
+	uint32_t saved;
+	/** Time the RRC connection has been open [ms]. */
+	uint32_t radio_on_ms;
+};
+
+/** @brief Reset the scheduler. */
+void data_sched_init(void);
+
+/**
+ * @brief Hold a new encoded message.
+ *
+ * @param len Length of the message.
+ * @param urgent The message must not be delayed.
+ * @param now Current uptime [ms].
+ *
+ * @return true if the held messages are to be published now.
+ */
+bool data_sched_add(size_t len, bool urgent, int64_t now);
+
+/**
+ * @brief Update the RRC connection state.
+ *
+ * @param connected An RRC connection is open.
+ * @param now Current uptime [ms].
+ *
+ * @return true if the held messages are to be published now.
+ */
+bool data_sched_rrc_update(bool connected, int64_t now);
+
+/**
+ * @brief Update the PSM active time granted by the network.
+ *
+ * @param active_time Active time [s], or -1 if PSM is not used.
+ */
+void data_sched_psm_update(int active_time);
+
+/**
+ * @brief Check if held messages have reached the age limit.
+ *
+ * @param now Current uptime [ms].
+ *
+ * @return true if the held messages are to be published now.
+ */
+bool data_sched_timeout(int64_t now);
+
+/**
+ * @brief Get the uptime at which the held messages reach the age limit.
+ *
+ * @return Uptime [ms], or -1 if no messages are held.
+ */
+int64_t data_sched_deadline(void);
+
+/**
+ * @brief Notify that the held messages have been published.
+ *
+ * @param now Current uptime [ms].
+ */
+void data_sched_flushed(int64_t now);
+
+/**
+ * @brief Get the scheduler statistics.
+ *
+ * @param stats Statistics.
+ * @param now Current uptime [ms], used to account for an open RRC
+ *	      connection.
+ */
+void data_sched_stats_get(struct data_sched_stats *stats, int64_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ *@}
+ */
+
+#endif /* DATA_SCHED_H__ */
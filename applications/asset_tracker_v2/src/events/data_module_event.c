@@ -33,6 +33,8 @@ static char *get_evt_type_str(enum data_module_event_type type)
 		return "DATA_EVT_SHUTDOWN_READY";
 	case DATA_EVT_DATE_TIME_OBTAINED:
 		return "DATA_EVT_DATE_TIME_OBTAINED";
+	case DATA_EVT_PUBLISH_TIMEOUT:
+		return "DATA_EVT_PUBLISH_TIMEOUT";
 	case DATA_EVT_ERROR:
 		return "DATA_EVT_ERROR";
 	default:
@@ -33,6 +33,7 @@ enum data_module_event_type {
 	DATA_EVT_CONFIG_GET,
 	DATA_EVT_SHUTDOWN_READY,
 	DATA_EVT_DATE_TIME_OBTAINED,
+	DATA_EVT_PUBLISH_TIMEOUT,
 	DATA_EVT_ERROR
 };
 
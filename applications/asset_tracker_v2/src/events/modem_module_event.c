@@ -23,6 +23,10 @@ static char *get_evt_type_str(enum modem_module_event_type type)
 		return "MODEM_EVT_LTE_PSM_UPDATE";
 	case MODEM_EVT_LTE_EDRX_UPDATE:
 		return "MODEM_EVT_LTE_EDRX_UPDATE";
+	case MODEM_EVT_LTE_RRC_CONNECTED:
+		return "MODEM_EVT_LTE_RRC_CONNECTED";
+	case MODEM_EVT_LTE_RRC_IDLE:
+		return "MODEM_EVT_LTE_RRC_IDLE";
 	case MODEM_EVT_MODEM_STATIC_DATA_READY:
 		return "MODEM_EVT_MODEM_STATIC_DATA_READY";
 	case MODEM_EVT_MODEM_DYNAMIC_DATA_READY:
@@ -27,6 +27,8 @@ enum modem_module_event_type {
 	MODEM_EVT_LTE_CELL_UPDATE,
 	MODEM_EVT_LTE_PSM_UPDATE,
 	MODEM_EVT_LTE_EDRX_UPDATE,
+	MODEM_EVT_LTE_RRC_CONNECTED,
+	MODEM_EVT_LTE_RRC_IDLE,
 	MODEM_EVT_MODEM_STATIC_DATA_READY,
 	MODEM_EVT_MODEM_DYNAMIC_DATA_READY,
 	MODEM_EVT_MODEM_STATIC_DATA_NOT_READY,
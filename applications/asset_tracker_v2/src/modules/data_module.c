@@ -11,6 +11,14 @@
 
 #include "cloud/cloud_codec/cloud_codec.h"
 
+#if defined(CONFIG_DATA_LOG)
+#include "data_log/data_log.h"
+#endif
+
+#if defined(CONFIG_DATA_SCHED)
+#include "data_sched/data_sched.h"
+#endif
+
 #define MODULE data_module
 
 #include "modules_common.h"
@@ -136,6 +144,26 @@ static struct ack_data failed_data[CONFIG_FAILED_DATA_COUNT];
 /* Data that has been encoded and shipped on, but has not yet been ACKed. */
 static struct ack_data pending_data[CONFIG_PENDING_DATA_COUNT];
 
+#if defined(CONFIG_DATA_SCHED)
+/* Encoded data held by the publish scheduler, not yet shipped on. */
+static struct ack_data held_data[CONFIG_DATA_SCHED_HELD_MAX];
+
+BUILD_ASSERT(CONFIG_DATA_SCHED_HELD_MAX <= CONFIG_PENDING_DATA_COUNT,
+	     "All held data must fit into the pending data list");
+
+static struct k_delayed_work publish_work;
+#endif
+
+#if defined(CONFIG_DATA_LOG)
+/* Batch of samples read from the persistent log, and the encoded batch that
+ * is sent. Only one batch from the log is in flight at a time, it is
+ * committed to the log when it has been ACKed.
+ */
+static struct data_log_batch log_batch;
+static struct data_log_pos log_batch_end;
+static void *log_batch_ptr;
+#endif
+
 /* Data module message queue. */
 #define DATA_QUEUE_ENTRY_COUNT		10
 #define DATA_QUEUE_BYTE_ALIGNMENT	4
@@ -150,6 +178,12 @@ static struct module_data self = {
 
 /* Forward declarations */
 static void data_send_work_fn(struct k_work *work);
+#if defined(CONFIG_DATA_SCHED)
+static void publish_work_fn(struct k_work *work);
+#endif
+#if defined(CONFIG_DATA_LOG)
+static void log_batch_send(void);
+#endif
 static int config_settings_handler(const char *key, size_t len,
 				   settings_read_cb read_cb, void *cb_arg);
 
@@ -312,6 +346,13 @@ static void data_list_clear_and_free(struct ack_data *list, size_t list_count)
 {
 	for (size_t i = 0; i < list_count; i++) {
 		if (list[i].ptr != NULL) {
+#if defined(CONFIG_DATA_LOG)
+			if (list[i].ptr == log_batch_ptr) {
+				/* Samples are read from the log again. */
+				data_log_rewind();
+				log_batch_ptr = NULL;
+			}
+#endif
 			k_free(list[i].ptr);
 			data_list_clear_entry(&list[i]);
 		}
@@ -359,48 +400,62 @@ static void data_list_add_pending(void *ptr, size_t len, enum data_type type)
 	SEND_ERROR(data, DATA_EVT_ERROR, -ENFILE);
 }
 
-static void data_resend(void)
+/* Ship encoded data on to the cloud module and add it to the pending data
+ * list.
+ */
+static int data_submit(void *ptr, size_t len, enum data_type type)
 {
 	struct data_module_event *evt;
+	enum data_module_event_type evt_type;
 
-	for (size_t i = 0; i < ARRAY_SIZE(failed_data); i++) {
-		if (failed_data[i].ptr != NULL) {
+	switch (type) {
+	case GENERIC:
+		evt_type = DATA_EVT_DATA_SEND;
+		break;
+	case BATCH:
+		evt_type = DATA_EVT_DATA_SEND_BATCH;
+		break;
+	case CONFIG:
+		evt_type = DATA_EVT_CONFIG_SEND;
+		break;
+	case UI:
+		evt_type = DATA_EVT_UI_DATA_SEND;
+		break;
+	default:
+		LOG_WRN("Unknown associated data type");
+		return -ENODATA;
+	}
 
-			evt = new_data_module_event();
-
-			switch (failed_data[i].type) {
-			case GENERIC:
-				evt->type = DATA_EVT_DATA_SEND;
-				break;
-			case BATCH:
-				evt->type = DATA_EVT_DATA_SEND_BATCH;
-				break;
-			case CONFIG:
-				evt->type = DATA_EVT_CONFIG_SEND;
-				break;
-			case UI:
-				evt->type = DATA_EVT_UI_DATA_SEND;
-				break;
-			default:
-				LOG_WRN("Unknown associated data type");
-				SEND_ERROR(data, DATA_EVT_ERROR, -ENODATA);
-				return;
-			}
+	evt = new_data_module_event();
+	evt->type = evt_type;
+	evt->data.buffer.buf = ptr;
+	evt->data.buffer.len = len;
+
+	data_list_add_pending(ptr, len, type);
+	EVENT_SUBMIT(evt);
+
+	return 0;
+}
 
-			evt->data.buffer.buf = failed_data[i].ptr;
-			evt->data.buffer.len = failed_data[i].len;
+static void data_resend(void)
+{
+	int err;
+
+	for (size_t i = 0; i < ARRAY_SIZE(failed_data); i++) {
+		if (failed_data[i].ptr != NULL) {
 			LOG_WRN("Resending data: %.*s", failed_data[i].len,
 				log_strdup(failed_data[i].ptr));
-			EVENT_SUBMIT(evt);
 
 			/* Move data from failed to pending data list after
 			 * resend.
 			 */
-
-			/* Add entry to pending data list. */
-			data_list_add_pending(failed_data[i].ptr,
-					      failed_data[i].len,
-					      failed_data[i].type);
+			err = data_submit(failed_data[i].ptr,
+					  failed_data[i].len,
+					  failed_data[i].type);
+			if (err) {
+				SEND_ERROR(data, DATA_EVT_ERROR, err);
+				return;
+			}
 
 			/* Remove entry from failed data list. */
 			data_list_clear_entry(&failed_data[i]);
@@ -408,6 +463,130 @@ static void data_resend(void)
 	}
 }
 
+#if defined(CONFIG_DATA_SCHED)
+static void held_flush(void)
+{
+	struct data_sched_stats stats;
+	int err;
+
+	for (size_t i = 0; i < ARRAY_SIZE(held_data); i++) {
+		if (held_data[i].ptr == NULL) {
+			continue;
+		}
+
+		err = data_submit(held_data[i].ptr, held_data[i].len,
+				  held_data[i].type);
+		if (err) {
+			k_free(held_data[i].ptr);
+			SEND_ERROR(data, DATA_EVT_ERROR, err);
+		}
+
+		data_list_clear_entry(&held_data[i]);
+	}
+
+	k_delayed_work_cancel(&publish_work);
+	data_sched_flushed(k_uptime_get());
+	data_sched_stats_get(&stats, k_uptime_get());
+
+	LOG_DBG("Held data published, %u of %u messages saved a wake-up",
+		stats.saved, stats.held);
+	LOG_DBG("RRC connected for %u ms in total", stats.radio_on_ms);
+}
+
+static void publish_timer_update(void)
+{
+	int64_t deadline = data_sched_deadline();
+
+	if (deadline < 0) {
+		k_delayed_work_cancel(&publish_work);
+		return;
+	}
+
+	k_delayed_work_submit(&publish_work,
+			      K_MSEC(MAX(deadline - k_uptime_get(), 0)));
+}
+
+static void held_add(void *ptr, size_t len, enum data_type type)
+{
+	while (true) {
+		for (size_t i = 0; i < ARRAY_SIZE(held_data); i++) {
+			if (held_data[i].ptr == NULL) {
+				held_data[i].ptr = ptr;
+				held_data[i].len = len;
+				held_data[i].type = type;
+				return;
+			}
+		}
+
+		LOG_DBG("Held data list is full, publishing");
+		held_flush();
+	}
+}
+
+static void publish_work_fn(struct k_work *work)
+{
+	SEND_EVENT(data, DATA_EVT_PUBLISH_TIMEOUT);
+}
+#endif /* CONFIG_DATA_SCHED */
+
+/* Publish encoded data. Data is held and published later together with
+ * other data if the publish scheduler is enabled, unless it is urgent.
+ */
+static void data_publish(void *ptr, size_t len, enum data_type type,
+			 bool urgent)
+{
+#if defined(CONFIG_DATA_SCHED)
+	held_add(ptr, len, type);
+
+	if (data_sched_add(len, urgent, k_uptime_get())) {
+		held_flush();
+	} else {
+		publish_timer_update();
+	}
+#else
+	int err;
+
+	err = data_submit(ptr, len, type);
+	if (err) {
+		k_free(ptr);
+		SEND_ERROR(data, DATA_EVT_ERROR, err);
+	}
+#endif
+}
+
+#if defined(CONFIG_DATA_LOG)
+static void log_batch_commit(void)
+{
+	int err;
+
+	err = data_log_commit(&log_batch_end);
+	if (err) {
+		/* The samples are sent again after a reboot. */
+		LOG_WRN("data_log_commit, error: %d", err);
+	}
+
+	log_batch_ptr = NULL;
+}
+
+/* Store the entry that is about to be overwritten in a ringbuffer in the
+ * persistent log, unless it has already been sent.
+ */
+static void log_spill(enum data_log_type type, const void *entry)
+{
+	int err;
+
+	err = data_log_append(type, entry);
+	if (err) {
+		LOG_WRN("data_log_append, error: %d", err);
+	}
+}
+
+#define BUFFER_SPILL(_type, _buf, _head) \
+	log_spill(_type, &_buf[((_head) + 1) % ARRAY_SIZE(_buf)])
+#else
+#define BUFFER_SPILL(_type, _buf, _head)
+#endif /* CONFIG_DATA_LOG */
+
 static void data_ack(void *ptr, bool sent)
 {
 	/* Move data from pending to failed data list if incoming data is
@@ -418,6 +597,11 @@ static void data_ack(void *ptr, bool sent)
 	for (size_t i = 0; i < ARRAY_SIZE(pending_data); i++) {
 		if (pending_data[i].ptr == ptr) {
 			if (sent) {
+#if defined(CONFIG_DATA_LOG)
+				if (ptr == log_batch_ptr) {
+					log_batch_commit();
+				}
+#endif
 				k_free(ptr);
 				LOG_DBG("Pending data ACKed: %p",
 					pending_data[i].ptr);
@@ -462,6 +646,16 @@ static int setup(void)
 
 	cloud_codec_init();
 
+#if defined(CONFIG_DATA_LOG)
+	err = data_log_init();
+	if (err) {
+		/* The Data module works without the log, samples are then
+		 * dropped when the ringbuffers are full.
+		 */
+		LOG_ERR("data_log_init, error: %d", err);
+	}
+#endif
+
 	err = settings_subsys_init();
 	if (err) {
 		LOG_ERR("settings_subsys_init, error: %d", err);
@@ -492,8 +686,6 @@ static void config_distribute(enum data_module_event_type type)
 static void data_send(void)
 {
 	int err;
-	struct data_module_event *data_module_event_new;
-	struct data_module_event *data_module_event_batch;
 	struct cloud_codec_data codec;
 
 	if (!date_time_is_valid()) {
@@ -519,6 +711,9 @@ static void data_send(void)
 		 */
 		LOG_DBG("Ringbuffers empty...");
 		LOG_DBG("No data to encode, error: %d", err);
+#if defined(CONFIG_DATA_LOG)
+		log_batch_send();
+#endif
 		return;
 	} else if (err) {
 		LOG_ERR("Error encoding message %d", err);
@@ -529,14 +724,7 @@ static void data_send(void)
 	LOG_DBG("Data encoded successfully");
 
 
-	data_module_event_new = new_data_module_event();
-	data_module_event_new->type = DATA_EVT_DATA_SEND;
-
-	data_module_event_new->data.buffer.buf = codec.buf;
-	data_module_event_new->data.buffer.len = codec.len;
-
-	data_list_add_pending(codec.buf, codec.len, GENERIC);
-	EVENT_SUBMIT(data_module_event_new);
+	data_publish(codec.buf, codec.len, GENERIC, false);
 
 	codec.buf = NULL;
 	codec.len = 0;
@@ -556,21 +744,73 @@ static void data_send(void)
 					ARRAY_SIZE(bat_buf));
 	if (err == -ENODATA) {
 		LOG_DBG("No batch data to encode, ringbuffers empty");
-		return;
 	} else if (err) {
 		LOG_ERR("Error batch-enconding data: %d", err);
 		SEND_ERROR(data, DATA_EVT_ERROR, err);
 		return;
+	} else {
+		data_publish(codec.buf, codec.len, BATCH, false);
+	}
+
+#if defined(CONFIG_DATA_LOG)
+	/* Samples in the persistent log are older than the ones in the
+	 * ringbuffers, but are sent last so that fresh data is not delayed.
+	 */
+	log_batch_send();
+#endif
+}
+
+#if defined(CONFIG_DATA_LOG)
+static void log_batch_send(void)
+{
+	int err;
+	struct cloud_codec_data codec;
+
+	if (log_batch_ptr != NULL) {
+		/* Previous batch from the log is not yet delivered. */
+		return;
+	}
+
+	err = data_log_batch_read(&log_batch);
+	if ((err == -ENODATA) || (err == -EAGAIN)) {
+		/* Nothing to send, or not before the time is known. */
+		return;
+	} else if (err) {
+		LOG_ERR("data_log_batch_read, error: %d", err);
+		return;
+	}
+
+	err = cloud_codec_encode_batch_data(&codec,
+					    log_batch.gps,
+					    log_batch.sensors,
+					    log_batch.modem_dyn,
+					    log_batch.ui,
+					    log_batch.accel,
+					    log_batch.bat,
+					    log_batch.gps_count,
+					    log_batch.sensors_count,
+					    log_batch.modem_dyn_count,
+					    log_batch.ui_count,
+					    log_batch.accel_count,
+					    log_batch.bat_count);
+	if (err == -ENODATA) {
+		/* None of the samples could be sent, skip them. */
+		log_batch_end = log_batch.end;
+		log_batch_commit();
+		return;
+	} else if (err) {
+		LOG_ERR("Error batch-enconding logged data: %d", err);
+		data_log_rewind();
+		SEND_ERROR(data, DATA_EVT_ERROR, err);
+		return;
 	}
 
-	data_module_event_batch = new_data_module_event();
-	data_module_event_batch->type = DATA_EVT_DATA_SEND_BATCH;
-	data_module_event_batch->data.buffer.buf = codec.buf;
-	data_module_event_batch->data.buffer.len = codec.len;
+	log_batch_ptr = codec.buf;
+	log_batch_end = log_batch.end;
 
-	data_list_add_pending(codec.buf, codec.len, BATCH);
-	EVENT_SUBMIT(data_module_event_batch);
+	data_publish(codec.buf, codec.len, BATCH, false);
 }
+#endif /* CONFIG_DATA_LOG */
 
 static void config_get(void)
 {
@@ -603,7 +843,6 @@ static void config_send(void)
 static void data_ui_send(void)
 {
 	int err;
-	struct data_module_event *evt;
 	struct cloud_codec_data codec;
 
 	if (!date_time_is_valid()) {
@@ -621,14 +860,10 @@ static void data_ui_send(void)
 		return;
 	}
 
-	evt = new_data_module_event();
-	evt->type = DATA_EVT_UI_DATA_SEND;
-	evt->data.buffer.buf = codec.buf;
-	evt->data.buffer.len = codec.len;
-
-	data_list_add_pending(codec.buf, codec.len, UI);
-
-	EVENT_SUBMIT(evt);
+	/* Button presses are not delayed, held data is published with
+	 * them.
+	 */
+	data_publish(codec.buf, codec.len, UI, true);
 }
 
 static void requested_data_clear(void)
@@ -682,6 +917,13 @@ static void on_cloud_state_disconnected(struct data_msg_data *msg)
 	if (IS_EVENT(msg, cloud, CLOUD_EVT_CONNECTED)) {
 		date_time_update_async(date_time_event_handler);
 		state_set(STATE_CLOUD_CONNECTED);
+
+#if defined(CONFIG_DATA_SCHED)
+		/* Held data that reached the age limit while disconnected
+		 * is published now.
+		 */
+		publish_timer_update();
+#endif
 	}
 }
 
@@ -705,6 +947,15 @@ static void on_cloud_state_connected(struct data_msg_data *msg)
 		return;
 	}
 
+#if defined(CONFIG_DATA_SCHED)
+	if (IS_EVENT(msg, data, DATA_EVT_PUBLISH_TIMEOUT)) {
+		if (data_sched_timeout(k_uptime_get())) {
+			held_flush();
+		}
+		return;
+	}
+#endif
+
 	if (IS_EVENT(msg, cloud, CLOUD_EVT_DISCONNECTED)) {
 		state_set(STATE_CLOUD_DISCONNECTED);
 		return;
@@ -851,6 +1102,26 @@ static void on_all_states(struct data_msg_data *msg)
 		config_distribute(DATA_EVT_CONFIG_INIT);
 	}
 
+#if defined(CONFIG_DATA_SCHED)
+	if (IS_EVENT(msg, modem, MODEM_EVT_LTE_RRC_CONNECTED)) {
+		/* The radio is already on, publish held data with the
+		 * traffic that caused the connection.
+		 */
+		if (data_sched_rrc_update(true, k_uptime_get()) &&
+		    (state == STATE_CLOUD_CONNECTED)) {
+			held_flush();
+		}
+	}
+
+	if (IS_EVENT(msg, modem, MODEM_EVT_LTE_RRC_IDLE)) {
+		data_sched_rrc_update(false, k_uptime_get());
+	}
+
+	if (IS_EVENT(msg, modem, MODEM_EVT_LTE_PSM_UPDATE)) {
+		data_sched_psm_update(msg->module.modem.data.psm.active_time);
+	}
+#endif
+
 	if (IS_EVENT(msg, util, UTIL_EVT_SHUTDOWN_REQUEST)) {
 		/* The module doesn't have anything to shut down and can
 		 * report back immediately.
@@ -881,6 +1152,7 @@ static void on_all_states(struct data_msg_data *msg)
 			.queued = true
 		};
 
+		BUFFER_SPILL(DATA_LOG_UI, ui_buf, head_ui_buf);
 		cloud_codec_populate_ui_buffer(ui_buf, &new_ui_data,
 					       &head_ui_buf,
 					       ARRAY_SIZE(ui_buf));
@@ -926,6 +1198,8 @@ static void on_all_states(struct data_msg_data *msg)
 			.queued = true
 		};
 
+		BUFFER_SPILL(DATA_LOG_MODEM_DYNAMIC, modem_dyn_buf,
+			     head_modem_dyn_buf);
 		cloud_codec_populate_modem_dynamic_buffer(
 						modem_dyn_buf,
 						&new_modem_data,
@@ -946,6 +1220,7 @@ static void on_all_states(struct data_msg_data *msg)
 			.queued = true
 		};
 
+		BUFFER_SPILL(DATA_LOG_BATTERY, bat_buf, head_bat_buf);
 		cloud_codec_populate_bat_buffer(bat_buf, &new_battery_data,
 						&head_bat_buf,
 						ARRAY_SIZE(bat_buf));
@@ -961,6 +1236,7 @@ static void on_all_states(struct data_msg_data *msg)
 			.queued = true
 		};
 
+		BUFFER_SPILL(DATA_LOG_SENSORS, sensors_buf, head_sensor_buf);
 		cloud_codec_populate_sensor_buffer(sensors_buf,
 						   &new_sensor_data,
 						   &head_sensor_buf,
@@ -987,6 +1263,7 @@ static void on_all_states(struct data_msg_data *msg)
 			.queued = true
 		};
 
+		BUFFER_SPILL(DATA_LOG_ACCEL, accel_buf, head_accel_buf);
 		cloud_codec_populate_accel_buffer(accel_buf, &new_movement_data,
 						  &head_accel_buf,
 						  ARRAY_SIZE(accel_buf));
@@ -1004,6 +1281,7 @@ static void on_all_states(struct data_msg_data *msg)
 			.queued = true
 		};
 
+		BUFFER_SPILL(DATA_LOG_GPS, gps_buf, head_gps_buf);
 		cloud_codec_populate_gps_buffer(gps_buf, &new_gps_data,
 						&head_gps_buf,
 						ARRAY_SIZE(gps_buf));
@@ -1034,6 +1312,11 @@ static void module_thread_fn(void)
 
 	k_delayed_work_init(&data_send_work, data_send_work_fn);
 
+#if defined(CONFIG_DATA_SCHED)
+	k_delayed_work_init(&publish_work, publish_work_fn);
+	data_sched_init();
+#endif
+
 	err = setup();
 	if (err) {
 		LOG_ERR("setup, error: %d", err);
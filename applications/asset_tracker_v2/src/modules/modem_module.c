@@ -190,6 +190,12 @@ static void lte_evt_handler(const struct lte_lc_evt *const evt)
 		LOG_DBG("RRC mode: %s",
 			evt->rrc_mode == LTE_LC_RRC_MODE_CONNECTED ?
 			"Connected" : "Idle");
+
+		if (evt->rrc_mode == LTE_LC_RRC_MODE_CONNECTED) {
+			SEND_EVENT(modem, MODEM_EVT_LTE_RRC_CONNECTED);
+		} else {
+			SEND_EVENT(modem, MODEM_EVT_LTE_RRC_IDLE);
+		}
 		break;
 	case LTE_LC_EVT_CELL_UPDATE:
 		LOG_DBG("LTE cell changed: Cell ID: %d, Tracking area: %d",
@@ -0,0 +1,36 @@
+#
+# Copyright (c) 2021 Nordic Semiconductor
+#
+# SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+#
+
+set(HID_KEYMAP_TABLE_SCRIPT
+  ${CMAKE_CURRENT_LIST_DIR}/../scripts/hid_keymap_table.py)
+set(HID_REPORT_DESC_PATH
+  ${CMAKE_CURRENT_LIST_DIR}/../configuration/common/hid_report_desc.h)
+
+# Generate hid_keymap_table.h from the given hid_keymap_def.h and add its
+# directory to the include path of the application.
+function(hid_keymap_table_generate keymap_def_path)
+  set(output_dir ${CMAKE_BINARY_DIR}/nrf_desktop/include)
+  set(output_file ${output_dir}/hid_keymap_table.h)
+
+  file(MAKE_DIRECTORY "${output_dir}")
+
+  add_custom_command(
+    OUTPUT ${output_file}
+    COMMAND ${PYTHON_EXECUTABLE} ${HID_KEYMAP_TABLE_SCRIPT}
+    --input ${keymap_def_path}
+    --report-desc ${HID_REPORT_DESC_PATH}
+    --output ${output_file}
+    DEPENDS ${keymap_def_path} ${HID_REPORT_DESC_PATH}
+            ${HID_KEYMAP_TABLE_SCRIPT}
+  )
+
+  add_custom_target(hid_keymap_table DEPENDS ${output_file})
+  add_dependencies(app hid_keymap_table)
+
+  zephyr_library_include_directories(${output_dir})
+
+  message(STATUS "Generating ${output_file}")
+endfunction()
@@ -0,0 +1,221 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2021 Nordic Semiconductor ASA
+#
+# SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+
+"""Generate a direct-index lookup table for the nRF Desktop HID keymap.
+
+The script parses the hid_keymap array from hid_keymap_def.h and generates
+a header with a table that maps a key ID to the position of its entry in the
+hid_keymap array. The table is indexed by the function key flag, the column
+and the row of the key ID. The header also defines hid_keymap_get() that
+translates a key ID using the table.
+
+The report IDs of the keymap entries are checked against the report_id enum
+from hid_report_desc.h. An entry with a reserved or out of range report ID is
+a build error.
+
+The generated header must be included right after hid_keymap_def.h.
+"""
+
+import argparse
+import re
+import sys
+
+# Must match configuration/common/key_id.h.
+ROW_SIZE = 7
+COL_SIZE = 7
+
+ENTRY_RE = re.compile(r'\{\s*(FN_)?KEY_ID\s*\(\s*([^,()]+?)\s*,\s*([^,()]+?)\s*\)'
+                      r'\s*,\s*([^,{}]+?)\s*,\s*(\w+)\s*\}')
+COMMENT_RE = re.compile(r'/\*.*?\*/|//[^\n]*', re.DOTALL)
+ENUM_RE = re.compile(r'enum\s+report_id\s*\{(.*?)\}', re.DOTALL)
+ENUM_ITEM_RE = re.compile(r'^\s*(\w+)\s*(?:=\s*(\w+))?\s*$')
+
+
+def parse_report_ids(text):
+    """Return a dictionary of the report_id enum names and their values."""
+    text = COMMENT_RE.sub('', text)
+
+    match = ENUM_RE.search(text)
+    if not match:
+        raise ValueError('report_id enum not found')
+
+    report_ids = {}
+    value = 0
+    for item in match.group(1).split(','):
+        if not item.strip():
+            continue
+
+        item_match = ENUM_ITEM_RE.match(item)
+        if not item_match:
+            raise ValueError(f'Cannot parse report_id enum item {item.strip()}')
+
+        name, init = item_match.groups()
+        if init is not None:
+            value = int(init, 0)
+
+        report_ids[name] = value
+        value += 1
+
+    if 'REPORT_ID_COUNT' not in report_ids:
+        raise ValueError('REPORT_ID_COUNT not found in report_id enum')
+
+    return report_ids
+
+
+def report_id_value(report, report_ids):
+    try:
+        return int(report, 0)
+    except ValueError:
+        pass
+
+    if report not in report_ids:
+        raise ValueError(f'Unknown report ID {report}')
+
+    return report_ids[report]
+
+
+def parse_keymap(text, report_ids):
+    text = COMMENT_RE.sub('', text)
+
+    start = text.find('hid_keymap[]')
+    if start < 0:
+        raise ValueError('hid_keymap array not found')
+
+    body_start = text.index('{', start)
+    body_end = text.index('};', body_start)
+
+    keymap = []
+    for match in ENTRY_RE.finditer(text, body_start + 1, body_end):
+        fn, col, row, usage, report = match.groups()
+        col = int(col, 0)
+        row = int(row, 0)
+
+        if (col >= (1 << COL_SIZE)) or (row >= (1 << ROW_SIZE)):
+            raise ValueError(f'Key ID ({col}, {row}) out of range')
+        report_id = report_id_value(report, report_ids)
+        if (report_id <= report_ids.get('REPORT_ID_RESERVED', 0)) or \
+           (report_id >= report_ids['REPORT_ID_COUNT']):
+            raise ValueError(f'Invalid report ID {report} for key ID '
+                             f'({col}, {row})')
+
+        keymap.append((fn is not None, col, row))
+
+    if not keymap:
+        raise ValueError('hid_keymap array is empty')
+
+    if len(set(keymap)) != len(keymap):
+        raise ValueError('Key ID mapped more than once in hid_keymap')
+
+    return keymap
+
+
+def generate_table(keymap, source):
+    fn_cnt = 2 if any(fn for fn, _, _ in keymap) else 1
+    col_cnt = max(col for _, col, _ in keymap) + 1
+    row_cnt = max(row for _, _, row in keymap) + 1
+
+    table = [0] * (fn_cnt * col_cnt * row_cnt)
+    for pos, (fn, col, row) in enumerate(keymap):
+        table[(int(fn) * col_cnt + col) * row_cnt + row] = pos + 1
+
+    elem_type = 'uint8_t' if len(keymap) <= 0xFF else 'uint16_t'
+
+    lines = [
+        '/*',
+        ' * Generated by hid_keymap_table.py from:',
+        f' * {source}',
+        ' *',
+        ' * Do not edit.',
+        ' */',
+        '',
+        '#ifndef _HID_KEYMAP_TABLE_H_',
+        '#define _HID_KEYMAP_TABLE_H_',
+        '',
+        f'#define HID_KEYMAP_TABLE_FN_CNT\t{fn_cnt}',
+        f'#define HID_KEYMAP_TABLE_COL_CNT\t{col_cnt}',
+        f'#define HID_KEYMAP_TABLE_ROW_CNT\t{row_cnt}',
+        '',
+        f'BUILD_ASSERT(ARRAY_SIZE(hid_keymap) == {len(keymap)},',
+        '\t     "hid_keymap_table.h does not match hid_keymap");',
+        '',
+        '/* Position of the hid_keymap entry increased by one. Zero is used',
+        ' * for key IDs without a mapping.',
+        ' */',
+        f'static const {elem_type} hid_keymap_table[] = {{',
+    ]
+
+    for i in range(0, len(table), row_cnt):
+        lines.append('\t' + ', '.join(str(v) for v in table[i:i + row_cnt]) +
+                     ',')
+
+    lines += [
+        '};',
+        '',
+        '/**@brief Translate Key ID to HID Usage ID and target report. */',
+        'static inline const struct hid_keymap *hid_keymap_get(uint16_t key_id)',
+        '{',
+        '\tsize_t fn = ((key_id & _FN_BIT) != 0);',
+        '\tsize_t col = KEY_COL(key_id);',
+        '\tsize_t row = KEY_ROW(key_id);',
+        '',
+        '\tif ((fn >= HID_KEYMAP_TABLE_FN_CNT) ||',
+        '\t    (col >= HID_KEYMAP_TABLE_COL_CNT) ||',
+        '\t    (row >= HID_KEYMAP_TABLE_ROW_CNT)) {',
+        '\t\treturn NULL;',
+        '\t}',
+        '',
+        '\tsize_t pos = hid_keymap_table[(fn * HID_KEYMAP_TABLE_COL_CNT + col) *',
+        '\t\t\t\t      HID_KEYMAP_TABLE_ROW_CNT + row];',
+        '',
+        '\tif (pos == 0) {',
+        '\t\treturn NULL;',
+        '\t}',
+        '',
+        '\treturn &hid_keymap[pos - 1];',
+        '}',
+        '',
+        '#endif /* _HID_KEYMAP_TABLE_H_ */',
+        '',
+    ]
+
+    return '\n'.join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description='Generate the HID keymap lookup table.')
+    parser.add_argument('-i', '--input', required=True,
+                        help='Path to hid_keymap_def.h')
+    parser.add_argument('-r', '--report-desc', required=True,
+                        help='Path to hid_report_desc.h')
+    parser.add_argument('-o', '--output', required=True,
+                        help='Path to the generated header')
+    args = parser.parse_args()
+
+    with open(args.report_desc, 'r') as f:
+        text = f.read()
+
+    try:
+        report_ids = parse_report_ids(text)
+    except ValueError as e:
+        sys.exit(f'{args.report_desc}: {e}')
+
+    with open(args.input, 'r') as f:
+        text = f.read()
+
+    try:
+        keymap = parse_keymap(text, report_ids)
+    except ValueError as e:
+        sys.exit(f'{args.input}: {e}')
+
+    header = generate_table(keymap, args.input)
+
+    with open(args.output, 'w') as f:
+        f.write(header)
+
+
+if __name__ == '__main__':
+    main()
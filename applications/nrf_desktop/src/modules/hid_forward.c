@@ -5,11 +5,11 @@
  */
 
 #include <zephyr/types.h>
-#include <sys/slist.h>
 #include <settings/settings.h>
 
 #include <bluetooth/services/hogp.h>
 #include <sys/byteorder.h>
+#include <profiler.h>
 
 #define MODULE hid_forward
 #include "module_state_event.h"
@@ -33,22 +33,26 @@ LOG_MODULE_REGISTER(MODULE, CONFIG_DESKTOP_HID_FORWARD_LOG_LEVEL);
 #define CFG_CHAN_BASE_ID		(CFG_CHAN_RECIPIENT_LOCAL + 1)
 
 #define PERIPHERAL_ADDRESSES_STORAGE_NAME "paddr"
+#define LATENCY_EVENT_NAME	"hid_forward_latency"
 
 BUILD_ASSERT(CFG_CHAN_MAX_RSP_POLL_CNT <= UCHAR_MAX);
 
 struct enqueued_report {
-	sys_snode_t node;
 	struct hid_report_event *report;
+	uint32_t timestamp;
 };
 
-struct counted_list {
-	sys_slist_t list;
-	size_t count;
+struct report_ring {
+	struct enqueued_report item[MAX_ENQUEUED_ITEMS];
+	uint8_t head;
+	uint8_t count;
 };
 
 struct enqueued_reports {
-	struct counted_list reports[ARRAY_SIZE(input_reports)];
+	struct report_ring reports[ARRAY_SIZE(input_reports)];
 	uint8_t last_idx;
+	uint32_t enqueued_cnt;
+	uint32_t drop_cnt;
 };
 
 struct subscriber {
@@ -57,6 +61,9 @@ struct subscriber {
 	struct enqueued_reports enqueued_reports;
 	bool busy;
 	uint8_t last_peripheral_id;
+	uint8_t sent_report_id;
+	uint32_t recv_time;
+	uint32_t submit_time;
 };
 
 struct hids_peripheral {
@@ -75,6 +82,7 @@ static struct subscriber subscribers[CONFIG_USB_HID_DEVICE_COUNT];
 static bt_addr_le_t peripheral_address[CONFIG_BT_MAX_PAIRED];
 static struct hids_peripheral peripherals[CONFIG_BT_MAX_CONN];
 static bool suspended;
+static uint16_t latency_event_id;
 
 
 #if CONFIG_USB_HID_DEVICE_COUNT > 1
@@ -179,19 +187,30 @@ static bool is_report_enabled(struct subscriber *sub, uint8_t report_id)
 	return (sub->enabled_reports_bm & BIT(report_id)) != 0;
 }
 
-static bool is_report_enqueued(struct enqueued_reports *enqueued_reports,
+static uint32_t timestamp_get(void)
+{
+	if (IS_ENABLED(CONFIG_DESKTOP_HID_FORWARD_PROFILE_LATENCY)) {
+		return k_cycle_get_32();
+	}
+
+	return 0;
+}
+
+static bool is_report_enqueued(const struct enqueued_reports *enqueued_reports,
 			       size_t irep_idx)
 {
-	struct counted_list *reports = &enqueued_reports->reports[irep_idx];
+	return (enqueued_reports->reports[irep_idx].count != 0);
+}
 
-	if (reports->count == 0) {
-		__ASSERT_NO_MSG(sys_slist_is_empty(&reports->list));
-		return false;
-	}
-	return true;
+static bool is_report_queue_full(const struct enqueued_reports *enqueued_reports,
+				 size_t irep_idx)
+{
+	const struct report_ring *ring = &enqueued_reports->reports[irep_idx];
+
+	return (ring->count == ARRAY_SIZE(ring->item));
 }
 
-static bool is_any_report_enqueued(struct enqueued_reports *enqueued_reports)
+static bool is_any_report_enqueued(const struct enqueued_reports *enqueued_reports)
 {
 	for (size_t irep_idx = 0; irep_idx < ARRAY_SIZE(enqueued_reports->reports); irep_idx++) {
 		if (is_report_enqueued(enqueued_reports, irep_idx)) {
@@ -202,136 +221,192 @@ static bool is_any_report_enqueued(struct enqueued_reports *enqueued_reports)
 	return false;
 }
 
-static struct enqueued_report *get_enqueued_report(struct enqueued_reports *enqueued_reports,
-						   size_t irep_idx)
+static struct enqueued_report get_enqueued_report(struct enqueued_reports *enqueued_reports,
+						  size_t irep_idx)
 {
-	struct counted_list *reports = &enqueued_reports->reports[irep_idx];
-	struct enqueued_report *item;
+	struct report_ring *ring = &enqueued_reports->reports[irep_idx];
+
+	__ASSERT_NO_MSG(ring->count > 0);
 
-	item = CONTAINER_OF(sys_slist_get(&reports->list),
-			    __typeof__(*item),
-			    node);
-	__ASSERT_NO_MSG(reports->count > 0);
-	reports->count--;
+	struct enqueued_report item = ring->item[ring->head];
+
+	ring->head = next_id(ring->head, ARRAY_SIZE(ring->item));
+	ring->count--;
 
 	return item;
 }
 
+static void put_enqueued_report(struct enqueued_reports *enqueued_reports,
+				size_t irep_idx,
+				const struct enqueued_report *item)
+{
+	struct report_ring *ring = &enqueued_reports->reports[irep_idx];
+
+	__ASSERT_NO_MSG(ring->count < ARRAY_SIZE(ring->item));
+
+	ring->item[(ring->head + ring->count) % ARRAY_SIZE(ring->item)] = *item;
+	ring->count++;
+}
+
 static void drop_enqueued_reports(struct enqueued_reports *enqueued_reports,
 				  size_t irep_idx)
 {
 	__ASSERT_NO_MSG(irep_idx < ARRAY_SIZE(enqueued_reports->reports));
 
 	while (is_report_enqueued(enqueued_reports, irep_idx)) {
-		struct enqueued_report *item;
+		struct enqueued_report item;
 
 		item = get_enqueued_report(enqueued_reports, irep_idx);
 
-		k_free(item->report);
-		k_free(item);
+		k_free(item.report);
 	}
 }
 
 static void init_enqueued_reports(struct enqueued_reports *enqueued_reports)
 {
 	for (size_t irep_idx = 0; irep_idx < ARRAY_SIZE(enqueued_reports->reports); irep_idx++) {
-		struct counted_list *reports = &enqueued_reports->reports[irep_idx];
+		struct report_ring *ring = &enqueued_reports->reports[irep_idx];
 
-		sys_slist_init(&reports->list);
-		reports->count = 0;
+		ring->head = 0;
+		ring->count = 0;
 	}
 
 	enqueued_reports->last_idx = 0;
+	enqueued_reports->enqueued_cnt = 0;
+	enqueued_reports->drop_cnt = 0;
 }
 
-static struct enqueued_report *get_next_enqueued_report(struct enqueued_reports *enqueued_reports)
+static bool get_next_enqueued_report(struct enqueued_reports *enqueued_reports,
+				     struct enqueued_report *item)
 {
-	struct enqueued_report *item = NULL;
-
 	for (size_t i = 0; i < ARRAY_SIZE(enqueued_reports->reports); i++) {
 		size_t irep_idx = next_id(enqueued_reports->last_idx + i,
 					  ARRAY_SIZE(enqueued_reports->reports));
 
 		if (is_report_enqueued(enqueued_reports, irep_idx)) {
-			item = get_enqueued_report(enqueued_reports, irep_idx);
+			*item = get_enqueued_report(enqueued_reports, irep_idx);
 
 			enqueued_reports->last_idx = irep_idx;
-			break;
+			return true;
 		}
 	}
 
-	return item;
+	return false;
+}
+
+static void enqueue_hid_report(struct enqueued_reports *enqueued_reports,
+			       size_t irep_idx,
+			       const struct enqueued_report *item)
+{
+	__ASSERT_NO_MSG(irep_idx < ARRAY_SIZE(enqueued_reports->reports));
+
+	if (is_report_queue_full(enqueued_reports, irep_idx)) {
+		struct enqueued_report dropped;
+
+		dropped = get_enqueued_report(enqueued_reports, irep_idx);
+		k_free(dropped.report);
+
+		enqueued_reports->drop_cnt++;
+		LOG_WRN("Enqueue dropped the oldest report");
+	}
+
+	put_enqueued_report(enqueued_reports, irep_idx, item);
+	enqueued_reports->enqueued_cnt++;
 }
 
 static void migrate_enqueued_reports(struct enqueued_reports *dst_reports,
 				     struct enqueued_reports *src_reports)
 {
-	/* Migrate only up to MAX_ENQUEUED_ITEMS newest items.
-	 * As per can hold up only up to MAX_ENQUEUED_ITEMS at a time,
-	 * migration from per to sub will affect entire list.
-	 * When migrating from sub to par we will never get more items
-	 * then the defined limit.
-	 * Leaving the oldest items at sub will allow them to be sent
-	 * out first.
+	/* Reports are moved starting from the oldest one. If the destination
+	 * queue fills up, its oldest reports are dropped, so only up to
+	 * MAX_ENQUEUED_ITEMS newest reports are left.
 	 */
 	for (size_t irep_idx = 0; irep_idx < ARRAY_SIZE(dst_reports->reports); irep_idx++) {
-		if (is_report_enqueued(src_reports, irep_idx)) {
-			struct counted_list *dst = &dst_reports->reports[irep_idx];
-			struct counted_list *src = &src_reports->reports[irep_idx];
+		while (is_report_enqueued(src_reports, irep_idx)) {
+			struct enqueued_report item;
 
-			sys_slist_t tmp_list;
-			size_t count = 0;
-
-			sys_slist_init(&tmp_list);
+			item = get_enqueued_report(src_reports, irep_idx);
+			enqueue_hid_report(dst_reports, irep_idx, &item);
+		}
+	}
+}
 
-			/* Move excessive items to a temporary list. */
-			while (src->count > MAX_ENQUEUED_ITEMS) {
-				sys_snode_t *node = sys_slist_get(&src->list);
-				src->count--;
+static struct hid_report_event *alloc_hid_report(struct hids_peripheral *per,
+						 size_t irep_idx,
+						 size_t size)
+{
+	struct enqueued_reports *enqueued_reports = &per->enqueued_reports;
 
-				sys_slist_append(&tmp_list, node);
-				count++;
-			}
+	if (get_subscriber(per)->busy &&
+	    is_report_queue_full(enqueued_reports, irep_idx)) {
+		/* The oldest report would be dropped on enqueue. Reuse its
+		 * event instead of allocating a new one.
+		 */
+		struct enqueued_report item;
 
-			/* Source hold MAX_ENQUEUED_ITEMS items max.
-			 * Migrate the entire list. */
-			sys_slist_merge_slist(&dst->list, &src->list);
-			dst->count += src->count;
+		item = get_enqueued_report(enqueued_reports, irep_idx);
+		enqueued_reports->drop_cnt++;
+		LOG_WRN("Enqueue dropped the oldest report");
 
-			/* Bring back excessive items to the source list. */
-			src->list = tmp_list;
-			src->count = count;
+		if (item.report->dyndata.size == size) {
+			return item.report;
 		}
+
+		k_free(item.report);
 	}
+
+	return new_hid_report_event(size);
 }
 
-static void enqueue_hid_report(struct enqueued_reports *enqueued_reports,
-			       size_t irep_idx,
-			       struct hid_report_event *report)
+static void submit_hid_report(struct subscriber *sub,
+			      const struct enqueued_report *item)
 {
-	__ASSERT_NO_MSG(irep_idx < ARRAY_SIZE(enqueued_reports->reports));
-
-	struct counted_list *reports = &enqueued_reports->reports[irep_idx];
+	sub->sent_report_id = item->report->dyndata.data[0];
+	sub->recv_time = item->timestamp;
+	sub->submit_time = timestamp_get();
 
-	struct enqueued_report *item;
+	EVENT_SUBMIT(item->report);
+	sub->busy = true;
+}
 
-	if (reports->count < MAX_ENQUEUED_ITEMS) {
-		item = k_malloc(sizeof(*item));
-	} else {
-		LOG_WRN("Enqueue dropped the oldest report");
-		item = get_enqueued_report(enqueued_reports, irep_idx);
-		k_free(item->report);
+static void profile_latency(const struct subscriber *sub)
+{
+	if (!IS_ENABLED(CONFIG_DESKTOP_HID_FORWARD_PROFILE_LATENCY) ||
+	    !is_profiling_enabled(latency_event_id)) {
+		return;
 	}
 
-	if (!item) {
-		LOG_ERR("Dropped HID report");
-		/* Should never happen. */
-		__ASSERT_NO_MSG(false);
-	} else {
-		item->report = report;
-		sys_slist_append(&reports->list, &item->node);
-		reports->count++;
+	if (!sub->busy) {
+		/* The sent report was not submitted by this module. Its
+		 * timestamps were not recorded.
+		 */
+		return;
 	}
+
+	uint32_t sent_time = timestamp_get();
+	struct log_event_buf buf;
+
+	profiler_log_start(&buf);
+	profiler_log_encode_u32(&buf, sub->sent_report_id);
+	profiler_log_encode_u32(&buf,
+		k_cyc_to_us_floor32(sub->submit_time - sub->recv_time));
+	profiler_log_encode_u32(&buf,
+		k_cyc_to_us_floor32(sent_time - sub->submit_time));
+	profiler_log_send(&buf, latency_event_id);
+}
+
+static void register_latency_event(void)
+{
+	static const char *args[] = {"report_id", "queue_us", "send_us"};
+	static const enum profiler_arg arg_types[] = {PROFILER_ARG_U32,
+						      PROFILER_ARG_U32,
+						      PROFILER_ARG_U32};
+
+	BUILD_ASSERT(ARRAY_SIZE(args) == ARRAY_SIZE(arg_types));
+
+	latency_event_id = profiler_register_event_type(LATENCY_EVENT_NAME,
+							args, arg_types,
+							ARRAY_SIZE(args));
 }
 
 static void forward_hid_report(struct hids_peripheral *per, uint8_t report_id,
@@ -362,22 +437,26 @@ static void forward_hid_report(struct hids_peripheral *per, uint8_t report_id,
 		return;
 	}
 
-	struct hid_report_event *report = new_hid_report_event(size + sizeof(report_id));
+	struct enqueued_report item = {
+		.report = alloc_hid_report(per, irep_idx,
+					   size + sizeof(report_id)),
+		.timestamp = timestamp_get(),
+	};
 
-	report->subscriber = sub->id;
+	item.report->subscriber = sub->id;
 
 	/* Forward report as is adding report id on the front. */
-	report->dyndata.data[0] = report_id;
-	memcpy(&report->dyndata.data[1], data, size);
+	item.report->dyndata.data[0] = report_id;
+	memcpy(&item.report->dyndata.data[1], data, size);
 
 	if (!sub->busy) {
 		__ASSERT_NO_MSG(!is_report_enqueued(&per->enqueued_reports, irep_idx));
 
-		EVENT_SUBMIT(report);
+		submit_hid_report(sub, &item);
 		per->enqueued_reports.last_idx = irep_idx;
-		sub->busy = true;
 	} else {
-		enqueue_hid_report(&per->enqueued_reports, irep_idx, report);
+		put_enqueued_report(&per->enqueued_reports, irep_idx, &item);
+		per->enqueued_reports.enqueued_cnt++;
 	}
 }
 
@@ -472,12 +551,15 @@ static int register_peripheral(struct bt_gatt_dm *dm, const uint8_t *hwid,
 
 	per->sub_id = sub_id;
 
-	/* Migrate part of the unsent reports to this peripheral.
-	 * This is needed to make sure that at any time number of
-	 * allocated reports is within configured bounds.
+	/* Migrate the unsent reports left at the subscriber to this
+	 * peripheral. The subscriber queue holds the reports of disconnected
+	 * peripherals. Emptying it makes sure that the reports migrated on
+	 * the next disconnection do not drop the reports already there,
+	 * e.g. the key releases of a disconnected peripheral.
 	 */
 	__ASSERT_NO_MSG(!is_any_report_enqueued(&per->enqueued_reports));
 	ARG_UNUSED(is_any_report_enqueued);
+	init_enqueued_reports(&per->enqueued_reports);
 	migrate_enqueued_reports(&per->enqueued_reports,
 				 &get_subscriber(per)->enqueued_reports);
 
@@ -874,6 +956,10 @@ static void disconnect_peripheral(struct hids_peripheral *per)
 		}
 	}
 
+	LOG_INF("Peripheral %p reports enqueued: %" PRIu32 ", dropped: %" PRIu32,
+		per, per->enqueued_reports.enqueued_cnt,
+		per->enqueued_reports.drop_cnt);
+
 	migrate_enqueued_reports(&get_subscriber(per)->enqueued_reports,
 				 &per->enqueued_reports);
 	__ASSERT_NO_MSG(!is_any_report_enqueued(&per->enqueued_reports));
@@ -980,6 +1066,10 @@ static void init(void)
 	}
 
 	reset_peripheral_address();
+
+	if (IS_ENABLED(CONFIG_DESKTOP_HID_FORWARD_PROFILE_LATENCY)) {
+		register_latency_event();
+	}
 }
 
 static void send_enqueued_report(struct subscriber *sub)
@@ -988,12 +1078,12 @@ static void send_enqueued_report(struct subscriber *sub)
 		return;
 	}
 
-	struct enqueued_report *item;
+	struct enqueued_report item;
 
 	/* First try to send report left at subscriber. */
-	item = get_next_enqueued_report(&sub->enqueued_reports);
+	bool found = get_next_enqueued_report(&sub->enqueued_reports, &item);
 
-	if (!item) {
+	if (!found) {
 		/* Look for any report to sent at linked peripherals. */
 		for (size_t i = 0; i < ARRAY_SIZE(peripherals); i++) {
 			size_t per_id = next_id(sub->last_peripheral_id + i,
@@ -1005,21 +1095,18 @@ static void send_enqueued_report(struct subscriber *sub)
 				continue;
 			}
 
-			item = get_next_enqueued_report(&per->enqueued_reports);
+			found = get_next_enqueued_report(&per->enqueued_reports,
+							 &item);
 
-			if (item) {
+			if (found) {
 				sub->last_peripheral_id = per_id;
 				break;
 			}
 		}
 	}
 
-	if (item) {
-		EVENT_SUBMIT(item->report);
-
-		k_free(item);
-
-		sub->busy = true;
+	if (found) {
+		submit_hid_report(sub, &item);
 	}
 }
 
@@ -1038,6 +1125,8 @@ static bool event_handler(const struct event_header *eh)
 		}
 		__ASSERT_NO_MSG(sub);
 
+		profile_latency(sub);
+
 		sub->busy = false;
 		send_enqueued_report(sub);
 
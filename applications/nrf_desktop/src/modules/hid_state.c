@@ -14,7 +14,6 @@
 #include <sys/types.h>
 
 #include <zephyr/types.h>
-#include <sys/slist.h>
 #include <sys/util.h>
 #include <sys/byteorder.h>
 
@@ -27,6 +26,7 @@
 
 #include "hid_keymap.h"
 #include "hid_keymap_def.h"
+#include "hid_keymap_table.h"
 #include "hid_report_desc.h"
 
 #define MODULE hid_state
@@ -85,15 +85,20 @@ struct items {
 
 /**@brief Enqueued HID state item. */
 struct item_event {
-	sys_snode_t node; /**< Event queue linked list node. */
 	struct item item; /**< HID state item which has been enqueued. */
 	uint32_t timestamp; /**< HID event timestamp. */
 };
 
-/**@brief Event queue. */
+/**@brief Event queue.
+ *
+ * Ring buffer of HID state items, oldest item at the head.
+ */
 struct eventq {
-	sys_slist_t root;
-	size_t len;
+	struct item_event event[CONFIG_DESKTOP_HID_EVENT_QUEUE_SIZE];
+	uint8_t head; /**< Position of the oldest event. */
+	uint8_t len; /**< Number of enqueued events. */
+	uint16_t overflow_cnt; /**< Number of times the queue was full. */
+	uint32_t drop_cnt; /**< Number of events dropped on overflow. */
 };
 
 /**@brief Axis data. */
@@ -178,31 +183,6 @@ static void *bsearch(const void *key, const uint8_t *base,
 	return NULL;
 }
 
-/**@brief Compare Key ID in HID Keymap entries. */
-static int hid_keymap_compare(const void *a, const void *b)
-{
-	const struct hid_keymap *p_a = a;
-	const struct hid_keymap *p_b = b;
-
-	return (p_a->key_id - p_b->key_id);
-}
-
-/**@brief Translate Key ID to HID Usage ID and target report. */
-static struct hid_keymap *hid_keymap_get(uint16_t key_id)
-{
-	struct hid_keymap key = {
-		.key_id = key_id
-	};
-
-	struct hid_keymap *map = bsearch(&key,
-					 (uint8_t *)hid_keymap,
-					 ARRAY_SIZE(hid_keymap),
-					 sizeof(key),
-					 hid_keymap_compare);
-
-	return map;
-}
-
 /**@brief Compare two usage values. */
 static int usage_id_compare(const void *a, const void *b)
 {
@@ -214,86 +194,80 @@ static int usage_id_compare(const void *a, const void *b)
 
 static void eventq_reset(struct eventq *eventq)
 {
-	struct item_event *event;
-	struct item_event *tmp;
-
-	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&eventq->root, event, tmp, node) {
-		sys_slist_remove(&eventq->root, NULL, &event->node);
-
-		k_free(event);
-	}
-
-	sys_slist_init(&eventq->root);
+	eventq->head = 0;
 	eventq->len = 0;
 }
 
 static bool eventq_is_full(const struct eventq *eventq)
 {
-	return (eventq->len >= CONFIG_DESKTOP_HID_EVENT_QUEUE_SIZE);
+	return (eventq->len >= ARRAY_SIZE(eventq->event));
 }
 
 
-static bool eventq_is_empty(struct eventq *eventq)
+static bool eventq_is_empty(const struct eventq *eventq)
 {
-	bool empty = sys_slist_is_empty(&eventq->root);
+	return (eventq->len == 0);
+}
 
-	__ASSERT_NO_MSG(!empty == (eventq->len != 0));
+/**@brief Get event at the given position, counting from the oldest one. */
+static struct item_event *eventq_peek(struct eventq *eventq, size_t pos)
+{
+	__ASSERT_NO_MSG(pos < eventq->len);
 
-	return empty;
+	return &eventq->event[(eventq->head + pos) % ARRAY_SIZE(eventq->event)];
 }
 
-static struct item_event *eventq_get(struct eventq *eventq)
+/**@brief Remove the oldest event from the queue.
+ *
+ * The returned event stays valid until a new event is appended.
+ */
+static const struct item_event *eventq_get(struct eventq *eventq)
 {
-	sys_snode_t *node = sys_slist_get(&eventq->root);
-
-	if (!node) {
+	if (eventq_is_empty(eventq)) {
 		return NULL;
 	}
 
+	const struct item_event *event = eventq_peek(eventq, 0);
+
+	eventq->head = (eventq->head + 1) % ARRAY_SIZE(eventq->event);
 	eventq->len--;
 
-	return CONTAINER_OF(node, struct item_event, node);
+	return event;
 }
 
 static void eventq_append(struct eventq *eventq, uint16_t usage_id, int16_t value)
 {
-	struct item_event *hid_event = k_malloc(sizeof(*hid_event));
+	__ASSERT_NO_MSG(!eventq_is_full(eventq));
 
-	if (!hid_event) {
-		LOG_ERR("Failed to allocate HID event");
-		/* Should never happen. */
-		__ASSERT_NO_MSG(false);
-		return;
-	}
+	eventq->len++;
+
+	struct item_event *hid_event = eventq_peek(eventq, eventq->len - 1);
 
 	hid_event->item.usage_id = usage_id;
 	hid_event->item.value = value;
 	hid_event->timestamp = k_uptime_get_32();
-
-	/* Add a new event to the queue. */
-	sys_slist_append(&eventq->root, &hid_event->node);
-
-	eventq->len++;
 }
 
-static void eventq_region_purge(struct eventq *eventq,
-				sys_snode_t *last_to_purge)
+/**@brief Remove the event at the given position, counting from the oldest one.
+ *
+ * Newer events are moved one position towards the head of the queue.
+ */
+static void eventq_remove(struct eventq *eventq, size_t pos)
 {
-	sys_snode_t *tmp;
-	sys_snode_t *tmp_safe;
-	size_t cnt = 0;
+	__ASSERT_NO_MSG(pos < eventq->len);
 
-	SYS_SLIST_FOR_EACH_NODE_SAFE(&eventq->root, tmp, tmp_safe) {
-		sys_slist_remove(&eventq->root, NULL, tmp);
+	for (; pos < eventq->len - 1U; pos++) {
+		*eventq_peek(eventq, pos) = *eventq_peek(eventq, pos + 1);
+	}
 
-		k_free(CONTAINER_OF(tmp, struct item_event, node));
-		cnt++;
+	eventq->len--;
+}
 
-		if (tmp == last_to_purge) {
-			break;
-		}
-	}
+static void eventq_region_purge(struct eventq *eventq, size_t cnt)
+{
+	__ASSERT_NO_MSG(cnt <= eventq->len);
 
+	eventq->head = (eventq->head + cnt) % ARRAY_SIZE(eventq->event);
 	eventq->len -= cnt;
 
 	LOG_WRN("%u stale events removed from the queue!", cnt);
@@ -304,11 +278,12 @@ static void eventq_cleanup(struct eventq *eventq, uint32_t timestamp)
 {
 	/* Find timed out events. */
 
-	sys_snode_t *first_valid;
+	const size_t len = eventq->len;
+	size_t first_valid;
 
-	SYS_SLIST_FOR_EACH_NODE(&eventq->root, first_valid) {
-		uint32_t diff = timestamp - CONTAINER_OF(
-			first_valid, struct item_event, node)->timestamp;
+	for (first_valid = 0; first_valid < len; first_valid++) {
+		uint32_t diff = timestamp -
+			eventq_peek(eventq, first_valid)->timestamp;
 
 		if (diff < CONFIG_DESKTOP_HID_REPORT_EXPIRATION) {
 			break;
@@ -316,20 +291,16 @@ static void eventq_cleanup(struct eventq *eventq, uint32_t timestamp)
 	}
 
 	/* Remove events but only if key up was generated for each removed
-	 * key down.
+	 * key down. Positions are counted from the head of the queue
+	 * before any event was removed.
 	 */
 
-	sys_snode_t *maxfound = sys_slist_peek_head(&eventq->root);
 	size_t maxfound_pos = 0;
+	size_t purged = 0;
 
-	sys_snode_t *cur;
-	size_t cur_pos = 0;
-
-	sys_snode_t *tmp_safe;
-
-	SYS_SLIST_FOR_EACH_NODE_SAFE(&eventq->root, cur, tmp_safe) {
+	for (size_t cur_pos = 0; cur_pos < len; cur_pos++) {
 		const struct item cur_item =
-			CONTAINER_OF(cur, struct item_event, node)->item;
+			eventq_peek(eventq, cur_pos - purged)->item;
 
 		if (cur_item.value > 0) {
 			/* Every key down must be paired with key up.
@@ -337,20 +308,12 @@ static void eventq_cleanup(struct eventq *eventq, uint32_t timestamp)
 			 * first key down for this usage.
 			 */
 
-			unsigned int hit_count = cur_item.value;
-			sys_snode_t *j = cur;
-			size_t j_pos = cur_pos;
-
-			SYS_SLIST_ITERATE_FROM_NODE(&eventq->root, j) {
-				j_pos++;
-				if (j == first_valid) {
-					break;
-				}
+			int hit_count = cur_item.value;
+			size_t j_pos;
 
+			for (j_pos = cur_pos + 1; j_pos < first_valid; j_pos++) {
 				const struct item item =
-					CONTAINER_OF(j,
-						     struct item_event,
-						     node)->item;
+					eventq_peek(eventq, j_pos - purged)->item;
 
 				if (cur_item.usage_id == item.usage_id) {
 					hit_count += item.value;
@@ -364,30 +327,28 @@ static void eventq_cleanup(struct eventq *eventq, uint32_t timestamp)
 				}
 			}
 
-			if (j == first_valid) {
+			if (j_pos >= first_valid) {
 				/* Pair not found. */
 				break;
 			}
 
 			if (j_pos > maxfound_pos) {
-				maxfound = j;
 				maxfound_pos = j_pos;
 			}
 		}
 
 
-		if (cur == first_valid) {
+		if (cur_pos == first_valid) {
 			break;
 		}
 
-		if (cur == maxfound) {
+		if (cur_pos == maxfound_pos) {
 			/* All events up to this point have pairs and can
 			 * be deleted.
 			 */
-			eventq_region_purge(eventq, maxfound);
+			eventq_region_purge(eventq, maxfound_pos + 1 - purged);
+			purged = maxfound_pos + 1;
 		}
-
-		cur_pos++;
 	}
 }
 
@@ -771,7 +732,7 @@ static bool update_report(struct report_data *rd)
 
 	while (!update_needed && !eventq_is_empty(&rd->eventq)) {
 		/* There are enqueued events to handle. */
-		struct item_event *event = eventq_get(&rd->eventq);
+		const struct item_event *event = eventq_get(&rd->eventq);
 
 		__ASSERT_NO_MSG(event);
 
@@ -781,9 +742,6 @@ static bool update_report(struct report_data *rd)
 
 		rd->update_needed = rd->update_needed || update_needed;
 
-
-		k_free(event);
-
 		/* If no item was changed, try next event. */
 	}
 
@@ -1133,6 +1091,71 @@ static void disconnect_subscriber(const void *subscriber_id)
 	LOG_INF("Subscriber %p disconnected", subscriber_id);
 }
 
+/**@brief Drop the oldest enqueued event to make room for a new one.
+ *
+ * A key up must not be lost, or the key would stay pressed. It is applied
+ * to the recorded items right away instead.
+ */
+static void drop_oldest(struct report_data *rd)
+{
+	const struct item_event *event = eventq_get(&rd->eventq);
+
+	__ASSERT_NO_MSG(event);
+
+	if ((event->item.value < 0) &&
+	    key_value_set(&rd->items, event->item.usage_id, event->item.value)) {
+		rd->update_needed = true;
+	} else {
+		rd->eventq.drop_cnt++;
+	}
+}
+
+/**@brief Merge the oldest key down and key up pair of the same usage.
+ *
+ * The pair brings no change to the HID report state once both events are
+ * applied, so it is removed from the queue. Only the key press is lost.
+ *
+ * @return true if a pair was removed, false otherwise.
+ */
+static bool coalesce_oldest(struct report_data *rd)
+{
+	struct eventq *eventq = &rd->eventq;
+
+	for (size_t i = 0; i < eventq->len; i++) {
+		const struct item item = eventq_peek(eventq, i)->item;
+
+		if (item.value <= 0) {
+			continue;
+		}
+
+		for (size_t j = i + 1; j < eventq->len; j++) {
+			const struct item next = eventq_peek(eventq, j)->item;
+
+			if (next.usage_id != item.usage_id) {
+				continue;
+			}
+
+			if (next.value == -item.value) {
+				/* Remove the newer event first, so that the
+				 * position of the older one does not change.
+				 */
+				eventq_remove(eventq, j);
+				eventq_remove(eventq, i);
+				eventq->drop_cnt += 2;
+
+				return true;
+			}
+
+			/* Next event of this usage does not cancel the key
+			 * down.
+			 */
+			break;
+		}
+	}
+
+	return false;
+}
+
 /**@brief Enqueue event that updates a given usage. */
 static void enqueue(struct report_data *rd, uint16_t usage_id, int16_t value,
 		    bool connected)
@@ -1145,16 +1168,12 @@ static void enqueue(struct report_data *rd, uint16_t usage_id, int16_t value,
 			 * Try to remove queued items starting from the
 			 * oldest one.
 			 */
-			sys_snode_t *i;
-
-			SYS_SLIST_FOR_EACH_NODE(&rd->eventq.root, i) {
+			for (size_t i = 0; i < rd->eventq.len; i++) {
 				/* Initial cleanup was done above. Queue will
 				 * not contain events with expired timestamp.
 				 */
 				uint32_t timestamp =
-					CONTAINER_OF(i,
-						     struct item_event,
-						     node)->timestamp +
+					eventq_peek(&rd->eventq, i)->timestamp +
 					CONFIG_DESKTOP_HID_REPORT_EXPIRATION;
 
 				eventq_cleanup(&rd->eventq, timestamp);
@@ -1162,7 +1181,7 @@ static void enqueue(struct report_data *rd, uint16_t usage_id, int16_t value,
 				if (!eventq_is_full(&rd->eventq)) {
 					/* At least one element was removed
 					 * from the queue. Do not continue
-					 * list traverse, content was modified!
+					 * queue traverse, content was modified!
 					 */
 					break;
 				}
@@ -1170,11 +1189,32 @@ static void enqueue(struct report_data *rd, uint16_t usage_id, int16_t value,
 		}
 
 		if (eventq_is_full(&rd->eventq)) {
-			/* To maintain the sanity of HID state, clear
-			 * all recorded events and items.
-			 */
-			LOG_WRN("Queue is full, all events are dropped!");
-			clear_report_data(rd);
+			rd->eventq.overflow_cnt++;
+
+			if (IS_ENABLED(CONFIG_DESKTOP_HID_EVENT_QUEUE_COALESCE) &&
+			    coalesce_oldest(rd)) {
+				LOG_WRN("Queue is full, key press dropped "
+					"(overflows: %u, dropped: %u)",
+					rd->eventq.overflow_cnt,
+					rd->eventq.drop_cnt);
+			} else if (IS_ENABLED(CONFIG_DESKTOP_HID_EVENT_QUEUE_DROP_OLDEST) ||
+				   IS_ENABLED(CONFIG_DESKTOP_HID_EVENT_QUEUE_COALESCE)) {
+				drop_oldest(rd);
+				LOG_WRN("Queue is full, oldest event dropped "
+					"(overflows: %u, dropped: %u)",
+					rd->eventq.overflow_cnt,
+					rd->eventq.drop_cnt);
+			} else {
+				/* To maintain the sanity of HID state, clear
+				 * all recorded events and items.
+				 */
+				rd->eventq.drop_cnt += rd->eventq.len;
+				LOG_WRN("Queue is full, all events are dropped "
+					"(overflows: %u, dropped: %u)",
+					rd->eventq.overflow_cnt,
+					rd->eventq.drop_cnt);
+				clear_report_data(rd);
+			}
 		}
 	}
 
@@ -1209,19 +1249,7 @@ static void update_key(const struct hid_keymap *map, int16_t value)
 
 static void init(void)
 {
-	if (IS_ENABLED(CONFIG_ASSERT)) {
-		/* Validate the order of key IDs on the key map array. */
-		for (size_t i = 1; i < ARRAY_SIZE(hid_keymap); i++) {
-			__ASSERT(hid_keymap[i - 1].key_id < hid_keymap[i].key_id,
-				 "The hid_keymap array must be sorted by key_id!");
-		}
-		/* Validate if report IDs are correct. */
-		for (size_t i = 0; i < ARRAY_SIZE(hid_keymap); i++) {
-			__ASSERT((hid_keymap[i].report_id != REPORT_ID_RESERVED) &&
-				 (hid_keymap[i].report_id < REPORT_ID_COUNT),
-				 "Invalid report ID used in hid_keymap!");
-		}
-	}
+	/* The HID keymap is validated by the generator of the lookup table. */
 
 	/* Mark unused report IDs. */
 	for (size_t i = 0; i < ARRAY_SIZE(report_data_index); i++) {
@@ -1322,7 +1350,7 @@ static bool handle_wheel_event(const struct wheel_event *event)
 static bool handle_button_event(const struct button_event *event)
 {
 	/* Get usage ID and target report from HID Keymap */
-	struct hid_keymap *map = hid_keymap_get(event->key_id);
+	const struct hid_keymap *map = hid_keymap_get(event->key_id);
 
 	if (!map || !map->usage_id) {
 		LOG_WRN("No mapping, button ignored");
@@ -16,6 +16,7 @@
 #include <hal/nrf_power.h>
 #include <hal/nrf_regulators.h>
 #include <modem/modem_info.h>
+#include <modem/at_cmd.h>
 #include <modem/nrf_modem_lib.h>
 #include <dfu/mcuboot.h>
 #include <power/reboot.h>
@@ -27,6 +28,7 @@ LOG_MODULE_REGISTER(app, CONFIG_SLM_LOG_LEVEL);
 
 #define SLM_WQ_STACK_SIZE	KB(2)
 #define SLM_WQ_PRIORITY		K_LOWEST_APPLICATION_THREAD_PRIO
+#define SLM_STARTUP_CMD_MAX	32
 static K_THREAD_STACK_DEFINE(slm_wq_stack_area, SLM_WQ_STACK_SIZE);
 
 static const struct device *gpio_dev;
@@ -155,6 +157,50 @@ void handle_nrf_modem_lib_init_ret(void)
 	}
 }
 
+static int send_startup_cmds(void)
+{
+	static char cmds[] = CONFIG_SLM_STARTUP_AT_CMDS;
+	static struct at_cmd_batch_item items[SLM_STARTUP_CMD_MAX];
+	struct at_cmd_batch_stats stats = {0};
+	size_t count = 0;
+	char *next = cmds;
+	int err;
+
+	while (next != NULL && count < ARRAY_SIZE(items)) {
+		char *cmd = next;
+
+		next = strchr(cmd, ';');
+		if (next != NULL) {
+			*next++ = '\0';
+		}
+		if (*cmd != '\0') {
+			items[count++].cmd = cmd;
+		}
+	}
+
+	if (next != NULL) {
+		LOG_WRN("Only %d startup AT commands are sent", count);
+	}
+
+	if (count == 0) {
+		return 0;
+	}
+
+	err = at_cmd_write_batch(items, count, false, &stats);
+	for (size_t i = 0; i < stats.exec_cnt; i++) {
+		if (items[i].state != AT_CMD_OK) {
+			LOG_WRN("%s failed: %d", log_strdup(items[i].cmd),
+				items[i].code);
+		}
+	}
+
+	LOG_INF("%d startup AT commands: queue %u us, exec %u us, "
+		"max rtt %u us", stats.exec_cnt, stats.queue_us,
+		stats.exec_us, stats.max_rtt_us);
+
+	return err;
+}
+
 void start_execute(void)
 {
 	int err;
@@ -186,6 +232,12 @@ void start_execute(void)
 		return;
 	}
 
+	/* Configure the modem before accepting AT commands from the host */
+	err = send_startup_cmds();
+	if (err) {
+		LOG_ERR("Failed to send startup AT commands: %d", err);
+	}
+
 	err = slm_at_host_init();
 	if (err) {
 		LOG_ERR("Failed to init at_host: %d", err);
@@ -133,6 +133,45 @@ struct bt_filter_status {
 	struct bt_scan_filter_info manufacturer_data;
 };
 
+/**@brief Hit and miss counters of one filter type.
+ */
+struct bt_scan_filter_counters {
+	/** Number of advertising reports that matched the filter type. */
+	uint32_t hit;
+
+	/** Number of advertising reports that did not match the filter
+	 *  type.
+	 */
+	uint32_t miss;
+};
+
+/**@brief Filter statistics structure.
+ *
+ * @details A filter type is only counted while it is enabled.
+ */
+struct bt_scan_filter_stats {
+	/** Number of received advertising reports. */
+	uint32_t reports;
+
+	/** Name filters counters. */
+	struct bt_scan_filter_counters name;
+
+	/** Short name filters counters. */
+	struct bt_scan_filter_counters short_name;
+
+	/** Address filters counters. */
+	struct bt_scan_filter_counters addr;
+
+	/** UUID filters counters. */
+	struct bt_scan_filter_counters uuid;
+
+	/** Appearance filters counters. */
+	struct bt_scan_filter_counters appearance;
+
+	/** Manufacturer data filters counters. */
+	struct bt_scan_filter_counters manufacturer_data;
+};
+
 /**@brief Advertising info structure.
  */
 struct bt_scan_adv_info {
@@ -497,6 +536,27 @@ int bt_scan_filter_add(enum bt_scan_filter_type type,
  */
 void bt_scan_filter_remove_all(void);
 
+#if CONFIG_BT_SCAN_FILTER_STATS
+
+/**@brief Function for getting the filter statistics.
+ *
+ * @details Requires @option{CONFIG_BT_SCAN_FILTER_STATS}. The counters
+ *          are read one by one, without stopping the processing of
+ *          advertising reports.
+ *
+ * @param[out] stats Pointer to Filter Statistics structure.
+ *
+ * @return 0 If the operation was successful. Otherwise, a (negative) error
+ *	     code is returned.
+ */
+int bt_scan_filter_stats_get(struct bt_scan_filter_stats *stats);
+
+/**@brief Function for resetting the filter statistics.
+ */
+void bt_scan_filter_stats_reset(void);
+
+#endif /* CONFIG_BT_SCAN_FILTER_STATS */
+
 #endif /* CONFIG_BT_SCAN_FILTER_ENABLE */
 
 /**@brief Function for changing the scanning parameters.
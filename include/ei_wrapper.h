@@ -34,6 +34,42 @@ extern "C" {
 typedef void (*ei_wrapper_result_ready_cb)(int err);
 
 
+/** @brief Execution time statistics of a single operation.
+ *
+ * Times are expressed in milliseconds. If the operation is not performed by
+ * the impulse, all of the times are set to the value of -1.
+ */
+struct ei_wrapper_timing_stats {
+	/** Time of the last prediction. */
+	int last;
+
+	/** Average time of the recent predictions. */
+	int avg;
+
+	/** Maximum time of the recent predictions. */
+	int max;
+};
+
+
+/** @brief Prediction statistics. */
+struct ei_wrapper_stats {
+	/** Number of successful predictions. */
+	uint32_t prediction_cnt;
+
+	/** Number of windows skipped by continuous prediction. */
+	uint32_t dropped_cnt;
+
+	/** DSP time statistics. */
+	struct ei_wrapper_timing_stats dsp;
+
+	/** Classification time statistics. */
+	struct ei_wrapper_timing_stats classification;
+
+	/** Anomaly time statistics. */
+	struct ei_wrapper_timing_stats anomaly;
+};
+
+
 /** Check if classifier calculates anomaly value.
  *
  * @retval true If the classifier calculates the anomaly value.
@@ -61,6 +97,7 @@ size_t ei_wrapper_get_window_size(void);
 /** Add input data for the library.
  *
  * Size of the added data must be divisible by input frame size.
+ * Not available with @option{CONFIG_EI_WRAPPER_DATA_INT16}.
  *
  * @param[in] data       Pointer to the buffer with input data.
  * @param[in] data_size  Size of the data (number of floating-point values).
@@ -71,6 +108,40 @@ size_t ei_wrapper_get_window_size(void);
 int ei_wrapper_add_data(const float *data, size_t data_size);
 
 
+/** Add 16-bit integer input data for the library.
+ *
+ * Requires @option{CONFIG_EI_WRAPPER_DATA_INT16}. The data is stored in this
+ * form and converted to floating-point values only when the library reads it.
+ * The conversion multiplies the data by the scale set with
+ * @ref ei_wrapper_set_data_scale.
+ *
+ * Size of the added data must be divisible by input frame size.
+ *
+ * @param[in] data       Pointer to the buffer with input data.
+ * @param[in] data_size  Size of the data (number of integer values).
+ *
+ * @retval 0 If the operation was successful.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int ei_wrapper_add_data_int16(const int16_t *data, size_t data_size);
+
+
+/** Set the scale of 16-bit integer input data.
+ *
+ * Requires @option{CONFIG_EI_WRAPPER_DATA_INT16}. The default scale of
+ * 1/32768 interprets the input data as Q15 fixed-point values. Use the
+ * sensor resolution to provide the data in physical units instead.
+ *
+ * The scale cannot be changed while a prediction is running.
+ *
+ * @param[in] scale Value of one least significant bit of input data.
+ *
+ * @retval 0 If the operation was successful.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int ei_wrapper_set_data_scale(float scale);
+
+
 /** Clear all buffered data.
  *
  * @retval 0 If the operation was successful.
@@ -95,6 +166,45 @@ int ei_wrapper_clear_data(void);
 int ei_wrapper_start_prediction(size_t window_shift, size_t frame_shift);
 
 
+/** Start continuous prediction using the Edge Impulse library.
+ *
+ * The first prediction is done for the current input window, like for
+ * @ref ei_wrapper_start_prediction with no shift. After every result, the
+ * window is automatically shifted by the given number of frames and the next
+ * prediction is started as soon as the window is complete.
+ *
+ * If the predictions cannot keep up with the input data, the prediction skips
+ * to the newest complete window. The skipped windows are reported as dropped
+ * in the prediction statistics.
+ *
+ * With @option{CONFIG_EI_WRAPPER_CONTINUOUS_DSP}, the frame shift must be
+ * equal to the size of a window slice.
+ *
+ * @ref ei_wrapper_start_prediction cannot be used until the continuous
+ * prediction is stopped.
+ *
+ * @param[in] frame_shift Number of frames the input window is shifted between
+ *                        predictions. The shift cannot be bigger than the
+ *                        input window.
+ *
+ * @retval 0 If the operation was successful.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int ei_wrapper_start_continuous(size_t frame_shift);
+
+
+/** Stop continuous prediction.
+ *
+ * No new prediction is started after this call. A prediction that is already
+ * running still reports its result. A window that is waiting for input data is
+ * cancelled.
+ *
+ * @retval 0 If the operation was successful.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int ei_wrapper_stop_continuous(void);
+
+
 /** Get classification results.
  *
  * This function can be executed only from the wrapper's callback context.
@@ -142,6 +252,25 @@ int ei_wrapper_get_timing(int *dsp_time, int *classification_time,
 			  int *anomaly_time);
 
 
+/** Get prediction statistics.
+ *
+ * Unlike the results, the statistics can be read from any context. Timing
+ * statistics are calculated over the last
+ * @option{CONFIG_EI_WRAPPER_STATS_WINDOW} successful predictions.
+ *
+ * @param[out] stats Pointer to the structure that is used to store the
+ *                   statistics.
+ *
+ * @retval 0 If the operation was successful.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int ei_wrapper_get_stats(struct ei_wrapper_stats *stats);
+
+
+/** Reset prediction statistics. */
+void ei_wrapper_reset_stats(void);
+
+
 /** Initialize the Edge Impulse wrapper.
  *
  * @param[in] cb Callback used to receive results.
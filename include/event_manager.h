@@ -54,6 +54,27 @@ extern "C" {
 #define SUBS_PRIO_COUNT (SUBS_PRIO_MAX - SUBS_PRIO_MIN + 1)
 
 
+/** @brief Event delivery class.
+ *
+ * Events of every delivery class are processed from a separate queue by
+ * a separate thread. Events of the same delivery class are processed in
+ * the order in which they were submitted.
+ */
+enum event_delivery_class {
+	/** Latency-critical events, processed by the realtime thread. */
+	EVENT_DELIVERY_CLASS_REALTIME,
+
+	/** Events processed by the system workqueue (default). */
+	EVENT_DELIVERY_CLASS_NORMAL,
+
+	/** Events processed by the low priority background thread. */
+	EVENT_DELIVERY_CLASS_BACKGROUND,
+
+	/** Number of delivery classes. */
+	EVENT_DELIVERY_CLASS_COUNT
+};
+
+
 /** @brief Event header.
  *
  * When defining an event structure, the event header
@@ -65,6 +86,11 @@ struct event_header {
 
 	/** Pointer to the event type object. */
 	const struct event_type *type_id;
+
+#ifdef CONFIG_DESKTOP_EVENT_MANAGER_TRACE_DELIVERY_CLASSES
+	/** Cycle count at the moment of the event submission. */
+	uint32_t submit_cycles;
+#endif
 };
 
 
@@ -101,6 +127,9 @@ struct event_listener {
 struct event_subscriber {
 	/** Pointer to the listener. */
 	const struct event_listener *listener;
+
+	/** Subscriber priority level. */
+	uint8_t prio;
 };
 
 
@@ -122,18 +151,61 @@ struct event_info {
 };
 
 
+/** @brief Event pool.
+ *
+ * Memory slab from which events of a given type are allocated, along with
+ * the usage statistics. Event pools must be defined using
+ * @ref EVENT_POOL_DEFINE.
+ */
+struct event_pool {
+	/** Memory slab holding the events. */
+	struct k_mem_slab *slab;
+
+	/** Maximum number of events allocated at the same time. */
+	atomic_t max_used;
+
+	/** Number of allocations that failed because the pool was empty. */
+	atomic_t alloc_failures;
+};
+
+
+/** @brief Event coalescing.
+ *
+ * Describes how events of a given type are merged while they wait for
+ * processing. Event coalescing must be defined using
+ * @ref EVENT_COALESCE_DEFINE.
+ */
+struct event_coalesce {
+	/** Function merging a newly submitted event into the pending event.
+	 *  The function returns true if the event was merged or false if
+	 *  the event must be queued separately. The function is called with
+	 *  interrupts locked. */
+	bool (*merge)(struct event_header *pending,
+		      const struct event_header *eh);
+
+	/** Queued event that has not been processed yet or NULL. */
+	struct event_header *pending;
+
+	/** Number of events merged into pending events. */
+	atomic_t merged_cnt;
+
+	/** Number of events delivered to listeners. */
+	atomic_t delivered_cnt;
+};
+
+
 /** @brief Event type.
  */
 struct event_type {
 	/** Event name. */
 	const char			*name;
 
-	/** Array of pointers to the array of subscribers. */
-	const struct event_subscriber	*subs_start[SUBS_PRIO_COUNT];
+	/** Pointer to the array of subscribers ordered by priority. */
+	const struct event_subscriber	*subs_start;
 
-	/** Array of pointers to the element directly after the array of
+	/** Pointer to the element directly after the array of
 	 * subscribers. */
-	const struct event_subscriber	*subs_stop[SUBS_PRIO_COUNT];
+	const struct event_subscriber	*subs_stop;
 
 	/** Bool indicating if the event is logged by default. */
 	bool init_log_enable;
@@ -144,6 +216,23 @@ struct event_type {
 
 	/** Logging and formatting information. */
 	const struct event_info *ev_info;
+
+#ifdef CONFIG_DESKTOP_EVENT_MANAGER_EVENT_POOLS
+	/** Pool used to allocate events or NULL if events are allocated
+	 *  from the heap. */
+	struct event_pool *pool;
+#endif
+
+#ifdef CONFIG_DESKTOP_EVENT_MANAGER_DELIVERY_CLASSES
+	/** Delivery class of the event type or NULL if the event type uses
+	 *  the normal delivery class. */
+	const enum event_delivery_class *delivery_class;
+#endif
+
+#ifdef CONFIG_DESKTOP_EVENT_MANAGER_EVENT_COALESCING
+	/** Event coalescing or NULL if events of this type are not merged. */
+	struct event_coalesce *coalesce;
+#endif
 };
 
 
@@ -169,7 +258,7 @@ extern const struct event_type __stop_event_types[];
  * @param ename  Name of the event.
  */
 #define EVENT_SUBSCRIBE_EARLY(lname, ename) \
-	_EVENT_SUBSCRIBE(lname, ename, _SUBS_PRIO_ID(_SUBS_PRIO_FIRST))
+	_EVENT_SUBSCRIBE(lname, ename, _SUBS_PRIO_FIRST)
 
 
 /** Subscribe a listener to the normal notification list for an event
@@ -179,7 +268,7 @@ extern const struct event_type __stop_event_types[];
  * @param ename  Name of the event.
  */
 #define EVENT_SUBSCRIBE(lname, ename) \
-	_EVENT_SUBSCRIBE(lname, ename, _SUBS_PRIO_ID(_SUBS_PRIO_NORMAL))
+	_EVENT_SUBSCRIBE(lname, ename, _SUBS_PRIO_NORMAL)
 
 
 /** Subscribe a listener to an event type as final module that is
@@ -189,7 +278,7 @@ extern const struct event_type __stop_event_types[];
  * @param ename  Name of the event.
  */
 #define EVENT_SUBSCRIBE_FINAL(lname, ename)							\
-	_EVENT_SUBSCRIBE(lname, ename, _SUBS_PRIO_ID(_SUBS_PRIO_FINAL));			\
+	_EVENT_SUBSCRIBE(lname, ename, _SUBS_PRIO_FINAL);			\
 	const struct {} _CONCAT(_CONCAT(__event_subscriber_, ename), final_sub_redefined) = {}
 
 
@@ -261,6 +350,88 @@ extern const struct event_type __stop_event_types[];
 	_EVENT_TYPE_DEFINE(ename, init_log_en, log_fn, ev_info_struct)
 
 
+/** Define an event pool.
+ *
+ * This macro defines a memory slab holding a fixed number of events of
+ * the given type. If the pool is defined, events of this type are
+ * allocated from the pool instead of the heap. Allocation and release
+ * of an event then take constant time.
+ *
+ * If the pool is exhausted, new_<i>%event_type</i> returns NULL and the
+ * failed allocation is counted in the pool statistics. The caller must
+ * handle the NULL pointer.
+ *
+ * The macro must be placed in the source file that defines the event type
+ * with @ref EVENT_TYPE_DEFINE. Pools cannot be used for event types with
+ * dynamic data, this is checked at build time.
+ *
+ * @note Pools are used only if @option{CONFIG_DESKTOP_EVENT_MANAGER_EVENT_POOLS}
+ *       is enabled.
+ *
+ * @param ename  Name of the event.
+ * @param count  Number of events in the pool.
+ */
+#ifdef CONFIG_DESKTOP_EVENT_MANAGER_EVENT_POOLS
+#define EVENT_POOL_DEFINE(ename, count) _EVENT_POOL_DEFINE(ename, count)
+#else
+#define EVENT_POOL_DEFINE(ename, count)
+#endif
+
+
+/** Define a delivery class of an event type.
+ *
+ * By default, events are delivered using @ref EVENT_DELIVERY_CLASS_NORMAL.
+ * This macro assigns a different delivery class to the event type.
+ * Note that listeners of the event type are then notified from the
+ * thread that processes the given delivery class.
+ *
+ * The macro must be placed in the source file that defines the event type
+ * with @ref EVENT_TYPE_DEFINE.
+ *
+ * @note Delivery classes are used only if
+ *       @option{CONFIG_DESKTOP_EVENT_MANAGER_DELIVERY_CLASSES} is enabled.
+ *
+ * @param ename   Name of the event.
+ * @param dclass  Delivery class (see @ref event_delivery_class).
+ */
+#ifdef CONFIG_DESKTOP_EVENT_MANAGER_DELIVERY_CLASSES
+#define EVENT_DELIVERY_CLASS_DEFINE(ename, dclass) \
+	_EVENT_DELIVERY_CLASS_DEFINE(ename, dclass)
+#else
+#define EVENT_DELIVERY_CLASS_DEFINE(ename, dclass)
+#endif
+
+
+/** Define coalescing of an event type.
+ *
+ * If coalescing is defined for an event type, a newly submitted event is
+ * merged into the event of the same type that is already queued, but has
+ * not been processed yet. The merge function decides how the data of the
+ * events is combined (for example, motion deltas are summed). Merged event
+ * is released right after the merge. This bounds the queue growth when
+ * events are submitted faster than they are processed.
+ *
+ * The merge function is called with interrupts locked and it must be
+ * short. It returns true if the event was merged or false if the event
+ * must be queued separately.
+ *
+ * The macro must be placed in the source file that defines the event type
+ * with @ref EVENT_TYPE_DEFINE.
+ *
+ * @note Coalescing is used only if
+ *       @option{CONFIG_DESKTOP_EVENT_MANAGER_EVENT_COALESCING} is enabled.
+ *
+ * @param ename     Name of the event.
+ * @param merge_fn  Function merging the submitted event into pending event.
+ */
+#ifdef CONFIG_DESKTOP_EVENT_MANAGER_EVENT_COALESCING
+#define EVENT_COALESCE_DEFINE(ename, merge_fn) \
+	_EVENT_COALESCE_DEFINE(ename, merge_fn)
+#else
+#define EVENT_COALESCE_DEFINE(ename, merge_fn)
+#endif
+
+
 /** Verify if an event ID is valid.
  *
  * The pointer to an event type structure is used as its ID. This macro
@@ -273,6 +444,26 @@ extern const struct event_type __stop_event_types[];
 	__ASSERT_NO_MSG((id >= __start_event_types) && (id < __stop_event_types))
 
 
+/** Allocate memory for an event of the given type.
+ *
+ * The memory is taken from the event pool if the event type has one,
+ * otherwise from the heap.
+ *
+ * @param et    Event type.
+ * @param size  Size of the event.
+ *
+ * @return Pointer to the allocated memory or NULL if the allocation failed.
+ */
+void *_event_manager_alloc(const struct event_type *et, size_t size);
+
+
+/** Free memory of a processed event.
+ *
+ * @param eh  Pointer to the event header element in the event object.
+ */
+void _event_manager_free(struct event_header *eh);
+
+
 /** Submit an event to the Event Manager.
  *
  * @param eh  Pointer to the event header element in the event object.
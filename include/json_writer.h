@@ -0,0 +1,194 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef JSON_WRITER_H__
+#define JSON_WRITER_H__
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file json_writer.h
+ *
+ * @defgroup json_writer Streaming JSON writer
+ * @{
+ * @brief Library for writing compact JSON directly into a buffer.
+ *
+ * @details The writer does not build an object tree and does not allocate
+ *          memory. Values are written to the output buffer in the order in
+ *          which they are added. Writing past the end of the buffer is not
+ *          an error by itself: the writer keeps counting the bytes that
+ *          would have been written, which is used to get the required
+ *          buffer size before allocating it.
+ */
+
+/** @brief Streaming JSON writer instance. */
+struct json_writer {
+	/** Output buffer, or NULL to only compute the output length. */
+	char *buf;
+	/** Size of the output buffer. */
+	size_t size;
+	/** Length of the output, including the part that did not fit. */
+	size_t len;
+	/** Nesting level of the currently open containers. */
+	uint8_t depth;
+	/** Next value must be preceded by a separator. */
+	bool separate;
+};
+
+/**
+ * @brief Initialize a JSON writer.
+ *
+ * @param writer Writer instance.
+ * @param buf Output buffer. If NULL, the writer only computes the length of
+ *            the output.
+ * @param size Size of the output buffer.
+ */
+void json_writer_init(struct json_writer *writer, char *buf, size_t size);
+
+/**
+ * @brief Start a JSON object.
+ *
+ * @param writer Writer instance.
+ */
+void json_writer_obj_start(struct json_writer *writer);
+
+/**
+ * @brief End the JSON object that was started last.
+ *
+ * @param writer Writer instance.
+ */
+void json_writer_obj_end(struct json_writer *writer);
+
+/**
+ * @brief Start a JSON array.
+ *
+ * @param writer Writer instance.
+ */
+void json_writer_arr_start(struct json_writer *writer);
+
+/**
+ * @brief End the JSON array that was started last.
+ *
+ * @param writer Writer instance.
+ */
+void json_writer_arr_end(struct json_writer *writer);
+
+/**
+ * @brief Write the key of an object member.
+ *
+ * The key must be followed by a value or by the start of a container.
+ *
+ * @param writer Writer instance.
+ * @param key Null-terminated key. Escaped as a JSON string.
+ */
+void json_writer_key(struct json_writer *writer, const char *key);
+
+/**
+ * @brief Write a string value.
+ *
+ * @param writer Writer instance.
+ * @param str Null-terminated string. Written as an empty string if NULL.
+ */
+void json_writer_str(struct json_writer *writer, const char *str);
+
+/**
+ * @brief Write a number value.
+ *
+ * The number is formatted in the same way as cJSON formats it. NaN and
+ * infinity are written as null.
+ *
+ * @param writer Writer instance.
+ * @param value Number.
+ */
+void json_writer_number(struct json_writer *writer, double value);
+
+/**
+ * @brief Write an integer value.
+ *
+ * @param writer Writer instance.
+ * @param value Integer.
+ */
+void json_writer_int(struct json_writer *writer, int64_t value);
+
+/**
+ * @brief Write a boolean value.
+ *
+ * @param writer Writer instance.
+ * @param value Boolean.
+ */
+void json_writer_bool(struct json_writer *writer, bool value);
+
+/**
+ * @brief Write a null value.
+ *
+ * @param writer Writer instance.
+ */
+void json_writer_null(struct json_writer *writer);
+
+/**
+ * @brief Terminate the output with a null character.
+ *
+ * @param writer Writer instance.
+ *
+ * @retval 0 If the output, including the null character, fits in the buffer.
+ * @retval -ENOMEM If the buffer is too small or was not provided.
+ */
+int json_writer_finish(struct json_writer *writer);
+
+/**
+ * @brief Get the length of the output.
+ *
+ * The length does not include the terminating null character. It is valid
+ * also if the output did not fit in the buffer.
+ *
+ * @param writer Writer instance.
+ *
+ * @return Length of the output.
+ */
+static inline size_t json_writer_len(const struct json_writer *writer)
+{
+	return writer->len;
+}
+
+/** @brief Write an object member with a string value. */
+static inline void json_writer_key_str(struct json_writer *writer,
+				       const char *key, const char *str)
+{
+	json_writer_key(writer, key);
+	json_writer_str(writer, str);
+}
+
+/** @brief Write an object member with a number value. */
+static inline void json_writer_key_number(struct json_writer *writer,
+					  const char *key, double value)
+{
+	json_writer_key(writer, key);
+	json_writer_number(writer, value);
+}
+
+/** @brief Write an object member with an integer value. */
+static inline void json_writer_key_int(struct json_writer *writer,
+				       const char *key, int64_t value)
+{
+	json_writer_key(writer, key);
+	json_writer_int(writer, value);
+}
+
+/**
+ * @}
+ */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* JSON_WRITER_H__ */
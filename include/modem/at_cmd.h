@@ -23,6 +23,7 @@ extern "C" {
 
 #include <zephyr/types.h>
 #include <stddef.h>
+#include <stdbool.h>
 
 /**
  * @brief AT command return codes
@@ -54,6 +55,57 @@ enum at_cmd_state {
  */
 typedef void (*at_cmd_handler_t)(const char *response);
 
+/**
+ * @typedef at_cmd_stream_handler_t
+ *
+ * Handler receiving the response to an AT command sent with
+ * at_cmd_write_stream() in chunks. Every chunk holds one line of the
+ * response, including the line terminator. The chunk points into the
+ * receive buffer of the driver and it is not null terminated.
+ *
+ * @param chunk  Pointer to the chunk of the response.
+ * @param len    Length of the chunk.
+ */
+typedef void (*at_cmd_stream_handler_t)(const char *chunk, size_t len);
+
+/**
+ * @brief AT command in a batch sent with at_cmd_write_batch().
+ */
+struct at_cmd_batch_item {
+	/** Null terminated AT command string. */
+	const char *cmd;
+	/** Buffer for the response. NULL pointer is allowed. */
+	char *buf;
+	/** Length of the response buffer. */
+	size_t buf_len;
+	/** Return code of the command, set by at_cmd_write_batch(). */
+	int code;
+	/** State of the command, set by at_cmd_write_batch(). */
+	enum at_cmd_state state;
+	/** Time from writing the command to receiving its response, in
+	 *  microseconds.
+	 */
+	uint32_t rtt_us;
+};
+
+/**
+ * @brief Timing of a batch sent with at_cmd_write_batch().
+ */
+struct at_cmd_batch_stats {
+	/** Time the batch waited for previously queued commands, in
+	 *  microseconds.
+	 */
+	uint32_t queue_us;
+	/** Time from writing the first command to receiving the response to
+	 *  the last one, in microseconds.
+	 */
+	uint32_t exec_us;
+	/** Longest round trip of a single command, in microseconds. */
+	uint32_t max_rtt_us;
+	/** Number of commands that were executed. */
+	size_t exec_cnt;
+};
+
 /**@brief Initialize or recover the AT command driver.
  *
  * @return Zero on success, non-zero otherwise.
@@ -119,6 +171,11 @@ int at_cmd_write_with_callback(const char *const cmd,
  *           positive values, the state parameter will indicate if it's a CME
  *           or CMS error. ERROR will return ENOEXEC (positve).
  *
+ * @note If @option{CONFIG_AT_CMD_ZERO_COPY_RESPONSE} is enabled and
+ *       @p buf_len is at least AT_CMD_RESPONSE_MAX_LEN, the response is
+ *       received directly into @p buf. Such a response is not copied and
+ *       it is limited only by @p buf_len.
+ *
  * @retval -ENOBUFS is returned if AT_CMD_RESPONSE_MAX_LEN is not large enough
  *         to hold the data returned from the modem.
  * @retval -ENOEXEC is returned if the modem returned ERROR.
@@ -132,6 +189,68 @@ int at_cmd_write(const char *const cmd,
 		 size_t buf_len,
 		 enum at_cmd_state *state);
 
+/**
+ * @brief Function to send an AT command and receive the response in chunks.
+ *
+ * This function should be used for commands with large responses, for
+ * example listing of the stored credentials, that the caller processes line
+ * by line. The response is not copied to a user supplied buffer. Instead,
+ * the handler is called for every line of the response before the function
+ * returns.
+ *
+ * @param cmd     Pointer to null terminated AT command string.
+ * @param handler Pointer to handler that will process the response chunks.
+ * @param state   Pointer to enum @em at_cmd_state variable that can hold
+ *                the error state returned by the modem. NULL pointer is
+ *                allowed.
+ *
+ * @note The handler function runs from at_cmd's thread. It must not call
+ *       at_cmd_write, as that would lead to a deadlock.
+ *
+ * @note The response is received into the internal buffer of the driver
+ *       before it is delivered, so it is limited by AT_CMD_RESPONSE_MAX_LEN.
+ *
+ * @retval 0 If command execution was successful (same as OK returned from
+ *           modem). Error codes are returned in the same way as for
+ *           at_cmd_write().
+ * @retval -EINVAL is returned if the command or the handler is invalid.
+ * @retval -EHOSTDOWN is returned if the Modem library is shutdown.
+ */
+int at_cmd_write_stream(const char *const cmd,
+			at_cmd_stream_handler_t handler,
+			enum at_cmd_state *state);
+
+/**
+ * @brief Function to send an ordered list of AT commands.
+ *
+ * The commands are queued as a single request. The AT command interface
+ * thread writes every command as soon as the response to the previous one is
+ * received, without waking up the caller in between. The function returns
+ * once all the commands are completed. Commands from other threads are not
+ * interleaved with the commands of the batch.
+ *
+ * The result of every command is stored in its item. Commands that were not
+ * executed because of an earlier error have the state set to
+ * AT_CMD_ERROR_QUEUE and the return code set to -ECANCELED.
+ *
+ * @param items         Array of commands. The array must remain valid until
+ *                      the function returns.
+ * @param count         Number of commands in the array.
+ * @param stop_on_error If true, the commands that follow a failed command
+ *                      are not executed.
+ * @param stats         Pointer to the structure to store the timing of the
+ *                      batch in. NULL pointer is allowed.
+ *
+ * @retval 0 If all the commands were executed successfully. Otherwise, the
+ *           return code of the first failed command is returned.
+ * @retval -EINVAL is returned if any of the commands is invalid.
+ * @retval -EMSGSIZE is returned if a response does not fit into the buffer
+ *                   of its command.
+ * @retval -EHOSTDOWN is returned if the Modem library is shutdown.
+ */
+int at_cmd_write_batch(struct at_cmd_batch_item *items, size_t count,
+		       bool stop_on_error, struct at_cmd_batch_stats *stats);
+
 /**
  * @brief Function to set AT command global notification handler
  *
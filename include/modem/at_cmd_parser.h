@@ -15,6 +15,7 @@
 #define AT_CMD_PARSER_H__
 
 #include <stdlib.h>
+#include <stdbool.h>
 #include <zephyr/types.h>
 
 #include <modem/at_params.h>
@@ -106,6 +107,95 @@ int at_parser_max_params_from_str(const char *at_params_str,
 int at_parser_params_from_str(const char *at_params_str, char **next_param_str,
 			      struct at_param_list *const list);
 
+/**
+ * @brief AT parser context.
+ *
+ * Holds the state of the parsing of a single AT command, response or
+ * notification that is fed to the parser incrementally. The members are
+ * internal to the parser and must not be accessed directly.
+ */
+struct at_parser {
+	/** List the parameters are stored in. */
+	struct at_param_list *list;
+	/** Maximum number of parameters to parse. */
+	size_t max_params;
+	/** Buffer holding the data fed so far. */
+	char *buf;
+	/** Size of the buffer. */
+	size_t buf_size;
+	/** Length of the data fed so far. */
+	size_t len;
+	/** Next character to parse. */
+	const char *str;
+	/** Index of the next parameter. */
+	size_t index;
+	/** State of the parser. */
+	uint8_t state;
+	/** All the remaining parameters are strings. */
+	bool set_type_string;
+	/** More parameters were found than can be stored. */
+	bool oversized;
+};
+
+/**
+ * @brief Initialize a parser context for incremental parsing.
+ *
+ * The list is cleared. The data fed to the parser is stored in @p buf, so
+ * string parameters of a list created with at_params_list_init_arena()
+ * refer to @p buf.
+ *
+ * @param parser   Parser context to initialize.
+ * @param list     Pointer to an initialized list where parameters are
+ *                 stored.
+ * @param buf      Buffer for the data fed to the parser.
+ * @param buf_size Size of the buffer. It must be large enough to hold the
+ *                 whole string and the null terminator.
+ *
+ * @retval 0 If the operation was successful.
+ * @retval -EINVAL One or more of the supplied parameters are invalid.
+ */
+int at_parser_init(struct at_parser *parser, struct at_param_list *list,
+		   char *buf, size_t buf_size);
+
+/**
+ * @brief Feed a part of an AT string to the parser.
+ *
+ * The parameters that are complete in the data fed so far are parsed and
+ * stored in the list right away. A parameter is complete when the character
+ * following it has been received.
+ *
+ * @param parser Parser context.
+ * @param data   Part of the AT string. It does not have to be
+ *               null-terminated.
+ * @param len    Length of the data.
+ *
+ * @retval -EINPROGRESS More data is needed to continue parsing.
+ * @retval -ENOMEM The data does not fit in the parser buffer.
+ * @retval -EINVAL One or more of the supplied parameters are invalid.
+ * @return Any other value is returned in the same way as for
+ *         at_parser_finish() if the parsing has completed.
+ */
+int at_parser_feed(struct at_parser *parser, const char *data, size_t len);
+
+/**
+ * @brief Finish parsing the AT string fed to the parser.
+ *
+ * The end of the data is treated as the end of the string.
+ *
+ * @param parser         Parser context.
+ * @param next_param_str Pointer to the remainder of the string in the parser
+ *                       buffer if the string contains multiple
+ *                       notifications. Can be NULL.
+ *
+ * @retval 0 If the operation was successful.
+ * @retval -EAGAIN New notification detected in string re-run the parser
+ *                 with the string pointed to by @p next_param_str.
+ * @retval -E2BIG  The at_param_list supplied cannot hold all detected
+ *                 parameters in string.
+ * @retval -EINVAL One or more of the supplied parameters are invalid.
+ */
+int at_parser_finish(struct at_parser *parser, char **next_param_str);
+
 enum at_cmd_type {
 	/** Unknown command, indicates that the actual command type could not
 	 *  be resolved.
@@ -63,9 +63,39 @@ int at_notif_init(void);
  */
 int at_notif_register_handler(void *context, at_notif_handler_t handler);
 
+/**
+ * @brief Function to register AT command notification handler for
+ *        notifications with the given prefix
+ *
+ * The handler is only called for notifications whose name, the part of the
+ * notification before the colon, equals @p prefix. Handlers are looked up
+ * in an index sorted by prefix, so handlers for other notifications are not
+ * called.
+ *
+ * @note  If the same combination of context, handler and prefix exists in
+ *        the memory, then the request will be ignored and command execution
+ *        will be regarded as finished successfully.
+ *
+ * @param context Pointer to context provided by the module which has
+ *                registered the handler.
+ * @param prefix  Notification name including the leading + or %
+ *                character, for example "+CEREG". The string is copied.
+ * @param handler Pointer to a received notification handler function of type
+ *                @ref at_notif_handler_t.
+ *
+ * @retval 0            If command execution was successful.
+ * @retval -ENOBUFS     If memory cannot be allocated.
+ * @retval -EINVAL      If handler is a NULL pointer or the prefix is invalid.
+ */
+int at_notif_register_prefix_handler(void *context, const char *prefix,
+				     at_notif_handler_t handler);
+
 /**
  * @brief Function to de-register AT command notification handler
  *
+ * All registrations of the handler with the given context are removed,
+ * including the registrations with a prefix.
+ *
  * @param context Pointer to context provided by the module which has
  *                registered the handler.
  * @param handler Pointer to a received notification handler function of type
@@ -78,6 +108,23 @@ int at_notif_register_handler(void *context, at_notif_handler_t handler);
  */
 int at_notif_deregister_handler(void *context, at_notif_handler_t handler);
 
+/**
+ * @brief Function to get the number of notifications dispatched for a prefix
+ *
+ * The count is the sum of the calls of all handlers registered with the
+ * prefix.
+ *
+ * @param prefix Notification name the handlers were registered with. An
+ *               empty string selects the handlers registered without a
+ *               prefix.
+ * @param hits   Pointer to the number of handler calls.
+ *
+ * @retval 0            If command execution was successful.
+ * @retval -ENXIO       If no handler is registered with the prefix.
+ * @retval -EINVAL      If a parameter is a NULL pointer.
+ */
+int at_notif_prefix_hits_get(const char *prefix, uint32_t *hits);
+
 /** @} */
 
 #ifdef __cplusplus
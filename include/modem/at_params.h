@@ -22,6 +22,11 @@
  * All parameters values are copied in the list. Parameters should be
  * cleared to free that memory. Getter and setter methods are available
  * to read and write parameter values.
+ *
+ * A list can also be created over a memory arena provided by the caller.
+ * Such a list does not use the heap. String values are not copied, they
+ * refer to the string they were parsed from, and array values are stored
+ * in the arena.
  */
 #ifndef AT_PARAMS_H__
 #define AT_PARAMS_H__
@@ -74,8 +79,41 @@ struct at_param {
 struct at_param_list {
 	size_t param_count;
 	struct at_param *params;
+	/** Memory for the array values of a list created with
+	 *  at_params_list_init_arena(). NULL for lists using the heap.
+	 */
+	uint8_t *arena;
+	size_t arena_size;
+	size_t arena_used;
 };
 
+/**
+ * @brief Alignment of an arena for a list of parameters.
+ */
+#define AT_PARAMS_ARENA_ALIGN __alignof__(struct at_param)
+
+/**
+ * @brief Size of an arena for a list of parameters.
+ *
+ * @param max_params_count Maximum number of element that the list can store.
+ * @param values_size      Total size of the array values in bytes. The size
+ *                         of every value is rounded up to a multiple of
+ *                         @ref AT_PARAMS_ARENA_ALIGN.
+ */
+#define AT_PARAMS_ARENA_SIZE(max_params_count, values_size) \
+	((max_params_count) * sizeof(struct at_param) + (values_size))
+
+/**
+ * @brief Define an arena for a list of parameters.
+ *
+ * @param name             Name of the arena.
+ * @param max_params_count Maximum number of element that the list can store.
+ * @param values_size      Total size of the array values in bytes.
+ */
+#define AT_PARAMS_ARENA_DEFINE(name, max_params_count, values_size)	\
+	uint8_t name[AT_PARAMS_ARENA_SIZE(max_params_count, values_size)] \
+		__aligned(AT_PARAMS_ARENA_ALIGN)
+
 /**
  * @brief Create a list of parameters.
  *
@@ -92,6 +130,32 @@ struct at_param_list {
  */
 int at_params_list_init(struct at_param_list *list, size_t max_params_count);
 
+/**
+ * @brief Create a list of parameters over a memory arena.
+ *
+ * The parameters and the array values are stored in the arena, so the list
+ * does not use the heap. String values are not copied. They refer to the
+ * string passed to at_params_string_put(), which must remain valid as long
+ * as the value is used. The string getters copy the value on request.
+ *
+ * The space taken by array values is reclaimed when the list is cleared.
+ *
+ * @param[in] list Parameter list to initialize.
+ * @param[in] max_params_count Maximum number of element that the list can
+ * store.
+ * @param[in] arena      Memory for the list, aligned to
+ *                       @ref AT_PARAMS_ARENA_ALIGN. Use
+ *                       @ref AT_PARAMS_ARENA_DEFINE to define it.
+ * @param[in] arena_size Size of the arena in bytes. Use
+ *                       @ref AT_PARAMS_ARENA_SIZE to compute it.
+ *
+ * @retval 0 If the operation was successful.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int at_params_list_init_arena(struct at_param_list *list,
+			      size_t max_params_count,
+			      void *arena, size_t arena_size);
+
 /**
  * @brief Clear/reset all parameter types and values.
  *
@@ -148,6 +212,8 @@ int at_params_int_put(const struct at_param_list *list, size_t index,
  *
  * The parameter string value is copied and added to the list as a
  * null-terminated string. If a parameter exists at this index, it is replaced.
+ * In a list created with at_params_list_init_arena(), the value is not
+ * copied and it refers to @p str.
  *
  * @param[in] list    Parameter list.
  * @param[in] index   Index in the list where to put the parameter.
@@ -264,6 +330,23 @@ int at_params_int_get(const struct at_param_list *list, size_t index,
 int at_params_string_get(const struct at_param_list *list, size_t index,
 			 char *value, size_t *len);
 
+/**
+ * @brief Get a pointer to a string parameter value.
+ *
+ * The parameter type must be a string, or an error is returned.
+ * The value is not copied. The returned string is not null-terminated.
+ *
+ * @param[in]  list    Parameter list.
+ * @param[in]  index   Parameter index in the list.
+ * @param[out] str     Pointer to the string value.
+ * @param[out] len     Length of the string value in bytes.
+ *
+ * @retval 0 If the operation was successful.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int at_params_string_ptr_get(const struct at_param_list *list, size_t index,
+			     const char **str, size_t *len);
+
 /**
  * @brief Get a parameter value as a array.
  *
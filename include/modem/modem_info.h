@@ -120,6 +120,30 @@ struct modem_param_info {
 	struct device_param  device;/**< Device parameters. */
 };
 
+/**@brief Statistics of the modem parameter cache. */
+struct modem_info_cache_stats {
+	/** Number of calls to modem_info_params_get(). */
+	uint32_t read_cnt;
+	/** Number of times all parameters were read from the modem. */
+	uint32_t full_refresh_cnt;
+	/** Number of times the network parameters were read from the modem
+	 *  after a notification.
+	 */
+	uint32_t network_refresh_cnt;
+	/** Number of +CEREG notifications that invalidated the network
+	 *  parameters.
+	 */
+	uint32_t notif_cnt;
+	/** Number of AT commands sent by the cache. */
+	uint32_t at_cmd_cnt;
+	/** Duration of the last call to modem_info_params_get(), in
+	 *  microseconds.
+	 */
+	uint32_t last_read_us;
+	/** Longest call to modem_info_params_get(), in microseconds. */
+	uint32_t max_read_us;
+};
+
 /** @brief Initialize the modem information module.
  *
  * @retval 0 If the operation was successful.
@@ -237,6 +261,25 @@ int modem_info_json_object_encode(struct modem_param_info *modem,
  */
 int modem_info_params_get(struct modem_param_info *modem_param);
 
+#ifdef CONFIG_MODEM_INFO_CACHE
+/** @brief Invalidate the cached modem parameters.
+ *
+ * All parameters are read from the modem on the next call to
+ * @ref modem_info_params_get. Call this function after changing the modem
+ * configuration, for example the system mode.
+ */
+void modem_info_cache_invalidate(void);
+
+/** @brief Get the statistics of the modem parameter cache.
+ *
+ * @param stats Pointer to the structure where the statistics are stored.
+ *
+ * @retval 0 If the operation was successful.
+ *           Otherwise, a (negative) error code is returned.
+ */
+int modem_info_cache_stats_get(struct modem_info_cache_stats *stats);
+#endif
+
 /** @} */
 
 #ifdef __cplusplus
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef NRF91_POLL_SET_H_
+#define NRF91_POLL_SET_H_
+
+/**
+ * @file nrf91_poll_set.h
+ *
+ * @defgroup nrf91_poll_set nRF91 socket poll sets
+ * @{
+ * @brief Wait for events on a persistent set of offloaded nRF91 sockets.
+ *
+ * Unlike poll(), which translates and checks all sockets on every call, the
+ * sockets of a poll set are registered once. The readiness of all registered
+ * sockets is updated once per Modem library event, and a thread waiting on a
+ * poll set is woken up only when a socket of that set becomes ready.
+ */
+
+#include <zephyr.h>
+#include <net/socket.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Poll set. The members are private. */
+struct nrf91_poll_set {
+	struct k_sem sem;
+	bool wake;
+};
+
+/** @brief Poll set statistics, shared by all poll sets. */
+struct nrf91_poll_set_stats {
+	/** Number of readiness checks of the registered sockets. */
+	uint32_t scan_cnt;
+	/** Number of readiness changes of the registered sockets. */
+	uint32_t change_cnt;
+	/** Number of times a waiting thread was woken up. */
+	uint32_t wakeup_cnt;
+	/** Number of calls to @ref nrf91_poll_set_wait. */
+	uint32_t wait_cnt;
+};
+
+/** @brief Initialize a poll set.
+ *
+ * @param set Poll set.
+ */
+void nrf91_poll_set_init(struct nrf91_poll_set *set);
+
+/** @brief Add a socket to a poll set.
+ *
+ * A socket can belong to one poll set at a time. It is removed from the
+ * poll set when it is closed.
+ *
+ * @param set    Poll set.
+ * @param fd     Socket.
+ * @param events Requested events, POLLIN and POLLOUT. POLLERR, POLLHUP and
+ *               POLLNVAL are always reported.
+ *
+ * @retval 0 If the operation was successful.
+ * @retval -EBADF If the socket is not an offloaded nRF91 socket.
+ * @retval -EEXIST If the socket already belongs to a poll set.
+ */
+int nrf91_poll_set_add(struct nrf91_poll_set *set, int fd, short events);
+
+/** @brief Remove a socket from a poll set.
+ *
+ * @param set Poll set.
+ * @param fd  Socket.
+ *
+ * @retval 0 If the operation was successful.
+ * @retval -EBADF If the socket is not an offloaded nRF91 socket.
+ * @retval -ENOENT If the socket does not belong to the poll set.
+ */
+int nrf91_poll_set_remove(struct nrf91_poll_set *set, int fd);
+
+/** @brief Wait until sockets of a poll set are ready.
+ *
+ * The function returns immediately if a socket is ready. The readiness is
+ * level-triggered: a socket is reported until the data is received or until
+ * sending is no longer possible.
+ *
+ * @param set     Poll set.
+ * @param fds     Array filled with the ready sockets and their events.
+ * @param nfds    Number of elements in @p fds.
+ * @param timeout Timeout in milliseconds, or SYS_FOREVER_MS to wait forever.
+ *
+ * @return Number of ready sockets, or 0 if the timeout expired.
+ */
+int nrf91_poll_set_wait(struct nrf91_poll_set *set, struct zsock_pollfd *fds,
+			int nfds, int32_t timeout);
+
+/** @brief Get the poll set statistics.
+ *
+ * @param stats Statistics.
+ */
+void nrf91_poll_set_stats_get(struct nrf91_poll_set_stats *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+/** @} */
+
+#endif /* NRF91_POLL_SET_H_ */
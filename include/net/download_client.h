@@ -100,6 +100,10 @@ struct download_client_cfg {
 	 *  values shall be used.
 	 */
 	size_t frag_size_override;
+	/** Maximum number of HTTP range requests in flight.
+	 *  0 indicates that the Kconfigured value shall be used.
+	 */
+	uint8_t pipeline_depth;
 	/** Set hostname for TLS Server Name Indication extension */
 	bool set_tls_hostname;
 };
@@ -153,6 +157,16 @@ struct download_client {
 		bool has_header;
 		/** The server has closed the connection. */
 		bool connection_close;
+		/** Offset of the next fragment to request. */
+		size_t next_req;
+		/** Number of requests sent and not yet fully answered. */
+		size_t pending;
+		/** Payload bytes left in the current response. */
+		size_t remaining;
+		/** Bytes of the next response read along with
+		 * the current one, located after it in the buffer.
+		 */
+		size_t carry;
 	} http;
 
 	struct {
@@ -160,6 +174,15 @@ struct download_client {
 		struct coap_block_context block_ctx;
 	} coap;
 
+	struct {
+		/** Download start time, in milliseconds. */
+		int64_t start;
+		/** Offset the download was started from. */
+		size_t from;
+		/** Average throughput, in bytes per second. */
+		uint32_t throughput;
+	} stats;
+
 	/** Internal thread ID. */
 	k_tid_t tid;
 	/** Internal download thread. */
@@ -242,6 +265,20 @@ void download_client_resume(struct download_client *client);
  */
 int download_client_file_size_get(struct download_client *client, size_t *size);
 
+/**
+ * @brief Retrieve the average throughput of the download, in bytes per second.
+ *
+ * The throughput is updated as fragments are received, and it is kept
+ * after the download has completed, until the next download is started.
+ *
+ * @param[in]  client		Client instance.
+ * @param[out] throughput	Average throughput, in bytes per second.
+ *
+ * @retval int Zero on success, otherwise a negative error code.
+ */
+int download_client_throughput_get(struct download_client *client,
+				   uint32_t *throughput);
+
 /**
  * @brief Disconnect from the server.
  *
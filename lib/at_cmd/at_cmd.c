@@ -27,13 +27,32 @@ LOG_MODULE_REGISTER(at_cmd, CONFIG_AT_CMD_LOG_LEVEL);
 enum at_cmd_flags {
 	AT_CMD_BUF_CMD = 1 << 0,	/* Command is buffered by at_cmd */
 	AT_CMD_SYNC = 1 << 1,		/* Command is synchronous */
+	AT_CMD_STREAM = 1 << 2,		/* Response is streamed in chunks */
+	AT_CMD_BATCH = 1 << 3,		/* Command is part of a batch */
+};
+
+/* Metadata for a batch of AT commands */
+struct cmd_batch {
+	struct at_cmd_batch_item *items;	/* Commands of the batch */
+	size_t count;			/* Number of commands */
+	size_t idx;			/* Index of the current command */
+	bool stop_on_error;		/* Skip commands after a failure */
+	uint32_t submit_cycles;		/* Time the batch was queued */
+	uint32_t start_cycles;		/* Time the first command was written */
+	uint32_t write_cycles;		/* Time the current command was written */
+	struct at_cmd_batch_stats stats; /* Timing of the batch */
+	struct k_sem done;		/* Given when the batch completes */
 };
 
 /* Metadata for a queued AT command */
 struct cmd_item  {
 	char *cmd;			/* Pointer to 0-terminated command */
 	char *resp;			/* Pointer to response buffer */
-	at_cmd_handler_t callback;	/* Callback to execute on result */
+	union {
+		at_cmd_handler_t callback;	/* Callback to execute on result */
+		at_cmd_stream_handler_t stream;	/* Callback for response chunks */
+		struct cmd_batch *batch;	/* Batch the command belongs to */
+	};
 	size_t resp_size;		/* Size of response buffer */
 	enum at_cmd_flags flags;	/* Flags describing the request */
 };
@@ -171,6 +190,135 @@ static inline int at_write(const char *const cmd)
 	return 0;
 }
 
+/* Deliver the response line by line. The chunks point into the receive
+ * buffer, so the response is not copied.
+ */
+static void stream_response(at_cmd_stream_handler_t handler,
+			    const char *buf, size_t len)
+{
+	const char *end = buf + len;
+
+	while (buf < end && *buf != '\0') {
+		const char *eol = memchr(buf, '\n', end - buf);
+		size_t chunk_len = eol ? (eol - buf + 1) : strnlen(buf, end - buf);
+
+		handler(buf, chunk_len);
+		buf += chunk_len;
+	}
+}
+
+/* Select the buffer to receive the next message into. The caller's response
+ * buffer is used directly if it can hold any message that would fit into the
+ * internal buffer, so that the response does not have to be copied.
+ */
+static char *recv_buf_get(char *buf, size_t *buf_len)
+{
+	if (!IS_ENABLED(CONFIG_AT_CMD_ZERO_COPY_RESPONSE)) {
+		return buf;
+	}
+
+	k_mutex_lock(&current_cmd_mutex, K_FOREVER);
+	if (current_cmd.cmd != NULL &&
+	    current_cmd.resp != NULL &&
+	    current_cmd.resp_size >= *buf_len) {
+		buf = current_cmd.resp;
+		*buf_len = current_cmd.resp_size;
+	}
+	k_mutex_unlock(&current_cmd_mutex);
+
+	return buf;
+}
+
+/* Wait until there is data to read on the socket. The receive buffer is
+ * selected once the data is available, that is after the command the data
+ * responds to has been written.
+ */
+static int wait_for_data(void)
+{
+	struct pollfd fds = {
+		.fd = common_socket_fd,
+		.events = POLLIN,
+	};
+
+	if (!IS_ENABLED(CONFIG_AT_CMD_ZERO_COPY_RESPONSE)) {
+		return 0;
+	}
+
+	if (poll(&fds, 1, -1) < 0) {
+		return -errno;
+	}
+
+	return 0;
+}
+
+/* Called when the first command of a batch is written */
+static void batch_start(struct cmd_batch *batch)
+{
+	batch->start_cycles = k_cycle_get_32();
+	batch->write_cycles = batch->start_cycles;
+	batch->stats.queue_us = k_cyc_to_us_floor32(batch->start_cycles -
+						    batch->submit_cycles);
+}
+
+/*
+ * Store the result of the current command of a batch and write the next
+ * command right away. Commands that fail to be written are completed with
+ * an error. Returns true if a command of the batch is pending a response,
+ * or false if the batch has completed.
+ */
+static bool batch_write_next(struct resp_item *resp)
+{
+	struct cmd_batch *batch = current_cmd.batch;
+	struct at_cmd_batch_item *item;
+	uint32_t now;
+	bool pending = false;
+
+	k_mutex_lock(&current_cmd_mutex, K_FOREVER);
+	do {
+		now = k_cycle_get_32();
+		item = &batch->items[batch->idx];
+		item->code = resp->code;
+		item->state = resp->state;
+		item->rtt_us = k_cyc_to_us_floor32(now - batch->write_cycles);
+
+		batch->stats.exec_cnt++;
+		batch->stats.max_rtt_us = MAX(batch->stats.max_rtt_us,
+					      item->rtt_us);
+
+		/* A response that does not fit into the buffer of the item
+		 * is completed with an error code, but in the OK state.
+		 */
+		if (((resp->state != AT_CMD_OK) || (resp->code != 0)) &&
+		    batch->stop_on_error) {
+			break;
+		}
+
+		batch->idx++;
+		if (batch->idx == batch->count) {
+			break;
+		}
+
+		item = &batch->items[batch->idx];
+		current_cmd.cmd = (char *)item->cmd;
+		current_cmd.resp = item->buf;
+		current_cmd.resp_size = item->buf_len;
+
+		batch->write_cycles = k_cycle_get_32();
+		resp->code = at_write(item->cmd);
+		resp->state = AT_CMD_ERROR_WRITE;
+		pending = (resp->code == 0);
+	} while (!pending);
+
+	if (!pending) {
+		batch->stats.exec_us = k_cyc_to_us_floor32(now -
+							   batch->start_cycles);
+		k_sem_give(&batch->done);
+	}
+	k_mutex_unlock(&current_cmd_mutex);
+
+	return pending;
+}
+
 /* Clear the current command safely */
 static void complete_cmd(void)
 {
@@ -200,6 +348,10 @@ static void load_cmd_and_write(void)
 			break;
 		}
 
+		if (current_cmd.flags & AT_CMD_BATCH) {
+			batch_start(current_cmd.batch);
+		}
+
 		ret = at_write(current_cmd.cmd);
 
 		if (current_cmd.flags & AT_CMD_BUF_CMD) {
@@ -212,6 +364,10 @@ static void load_cmd_and_write(void)
 			resp.code = ret;
 			if (current_cmd.flags & AT_CMD_SYNC) {
 				k_msgq_put(&response_sync, &resp, K_FOREVER);
+			} else if ((current_cmd.flags & AT_CMD_BATCH) &&
+				   batch_write_next(&resp)) {
+				/* Another command of the batch was written */
+				break;
 			}
 			complete_cmd();
 		}
@@ -219,12 +375,46 @@ static void load_cmd_and_write(void)
 	k_mutex_unlock(&current_cmd_mutex);
 }
 
+/*
+ * Write the command from the caller's context if no other command is loaded
+ * or queued. Command string is not accessed after it is written, so it does
+ * not have to outlive this call. Returns true if the command was handled.
+ */
+static bool write_if_idle(const char *cmd, struct cmd_item *command, int *ret)
+{
+	bool idle;
+
+	k_mutex_lock(&current_cmd_mutex, K_FOREVER);
+
+	idle = (current_cmd.cmd == NULL) &&
+	       (k_msgq_num_used_get(&commands) == 0);
+
+	if (idle) {
+		/* This cast is safe; we do not free cmd without
+		 * AT_CMD_BUF_CMD.
+		 */
+		command->cmd = (char *)cmd;
+		current_cmd = *command;
+
+		*ret = at_write(cmd);
+		if (*ret != 0) {
+			complete_cmd();
+		}
+	}
+
+	k_mutex_unlock(&current_cmd_mutex);
+
+	return idle;
+}
+
 static void socket_thread_fn(void *arg1, void *arg2, void *arg3)
 {
 	static int bytes_read;
 	static size_t payload_len;
 	static struct resp_item ret;
-	static char buf[CONFIG_AT_CMD_RESPONSE_MAX_LEN];
+	static char static_buf[CONFIG_AT_CMD_RESPONSE_MAX_LEN];
+	char *buf;
+	size_t buf_len;
 
 	ARG_UNUSED(arg1);
 	ARG_UNUSED(arg2);
@@ -237,7 +427,13 @@ static void socket_thread_fn(void *arg1, void *arg2, void *arg3)
 		load_cmd_and_write();
 
 		LOG_DBG("Listening on socket");
-		bytes_read = recv(common_socket_fd, buf, sizeof(buf), 0);
+		buf_len = sizeof(static_buf);
+		if (wait_for_data() == 0) {
+			buf = recv_buf_get(static_buf, &buf_len);
+		} else {
+			buf = static_buf;
+		}
+		bytes_read = recv(common_socket_fd, buf, buf_len, 0);
 
 		/* Initialize the response */
 		ret.code  = 0;
@@ -296,9 +492,29 @@ static void socket_thread_fn(void *arg1, void *arg2, void *arg3)
 
 		payload_len = get_return_code(buf, bytes_read, &ret);
 
-		/* Verify the buffer size if provided, and copy the message */
+		/* The type of a message is known only after it is received. A
+		 * notification received into the caller's buffer is moved to
+		 * the internal buffer, so that the caller's buffer only ever
+		 * holds the response.
+		 */
+		if (buf != static_buf && ret.state == AT_CMD_NOTIFICATION) {
+			if (payload_len > sizeof(static_buf)) {
+				LOG_ERR("AT notification too large for "
+					"reception buffer");
+				memset(buf, 0, payload_len);
+				goto next;
+			}
+			memcpy(static_buf, buf, payload_len);
+			memset(buf, 0, payload_len);
+			buf = static_buf;
+		}
+
+		/* Verify the buffer size if provided, and copy the message
+		 * unless it has been received directly into the buffer.
+		 */
 		if (current_cmd.cmd != NULL &&
 		    current_cmd.resp != NULL &&
+		    current_cmd.resp != buf &&
 		    ret.state != AT_CMD_NOTIFICATION) {
 			if (current_cmd.resp_size < payload_len) {
 				LOG_ERR("Response buffer not large enough");
@@ -312,11 +528,27 @@ static void socket_thread_fn(void *arg1, void *arg2, void *arg3)
 		if (ret.state == AT_CMD_NOTIFICATION &&
 		    notification_handler != NULL) {
 			notification_handler(buf);
-		} else if (current_cmd.callback != NULL) {
+		} else if (current_cmd.flags & AT_CMD_STREAM) {
+			if (ret.state != AT_CMD_NOTIFICATION) {
+				stream_response(current_cmd.stream, buf,
+						payload_len);
+			}
+		} else if (!(current_cmd.flags & AT_CMD_BATCH) &&
+			   current_cmd.callback != NULL) {
 			current_cmd.callback(buf);
 		}
 
 next:
+		/* Write the next command of a batch from this thread, so that
+		 * the caller is not woken up between the commands.
+		 */
+		if (current_cmd.cmd != NULL &&
+		    current_cmd.flags & AT_CMD_BATCH &&
+		    ret.state != AT_CMD_NOTIFICATION &&
+		    batch_write_next(&ret)) {
+			continue;
+		}
+
 		/* Dispatch response for sync call */
 		if (current_cmd.cmd != NULL &&
 		    current_cmd.flags & AT_CMD_SYNC &&
@@ -352,14 +584,23 @@ int at_cmd_write_with_callback(const char *const cmd,
 		return -EINVAL;
 	}
 
+	command.resp = NULL;
+	command.resp_size = 0;
+	command.callback = handler;
+	command.flags = 0;
+
+	/* If no command is pending, the command is written right away and it
+	 * does not have to be duplicated.
+	 */
+	if (write_if_idle(cmd, &command, &ret)) {
+		return ret;
+	}
+
 	command.cmd = k_malloc(strlen(cmd) + 1);
 	if (command.cmd == NULL) {
 		return -ENOMEM;
 	}
 	strcpy(command.cmd, cmd);
-
-	command.resp = NULL;
-	command.callback = handler;
 	command.flags = AT_CMD_BUF_CMD;
 
 	ret = k_msgq_put(&commands, &command, K_FOREVER);
@@ -435,6 +676,130 @@ int at_cmd_write(const char *const cmd,
 	return ret.code;
 }
 
+int at_cmd_write_stream(const char *const cmd,
+			at_cmd_stream_handler_t handler,
+			enum at_cmd_state *state)
+{
+	struct cmd_item command;
+	struct resp_item ret;
+
+	if (atomic_get(&shutdown_mode) == 1) {
+		return -EHOSTDOWN;
+	}
+
+	__ASSERT(k_current_get() != socket_tid,
+		 "at_cmd deadlock: socket thread blocking self\n");
+
+	if (handler == NULL || check_cmd(cmd)) {
+		LOG_ERR("Invalid command or handler");
+		if (state) {
+			*state = AT_CMD_ERROR_QUEUE;
+		}
+		return -EINVAL;
+	}
+
+	/* This cast is safe; we do not free cmd without AT_CMD_BUF_CMD */
+	command.cmd = (char *)cmd;
+	command.resp = NULL;
+	command.resp_size = 0;
+	command.stream = handler;
+	command.flags = AT_CMD_SYNC | AT_CMD_STREAM;
+
+	k_mutex_lock(&response_sync_get, K_FOREVER);
+
+	ret.code = k_msgq_put(&commands, &command, K_FOREVER);
+	if (ret.code) {
+		LOG_ERR("Could not enqueue cmd, error %d", ret.code);
+		k_mutex_unlock(&response_sync_get);
+		if (state) {
+			*state = AT_CMD_ERROR_QUEUE;
+		}
+		return ret.code;
+	}
+
+	load_cmd_and_write();
+
+	k_msgq_get(&response_sync, &ret, K_FOREVER);
+	k_mutex_unlock(&response_sync_get);
+
+	if (state) {
+		*state = ret.state;
+	}
+
+	return ret.code;
+}
+
+int at_cmd_write_batch(struct at_cmd_batch_item *items, size_t count,
+		       bool stop_on_error, struct at_cmd_batch_stats *stats)
+{
+	struct cmd_item command;
+	struct cmd_batch batch;
+	int ret;
+
+	if (atomic_get(&shutdown_mode) == 1) {
+		return -EHOSTDOWN;
+	}
+
+	__ASSERT(k_current_get() != socket_tid,
+		 "at_cmd deadlock: socket thread blocking self\n");
+
+	if (items == NULL || count == 0) {
+		return -EINVAL;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		if (check_cmd(items[i].cmd)) {
+			LOG_ERR("Invalid command at index %zu", i);
+			return -EINVAL;
+		}
+
+		items[i].code = -ECANCELED;
+		items[i].state = AT_CMD_ERROR_QUEUE;
+		items[i].rtt_us = 0;
+	}
+
+	memset(&batch, 0, sizeof(batch));
+	batch.items = items;
+	batch.count = count;
+	batch.stop_on_error = stop_on_error;
+	k_sem_init(&batch.done, 0, 1);
+
+	/* This cast is safe; we do not free cmd without AT_CMD_BUF_CMD */
+	command.cmd = (char *)items[0].cmd;
+	command.resp = items[0].buf;
+	command.resp_size = items[0].buf_len;
+	command.batch = &batch;
+	command.flags = AT_CMD_BATCH;
+
+	batch.submit_cycles = k_cycle_get_32();
+
+	ret = k_msgq_put(&commands, &command, K_FOREVER);
+	if (ret) {
+		LOG_ERR("Could not enqueue batch, error %d", ret);
+		return ret;
+	}
+
+	load_cmd_and_write();
+
+	k_sem_take(&batch.done, K_FOREVER);
+
+	LOG_DBG("Batch of %zu commands: queue %u us, exec %u us, "
+		"max rtt %u us", batch.stats.exec_cnt, batch.stats.queue_us,
+		batch.stats.exec_us, batch.stats.max_rtt_us);
+
+	if (stats) {
+		*stats = batch.stats;
+	}
+
+	for (size_t i = 0; i < batch.stats.exec_cnt; i++) {
+		if ((items[i].state != AT_CMD_OK) || (items[i].code != 0)) {
+			return items[i].code;
+		}
+	}
+
+	return 0;
+}
+
 void at_cmd_set_notification_handler(at_cmd_handler_t handler)
 {
 	LOG_DBG("Setting notification handler to %p", handler);
@@ -37,20 +37,18 @@ enum at_parser_state {
 	CLAC,
 };
 
-static enum at_parser_state state;
-
-static bool set_type_string;
-
-static inline void set_new_state(enum at_parser_state new_state)
+static inline void set_new_state(struct at_parser *parser,
+				 enum at_parser_state new_state)
 {
-	state = new_state;
+	parser->state = new_state;
 }
 
-static inline void reset_state(void)
+static inline void reset_state(struct at_parser *parser)
 {
-	state = IDLE;
-
-	set_type_string = false;
+	parser->state = IDLE;
+	parser->set_type_string = false;
+	parser->index = 0;
+	parser->oversized = false;
 }
 
 static inline void skip_command_prefix(const char **cmd)
@@ -80,7 +78,8 @@ static inline bool check_response_for_forced_string(const char *tmpstr)
 	return retval;
 }
 
-static int at_parse_detect_type(const char **str, int index)
+static int at_parse_detect_type(struct at_parser *parser, const char **str,
+				int index)
 {
 	const char *tmpstr = *str;
 
@@ -88,25 +87,26 @@ static int at_parse_detect_type(const char **str, int index)
 		/* Only first parameter in the string can be
 		 * notification ID, (eg +CEREG:)
 		 */
-		set_new_state(NOTIFICATION);
+		set_new_state(parser, NOTIFICATION);
 
 		/* Check for responses we know need to be strings */
-		set_type_string = check_response_for_forced_string(tmpstr);
+		parser->set_type_string =
+			check_response_for_forced_string(tmpstr);
 
-	} else if (set_type_string) {
-		set_new_state(STRING);
+	} else if (parser->set_type_string) {
+		set_new_state(parser, STRING);
 	} else if ((index == 0) && is_clac(tmpstr)) {
 		/* Next, check if we deal with CLAC response (eg AT+, AT%) */
-		set_new_state(CLAC);
+		set_new_state(parser, CLAC);
 	} else if ((index == 0) && is_command(tmpstr)) {
 		/* Next, check if we deal with command (eg AT+CCLK) */
-		set_new_state(COMMAND);
+		set_new_state(parser, COMMAND);
 	} else if (index == 0) {
 		/* If the string start without an notification
 		 * ID, we treat the whole string as one string
 		 * parameter
 		 */
-		set_new_state(STRING);
+		set_new_state(parser, STRING);
 	} else if ((index > 0) && is_notification(*tmpstr)) {
 		/* If notifications is detected later in the
 		 * string we should stop parsing and return
@@ -115,15 +115,15 @@ static int at_parse_detect_type(const char **str, int index)
 		*str = tmpstr;
 		return -1;
 	} else if (is_number(*tmpstr)) {
-		set_new_state(NUMBER);
+		set_new_state(parser, NUMBER);
 
 	} else if (is_dblquote(*tmpstr)) {
-		set_new_state(QUOTED_STRING);
+		set_new_state(parser, QUOTED_STRING);
 		tmpstr++;
 	} else if (is_array_start(*tmpstr)) {
-		set_new_state(ARRAY);
+		set_new_state(parser, ARRAY);
 		tmpstr++;
-	} else if (is_lfcr(*tmpstr) && (state == NUMBER)) {
+	} else if (is_lfcr(*tmpstr) && (parser->state == NUMBER)) {
 		/* If \n or \r is detected in the string and the
 		 * previous param was a number we assume the
 		 * next parameter is PDU data
@@ -133,14 +133,14 @@ static int at_parse_detect_type(const char **str, int index)
 			tmpstr++;
 		}
 
-		set_new_state(SMS_PDU);
-	} else if (is_lfcr(*tmpstr) && (state == OPTIONAL)) {
-		set_new_state(OPTIONAL);
+		set_new_state(parser, SMS_PDU);
+	} else if (is_lfcr(*tmpstr) && (parser->state == OPTIONAL)) {
+		set_new_state(parser, OPTIONAL);
 	} else if (is_separator(*tmpstr)) {
 		/* If a separator is detected we have detected
 		 * and empty optional parameter
 		 */
-		set_new_state(OPTIONAL);
+		set_new_state(parser, OPTIONAL);
 	} else {
 		/* The rule set is exhausted, and cannot
 		 * continue. Break the loop and return an error
@@ -153,10 +153,12 @@ static int at_parse_detect_type(const char **str, int index)
 	return 0;
 }
 
-static int at_parse_process_element(const char **str, int index,
-				    struct at_param_list *const list)
+static int at_parse_process_element(struct at_parser *parser,
+				    const char **str, int index)
 {
+	struct at_param_list *const list = parser->list;
 	const char *tmpstr = *str;
+	enum at_parser_state state = parser->state;
 
 	if (is_terminated(*tmpstr)) {
 		return -1;
@@ -262,7 +264,7 @@ static int at_parse_process_element(const char **str, int index,
 	} else if (state == SMS_PDU) {
 		const char *start_ptr = tmpstr;
 
-		while (isxdigit((int)*tmpstr)) {
+		while (is_xdigit(*tmpstr)) {
 			tmpstr++;
 		}
 
@@ -285,28 +287,27 @@ static int at_parse_process_element(const char **str, int index,
 
 /*
  * Internal function.
- * Parameters cannot be null. String must be null terminated.
+ * Parse the next parameter and the separator following it. Returns true if
+ * the parsing is complete.
  */
-static int at_parse_param(const char **at_params_str,
-			  struct at_param_list *const list,
-			  const size_t max_params)
+static bool at_parse_next(struct at_parser *parser, const char **at_str)
 {
-	int index = 0;
-	const char *str = *at_params_str;
-	bool oversized = false;
-
-	reset_state();
+	const char *str = *at_str;
+	bool done = false;
 
-	while ((!is_terminated(*str)) && (index < max_params)) {
-		if (isspace((int)*str)) {
+	do {
+		if (is_space(*str)) {
 			str++;
 		}
 
-		if (at_parse_detect_type(&str, index) == -1) {
+		if (at_parse_detect_type(parser, &str, parser->index) == -1) {
+			done = true;
 			break;
 		}
 
-		if (at_parse_process_element(&str, index, list) == -1) {
+		if (at_parse_process_element(parser, &str,
+					     parser->index) == -1) {
+			done = true;
 			break;
 		}
 
@@ -314,19 +315,23 @@ static int at_parse_param(const char **at_params_str,
 			if (is_lfcr(*(str + 1))) {
 				/* Make sure we catch the last empty parameter
 				 **/
-				index++;
+				parser->index++;
 
-				if (index == max_params) {
-					oversized = true;
+				if (parser->index == parser->max_params) {
+					parser->oversized = true;
+					done = true;
 					break;
 				}
 
-				if (at_parse_detect_type(&str, index) == -1) {
+				if (at_parse_detect_type(parser, &str,
+							 parser->index) == -1) {
+					done = true;
 					break;
 				}
 
-				if (at_parse_process_element(&str, index,
-							     list) == -1) {
+				if (at_parse_process_element(parser, &str,
+						parser->index) == -1) {
+					done = true;
 					break;
 				}
 			}
@@ -343,23 +348,66 @@ static int at_parse_param(const char **at_params_str,
 
 			if (is_terminated(str[i]) || is_notification(str[i])) {
 				str += i;
+				done = true;
 				break;
 			}
 		}
 
-		index++;
+		parser->index++;
 
-		if (index == max_params) {
-			oversized = true;
+		if (parser->index == parser->max_params) {
+			parser->oversized = true;
+		}
+	} while (0);
+
+	*at_str = str;
+
+	return done;
+}
+
+/*
+ * Internal function.
+ * Parameters cannot be null. String must be null terminated. If the string
+ * is not final, a parameter reaching the end of the string is not parsed
+ * until more data is available, because it might not be complete.
+ */
+static int at_parse_param(struct at_parser *parser, bool final)
+{
+	const char *str = parser->str;
+
+	while ((!is_terminated(*str)) && (parser->index < parser->max_params)) {
+		if (!final) {
+			/* Parse the parameter without storing it, the setters
+			 * ignore a NULL list, to check whether it is complete.
+			 */
+			struct at_parser probe = *parser;
+			const char *next = str;
+
+			probe.list = NULL;
+			at_parse_next(&probe, &next);
+
+			if (next >= parser->buf + parser->len) {
+				/* Wait for the rest of the parameter */
+				parser->str = str;
+				return -EINPROGRESS;
+			}
+		}
+
+		if (at_parse_next(parser, &str)) {
+			break;
 		}
 	}
 
-	*at_params_str = str;
+	parser->str = str;
 
-	if (oversized) {
+	if (parser->oversized) {
 		return -E2BIG;
 	}
 
+	if (!final && is_terminated(*str)) {
+		return -EINPROGRESS;
+	}
+
 	if (!is_terminated(*str)) {
 		return -EAGAIN;
 	}
@@ -380,6 +428,10 @@ int at_parser_max_params_from_str(const char *at_params_str,
 				  size_t max_params_count)
 {
 	int err = 0;
+	struct at_parser parser = {
+		.list = list,
+		.str = at_params_str,
+	};
 
 	if (at_params_str == NULL || list == NULL || list->params == NULL) {
 		return -EINVAL;
@@ -387,12 +439,69 @@ int at_parser_max_params_from_str(const char *at_params_str,
 
 	at_params_list_clear(list);
 
-	max_params_count = MIN(max_params_count, list->param_count);
+	parser.max_params = MIN(max_params_count, list->param_count);
+	reset_state(&parser);
+
+	err = at_parse_param(&parser, true);
+
+	if (next_param_str) {
+		*next_param_str = (char *)parser.str;
+	}
+
+	return err;
+}
+
+int at_parser_init(struct at_parser *parser, struct at_param_list *list,
+		   char *buf, size_t buf_size)
+{
+	if (parser == NULL || list == NULL || list->params == NULL ||
+	    buf == NULL || buf_size == 0) {
+		return -EINVAL;
+	}
+
+	at_params_list_clear(list);
+
+	parser->list = list;
+	parser->max_params = list->param_count;
+	parser->buf = buf;
+	parser->buf_size = buf_size;
+	parser->len = 0;
+	parser->buf[0] = AT_CMD_BUFFER_TERMINATOR;
+	parser->str = buf;
+	reset_state(parser);
+
+	return 0;
+}
+
+int at_parser_feed(struct at_parser *parser, const char *data, size_t len)
+{
+	if (parser == NULL || parser->buf == NULL || data == NULL) {
+		return -EINVAL;
+	}
+
+	if (len >= parser->buf_size - parser->len) {
+		return -ENOMEM;
+	}
+
+	memcpy(&parser->buf[parser->len], data, len);
+	parser->len += len;
+	parser->buf[parser->len] = AT_CMD_BUFFER_TERMINATOR;
+
+	return at_parse_param(parser, false);
+}
+
+int at_parser_finish(struct at_parser *parser, char **next_param_str)
+{
+	int err;
+
+	if (parser == NULL || parser->buf == NULL) {
+		return -EINVAL;
+	}
 
-	err = at_parse_param(&at_params_str, list, max_params_count);
+	err = at_parse_param(parser, true);
 
 	if (next_param_str) {
-		*next_param_str = (char *)at_params_str;
+		*next_param_str = (char *)parser->str;
 	}
 
 	return err;
@@ -23,13 +23,16 @@ static void at_param_init(struct at_param *param)
 	memset(param, 0, sizeof(struct at_param));
 }
 
-/* Internal function. Parameter cannot be null. */
-static void at_param_clear(struct at_param *param)
+/* Internal function. Parameters cannot be null. */
+static void at_param_clear(const struct at_param_list *list,
+			   struct at_param *param)
 {
 	__ASSERT(param != NULL, "Parameter cannot be NULL.");
 
-	if ((param->type == AT_PARAM_TYPE_STRING) ||
-	    (param->type == AT_PARAM_TYPE_ARRAY)) {
+	/* Values of an arena list are not owned by the parameter */
+	if ((list->arena == NULL) &&
+	    ((param->type == AT_PARAM_TYPE_STRING) ||
+	     (param->type == AT_PARAM_TYPE_ARRAY))) {
 		k_free(param->value.str_val);
 	}
 
@@ -51,6 +54,25 @@ static struct at_param *at_params_get(const struct at_param_list *list,
 	return &param[index];
 }
 
+/* Internal function. Parameter cannot be null. */
+static void *at_params_arena_alloc(const struct at_param_list *list,
+				   size_t size)
+{
+	/* The list is const for the setters, the arena is not */
+	struct at_param_list *arena_list = (struct at_param_list *)list;
+	size_t aligned = ROUND_UP(size, AT_PARAMS_ARENA_ALIGN);
+	void *mem;
+
+	if (aligned > list->arena_size - list->arena_used) {
+		return NULL;
+	}
+
+	mem = &arena_list->arena[list->arena_used];
+	arena_list->arena_used += aligned;
+
+	return mem;
+}
+
 /* Internal function. Parameter cannot be null. */
 static size_t at_param_size(const struct at_param *param)
 {
@@ -81,6 +103,35 @@ int at_params_list_init(struct at_param_list *list, size_t max_params_count)
 	}
 
 	list->param_count = max_params_count;
+	list->arena = NULL;
+	list->arena_size = 0;
+	list->arena_used = 0;
+	return 0;
+}
+
+int at_params_list_init_arena(struct at_param_list *list,
+			      size_t max_params_count,
+			      void *arena, size_t arena_size)
+{
+	size_t params_size = max_params_count * sizeof(struct at_param);
+
+	if (list == NULL || arena == NULL || max_params_count == 0 ||
+	    ((uintptr_t)arena % AT_PARAMS_ARENA_ALIGN) != 0) {
+		return -EINVAL;
+	}
+
+	if (arena_size < params_size) {
+		return -ENOMEM;
+	}
+
+	/* Array initialized with empty parameters. */
+	memset(arena, 0, params_size);
+
+	list->params = arena;
+	list->param_count = max_params_count;
+	list->arena = (uint8_t *)arena + params_size;
+	list->arena_size = arena_size - params_size;
+	list->arena_used = 0;
 	return 0;
 }
 
@@ -93,9 +144,11 @@ void at_params_list_clear(struct at_param_list *list)
 	for (size_t i = 0; i < list->param_count; ++i) {
 		struct at_param *params = list->params;
 
-		at_param_clear(&params[i]);
+		at_param_clear(list, &params[i]);
 		at_param_init(&params[i]);
 	}
+
+	list->arena_used = 0;
 }
 
 void at_params_list_free(struct at_param_list *list)
@@ -107,8 +160,12 @@ void at_params_list_free(struct at_param_list *list)
 	at_params_list_clear(list);
 
 	list->param_count = 0;
-	k_free(list->params);
+	if (list->arena == NULL) {
+		k_free(list->params);
+	}
 	list->params = NULL;
+	list->arena = NULL;
+	list->arena_size = 0;
 }
 
 int at_params_short_put(const struct at_param_list *list, size_t index,
@@ -124,7 +181,7 @@ int at_params_short_put(const struct at_param_list *list, size_t index,
 		return -EINVAL;
 	}
 
-	at_param_clear(param);
+	at_param_clear(list, param);
 
 	param->type = AT_PARAM_TYPE_NUM_SHORT;
 	param->value.int_val = value;
@@ -143,7 +200,7 @@ int at_params_empty_put(const struct at_param_list *list, size_t index)
 		return -EINVAL;
 	}
 
-	at_param_clear(param);
+	at_param_clear(list, param);
 
 	param->type = AT_PARAM_TYPE_EMPTY;
 	param->value.int_val = 0;
@@ -164,7 +221,7 @@ int at_params_int_put(const struct at_param_list *list, size_t index,
 		return -EINVAL;
 	}
 
-	at_param_clear(param);
+	at_param_clear(list, param);
 
 	param->type = AT_PARAM_TYPE_NUM_INT;
 	param->value.int_val = value;
@@ -184,15 +241,21 @@ int at_params_string_put(const struct at_param_list *list, size_t index,
 		return -EINVAL;
 	}
 
-	char *param_value = (char *)k_malloc(str_len + 1);
+	char *param_value;
 
-	if (param_value == NULL) {
-		return -ENOMEM;
-	}
+	if (list->arena != NULL) {
+		/* This cast is safe; values of an arena list are not freed */
+		param_value = (char *)str;
+	} else {
+		param_value = (char *)k_malloc(str_len + 1);
+		if (param_value == NULL) {
+			return -ENOMEM;
+		}
 
-	memcpy(param_value, str, str_len);
+		memcpy(param_value, str, str_len);
+	}
 
-	at_param_clear(param);
+	at_param_clear(list, param);
 	param->size = str_len;
 	param->type = AT_PARAM_TYPE_STRING;
 	param->value.str_val = param_value;
@@ -213,7 +276,13 @@ int at_params_array_put(const struct at_param_list *list, size_t index,
 		return -EINVAL;
 	}
 
-	uint32_t *param_value = (uint32_t *)k_malloc(array_len);
+	uint32_t *param_value;
+
+	if (list->arena != NULL) {
+		param_value = at_params_arena_alloc(list, array_len);
+	} else {
+		param_value = (uint32_t *)k_malloc(array_len);
+	}
 
 	if (param_value == NULL) {
 		return -ENOMEM;
@@ -221,7 +290,7 @@ int at_params_array_put(const struct at_param_list *list, size_t index,
 
 	memcpy(param_value, array, array_len);
 
-	at_param_clear(param);
+	at_param_clear(list, param);
 	param->size = array_len;
 	param->type = AT_PARAM_TYPE_ARRAY;
 	param->value.array_val = param_value;
@@ -319,6 +388,30 @@ int at_params_string_get(const struct at_param_list *list, size_t index,
 	return 0;
 }
 
+int at_params_string_ptr_get(const struct at_param_list *list, size_t index,
+			     const char **str, size_t *len)
+{
+	if (list == NULL || list->params == NULL || str == NULL ||
+	    len == NULL) {
+		return -EINVAL;
+	}
+
+	struct at_param *param = at_params_get(list, index);
+
+	if (param == NULL) {
+		return -EINVAL;
+	}
+
+	if (param->type != AT_PARAM_TYPE_STRING) {
+		return -EINVAL;
+	}
+
+	*str = param->value.str_val;
+	*len = at_param_size(param);
+
+	return 0;
+}
+
 int at_params_array_get(const struct at_param_list *list, size_t index,
 			uint32_t *array, size_t *len)
 {
@@ -19,6 +19,7 @@
 #include <zephyr/types.h>
 #include <stddef.h>
 #include <ctype.h>
+#include <sys/util.h>
 
 #define AT_PARAM_SEPARATOR ','
 #define AT_RSP_SEPARATOR ':'
@@ -30,6 +31,58 @@
 #define AT_PROP_NOTIFICATION_PREFX '%'
 #define AT_CUSTOM_COMMAND_PREFX '#'
 
+/* Character classes used by the parser */
+#define AT_CHAR_TERMINATOR	BIT(0)
+#define AT_CHAR_NOTIFICATION	BIT(1)
+#define AT_CHAR_ALPHA		BIT(2)
+#define AT_CHAR_SEPARATOR	BIT(3)
+#define AT_CHAR_LFCR		BIT(4)
+#define AT_CHAR_DBLQUOTE	BIT(5)
+#define AT_CHAR_ARRAY_START	BIT(6)
+#define AT_CHAR_ARRAY_STOP	BIT(7)
+#define AT_CHAR_NUMBER		BIT(8)
+#define AT_CHAR_XDIGIT		BIT(9)
+#define AT_CHAR_SPACE		BIT(10)
+
+/* Character class lookup table, indexed by the character value */
+static const uint16_t at_char_class[256] = {
+	[AT_CMD_BUFFER_TERMINATOR] = AT_CHAR_TERMINATOR,
+	['\t'] = AT_CHAR_SPACE,
+	['\n'] = AT_CHAR_LFCR | AT_CHAR_SPACE,
+	['\v'] = AT_CHAR_SPACE,
+	['\f'] = AT_CHAR_SPACE,
+	['\r'] = AT_CHAR_LFCR | AT_CHAR_SPACE,
+	[' '] = AT_CHAR_SPACE,
+	['"'] = AT_CHAR_DBLQUOTE,
+	['%'] = AT_CHAR_NOTIFICATION,
+	['('] = AT_CHAR_ARRAY_START,
+	[')'] = AT_CHAR_ARRAY_STOP,
+	['+'] = AT_CHAR_NOTIFICATION | AT_CHAR_NUMBER,
+	[','] = AT_CHAR_SEPARATOR,
+	['-'] = AT_CHAR_NUMBER,
+	['0' ... '9'] = AT_CHAR_NUMBER | AT_CHAR_XDIGIT,
+	[':'] = AT_CHAR_SEPARATOR,
+	['='] = AT_CHAR_SEPARATOR,
+	['A' ... 'F'] = AT_CHAR_ALPHA | AT_CHAR_XDIGIT,
+	['G' ... 'Z'] = AT_CHAR_ALPHA,
+	['a' ... 'f'] = AT_CHAR_ALPHA | AT_CHAR_XDIGIT,
+	['g' ... 'z'] = AT_CHAR_ALPHA,
+};
+
+/**
+ * @brief Check if character belongs to any of the character classes
+ *
+ * @param[in] chr     Character that should be examined
+ * @param[in] classes Bitmask of AT_CHAR_* character classes
+ *
+ * @retval true  If character belongs to one of the classes
+ * @retval false Otherwise
+ */
+static inline bool is_char_class(char chr, uint16_t classes)
+{
+	return (at_char_class[(uint8_t)chr] & classes) != 0;
+}
+
 /**
  * @brief Check if character is a notification start character
  *
@@ -43,12 +96,7 @@
  */
 static inline bool is_notification(char chr)
 {
-	if ((chr == AT_STANDARD_NOTIFICATION_PREFIX) ||
-	    (chr == AT_PROP_NOTIFICATION_PREFX)) {
-		return true;
-	}
-
-	return false;
+	return is_char_class(chr, AT_CHAR_NOTIFICATION);
 }
 
 /**
@@ -63,13 +111,7 @@ static inline bool is_notification(char chr)
  */
 static inline bool is_valid_notification_char(char chr)
 {
-	chr = toupper((int)chr);
-
-	if ((chr >= 'A') && (chr <= 'Z')) {
-		return true;
-	}
-
-	return false;
+	return is_char_class(chr, AT_CHAR_ALPHA);
 }
 
 /**
@@ -85,11 +127,7 @@ static inline bool is_valid_notification_char(char chr)
  */
 static inline bool is_terminated(char chr)
 {
-	if (chr == AT_CMD_BUFFER_TERMINATOR) {
-		return true;
-	}
-
-	return false;
+	return is_char_class(chr, AT_CHAR_TERMINATOR);
 }
 
 /**
@@ -105,12 +143,7 @@ static inline bool is_terminated(char chr)
  */
 static inline bool is_separator(char chr)
 {
-	if ((chr == AT_PARAM_SEPARATOR) || (chr == AT_RSP_SEPARATOR) ||
-	    (chr == AT_CMD_SEPARATOR)) {
-		return true;
-	}
-
-	return false;
+	return is_char_class(chr, AT_CHAR_SEPARATOR);
 }
 
 /**
@@ -125,11 +158,7 @@ static inline bool is_separator(char chr)
  */
 static inline bool is_lfcr(char chr)
 {
-	if ((chr == '\r') || (chr == '\n')) {
-		return true;
-	}
-
-	return false;
+	return is_char_class(chr, AT_CHAR_LFCR);
 }
 
 /**
@@ -145,11 +174,7 @@ static inline bool is_lfcr(char chr)
  */
 static inline bool is_dblquote(char chr)
 {
-	if (chr == '"') {
-		return true;
-	}
-
-	return false;
+	return is_char_class(chr, AT_CHAR_DBLQUOTE);
 }
 
 /**
@@ -164,11 +189,7 @@ static inline bool is_dblquote(char chr)
  */
 static inline bool is_array_start(char chr)
 {
-	if (chr == '(') {
-		return true;
-	}
-
-	return false;
+	return is_char_class(chr, AT_CHAR_ARRAY_START);
 }
 
 /**
@@ -183,11 +204,7 @@ static inline bool is_array_start(char chr)
  */
 static inline bool is_array_stop(char chr)
 {
-	if (chr == ')') {
-		return true;
-	}
-
-	return false;
+	return is_char_class(chr, AT_CHAR_ARRAY_STOP);
 }
 
 /**
@@ -202,11 +219,33 @@ static inline bool is_array_stop(char chr)
  */
 static inline bool is_number(char chr)
 {
-	if (isdigit((int)chr) || (chr == '-') || (chr == '+')) {
-		return true;
-	}
+	return is_char_class(chr, AT_CHAR_NUMBER);
+}
 
-	return false;
+/**
+ * @brief Check if character is a hexadecimal digit
+ *
+ * @param[in] chr Character that should be examined
+ *
+ * @retval true  If character is 0-9, a-f or A-F
+ * @retval false If character is something else
+ */
+static inline bool is_xdigit(char chr)
+{
+	return is_char_class(chr, AT_CHAR_XDIGIT);
+}
+
+/**
+ * @brief Check if character is a whitespace character
+ *
+ * @param[in] chr Character that should be examined
+ *
+ * @retval true  If character is a space, tab or line shift character
+ * @retval false If character is something else
+ */
+static inline bool is_space(char chr)
+{
+	return is_char_class(chr, AT_CHAR_SPACE);
 }
 
 /**
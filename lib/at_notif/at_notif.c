@@ -7,115 +7,356 @@
 #include <logging/log.h>
 #include <zephyr.h>
 #include <stdio.h>
+#include <string.h>
 #include <init.h>
 #include <modem/at_cmd.h>
 #include <modem/at_notif.h>
-#include <sys/slist.h>
 
 LOG_MODULE_REGISTER(at_notif, CONFIG_AT_NOTIF_LOG_LEVEL);
 
+/* Serializes handler registration. Dispatching does not take the lock. */
 static K_MUTEX_DEFINE(list_mtx);
 
-/**@brief Link list element for notification handler. */
+/**@brief Registered notification handler. */
 struct notif_handler {
-	sys_snode_t        node;
 	void               *ctx;
 	at_notif_handler_t handler;
+	atomic_t           hits;
+	size_t             prefix_len;
+	char               prefix[];
 };
 
-static sys_slist_t handler_list;
+/**@brief Dispatch index.
+ *
+ * Handlers without a prefix come first, in registration order. They are
+ * followed by the handlers with a prefix, sorted by prefix. The index is
+ * never modified once published. It is replaced as a whole when a handler
+ * is registered or de-registered.
+ */
+struct notif_index {
+	/* Next index waiting for the dispatches to complete */
+	struct notif_index *next_retired;
+	/* Handlers removed from the previous index, freed with this index */
+	struct notif_handler **removed;
+	size_t removed_cnt;
+	size_t any_cnt;
+	size_t count;
+	struct notif_handler *handlers[];
+};
+
+static atomic_ptr_t current_index;
+
+/* Protects the number of dispatches in progress and the retired indexes */
+static struct k_spinlock index_lock;
+static size_t readers;
+
+/* Indexes replaced during a dispatch, freed when the last dispatch
+ * completes.
+ */
+static struct notif_index *retired_index;
+
+static int prefix_cmp(const char *prefix, size_t prefix_len,
+		      const char *key, size_t key_len)
+{
+	int cmp = memcmp(prefix, key, MIN(prefix_len, key_len));
+
+	if (cmp != 0) {
+		return cmp;
+	}
+
+	return (prefix_len > key_len) - (prefix_len < key_len);
+}
+
+/**@brief Get the length of the notification name, for example +CEREG. */
+static size_t notif_key_len(const char *response)
+{
+	size_t len = 0;
+
+	while (response[len] != '\0' && response[len] != ':' &&
+	       response[len] != '\r' && response[len] != '\n') {
+		len++;
+	}
 
+	return len;
+}
 
 /**
- * @brief Find the handler from the notification list.
+ * @brief Find the first handler with a prefix not smaller than the key.
  *
- * @return The node or NULL if not found and its previous node in @p prev_out.
+ * @return Index of the handler, or @p index->count if there is none.
  */
-static struct notif_handler *find_node(struct notif_handler **prev_out,
-	void *ctx, at_notif_handler_t handler)
+static size_t find_first(const struct notif_index *index,
+			 const char *key, size_t key_len)
 {
-	struct notif_handler *prev = NULL, *curr, *tmp;
+	size_t lo = index->any_cnt;
+	size_t hi = index->count;
 
-	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&handler_list, curr, tmp, node) {
-		if (curr->ctx == ctx && curr->handler == handler) {
-			*prev_out = prev;
-			return curr;
+	while (lo < hi) {
+		size_t mid = lo + (hi - lo) / 2;
+		const struct notif_handler *curr = index->handlers[mid];
+
+		if (prefix_cmp(curr->prefix, curr->prefix_len,
+			       key, key_len) < 0) {
+			lo = mid + 1;
+		} else {
+			hi = mid;
 		}
-		prev = curr;
 	}
-	return NULL;
+
+	return lo;
+}
+
+/* A NULL prefix matches the handler registered with any prefix */
+static bool handler_match(const struct notif_handler *curr, void *ctx,
+			  at_notif_handler_t handler,
+			  const char *prefix, size_t prefix_len)
+{
+	return (curr->ctx == ctx) && (curr->handler == handler) &&
+	       (prefix == NULL || (prefix_cmp(curr->prefix, curr->prefix_len,
+					      prefix, prefix_len) == 0));
 }
 
-/**@brief Add the handler in the notification list if not already present. */
-static int append_notif_handler(void *ctx, at_notif_handler_t handler)
+static struct notif_index *index_alloc(size_t count)
 {
+	struct notif_index *index;
+
+	index = k_malloc(sizeof(*index) + count * sizeof(index->handlers[0]));
+	if (index != NULL) {
+		memset(index, 0, sizeof(*index));
+		index->count = count;
+	}
+
+	return index;
+}
+
+/**@brief Free an index and the handlers removed from its predecessor. */
+static void index_free(struct notif_index *index)
+{
+	for (size_t i = 0; i < index->removed_cnt; i++) {
+		k_free(index->removed[i]);
+	}
+
+	k_free(index->removed);
+	k_free(index);
+}
+
+/**@brief Free a list of retired indexes. */
+static void index_free_retired(struct notif_index *index)
+{
+	while (index != NULL) {
+		struct notif_index *next = index->next_retired;
+
+		index_free(index);
+		index = next;
+	}
+}
+
+/**
+ * @brief Publish a new index.
+ *
+ * The previous index is freed right away if no dispatch is in progress.
+ * Otherwise, it is retired and the last dispatch to complete frees it. The
+ * writer never waits for a dispatch, so handlers can change registrations
+ * while another thread does the same.
+ */
+static void index_publish(struct notif_index *index)
+{
+	struct notif_index *prev = atomic_ptr_get(&current_index);
+	k_spinlock_key_t key = k_spin_lock(&index_lock);
+
+	atomic_ptr_set(&current_index, index);
+
+	if (prev != NULL && readers != 0) {
+		prev->next_retired = retired_index;
+		retired_index = prev;
+		prev = NULL;
+	}
+
+	k_spin_unlock(&index_lock, key);
+
+	if (prev != NULL) {
+		index_free(prev);
+	}
+}
+
+/**@brief Add the handler in the notification index if not already present. */
+static int append_notif_handler(void *ctx, at_notif_handler_t handler,
+				const char *prefix)
+{
+	const struct notif_index *index;
+	struct notif_index *new_index;
 	struct notif_handler *to_ins;
+	size_t prefix_len = prefix ? strlen(prefix) : 0;
+	size_t count, pos;
 
 	k_mutex_lock(&list_mtx, K_FOREVER);
 
+	index = atomic_ptr_get(&current_index);
+	count = index ? index->count : 0;
+
 	/* Check if handler is already registered. */
-	if (find_node(&to_ins, ctx, handler) != NULL) {
-		LOG_DBG("Handler already registered. Nothing to do");
-		k_mutex_unlock(&list_mtx);
-		return 0;
+	for (size_t i = 0; i < count; i++) {
+		if (handler_match(index->handlers[i], ctx, handler,
+				  prefix ? prefix : "", prefix_len)) {
+			LOG_DBG("Handler already registered. Nothing to do");
+			k_mutex_unlock(&list_mtx);
+			return 0;
+		}
 	}
 
 	/* Allocate memory and fill. */
-	to_ins = (struct notif_handler *)k_malloc(sizeof(struct notif_handler));
-	if (to_ins == NULL) {
+	to_ins = k_malloc(sizeof(struct notif_handler) + prefix_len + 1);
+	new_index = index_alloc(count + 1);
+	if (to_ins == NULL || new_index == NULL) {
+		k_free(to_ins);
+		k_free(new_index);
 		k_mutex_unlock(&list_mtx);
 		return -ENOBUFS;
 	}
 	memset(to_ins, 0, sizeof(struct notif_handler));
-	to_ins->ctx     = ctx;
-	to_ins->handler = handler;
+	to_ins->ctx        = ctx;
+	to_ins->handler    = handler;
+	to_ins->prefix_len = prefix_len;
+	memcpy(to_ins->prefix, prefix ? prefix : "", prefix_len + 1);
 
-	/* Insert handler in the list. */
-	sys_slist_append(&handler_list, &to_ins->node);
+	/* Insert after the handlers with the same prefix */
+	if (prefix_len == 0) {
+		pos = index ? index->any_cnt : 0;
+	} else {
+		pos = index ? find_first(index, prefix, prefix_len) : 0;
+		while (pos < count &&
+		       prefix_cmp(index->handlers[pos]->prefix,
+				  index->handlers[pos]->prefix_len,
+				  prefix, prefix_len) == 0) {
+			pos++;
+		}
+	}
+
+	for (size_t i = 0; i < pos; i++) {
+		new_index->handlers[i] = index->handlers[i];
+	}
+	new_index->handlers[pos] = to_ins;
+	for (size_t i = pos; i < count; i++) {
+		new_index->handlers[i + 1] = index->handlers[i];
+	}
+	new_index->any_cnt = (index ? index->any_cnt : 0) +
+			     (prefix_len == 0 ? 1 : 0);
+
+	index_publish(new_index);
 	k_mutex_unlock(&list_mtx);
 	return 0;
 }
 
-/**@brief Remove the handler from the notification list if registered. */
+/**@brief Remove all registrations of the handler from the notification index.
+ */
 static int remove_notif_handler(void *ctx, at_notif_handler_t handler)
 {
-	struct notif_handler *curr, *prev = NULL;
+	const struct notif_index *index;
+	struct notif_index *new_index;
+	size_t removed_cnt = 0;
+	size_t pos = 0;
 
 	k_mutex_lock(&list_mtx, K_FOREVER);
 
+	index = atomic_ptr_get(&current_index);
+
 	/* Check if the handler is registered before removing it. */
-	curr = find_node(&prev, ctx, handler);
-	if (curr == NULL) {
+	for (size_t i = 0; index != NULL && i < index->count; i++) {
+		if (handler_match(index->handlers[i], ctx, handler, NULL, 0)) {
+			removed_cnt++;
+		}
+	}
+
+	if (removed_cnt == 0) {
 		LOG_WRN("Handler not registered. Nothing to do");
 		k_mutex_unlock(&list_mtx);
 		return 0;
 	}
 
-	/* Remove the handler from the list. */
-	sys_slist_remove(&handler_list, &prev->node, &curr->node);
-	k_free(curr);
+	new_index = index_alloc(index->count - removed_cnt);
+	if (new_index != NULL) {
+		new_index->removed = k_malloc(removed_cnt *
+					      sizeof(new_index->removed[0]));
+	}
+	if (new_index == NULL || new_index->removed == NULL) {
+		k_free(new_index);
+		k_mutex_unlock(&list_mtx);
+		return -ENOBUFS;
+	}
+
+	/* Remove the handler from the index. */
+	for (size_t i = 0; i < index->count; i++) {
+		struct notif_handler *curr = index->handlers[i];
 
+		if (handler_match(curr, ctx, handler, NULL, 0)) {
+			new_index->removed[new_index->removed_cnt++] = curr;
+		} else {
+			new_index->handlers[pos++] = curr;
+			if (curr->prefix_len == 0) {
+				new_index->any_cnt++;
+			}
+		}
+	}
+
+	index_publish(new_index);
 	k_mutex_unlock(&list_mtx);
 	return 0;
 }
 
+static void handler_call(struct notif_handler *curr, const char *response)
+{
+	LOG_DBG(" - ctx=0x%08X, handler=0x%08X", (uint32_t)curr->ctx,
+		(uint32_t)curr->handler);
+	atomic_inc(&curr->hits);
+	curr->handler(curr->ctx, response);
+}
+
 /**@brief AT command notifications handler. */
 static void notif_dispatch(const char *response)
 {
-	struct notif_handler *curr, *tmp;
+	const struct notif_index *index;
+	struct notif_index *retired = NULL;
+	size_t key_len = notif_key_len(response);
+	k_spinlock_key_t key;
 
-	k_mutex_lock(&list_mtx, K_FOREVER);
+	/* An index replaced while a dispatch is in progress is not freed
+	 * until the last dispatch completes.
+	 */
+	key = k_spin_lock(&index_lock);
+	readers++;
+	index = atomic_ptr_get(&current_index);
+	k_spin_unlock(&index_lock, key);
 
-	/* Dispatch notifications to all registered handlers */
 	LOG_DBG("Dispatching events:");
-	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&handler_list, curr, tmp, node) {
-		LOG_DBG(" - ctx=0x%08X, handler=0x%08X", (uint32_t)curr->ctx,
-			(uint32_t)curr->handler);
-		curr->handler(curr->ctx, response);
+	if (index != NULL) {
+		/* Handlers without a prefix receive all notifications */
+		for (size_t i = 0; i < index->any_cnt; i++) {
+			handler_call(index->handlers[i], response);
+		}
+
+		for (size_t i = find_first(index, response, key_len);
+		     i < index->count; i++) {
+			struct notif_handler *curr = index->handlers[i];
+
+			if (prefix_cmp(curr->prefix, curr->prefix_len,
+				       response, key_len) != 0) {
+				break;
+			}
+
+			handler_call(curr, response);
+		}
 	}
 	LOG_DBG("Done");
 
-	k_mutex_unlock(&list_mtx);
+	key = k_spin_lock(&index_lock);
+	readers--;
+	if (readers == 0) {
+		retired = retired_index;
+		retired_index = NULL;
+	}
+	k_spin_unlock(&index_lock, key);
+
+	index_free_retired(retired);
 }
 
 static int module_init(const struct device *dev)
@@ -132,7 +373,6 @@ static int module_init(const struct device *dev)
 	initialized = true;
 
 	LOG_DBG("Initialization");
-	sys_slist_init(&handler_list);
 	at_cmd_set_notification_handler(notif_dispatch);
 	return 0;
 }
@@ -149,7 +389,19 @@ int at_notif_register_handler(void *context, at_notif_handler_t handler)
 			(uint32_t)context, (uint32_t)handler);
 		return -EINVAL;
 	}
-	return append_notif_handler(context, handler);
+	return append_notif_handler(context, handler, NULL);
+}
+
+int at_notif_register_prefix_handler(void *context, const char *prefix,
+				     at_notif_handler_t handler)
+{
+	if (handler == NULL || prefix == NULL || prefix[0] == '\0' ||
+	    prefix[notif_key_len(prefix)] != '\0') {
+		LOG_ERR("Invalid handler (context=0x%08X, handler=0x%08X)",
+			(uint32_t)context, (uint32_t)handler);
+		return -EINVAL;
+	}
+	return append_notif_handler(context, handler, prefix);
 }
 
 int at_notif_deregister_handler(void *context, at_notif_handler_t handler)
@@ -162,6 +414,37 @@ int at_notif_deregister_handler(void *context, at_notif_handler_t handler)
 	return remove_notif_handler(context, handler);
 }
 
+int at_notif_prefix_hits_get(const char *prefix, uint32_t *hits)
+{
+	const struct notif_index *index;
+	size_t prefix_len;
+	bool found = false;
+
+	if (prefix == NULL || hits == NULL) {
+		return -EINVAL;
+	}
+
+	prefix_len = strlen(prefix);
+	*hits = 0;
+
+	k_mutex_lock(&list_mtx, K_FOREVER);
+
+	index = atomic_ptr_get(&current_index);
+	for (size_t i = 0; index != NULL && i < index->count; i++) {
+		const struct notif_handler *curr = index->handlers[i];
+
+		if (prefix_cmp(curr->prefix, curr->prefix_len,
+			       prefix, prefix_len) == 0) {
+			*hits += atomic_get(&curr->hits);
+			found = true;
+		}
+	}
+
+	k_mutex_unlock(&list_mtx);
+
+	return found ? 0 : -ENXIO;
+}
+
 #ifdef CONFIG_AT_NOTIF_SYS_INIT
 SYS_INIT(module_init, APPLICATION, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
 #endif
@@ -5,6 +5,13 @@
  */
 
 #include <assert.h>
+
+#ifdef CONFIG_EI_WRAPPER_CONTINUOUS_DSP
+/* Must be defined before the library header is included. */
+#define EI_CLASSIFIER_SLICES_PER_MODEL_WINDOW \
+	CONFIG_EI_WRAPPER_SLICES_PER_WINDOW
+#endif
+
 #include <ei_run_classifier.h>
 #include <ei_wrapper.h>
 
@@ -22,6 +29,20 @@ BUILD_ASSERT(CONFIG_EI_WRAPPER_THREAD_STACK_SIZE > 0);
 #define THREAD_STACK_SIZE	CONFIG_EI_WRAPPER_THREAD_STACK_SIZE
 #define THREAD_PRIORITY 	CONFIG_EI_WRAPPER_THREAD_PRIORITY
 #define DEBUG_MODE		IS_ENABLED(CONFIG_EI_WRAPPER_DEBUG_MODE)
+#define DATA_INT16		IS_ENABLED(CONFIG_EI_WRAPPER_DATA_INT16)
+#define STATS_WINDOW		CONFIG_EI_WRAPPER_STATS_WINDOW
+#define CONTINUOUS_DSP		IS_ENABLED(CONFIG_EI_WRAPPER_CONTINUOUS_DSP)
+
+#ifdef CONFIG_EI_WRAPPER_CONTINUOUS_DSP
+#define SLICE_CNT		CONFIG_EI_WRAPPER_SLICES_PER_WINDOW
+#else
+#define SLICE_CNT		1
+#endif
+
+#define SLICE_SIZE		(INPUT_WINDOW_SIZE / SLICE_CNT)
+
+/* Default scale of 16-bit input data, that makes it a Q15 value. */
+#define DATA_SCALE_Q15		(1.0f / 32768.0f)
 
 enum state {
 	STATE_DISABLED,
@@ -29,15 +50,55 @@ enum state {
 	STATE_READY,
 };
 
+enum window_mode {
+	/* Window of a single prediction. */
+	WINDOW_SINGLE,
+	/* First window of continuous prediction, or the first one after
+	 * windows were dropped.
+	 */
+	WINDOW_RESTART,
+	/* Window shifted by a single step of continuous prediction. */
+	WINDOW_NEXT,
+};
+
+enum timing_stage {
+	TIMING_DSP,
+	TIMING_CLASSIFICATION,
+	TIMING_ANOMALY,
+
+	TIMING_STAGE_COUNT
+};
+
+#ifdef CONFIG_EI_WRAPPER_DATA_INT16
+typedef int16_t sample_t;
+#else
+typedef float sample_t;
+#endif
+
 struct data_buffer {
-	float buf[DATA_BUFFER_SIZE];
+	/* Samples written to the first window of the buffer are mirrored past
+	 * its end. Every input window can then be read from consecutive
+	 * memory, without checking for a wrap.
+	 */
+	sample_t buf[DATA_BUFFER_SIZE + INPUT_WINDOW_SIZE];
 	size_t process_idx;
 	size_t append_idx;
 	size_t wait_data_size;
+	/* Shift between windows of continuous prediction, 0 if disabled. */
+	size_t continuous_shift;
+	enum window_mode window_mode;
 	struct k_spinlock lock;
 	enum state state;
 };
 
+struct prediction_stats {
+	/* Timings of the last STATS_WINDOW predictions. */
+	int timing[STATS_WINDOW][TIMING_STAGE_COUNT];
+	uint32_t prediction_cnt;
+	uint32_t dropped_cnt;
+	struct k_spinlock lock;
+};
+
 static K_THREAD_STACK_DEFINE(thread_stack, THREAD_STACK_SIZE);
 static struct k_thread thread;
 static k_tid_t ei_thread_id;
@@ -45,12 +106,17 @@ static k_tid_t ei_thread_id;
 static K_SEM_DEFINE(ei_sem, 0, 1);
 
 static struct data_buffer ei_input;
+static float ei_input_scale = DATA_SCALE_Q15;
+static size_t ei_slice_offset;
 static ei_impulse_result_t ei_result;
+static struct prediction_stats ei_stats;
 static ei_wrapper_result_ready_cb user_cb;
 
 
 BUILD_ASSERT(DATA_BUFFER_SIZE > INPUT_WINDOW_SIZE);
 BUILD_ASSERT(INPUT_WINDOW_SIZE % INPUT_FRAME_SIZE == 0);
+BUILD_ASSERT((INPUT_WINDOW_SIZE / INPUT_FRAME_SIZE) % SLICE_CNT == 0);
+BUILD_ASSERT(STATS_WINDOW > 0);
 
 
 static size_t buf_get_collected_data_count(const struct data_buffer *b)
@@ -59,17 +125,17 @@ static size_t buf_get_collected_data_count(const struct data_buffer *b)
 		return b->append_idx - b->process_idx;
 	}
 
-	return (ARRAY_SIZE(b->buf) - b->process_idx) + b->append_idx;
+	return (DATA_BUFFER_SIZE - b->process_idx) + b->append_idx;
 }
 
 static size_t buf_calc_free_space(const struct data_buffer *b)
 {
 	if (b->wait_data_size > 0) {
-		return b->wait_data_size + ARRAY_SIZE(b->buf) -
+		return b->wait_data_size + DATA_BUFFER_SIZE -
 		       INPUT_WINDOW_SIZE - 1;
 	}
 
-	return ARRAY_SIZE(b->buf) - buf_get_collected_data_count(b) - 1;
+	return DATA_BUFFER_SIZE - buf_get_collected_data_count(b) - 1;
 }
 
 static void buf_processing_end(struct data_buffer *b)
@@ -102,7 +168,20 @@ static int buf_cleanup(struct data_buffer *b)
 	return err;
 }
 
-static int buf_append(struct data_buffer *b, const float *data, size_t len,
+static void buf_write(struct data_buffer *b, size_t idx, const sample_t *data,
+		      size_t len)
+{
+	memcpy(&b->buf[idx], data, len * sizeof(b->buf[0]));
+
+	if (idx < INPUT_WINDOW_SIZE) {
+		size_t mirror_cnt = MIN(len, INPUT_WINDOW_SIZE - idx);
+
+		memcpy(&b->buf[DATA_BUFFER_SIZE + idx], data,
+		       mirror_cnt * sizeof(b->buf[0]));
+	}
+}
+
+static int buf_append(struct data_buffer *b, const sample_t *data, size_t len,
 		      bool *process_buf)
 {
 	*process_buf = false;
@@ -127,8 +206,8 @@ static int buf_append(struct data_buffer *b, const float *data, size_t len,
 		}
 	}
 
-	if (new_idx >= ARRAY_SIZE(b->buf)) {
-		new_idx -= ARRAY_SIZE(b->buf);
+	if (new_idx >= DATA_BUFFER_SIZE) {
+		new_idx -= DATA_BUFFER_SIZE;
 		looped = true;
 	}
 
@@ -137,41 +216,45 @@ static int buf_append(struct data_buffer *b, const float *data, size_t len,
 	k_spin_unlock(&b->lock, key);
 
 	if (looped) {
-		size_t copy_cnt = ARRAY_SIZE(b->buf) - cur_idx;
+		size_t copy_cnt = DATA_BUFFER_SIZE - cur_idx;
 
-		memcpy(&b->buf[cur_idx], data, copy_cnt * sizeof(b->buf[0]));
-		memcpy(&b->buf[0], data + copy_cnt,
-		      (len - copy_cnt) * sizeof(b->buf[0]));
+		buf_write(b, cur_idx, data, copy_cnt);
+		buf_write(b, 0, data + copy_cnt, len - copy_cnt);
 	} else {
-		memcpy(&b->buf[cur_idx], data, len * sizeof(b->buf[0]));
+		buf_write(b, cur_idx, data, len);
 	}
 
 	return 0;
 }
 
-static void buf_get(const struct data_buffer *b, float *b_res, size_t offset,
-		    size_t len)
+static const sample_t *buf_get(const struct data_buffer *b, size_t offset,
+			       size_t len)
 {
 	__ASSERT_NO_MSG((offset + len) <= INPUT_WINDOW_SIZE);
 
 	/* Processing index cannot change while processing is done. */
 	__ASSERT_NO_MSG(b->state == STATE_PROCESSING);
 
-	size_t read_start = b->process_idx + offset;
-	size_t read_end = read_start + len;
+	/* The mirrored part of the buffer keeps the window contiguous. */
+	return &b->buf[b->process_idx + offset];
+}
 
-	if ((read_end > ARRAY_SIZE(b->buf)) && (read_start < ARRAY_SIZE(b->buf))) {
-		size_t copy_cnt = ARRAY_SIZE(b->buf) - read_start;
+static void buf_window_move(struct data_buffer *b, size_t move,
+			    bool *process_buf)
+{
+	size_t max_move = buf_get_collected_data_count(b);
 
-		memcpy(b_res, &b->buf[read_start],
-		       copy_cnt * sizeof(b->buf[0]));
-		memcpy(b_res + copy_cnt, &b->buf[0],
-		       (len - copy_cnt) * sizeof(b->buf[0]));
+	b->process_idx += move;
+	if (b->process_idx >= DATA_BUFFER_SIZE) {
+		b->process_idx -= DATA_BUFFER_SIZE;
+	}
+
+	size_t processing_end_move = move + INPUT_WINDOW_SIZE;
+
+	if (processing_end_move > max_move) {
+		b->wait_data_size = processing_end_move - max_move;
 	} else {
-		if (read_start >= ARRAY_SIZE(b->buf)) {
-			read_start -= ARRAY_SIZE(b->buf);
-		}
-		memcpy(b_res, &b->buf[read_start], len * sizeof(b->buf[0]));
+		*process_buf = true;
 	}
 }
 
@@ -182,7 +265,7 @@ static int buf_processing_move(struct data_buffer *b, size_t move,
 
 	k_spinlock_key_t key = k_spin_lock(&b->lock);
 
-	if (b->state == STATE_READY) {
+	if ((b->state == STATE_READY) && !b->continuous_shift) {
 		b->state = STATE_PROCESSING;
 	} else {
 		__ASSERT_NO_MSG(b->state != STATE_DISABLED);
@@ -190,24 +273,156 @@ static int buf_processing_move(struct data_buffer *b, size_t move,
 		return -EBUSY;
 	}
 
-	size_t max_move = buf_get_collected_data_count(b);
+	b->window_mode = WINDOW_SINGLE;
+	buf_window_move(b, move, process_buf);
 
-	b->process_idx += move;
-	if (b->process_idx >= ARRAY_SIZE(b->buf)) {
-		b->process_idx -= ARRAY_SIZE(b->buf);
+	k_spin_unlock(&b->lock, key);
+
+	return 0;
+}
+
+static int buf_continuous_start(struct data_buffer *b, size_t shift,
+				bool *process_buf)
+{
+	*process_buf = false;
+
+	k_spinlock_key_t key = k_spin_lock(&b->lock);
+
+	if (b->continuous_shift) {
+		k_spin_unlock(&b->lock, key);
+		return -EALREADY;
 	}
 
-	size_t processing_end_move = move + INPUT_WINDOW_SIZE;
+	if (b->state != STATE_READY) {
+		__ASSERT_NO_MSG(b->state != STATE_DISABLED);
+		k_spin_unlock(&b->lock, key);
+		return -EBUSY;
+	}
 
-	if (processing_end_move > max_move) {
-		b->wait_data_size = processing_end_move - max_move;
+	b->state = STATE_PROCESSING;
+	b->continuous_shift = shift;
+	b->window_mode = WINDOW_RESTART;
+	buf_window_move(b, 0, process_buf);
+
+	k_spin_unlock(&b->lock, key);
+
+	return 0;
+}
+
+static int buf_continuous_stop(struct data_buffer *b)
+{
+	int err = 0;
+
+	k_spinlock_key_t key = k_spin_lock(&b->lock);
+
+	if (b->continuous_shift) {
+		b->continuous_shift = 0;
+
+		/* The window waiting for data is not passed to the thread yet.
+		 * Continuous prediction never moves the window past the
+		 * collected data, so the data count stays valid.
+		 */
+		if ((b->state == STATE_PROCESSING) && (b->wait_data_size > 0)) {
+			__ASSERT_NO_MSG(b->window_mode != WINDOW_SINGLE);
+			b->wait_data_size = 0;
+			b->state = STATE_READY;
+		}
 	} else {
-		*process_buf = true;
+		err = -EALREADY;
 	}
 
 	k_spin_unlock(&b->lock, key);
 
-	return 0;
+	return err;
+}
+
+static bool buf_continuous_next(struct data_buffer *b, bool restart,
+				uint32_t *dropped, bool *process_buf)
+{
+	*dropped = 0;
+	*process_buf = false;
+
+	k_spinlock_key_t key = k_spin_lock(&b->lock);
+
+	size_t shift = b->continuous_shift;
+
+	if (!shift || (b->state != STATE_READY)) {
+		k_spin_unlock(&b->lock, key);
+		return false;
+	}
+
+	size_t collected = buf_get_collected_data_count(b);
+	size_t move = shift;
+
+	/* If the prediction fell behind the input, skip to the newest
+	 * complete window to keep the delay of the results bounded.
+	 */
+	if (collected >= INPUT_WINDOW_SIZE + 2 * shift) {
+		size_t window_cnt = (collected - INPUT_WINDOW_SIZE) / shift;
+
+		*dropped = window_cnt - 1;
+		move = window_cnt * shift;
+	}
+
+	b->state = STATE_PROCESSING;
+	b->window_mode = (restart || *dropped) ? WINDOW_RESTART : WINDOW_NEXT;
+	buf_window_move(b, move, process_buf);
+
+	k_spin_unlock(&b->lock, key);
+
+	return true;
+}
+
+static void stats_add_prediction(struct prediction_stats *s,
+				 const ei_impulse_result_timing_t *timing)
+{
+	k_spinlock_key_t key = k_spin_lock(&s->lock);
+
+	int *entry = s->timing[s->prediction_cnt % STATS_WINDOW];
+
+	entry[TIMING_DSP] = timing->dsp;
+	entry[TIMING_CLASSIFICATION] = timing->classification;
+	entry[TIMING_ANOMALY] = (HAS_ANOMALY) ? (timing->anomaly) : (-1);
+	s->prediction_cnt++;
+
+	k_spin_unlock(&s->lock, key);
+}
+
+static void stats_add_dropped(struct prediction_stats *s, uint32_t dropped)
+{
+	k_spinlock_key_t key = k_spin_lock(&s->lock);
+
+	s->dropped_cnt += dropped;
+
+	k_spin_unlock(&s->lock, key);
+}
+
+static void stats_timing_get(const struct prediction_stats *s,
+			     enum timing_stage stage,
+			     struct ei_wrapper_timing_stats *out)
+{
+	size_t cnt = MIN(s->prediction_cnt, STATS_WINDOW);
+
+	if (cnt == 0) {
+		out->last = 0;
+		out->avg = 0;
+		out->max = 0;
+		return;
+	}
+
+	int sum = 0;
+	int max = s->timing[0][stage];
+
+	for (size_t i = 0; i < cnt; i++) {
+		int time = s->timing[i][stage];
+
+		sum += time;
+		max = MAX(max, time);
+	}
+
+	out->last = s->timing[(s->prediction_cnt - 1) % STATS_WINDOW][stage];
+	out->avg = sum / (int)cnt;
+	out->max = max;
 }
 
 bool ei_wrapper_classifier_has_anomaly(void)
@@ -225,7 +440,7 @@ size_t ei_wrapper_get_window_size(void)
 	return INPUT_WINDOW_SIZE;
 }
 
-int ei_wrapper_add_data(const float *data, size_t data_size)
+static int add_data(const sample_t *data, size_t data_size)
 {
 	if (data_size % INPUT_FRAME_SIZE) {
 		return -EINVAL;
@@ -241,11 +456,73 @@ int ei_wrapper_add_data(const float *data, size_t data_size)
 	return err;
 }
 
+int ei_wrapper_add_data(const float *data, size_t data_size)
+{
+#ifdef CONFIG_EI_WRAPPER_DATA_INT16
+	return -ENOTSUP;
+#else
+	return add_data(data, data_size);
+#endif
+}
+
+int ei_wrapper_add_data_int16(const int16_t *data, size_t data_size)
+{
+#ifdef CONFIG_EI_WRAPPER_DATA_INT16
+	return add_data(data, data_size);
+#else
+	return -ENOTSUP;
+#endif
+}
+
+int ei_wrapper_set_data_scale(float scale)
+{
+	if (!DATA_INT16) {
+		return -ENOTSUP;
+	}
+
+	int err = 0;
+	k_spinlock_key_t key = k_spin_lock(&ei_input.lock);
+
+	if (ei_input.state == STATE_PROCESSING) {
+		err = -EBUSY;
+	} else {
+		ei_input_scale = scale;
+	}
+
+	k_spin_unlock(&ei_input.lock, key);
+
+	return err;
+}
+
 int ei_wrapper_clear_data(void)
 {
 	return buf_cleanup(&ei_input);
 }
 
+int ei_wrapper_start_continuous(size_t frame_shift)
+{
+	size_t shift = frame_shift * ei_wrapper_get_frame_size();
+
+	if ((shift == 0) || (shift > INPUT_WINDOW_SIZE) ||
+	    (CONTINUOUS_DSP && (shift != SLICE_SIZE))) {
+		return -EINVAL;
+	}
+
+	bool process_buf;
+	int err = buf_continuous_start(&ei_input, shift, &process_buf);
+
+	if (!err && process_buf) {
+		k_sem_give(&ei_sem);
+	}
+
+	return err;
+}
+
+int ei_wrapper_stop_continuous(void)
+{
+	return buf_continuous_stop(&ei_input);
+}
+
 int ei_wrapper_start_prediction(size_t window_shift, size_t frame_shift)
 {
 	size_t sample_shift = window_shift * ei_wrapper_get_window_size() +
@@ -263,7 +540,17 @@ int ei_wrapper_start_prediction(size_t window_shift, size_t frame_shift)
 
 static int raw_feature_get_data(size_t offset, size_t length, float *out_ptr)
 {
-	buf_get(&ei_input, out_ptr, offset, length);
+	const sample_t *data = buf_get(&ei_input, ei_slice_offset + offset,
+				       length);
+
+	if (DATA_INT16) {
+		/* Convert only the samples requested by the library. */
+		for (size_t i = 0; i < length; i++) {
+			out_ptr[i] = data[i] * ei_input_scale;
+		}
+	} else {
+		memcpy(out_ptr, data, length * sizeof(out_ptr[0]));
+	}
 
 	return 0;
 }
@@ -272,23 +559,90 @@ static void processing_finished(int err)
 {
 	__ASSERT_NO_MSG(user_cb);
 
+	if (!err) {
+		stats_add_prediction(&ei_stats, &ei_result.timing);
+	}
+
 	buf_processing_end(&ei_input);
 	user_cb(err);
+
+	/* The next window of continuous prediction is scheduled after the
+	 * callback, so that the user can stop the prediction from it.
+	 */
+	uint32_t dropped;
+	bool process_buf;
+
+	if (buf_continuous_next(&ei_input, (err != 0), &dropped,
+				&process_buf)) {
+		if (dropped) {
+			LOG_DBG("Dropped %u windows", dropped);
+			stats_add_dropped(&ei_stats, dropped);
+		}
+
+		if (process_buf) {
+			k_sem_give(&ei_sem);
+		}
+	}
 }
 
-static void edge_impulse_thread_fn(void)
+#ifdef CONFIG_EI_WRAPPER_CONTINUOUS_DSP
+static EI_IMPULSE_ERROR run_impulse_continuous(enum window_mode mode,
+					       signal_t *features_signal)
+{
+	EI_IMPULSE_ERROR err = EI_IMPULSE_OK;
+	size_t first_slice = SLICE_CNT - 1;
+
+	/* The library keeps the DSP results of the previous slices. If the
+	 * window does not follow the previous one, all of its slices must be
+	 * processed again.
+	 */
+	if (mode == WINDOW_RESTART) {
+		run_classifier_init();
+		first_slice = 0;
+	}
+
+	features_signal->total_length = SLICE_SIZE;
+
+	for (size_t slice = first_slice; (slice < SLICE_CNT) && !err;
+	     slice++) {
+		ei_slice_offset = slice * SLICE_SIZE;
+		err = run_classifier_continuous(features_signal, &ei_result,
+						DEBUG_MODE, false);
+	}
+
+	ei_slice_offset = 0;
+
+	return err;
+}
+#endif /* CONFIG_EI_WRAPPER_CONTINUOUS_DSP */
+
+static EI_IMPULSE_ERROR run_impulse(void)
 {
 	signal_t features_signal;
 
+	features_signal.get_data = &raw_feature_get_data;
+
+#ifdef CONFIG_EI_WRAPPER_CONTINUOUS_DSP
+	/* Window mode cannot change while processing is done. */
+	enum window_mode mode = ei_input.window_mode;
+
+	if (mode != WINDOW_SINGLE) {
+		return run_impulse_continuous(mode, &features_signal);
+	}
+#endif /* CONFIG_EI_WRAPPER_CONTINUOUS_DSP */
+
+	features_signal.total_length = INPUT_WINDOW_SIZE;
+
+	return run_classifier(&features_signal, &ei_result, DEBUG_MODE);
+}
+
+static void edge_impulse_thread_fn(void)
+{
 	while (true) {
 		k_sem_take(&ei_sem, K_FOREVER);
 
-		features_signal.get_data = &raw_feature_get_data;
-		features_signal.total_length = INPUT_WINDOW_SIZE;
-
 		/* Invoke the impulse. */
-		EI_IMPULSE_ERROR err = run_classifier(&features_signal,
-						      &ei_result, DEBUG_MODE);
+		EI_IMPULSE_ERROR err = run_impulse();
 
 		if (err) {
 			LOG_ERR("run_classifier err=%d", err);
@@ -353,6 +707,36 @@ int ei_wrapper_get_timing(int *dsp_time, int *classification_time,
 	return 0;
 }
 
+int ei_wrapper_get_stats(struct ei_wrapper_stats *stats)
+{
+	if (!stats) {
+		return -EINVAL;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&ei_stats.lock);
+
+	stats->prediction_cnt = ei_stats.prediction_cnt;
+	stats->dropped_cnt = ei_stats.dropped_cnt;
+	stats_timing_get(&ei_stats, TIMING_DSP, &stats->dsp);
+	stats_timing_get(&ei_stats, TIMING_CLASSIFICATION,
+			 &stats->classification);
+	stats_timing_get(&ei_stats, TIMING_ANOMALY, &stats->anomaly);
+
+	k_spin_unlock(&ei_stats.lock, key);
+
+	return 0;
+}
+
+void ei_wrapper_reset_stats(void)
+{
+	k_spinlock_key_t key = k_spin_lock(&ei_stats.lock);
+
+	ei_stats.prediction_cnt = 0;
+	ei_stats.dropped_cnt = 0;
+
+	k_spin_unlock(&ei_stats.lock, key);
+}
+
 int ei_wrapper_init(ei_wrapper_result_ready_cb cb)
 {
 	if (!cb) {
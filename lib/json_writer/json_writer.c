@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <json_writer.h>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr.h>
+
+/* Enough for "%1.17g" of any double and for any int64_t. */
+#define NUMBER_BUF_SIZE 26
+
+static void put(struct json_writer *writer, const char *data, size_t len)
+{
+	if ((writer->buf != NULL) && (writer->len < writer->size)) {
+		memcpy(&writer->buf[writer->len], data,
+		       MIN(len, writer->size - writer->len));
+	}
+
+	writer->len += len;
+}
+
+static void put_char(struct json_writer *writer, char c)
+{
+	if ((writer->buf != NULL) && (writer->len < writer->size)) {
+		writer->buf[writer->len] = c;
+	}
+
+	writer->len++;
+}
+
+static void value_start(struct json_writer *writer)
+{
+	if (writer->separate) {
+		put_char(writer, ',');
+	}
+}
+
+static void value_end(struct json_writer *writer)
+{
+	writer->separate = true;
+}
+
+static void string_put(struct json_writer *writer, const char *str)
+{
+	static const char hex[] = "0123456789abcdef";
+	const char *run = str;
+
+	put_char(writer, '"');
+
+	if (str == NULL) {
+		put_char(writer, '"');
+		return;
+	}
+
+	/* Copy runs of characters that need no escaping in one go. */
+	for (const char *p = str; *p != '\0'; p++) {
+		unsigned char c = *p;
+		char esc[6] = { '\\' };
+		size_t esc_len = 2;
+
+		if ((c > 31) && (c != '"') && (c != '\\')) {
+			continue;
+		}
+
+		switch (c) {
+		case '"':
+		case '\\':
+			esc[1] = c;
+			break;
+		case '\b':
+			esc[1] = 'b';
+			break;
+		case '\f':
+			esc[1] = 'f';
+			break;
+		case '\n':
+			esc[1] = 'n';
+			break;
+		case '\r':
+			esc[1] = 'r';
+			break;
+		case '\t':
+			esc[1] = 't';
+			break;
+		default:
+			esc[1] = 'u';
+			esc[2] = '0';
+			esc[3] = '0';
+			esc[4] = hex[c >> 4];
+			esc[5] = hex[c & 0xF];
+			esc_len = sizeof(esc);
+			break;
+		}
+
+		put(writer, run, p - run);
+		put(writer, esc, esc_len);
+		run = p + 1;
+	}
+
+	put(writer, run, strlen(run));
+	put_char(writer, '"');
+}
+
+void json_writer_init(struct json_writer *writer, char *buf, size_t size)
+{
+	__ASSERT_NO_MSG(writer != NULL);
+
+	writer->buf = buf;
+	writer->size = (buf != NULL) ? size : 0;
+	writer->len = 0;
+	writer->depth = 0;
+	writer->separate = false;
+}
+
+static void container_start(struct json_writer *writer, char c)
+{
+	value_start(writer);
+	put_char(writer, c);
+
+	writer->depth++;
+	writer->separate = false;
+}
+
+static void container_end(struct json_writer *writer, char c)
+{
+	__ASSERT(writer->depth > 0, "No container to end");
+
+	put_char(writer, c);
+
+	writer->depth--;
+	value_end(writer);
+}
+
+void json_writer_obj_start(struct json_writer *writer)
+{
+	container_start(writer, '{');
+}
+
+void json_writer_obj_end(struct json_writer *writer)
+{
+	container_end(writer, '}');
+}
+
+void json_writer_arr_start(struct json_writer *writer)
+{
+	container_start(writer, '[');
+}
+
+void json_writer_arr_end(struct json_writer *writer)
+{
+	container_end(writer, ']');
+}
+
+void json_writer_key(struct json_writer *writer, const char *key)
+{
+	value_start(writer);
+	string_put(writer, key);
+	put_char(writer, ':');
+
+	/* The value that follows belongs to the key. */
+	writer->separate = false;
+}
+
+void json_writer_str(struct json_writer *writer, const char *str)
+{
+	value_start(writer);
+	string_put(writer, str);
+	value_end(writer);
+}
+
+void json_writer_number(struct json_writer *writer, double value)
+{
+	char number[NUMBER_BUF_SIZE];
+	int len;
+
+	/* This checks for NaN and infinity. */
+	if ((value * 0) != 0) {
+		json_writer_null(writer);
+		return;
+	}
+
+	/* Same formatting as cJSON, 15 significant digits unless more are
+	 * needed to recover the value.
+	 */
+	len = snprintf(number, sizeof(number), "%1.15g", value);
+	if (strtod(number, NULL) != value) {
+		len = snprintf(number, sizeof(number), "%1.17g", value);
+	}
+
+	__ASSERT_NO_MSG((len > 0) && (len < sizeof(number)));
+
+	value_start(writer);
+	put(writer, number, len);
+	value_end(writer);
+}
+
+void json_writer_int(struct json_writer *writer, int64_t value)
+{
+	char number[NUMBER_BUF_SIZE];
+	char *p = &number[sizeof(number)];
+	uint64_t abs = (value < 0) ? -(uint64_t)value : (uint64_t)value;
+
+	do {
+		*--p = '0' + (abs % 10);
+		abs /= 10;
+	} while (abs > 0);
+
+	if (value < 0) {
+		*--p = '-';
+	}
+
+	value_start(writer);
+	put(writer, p, &number[sizeof(number)] - p);
+	value_end(writer);
+}
+
+void json_writer_bool(struct json_writer *writer, bool value)
+{
+	value_start(writer);
+	if (value) {
+		put(writer, "true", strlen("true"));
+	} else {
+		put(writer, "false", strlen("false"));
+	}
+	value_end(writer);
+}
+
+void json_writer_null(struct json_writer *writer)
+{
+	value_start(writer);
+	put(writer, "null", strlen("null"));
+	value_end(writer);
+}
+
+int json_writer_finish(struct json_writer *writer)
+{
+	__ASSERT(writer->depth == 0, "Unterminated container");
+
+	if (writer->len >= writer->size) {
+		return -ENOMEM;
+	}
+
+	writer->buf[writer->len] = '\0';
+
+	return 0;
+}
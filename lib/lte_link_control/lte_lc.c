@@ -536,10 +536,14 @@ static int w_lte_lc_init(void)
 		return err;
 	}
 
-	err = at_notif_register_handler(NULL, at_handler);
-	if (err) {
-		LOG_ERR("Can't register AT handler, error: %d", err);
-		return err;
+	for (size_t i = 0; i < ARRAY_SIZE(at_notifs); i++) {
+		err = at_notif_register_prefix_handler(NULL, at_notifs[i],
+						       at_handler);
+		if (err) {
+			LOG_ERR("Can't register AT handler, error: %d", err);
+			at_notif_deregister_handler(NULL, at_handler);
+			return err;
+		}
 	}
 
 	if (sys_mode_current != sys_mode_target) {
@@ -18,6 +18,8 @@
 #include <zephyr/types.h>
 #include <logging/log.h>
 
+#include "modem_info_cache.h"
+
 LOG_MODULE_REGISTER(modem_info);
 
 #define INVALID_DESCRIPTOR	-1
@@ -417,11 +419,19 @@ int modem_info_name_get(enum modem_info info, char *name)
 	return len;
 }
 
+const char *modem_info_cmd_get(enum modem_info info)
+{
+	if (info >= MODEM_INFO_COUNT) {
+		return NULL;
+	}
+
+	return modem_data[info]->cmd;
+}
+
 int modem_info_short_get(enum modem_info info, uint16_t *buf)
 {
 	int err;
 	char recv_buf[CONFIG_MODEM_INFO_BUFFER_SIZE] = {0};
-	int cmd_length = 0;
 
 	if (buf == NULL) {
 		return -EINVAL;
@@ -440,7 +450,19 @@ int modem_info_short_get(enum modem_info info, uint16_t *buf)
 		return -EIO;
 	}
 
-	err = modem_info_parse(modem_data[info], &recv_buf[cmd_length]);
+	return modem_info_rsp_short_parse(info, recv_buf, buf);
+}
+
+int modem_info_rsp_short_parse(enum modem_info info, const char *rsp,
+			       uint16_t *buf)
+{
+	int err;
+
+	if (modem_data[info]->data_type == AT_PARAM_TYPE_STRING) {
+		return -EINVAL;
+	}
+
+	err = modem_info_parse(modem_data[info], rsp);
 
 	if (err) {
 		return err;
@@ -462,6 +484,28 @@ int modem_info_string_get(enum modem_info info, char *buf,
 {
 	int err;
 	char recv_buf[CONFIG_MODEM_INFO_BUFFER_SIZE] = {0};
+
+	if ((buf == NULL) || (buf_size == 0)) {
+		return -EINVAL;
+	}
+
+	err = at_cmd_write(modem_data[info]->cmd,
+			  recv_buf,
+			  CONFIG_MODEM_INFO_BUFFER_SIZE,
+			  NULL);
+
+	/* The supported bands are copied even if the command failed. */
+	if ((err != 0) && (info != MODEM_INFO_SUP_BAND)) {
+		return -EIO;
+	}
+
+	return modem_info_rsp_string_parse(info, recv_buf, buf, buf_size);
+}
+
+int modem_info_rsp_string_parse(enum modem_info info, char *recv_buf,
+				char *buf, const size_t buf_size)
+{
+	int err;
 	uint16_t param_value;
 	int ip_cnt = 0;
 	char *ip_str_end = recv_buf;
@@ -478,11 +522,6 @@ int modem_info_string_get(enum modem_info info, char *buf,
 		return -EINVAL;
 	}
 
-	err = at_cmd_write(modem_data[info]->cmd,
-			  recv_buf,
-			  CONFIG_MODEM_INFO_BUFFER_SIZE,
-			  NULL);
-
 	/* modem_info does not yet support array objects, so here we handle
 	 * the supported bands independently as a string
 	 */
@@ -500,10 +539,6 @@ int modem_info_string_get(enum modem_info info, char *buf,
 		LOG_DBG("Device contains %d IP addresses", ip_cnt);
 	}
 
-	if (err != 0) {
-		return -EIO;
-	}
-
 parse:
 	if (info == MODEM_INFO_IP_ADDRESS) {
 		/* parse each IP address line separately */
@@ -636,7 +671,7 @@ int modem_info_rsrp_register(rsrp_cb_t cb)
 {
 	modem_info_rsrp_cb = cb;
 
-	int rc = at_notif_register_handler(NULL,
+	int rc = at_notif_register_prefix_handler(NULL, AT_CMD_CESQ_RESP,
 		modem_info_rsrp_subscribe_handler);
 	if (rc != 0) {
 		LOG_ERR("Can't register handler rc=%d", rc);
@@ -656,5 +691,9 @@ int modem_info_init(void)
 	int err = at_params_list_init(&m_param_list,
 				CONFIG_MODEM_INFO_MAX_AT_PARAMS_RSP);
 
+	if (!err && IS_ENABLED(CONFIG_MODEM_INFO_CACHE)) {
+		err = modem_info_cache_init();
+	}
+
 	return err;
 }
@@ -0,0 +1,547 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <sys/atomic.h>
+#include <modem/modem_info.h>
+#include <modem/at_cmd.h>
+#include <modem/at_cmd_parser.h>
+#include <modem/at_notif.h>
+#include <modem/at_params.h>
+#include <logging/log.h>
+
+#include "modem_info_cache.h"
+
+LOG_MODULE_REGISTER(modem_info_cache);
+
+#define AT_CMD_XMONITOR		"AT%XMONITOR"
+#define AT_NOTIF_CEREG		"+CEREG"
+
+/* One command reads the current band, operator, tracking area code and cell
+ * ID that would otherwise take three commands.
+ */
+#define XMONITOR_PLMN_INDEX	4
+#define XMONITOR_TAC_INDEX	5
+#define XMONITOR_BAND_INDEX	7
+#define XMONITOR_CELLID_INDEX	8
+#define XMONITOR_PARAM_COUNT	9
+/* String values are substrings of the response, each padded to the arena
+ * alignment.
+ */
+#define XMONITOR_VALUES_SIZE	(CONFIG_MODEM_INFO_CACHE_XMONITOR_BUFFER_SIZE + \
+				 XMONITOR_PARAM_COUNT * AT_PARAMS_ARENA_ALIGN)
+
+#define CEREG_STAT_INDEX	1
+#define CEREG_TAC_INDEX		2
+#define CEREG_CELLID_INDEX	3
+#define CEREG_PARAM_COUNT	4
+
+/* Tracking area code and cell ID strings, as hexadecimal numbers. */
+#define CELL_STR_SIZE		9
+#define CEREG_VALUES_SIZE	(2 * ROUND_UP(CELL_STR_SIZE, \
+					      AT_PARAMS_ARENA_ALIGN))
+
+#define CACHE_TTL_MS		(CONFIG_MODEM_INFO_CACHE_TTL * MSEC_PER_SEC)
+
+#define ADD_NETWORK		IS_ENABLED(CONFIG_MODEM_INFO_ADD_NETWORK)
+#define ADD_DATE_TIME		IS_ENABLED(CONFIG_MODEM_INFO_ADD_DATE_TIME)
+#define ADD_SIM			IS_ENABLED(CONFIG_MODEM_INFO_ADD_SIM)
+#define ADD_SIM_ICCID		(ADD_SIM && \
+				 IS_ENABLED(CONFIG_MODEM_INFO_ADD_SIM_ICCID))
+#define ADD_SIM_IMSI		(ADD_SIM && \
+				 IS_ENABLED(CONFIG_MODEM_INFO_ADD_SIM_IMSI))
+#define ADD_DEVICE		IS_ENABLED(CONFIG_MODEM_INFO_ADD_DEVICE)
+
+enum cache_group {
+	/* Read only when the cache expires or is invalidated. */
+	GROUP_STATIC,
+	/* Also read after a +CEREG notification reported a change. */
+	GROUP_NETWORK,
+	/* Read every time the parameters are requested. */
+	GROUP_VOLATILE,
+};
+
+enum cache_cmd {
+	CMD_SUP_BAND,
+	CMD_UE_MODE,
+	CMD_SYSTEMMODE,
+	CMD_UICC,
+	CMD_ICCID,
+	CMD_IMSI,
+	CMD_FW_VERSION,
+	CMD_IMEI,
+	CMD_XMONITOR,
+	CMD_PDP_CONTEXT,
+	CMD_BATTERY,
+	CMD_DATE_TIME,
+
+	CMD_COUNT
+};
+
+enum cache_flag {
+	FLAG_INVALID,
+	FLAG_NETWORK_STALE,
+};
+
+struct cache_cmd_desc {
+	/* Information type that the command is taken from. Not used for
+	 * %XMONITOR, which is not a command of any type.
+	 */
+	enum modem_info info;
+	enum cache_group group;
+};
+
+struct cache_field {
+	enum modem_info info;
+	enum cache_cmd cmd;
+	/* Offset of the parameter in struct modem_param_info. */
+	uint16_t offset;
+	/* Index of the value in the %XMONITOR response. */
+	uint8_t xmonitor_index;
+	bool enabled;
+};
+
+#define CACHE_FIELD(_info, _cmd, _member, _enabled)			\
+	{								\
+		.info = _info,						\
+		.cmd = _cmd,						\
+		.offset = offsetof(struct modem_param_info, _member),	\
+		.enabled = _enabled,					\
+	}
+
+#define XMONITOR_FIELD(_info, _member, _index)				\
+	{								\
+		.info = _info,						\
+		.cmd = CMD_XMONITOR,					\
+		.offset = offsetof(struct modem_param_info, _member),	\
+		.xmonitor_index = _index,				\
+		.enabled = ADD_NETWORK,					\
+	}
+
+static const struct cache_cmd_desc cmd_desc[] = {
+	[CMD_SUP_BAND]		= { MODEM_INFO_SUP_BAND, GROUP_STATIC },
+	[CMD_UE_MODE]		= { MODEM_INFO_UE_MODE, GROUP_STATIC },
+	[CMD_SYSTEMMODE]	= { MODEM_INFO_LTE_MODE, GROUP_STATIC },
+	[CMD_UICC]		= { MODEM_INFO_UICC, GROUP_STATIC },
+	[CMD_ICCID]		= { MODEM_INFO_ICCID, GROUP_STATIC },
+	[CMD_IMSI]		= { MODEM_INFO_IMSI, GROUP_STATIC },
+	[CMD_FW_VERSION]	= { MODEM_INFO_FW_VERSION, GROUP_STATIC },
+	[CMD_IMEI]		= { MODEM_INFO_IMEI, GROUP_STATIC },
+	[CMD_XMONITOR]		= { MODEM_INFO_COUNT, GROUP_NETWORK },
+	[CMD_PDP_CONTEXT]	= { MODEM_INFO_IP_ADDRESS, GROUP_NETWORK },
+	[CMD_BATTERY]		= { MODEM_INFO_BATTERY, GROUP_VOLATILE },
+	[CMD_DATE_TIME]	= { MODEM_INFO_DATE_TIME, GROUP_VOLATILE },
+};
+
+BUILD_ASSERT(ARRAY_SIZE(cmd_desc) == CMD_COUNT);
+
+static const struct cache_field cache_fields[] = {
+	XMONITOR_FIELD(MODEM_INFO_CUR_BAND, network.current_band,
+		       XMONITOR_BAND_INDEX),
+	CACHE_FIELD(MODEM_INFO_SUP_BAND, CMD_SUP_BAND, network.sup_band,
+		    ADD_NETWORK),
+	/* The APN must be parsed first, parsing the IP address modifies the
+	 * response.
+	 */
+	CACHE_FIELD(MODEM_INFO_APN, CMD_PDP_CONTEXT, network.apn,
+		    ADD_NETWORK),
+	CACHE_FIELD(MODEM_INFO_IP_ADDRESS, CMD_PDP_CONTEXT, network.ip_address,
+		    ADD_NETWORK),
+	CACHE_FIELD(MODEM_INFO_UE_MODE, CMD_UE_MODE, network.ue_mode,
+		    ADD_NETWORK),
+	XMONITOR_FIELD(MODEM_INFO_OPERATOR, network.current_operator,
+		       XMONITOR_PLMN_INDEX),
+	XMONITOR_FIELD(MODEM_INFO_CELLID, network.cellid_hex,
+		       XMONITOR_CELLID_INDEX),
+	XMONITOR_FIELD(MODEM_INFO_AREA_CODE, network.area_code,
+		       XMONITOR_TAC_INDEX),
+	CACHE_FIELD(MODEM_INFO_LTE_MODE, CMD_SYSTEMMODE, network.lte_mode,
+		    ADD_NETWORK),
+	CACHE_FIELD(MODEM_INFO_NBIOT_MODE, CMD_SYSTEMMODE, network.nbiot_mode,
+		    ADD_NETWORK),
+	CACHE_FIELD(MODEM_INFO_GPS_MODE, CMD_SYSTEMMODE, network.gps_mode,
+		    ADD_NETWORK),
+	CACHE_FIELD(MODEM_INFO_DATE_TIME, CMD_DATE_TIME, network.date_time,
+		    ADD_DATE_TIME),
+	CACHE_FIELD(MODEM_INFO_UICC, CMD_UICC, sim.uicc, ADD_SIM),
+	CACHE_FIELD(MODEM_INFO_ICCID, CMD_ICCID, sim.iccid, ADD_SIM_ICCID),
+	CACHE_FIELD(MODEM_INFO_IMSI, CMD_IMSI, sim.imsi, ADD_SIM_IMSI),
+	CACHE_FIELD(MODEM_INFO_FW_VERSION, CMD_FW_VERSION, device.modem_fw,
+		    ADD_DEVICE),
+	CACHE_FIELD(MODEM_INFO_BATTERY, CMD_BATTERY, device.battery,
+		    ADD_DEVICE),
+	CACHE_FIELD(MODEM_INFO_IMEI, CMD_IMEI, device.imei, ADD_DEVICE),
+};
+
+/* Last registration reported by +CEREG, used only from the notification
+ * handler.
+ */
+struct cereg_state {
+	int16_t stat;
+	char tac[CELL_STR_SIZE];
+	char cellid[CELL_STR_SIZE];
+};
+
+static K_MUTEX_DEFINE(cache_lock);
+static struct modem_param_info cache_snapshot;
+static char cache_rsp[CMD_COUNT][CONFIG_MODEM_INFO_BUFFER_SIZE];
+/* %XMONITOR is longer than the responses of the other commands. */
+static char xmonitor_rsp[CONFIG_MODEM_INFO_CACHE_XMONITOR_BUFFER_SIZE];
+static int64_t cache_refresh_time;
+static atomic_t cache_flags = ATOMIC_INIT(BIT(FLAG_INVALID));
+static bool cache_initialized;
+
+static struct modem_info_cache_stats cache_stats;
+static struct k_spinlock stats_lock;
+
+static struct at_param_list xmonitor_list;
+static AT_PARAMS_ARENA_DEFINE(xmonitor_arena, XMONITOR_PARAM_COUNT,
+			      XMONITOR_VALUES_SIZE);
+
+static struct at_param_list cereg_list;
+static AT_PARAMS_ARENA_DEFINE(cereg_arena, CEREG_PARAM_COUNT,
+			      CEREG_VALUES_SIZE);
+static struct cereg_state cereg_last;
+
+static struct lte_param *field_param(struct modem_param_info *modem,
+				     const struct cache_field *field)
+{
+	return (struct lte_param *)((uint8_t *)modem + field->offset);
+}
+
+static const char *cmd_get(enum cache_cmd cmd)
+{
+	if (cmd == CMD_XMONITOR) {
+		return AT_CMD_XMONITOR;
+	}
+
+	return modem_info_cmd_get(cmd_desc[cmd].info);
+}
+
+static char *rsp_get(enum cache_cmd cmd, size_t *size)
+{
+	if (cmd == CMD_XMONITOR) {
+		*size = sizeof(xmonitor_rsp);
+		return xmonitor_rsp;
+	}
+
+	*size = sizeof(cache_rsp[cmd]);
+	return cache_rsp[cmd];
+}
+
+static uint32_t cmds_get(uint32_t groups)
+{
+	uint32_t cmds = 0;
+
+	for (size_t i = 0; i < ARRAY_SIZE(cache_fields); i++) {
+		const struct cache_field *field = &cache_fields[i];
+
+		if (field->enabled &&
+		    (groups & BIT(cmd_desc[field->cmd].group))) {
+			cmds |= BIT(field->cmd);
+		}
+	}
+
+	return cmds;
+}
+
+static int string_param_get(const struct at_param_list *list, size_t index,
+			    char *buf, size_t buf_size)
+{
+	size_t len = buf_size - 1;
+	int err = at_params_string_get(list, index, buf, &len);
+
+	if (err) {
+		return err;
+	}
+
+	buf[len] = '\0';
+
+	return 0;
+}
+
+static int xmonitor_field_parse(const struct cache_field *field,
+				struct lte_param *param)
+{
+	if (modem_info_type_get(field->info) == AT_PARAM_TYPE_STRING) {
+		return string_param_get(&xmonitor_list, field->xmonitor_index,
+					param->value_string,
+					sizeof(param->value_string));
+	}
+
+	return at_params_short_get(&xmonitor_list, field->xmonitor_index,
+				   &param->value);
+}
+
+static int field_parse(const struct cache_field *field)
+{
+	struct lte_param *param = field_param(&cache_snapshot, field);
+	char *rsp = cache_rsp[field->cmd];
+	int ret;
+
+	if (field->cmd == CMD_XMONITOR) {
+		return xmonitor_field_parse(field, param);
+	}
+
+	if (modem_info_type_get(field->info) == AT_PARAM_TYPE_STRING) {
+		ret = modem_info_rsp_string_parse(field->info, rsp,
+						  param->value_string,
+						  sizeof(param->value_string));
+	} else {
+		ret = modem_info_rsp_short_parse(field->info, rsp,
+						 &param->value);
+	}
+
+	return (ret < 0) ? ret : 0;
+}
+
+static int cache_refresh(uint32_t groups)
+{
+	struct at_cmd_batch_item items[CMD_COUNT];
+	struct at_cmd_batch_stats batch_stats = { 0 };
+	uint32_t cmds = cmds_get(groups);
+	size_t cnt = 0;
+	int err;
+
+	for (size_t cmd = 0; cmd < CMD_COUNT; cmd++) {
+		if (!(cmds & BIT(cmd))) {
+			continue;
+		}
+
+		items[cnt].cmd = cmd_get(cmd);
+		items[cnt].buf = rsp_get(cmd, &items[cnt].buf_len);
+		memset(items[cnt].buf, 0, items[cnt].buf_len);
+		cnt++;
+	}
+
+	if (cnt == 0) {
+		return 0;
+	}
+
+	/* All the commands are sent in a single request. */
+	err = at_cmd_write_batch(items, cnt, true, &batch_stats);
+
+	k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+	cache_stats.at_cmd_cnt += batch_stats.exec_cnt;
+
+	k_spin_unlock(&stats_lock, key);
+
+	if (err) {
+		LOG_ERR("Modem data not obtained: %d", err);
+		return -EIO;
+	}
+
+	if (cmds & BIT(CMD_XMONITOR)) {
+		err = at_parser_max_params_from_str(xmonitor_rsp, NULL,
+						    &xmonitor_list,
+						    XMONITOR_PARAM_COUNT);
+		/* Only the leading parameters are stored, the list being
+		 * full is expected.
+		 */
+		if (err && (err != -EAGAIN) && (err != -E2BIG)) {
+			LOG_ERR("Unable to parse %%XMONITOR: %d", err);
+			return err;
+		}
+
+		/* The cell is reported only when the device is registered. */
+		if (at_params_valid_count_get(&xmonitor_list) <
+		    XMONITOR_PARAM_COUNT) {
+			LOG_ERR("Incomplete %%XMONITOR response");
+			return -EBADMSG;
+		}
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(cache_fields); i++) {
+		const struct cache_field *field = &cache_fields[i];
+
+		if (!(cmds & BIT(field->cmd)) || !field->enabled) {
+			continue;
+		}
+
+		err = field_parse(field);
+		if (err) {
+			LOG_ERR("Link data not obtained: %d %d", field->info,
+				err);
+			return err;
+		}
+	}
+
+	return 0;
+}
+
+static void cereg_notif_handler(void *context, const char *notif)
+{
+	ARG_UNUSED(context);
+
+	struct cereg_state cereg = { 0 };
+	int err;
+
+	err = at_parser_max_params_from_str(notif, NULL, &cereg_list,
+					    CEREG_PARAM_COUNT);
+	if (err && (err != -EAGAIN) && (err != -E2BIG)) {
+		LOG_ERR("Unable to parse +CEREG: %d", err);
+		return;
+	}
+
+	err = at_params_short_get(&cereg_list, CEREG_STAT_INDEX, &cereg.stat);
+	if (err) {
+		LOG_ERR("Registration status not obtained: %d", err);
+		return;
+	}
+
+	/* The cell is reported only when the device is registered. */
+	if (string_param_get(&cereg_list, CEREG_TAC_INDEX, cereg.tac,
+			     sizeof(cereg.tac))) {
+		cereg.tac[0] = '\0';
+	}
+
+	if (string_param_get(&cereg_list, CEREG_CELLID_INDEX, cereg.cellid,
+			     sizeof(cereg.cellid))) {
+		cereg.cellid[0] = '\0';
+	}
+
+	if ((cereg.stat == cereg_last.stat) &&
+	    !strcmp(cereg.tac, cereg_last.tac) &&
+	    !strcmp(cereg.cellid, cereg_last.cellid)) {
+		return;
+	}
+
+	cereg_last = cereg;
+	atomic_set_bit(&cache_flags, FLAG_NETWORK_STALE);
+
+	k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+	cache_stats.notif_cnt++;
+
+	k_spin_unlock(&stats_lock, key);
+}
+
+int modem_info_cache_params_get(struct modem_param_info *modem)
+{
+	uint32_t start = k_cycle_get_32();
+	uint32_t groups = BIT(GROUP_VOLATILE);
+	int err;
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	/* Flags are cleared before the refresh, so that a notification
+	 * received during the refresh is not lost.
+	 */
+	bool expired = atomic_test_and_clear_bit(&cache_flags, FLAG_INVALID) ||
+		       (k_uptime_get() - cache_refresh_time >= CACHE_TTL_MS);
+	bool stale = atomic_test_and_clear_bit(&cache_flags,
+					       FLAG_NETWORK_STALE);
+
+	if (expired) {
+		groups |= BIT(GROUP_STATIC) | BIT(GROUP_NETWORK);
+	} else if (stale) {
+		groups |= BIT(GROUP_NETWORK);
+	}
+
+	err = cache_refresh(groups);
+
+	if (err) {
+		if (expired) {
+			atomic_set_bit(&cache_flags, FLAG_INVALID);
+		}
+
+		if (stale) {
+			atomic_set_bit(&cache_flags, FLAG_NETWORK_STALE);
+		}
+	} else {
+		if (expired) {
+			cache_refresh_time = k_uptime_get();
+		}
+
+		for (size_t i = 0; i < ARRAY_SIZE(cache_fields); i++) {
+			const struct cache_field *field = &cache_fields[i];
+
+			if (field->enabled) {
+				*field_param(modem, field) =
+					*field_param(&cache_snapshot, field);
+			}
+		}
+	}
+
+	k_mutex_unlock(&cache_lock);
+
+	uint32_t time_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+	k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+	cache_stats.read_cnt++;
+	if (!err && expired) {
+		cache_stats.full_refresh_cnt++;
+	} else if (!err && stale) {
+		cache_stats.network_refresh_cnt++;
+	}
+	cache_stats.last_read_us = time_us;
+	cache_stats.max_read_us = MAX(cache_stats.max_read_us, time_us);
+
+	k_spin_unlock(&stats_lock, key);
+
+	return err ? -EAGAIN : 0;
+}
+
+void modem_info_cache_invalidate(void)
+{
+	atomic_set_bit(&cache_flags, FLAG_INVALID);
+}
+
+int modem_info_cache_stats_get(struct modem_info_cache_stats *stats)
+{
+	if (stats == NULL) {
+		return -EINVAL;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&stats_lock);
+
+	*stats = cache_stats;
+
+	k_spin_unlock(&stats_lock, key);
+
+	return 0;
+}
+
+int modem_info_cache_init(void)
+{
+	int err;
+
+	k_mutex_lock(&cache_lock, K_FOREVER);
+
+	if (cache_initialized) {
+		k_mutex_unlock(&cache_lock);
+		return 0;
+	}
+
+	err = at_params_list_init_arena(&xmonitor_list, XMONITOR_PARAM_COUNT,
+					xmonitor_arena,
+					sizeof(xmonitor_arena));
+	if (!err) {
+		err = at_params_list_init_arena(&cereg_list, CEREG_PARAM_COUNT,
+						cereg_arena,
+						sizeof(cereg_arena));
+	}
+
+	if (!err) {
+		err = modem_info_params_init(&cache_snapshot);
+	}
+
+	if (!err) {
+		err = at_notif_register_prefix_handler(NULL, AT_NOTIF_CEREG,
+						       cereg_notif_handler);
+		if (err) {
+			LOG_ERR("Can't register handler err=%d", err);
+		}
+	}
+
+	cache_initialized = !err;
+
+	k_mutex_unlock(&cache_lock);
+
+	return err;
+}
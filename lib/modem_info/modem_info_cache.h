@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef MODEM_INFO_CACHE_H_
+#define MODEM_INFO_CACHE_H_
+
+#include <modem/modem_info.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Get the AT command used to read the information type. */
+const char *modem_info_cmd_get(enum modem_info info);
+
+/* Parse a short value from a response to the command of the information
+ * type.
+ */
+int modem_info_rsp_short_parse(enum modem_info info, const char *rsp,
+			       uint16_t *buf);
+
+/* Parse a value from a response to the command of the information type and
+ * store it as a string. The response buffer is modified while parsing.
+ */
+int modem_info_rsp_string_parse(enum modem_info info, char *rsp,
+				char *buf, const size_t buf_size);
+
+/* Initialize the cache and subscribe to the notifications that invalidate
+ * it.
+ */
+int modem_info_cache_init(void);
+
+/* Copy the cached modem parameters, refreshing the stale ones. Values derived
+ * from the parameters, like MCC and MNC, are not set.
+ */
+int modem_info_cache_params_get(struct modem_param_info *modem);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MODEM_INFO_CACHE_H_ */
@@ -11,6 +11,8 @@
 #include <modem/at_params.h>
 #include <logging/log.h>
 
+#include "modem_info_cache.h"
+
 LOG_MODULE_REGISTER(modem_info_params);
 
 int modem_info_params_init(struct modem_param_info *modem)
@@ -128,6 +130,38 @@ static int modem_data_get(struct lte_param *param)
 	return 0;
 }
 
+static int network_data_parse(struct network_param *network)
+{
+	int ret;
+
+	ret = mcc_mnc_parse(&network->current_operator,
+			    &network->mcc,
+			    &network->mnc);
+	ret += cellid_to_dec(&network->cellid_hex, &network->cellid_dec);
+	ret += area_code_parse(&network->area_code);
+
+	return ret;
+}
+
+static int cached_params_get(struct modem_param_info *modem)
+{
+	int ret = modem_info_cache_params_get(modem);
+
+	if (ret) {
+		return ret;
+	}
+
+	if (IS_ENABLED(CONFIG_MODEM_INFO_ADD_NETWORK)) {
+		ret = network_data_parse(&modem->network);
+		if (ret) {
+			LOG_ERR("Network data not obtained: %d", ret);
+			return -EAGAIN;
+		}
+	}
+
+	return 0;
+}
+
 int modem_info_params_get(struct modem_param_info *modem)
 {
 	int ret;
@@ -136,6 +170,10 @@ int modem_info_params_get(struct modem_param_info *modem)
 		return -EINVAL;
 	}
 
+	if (IS_ENABLED(CONFIG_MODEM_INFO_CACHE)) {
+		return cached_params_get(modem);
+	}
+
 	if (IS_ENABLED(CONFIG_MODEM_INFO_ADD_NETWORK)) {
 		ret = modem_data_get(&modem->network.current_band);
 		ret += modem_data_get(&modem->network.sup_band);
@@ -153,12 +191,7 @@ int modem_info_params_get(struct modem_param_info *modem)
 			ret += modem_data_get(&modem->network.date_time);
 		}
 
-		ret += mcc_mnc_parse(&modem->network.current_operator,
-				&modem->network.mcc,
-				&modem->network.mnc);
-		ret += cellid_to_dec(&modem->network.cellid_hex,
-				&modem->network.cellid_dec);
-		ret += area_code_parse(&modem->network.area_code);
+		ret += network_data_parse(&modem->network);
 		if (ret) {
 			LOG_ERR("Network data not obtained: %d", ret);
 			return -EAGAIN;
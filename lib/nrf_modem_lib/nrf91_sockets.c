@@ -22,6 +22,9 @@
 #include <sys/fdtable.h>
 #include <zephyr.h>
 #include <nrf_gai_errors.h>
+#include <modem/nrf91_poll_set.h>
+
+#include "nrf91_sockets_internal.h"
 
 #if defined(CONFIG_NET_SOCKETS_OFFLOAD)
 
@@ -31,14 +34,108 @@
 
 #define PROTO_WILDCARD 0
 
-/* Increment by 1 to make sure we do not store the value of 0, which has
- * a special meaning in the fdtable subsys.
- */
-#define SD_TO_OBJ(sd) ((void *)(sd + 1))
-#define OBJ_TO_SD(obj) (((int)obj) - 1)
+/* Offloaded socket context, stored as the object of the fdtable entry. */
+struct nrf_sock_ctx {
+	int nrf_fd; /* nRF socket descriptor */
+	bool in_use;
+	/* Serializes the senders of the socket, so that the parts of a
+	 * message sent by sendmsg are not interleaved with other data.
+	 */
+	struct k_mutex send_lock;
+	/* Buffer used by sendmsg to coalesce small message parts. */
+	uint8_t send_buf[CONFIG_NRF_MODEM_LIB_SENDMSG_BUF_SIZE];
+#if defined(CONFIG_NRF91_SOCKET_POLL_SET)
+	struct nrf91_poll_set *poll_set; /* Poll set of the socket, if any */
+	int fd; /* Zephyr file descriptor, reported by the poll set */
+	short poll_events; /* Requested events */
+	short poll_revents; /* Last known returned events */
+#endif
+};
+
+#define OBJ_TO_SD(obj) (((struct nrf_sock_ctx *)(obj))->nrf_fd)
+
+static struct nrf_sock_ctx offload_ctx[NRF_MODEM_MAX_SOCKET_COUNT];
+static K_MUTEX_DEFINE(ctx_lock);
 
 static const struct socket_op_vtable nrf91_socket_fd_op_vtable;
 
+static struct nrf_sock_ctx *allocate_ctx(int nrf_fd)
+{
+	struct nrf_sock_ctx *ctx = NULL;
+
+	k_mutex_lock(&ctx_lock, K_FOREVER);
+
+	for (int i = 0; i < ARRAY_SIZE(offload_ctx); i++) {
+		if (!offload_ctx[i].in_use) {
+			ctx = &offload_ctx[i];
+			ctx->nrf_fd = nrf_fd;
+			ctx->in_use = true;
+			k_mutex_init(&ctx->send_lock);
+			break;
+		}
+	}
+
+	k_mutex_unlock(&ctx_lock);
+
+	return ctx;
+}
+
+static void release_ctx(struct nrf_sock_ctx *ctx)
+{
+	k_mutex_lock(&ctx_lock, K_FOREVER);
+	ctx->in_use = false;
+	k_mutex_unlock(&ctx_lock);
+}
+
+#if defined(CONFIG_NRF91_SOCKET_POLL_SET)
+static void poll_set_scan(struct k_work *work);
+
+/* Protects the poll set members, their events and the statistics. */
+static K_MUTEX_DEFINE(poll_set_lock);
+static K_WORK_DEFINE(poll_set_work, poll_set_scan);
+static atomic_t poll_set_member_cnt;
+static struct nrf91_poll_set_stats poll_set_stats;
+
+/* Forget events of a socket in a poll set after data was received or sent,
+ * until the next scan tells whether the socket is still ready.
+ */
+static void poll_set_consume(struct nrf_sock_ctx *ctx, short events)
+{
+	if (atomic_get(&poll_set_member_cnt) == 0) {
+		return;
+	}
+
+	k_mutex_lock(&poll_set_lock, K_FOREVER);
+
+	if (ctx->poll_set != NULL) {
+		ctx->poll_revents &= ~events;
+		k_work_submit(&poll_set_work);
+	}
+
+	k_mutex_unlock(&poll_set_lock);
+}
+
+static void poll_set_close(struct nrf_sock_ctx *ctx)
+{
+	k_mutex_lock(&poll_set_lock, K_FOREVER);
+
+	if (ctx->poll_set != NULL) {
+		ctx->poll_set = NULL;
+		atomic_dec(&poll_set_member_cnt);
+	}
+
+	k_mutex_unlock(&poll_set_lock);
+}
+#else
+static inline void poll_set_consume(struct nrf_sock_ctx *ctx, short events)
+{
+}
+
+static inline void poll_set_close(struct nrf_sock_ctx *ctx)
+{
+}
+#endif /* defined(CONFIG_NRF91_SOCKET_POLL_SET) */
+
 static void z_to_nrf_ipv4(const struct sockaddr *z_in,
 			  struct nrf_sockaddr_in *nrf_out)
 {
@@ -535,6 +632,7 @@ static int nrf91_socket_offload_accept(void *obj, struct sockaddr *addr,
 	int fd = z_reserve_fd();
 	int sd = OBJ_TO_SD(obj);
 	int new_sd;
+	struct nrf_sock_ctx *ctx;
 	struct nrf_sockaddr *nrf_addr_ptr = NULL;
 	nrf_socklen_t *nrf_addrlen_ptr = NULL;
 	/* Use `struct nrf_sockaddr_in6` to fit both, IPv4 and IPv6 */
@@ -580,7 +678,14 @@ static int nrf91_socket_offload_accept(void *obj, struct sockaddr *addr,
 		}
 	}
 
-	z_finalize_fd(fd, SD_TO_OBJ(new_sd),
+	ctx = allocate_ctx(new_sd);
+	if (ctx == NULL) {
+		nrf_close(new_sd);
+		errno = ENOMEM;
+		goto error;
+	}
+
+	z_finalize_fd(fd, ctx,
 		      (const struct fd_op_vtable *)&nrf91_socket_fd_op_vtable);
 
 	return fd;
@@ -785,6 +890,8 @@ static ssize_t nrf91_socket_offload_recvfrom(void *obj, void *buf, size_t len,
 		}
 	}
 
+	poll_set_consume(obj, POLLIN);
+
 	return retval;
 }
 
@@ -821,6 +928,8 @@ static ssize_t nrf91_socket_offload_sendto(void *obj, const void *buf,
 		goto error;
 	}
 
+	poll_set_consume(obj, POLLOUT);
+
 	return retval;
 
 error:
@@ -829,88 +938,161 @@ error:
 	return retval;
 }
 
+/* Copy message parts to the buffer, starting at the given position, until
+ * the buffer is full or the parts are exhausted. Returns the number of bytes
+ * copied.
+ */
+static size_t sendmsg_gather(uint8_t *buf, size_t size,
+			     const struct msghdr *msg, size_t iov_idx,
+			     size_t iov_off)
+{
+	size_t len = 0;
+
+	for (; (iov_idx < msg->msg_iovlen) && (len < size); iov_idx++) {
+		const struct iovec *iov = &msg->msg_iov[iov_idx];
+		size_t part = MIN(iov->iov_len - iov_off, size - len);
+
+		memcpy(buf + len, (const uint8_t *)iov->iov_base + iov_off,
+		       part);
+		len += part;
+		iov_off = 0;
+	}
+
+	return len;
+}
+
+/* Move the position in the message forward by the given number of bytes. */
+static void sendmsg_advance(const struct msghdr *msg, size_t *iov_idx,
+			    size_t *iov_off, size_t len)
+{
+	while (len > 0) {
+		size_t part = MIN(msg->msg_iov[*iov_idx].iov_len - *iov_off,
+				  len);
+
+		*iov_off += part;
+		len -= part;
+
+		if (*iov_off == msg->msg_iov[*iov_idx].iov_len) {
+			(*iov_idx)++;
+			*iov_off = 0;
+		}
+	}
+}
+
 static ssize_t nrf91_socket_offload_sendmsg(void *obj, const struct msghdr *msg,
 					    int flags)
 {
-	ssize_t len = 0;
-	ssize_t ret;
-	ssize_t offset;
-	int i;
-	static K_MUTEX_DEFINE(sendmsg_lock);
-	static uint8_t buf[CONFIG_NRF_MODEM_LIB_SENDMSG_BUF_SIZE];
+	struct nrf_sock_ctx *ctx = obj;
+	k_timeout_t timeout = K_FOREVER;
+	size_t remaining = 0;
+	size_t sent = 0;
+	size_t iov_idx = 0;
+	size_t iov_off = 0;
+	ssize_t ret = 0;
 
 	if (msg == NULL) {
 		errno = EINVAL;
 		return -1;
 	}
 
-	/* The standard POSIX definition of sendmsg says it should return
-	 * EWOULDBLOCK if the socket is in NONBLOCK mode and handed too much data.
-	 * This implementation doesn't meet that requirement and will always
-	 * block, even in NONBLOCK mode.  See POSIX.1-2017:
-	 * <http://pubs.opengroup.org/onlinepubs/9699919799/functions/sendmsg.html>
-	 */
+	for (size_t i = 0; i < msg->msg_iovlen; i++) {
+		remaining += msg->msg_iov[i].iov_len;
+	}
 
-	/* Try to reduce number of `sendto` calls - copy data if they fit into
-	 * a single buffer
-	 */
+	if (flags & MSG_DONTWAIT) {
+		timeout = K_NO_WAIT;
+	}
 
-	for (i = 0; i < msg->msg_iovlen; i++) {
-		len += msg->msg_iov[i].iov_len;
+	/* Only the senders of this socket are serialized, the buffer is not
+	 * shared with other sockets.
+	 */
+	if (k_mutex_lock(&ctx->send_lock, timeout) != 0) {
+		errno = EAGAIN;
+		return -1;
 	}
 
-	if (len <= sizeof(buf)) {
-		/* Protect `buf` access with a mutex. */
-		k_mutex_lock(&sendmsg_lock, K_FOREVER);
-		len = 0;
+	while (remaining > 0) {
+		const uint8_t *data;
+		size_t len;
 
-		for (i = 0; i < msg->msg_iovlen; i++) {
-			memcpy(buf + len, msg->msg_iov[i].iov_base,
-			       msg->msg_iov[i].iov_len);
-			len += msg->msg_iov[i].iov_len;
+		/* Skip the parts which are sent or empty */
+		while (iov_off == msg->msg_iov[iov_idx].iov_len) {
+			iov_idx++;
+			iov_off = 0;
 		}
 
-		offset = 0;
-		ret = 0;
-		while ((offset < len) && (ret >= 0)) {
-			ret = nrf91_socket_offload_sendto(obj,
-				(buf + offset), (len - offset), flags,
-				msg->msg_name, msg->msg_namelen);
-			if (ret > 0) {
-				offset += ret;
-			}
+		data = (const uint8_t *)msg->msg_iov[iov_idx].iov_base +
+		       iov_off;
+		len = msg->msg_iov[iov_idx].iov_len - iov_off;
+
+		/* A part that fills the buffer, or the last part, is sent
+		 * without copying. Smaller parts are coalesced with the
+		 * following ones to reduce the number of `sendto` calls.
+		 */
+		if ((len < remaining) && (len < sizeof(ctx->send_buf))) {
+			len = sendmsg_gather(ctx->send_buf,
+					     sizeof(ctx->send_buf), msg,
+					     iov_idx, iov_off);
+			data = ctx->send_buf;
 		}
 
-		k_mutex_unlock(&sendmsg_lock);
-		return ret;
+		ret = nrf91_socket_offload_sendto(obj, data, len, flags,
+						  msg->msg_name,
+						  msg->msg_namelen);
+		if (ret <= 0) {
+			break;
+		}
+
+		sendmsg_advance(msg, &iov_idx, &iov_off, ret);
+		sent += ret;
+		remaining -= ret;
 	}
 
-	/* If the data won't fit into intermediate buffer, send the buffers
-	 * separately
-	 */
+	k_mutex_unlock(&ctx->send_lock);
 
-	len = 0;
+	/* Report the data accepted before an error, like a partial `send`. */
+	if (sent > 0) {
+		return sent;
+	}
 
-	for (i = 0; i < msg->msg_iovlen; i++) {
-		if (msg->msg_iov[i].iov_len == 0) {
-			continue;
-		}
+	return ret;
+}
 
-		offset = 0;
-		while (offset < msg->msg_iov[i].iov_len) {
-			ret = nrf91_socket_offload_sendto(obj,
-				(((uint8_t *) msg->msg_iov[i].iov_base) + offset),
-				(msg->msg_iov[i].iov_len - offset), flags,
-				msg->msg_name, msg->msg_namelen);
-			if (ret < 0) {
-				return ret;
-			}
-			offset += ret;
-			len += ret;
-		}
+static short z_to_nrf_poll_events(short z_events)
+{
+	short nrf_events = 0;
+
+	if (z_events & POLLIN) {
+		nrf_events |= NRF_POLLIN;
+	}
+	if (z_events & POLLOUT) {
+		nrf_events |= NRF_POLLOUT;
 	}
 
-	return len;
+	return nrf_events;
+}
+
+static short nrf_to_z_poll_events(short nrf_revents)
+{
+	short z_revents = 0;
+
+	if (nrf_revents & NRF_POLLIN) {
+		z_revents |= POLLIN;
+	}
+	if (nrf_revents & NRF_POLLOUT) {
+		z_revents |= POLLOUT;
+	}
+	if (nrf_revents & NRF_POLLERR) {
+		z_revents |= POLLERR;
+	}
+	if (nrf_revents & NRF_POLLNVAL) {
+		z_revents |= POLLNVAL;
+	}
+	if (nrf_revents & NRF_POLLHUP) {
+		z_revents |= POLLHUP;
+	}
+
+	return z_revents;
 }
 
 static inline int nrf91_socket_offload_poll(struct pollfd *fds, int nfds,
@@ -944,12 +1126,7 @@ static inline int nrf91_socket_offload_poll(struct pollfd *fds, int nfds,
 		}
 
 		/* Translate the API from native to nRF */
-		if (fds[i].events & POLLIN) {
-			tmp[i].events |= NRF_POLLIN;
-		}
-		if (fds[i].events & POLLOUT) {
-			tmp[i].events |= NRF_POLLOUT;
-		}
+		tmp[i].events = z_to_nrf_poll_events(fds[i].events);
 	}
 
 	if (retval > 0) {
@@ -965,26 +1142,217 @@ static inline int nrf91_socket_offload_poll(struct pollfd *fds, int nfds,
 			continue;
 		}
 
-		if (tmp[i].revents & NRF_POLLIN) {
-			fds[i].revents |= POLLIN;
+		fds[i].revents = nrf_to_z_poll_events(tmp[i].revents);
+	}
+
+	return retval;
+}
+
+#if defined(CONFIG_NRF91_SOCKET_POLL_SET)
+/* Update the known events of a socket, and mark its poll set for wakeup when
+ * an event that is waited for is raised.
+ */
+static void poll_set_update(struct nrf_sock_ctx *ctx, short revents)
+{
+	short raised = revents & ~ctx->poll_revents;
+
+	if (revents != ctx->poll_revents) {
+		ctx->poll_revents = revents;
+		poll_set_stats.change_cnt++;
+	}
+
+	if (raised & (ctx->poll_events | POLLERR | POLLHUP | POLLNVAL)) {
+		ctx->poll_set->wake = true;
+	}
+}
+
+static void poll_set_scan(struct k_work *work)
+{
+	struct nrf_pollfd fds[NRF_MODEM_MAX_SOCKET_COUNT];
+	struct nrf_sock_ctx *members[NRF_MODEM_MAX_SOCKET_COUNT];
+	int nfds = 0;
+
+	ARG_UNUSED(work);
+
+	k_mutex_lock(&poll_set_lock, K_FOREVER);
+
+	for (int i = 0; i < ARRAY_SIZE(offload_ctx); i++) {
+		struct nrf_sock_ctx *ctx = &offload_ctx[i];
+
+		if (ctx->poll_set == NULL) {
+			continue;
 		}
-		if (tmp[i].revents & NRF_POLLOUT) {
-			fds[i].revents |= POLLOUT;
+
+		fds[nfds].fd = ctx->nrf_fd;
+		fds[nfds].events = z_to_nrf_poll_events(ctx->poll_events);
+		fds[nfds].revents = 0;
+		members[nfds++] = ctx;
+	}
+
+	/* The sockets of all poll sets are checked at once, without
+	 * blocking, and only the poll sets with new events are woken up.
+	 */
+	if ((nfds > 0) && (nrf_poll(fds, nfds, 0) >= 0)) {
+		poll_set_stats.scan_cnt++;
+
+		for (int i = 0; i < nfds; i++) {
+			poll_set_update(members[i],
+					nrf_to_z_poll_events(fds[i].revents));
 		}
-		if (tmp[i].revents & NRF_POLLERR) {
-			fds[i].revents |= POLLERR;
+
+		for (int i = 0; i < nfds; i++) {
+			struct nrf91_poll_set *set = members[i]->poll_set;
+
+			if (set->wake) {
+				set->wake = false;
+				poll_set_stats.wakeup_cnt++;
+				k_sem_give(&set->sem);
+			}
 		}
-		if (tmp[i].revents & NRF_POLLNVAL) {
-			fds[i].revents |= POLLNVAL;
+	}
+
+	k_mutex_unlock(&poll_set_lock);
+}
+
+static int poll_set_collect(struct nrf91_poll_set *set,
+			    struct zsock_pollfd *fds, int nfds)
+{
+	int cnt = 0;
+
+	k_mutex_lock(&poll_set_lock, K_FOREVER);
+
+	for (int i = 0; (i < ARRAY_SIZE(offload_ctx)) && (cnt < nfds); i++) {
+		struct nrf_sock_ctx *ctx = &offload_ctx[i];
+		short revents;
+
+		if (ctx->poll_set != set) {
+			continue;
 		}
-		if (tmp[i].revents & NRF_POLLHUP) {
-			fds[i].revents |= POLLHUP;
+
+		revents = ctx->poll_revents &
+			  (ctx->poll_events | POLLERR | POLLHUP | POLLNVAL);
+		if (revents) {
+			fds[cnt].fd = ctx->fd;
+			fds[cnt].events = ctx->poll_events;
+			fds[cnt].revents = revents;
+			cnt++;
 		}
 	}
 
-	return retval;
+	k_mutex_unlock(&poll_set_lock);
+
+	return cnt;
+}
+
+static struct nrf_sock_ctx *poll_set_ctx_get(int fd)
+{
+	return z_get_fd_obj(fd, (const struct fd_op_vtable *)
+				&nrf91_socket_fd_op_vtable, ENOTSUP);
+}
+
+void nrf91_socket_event_notify(void)
+{
+	if (atomic_get(&poll_set_member_cnt) > 0) {
+		k_work_submit(&poll_set_work);
+	}
+}
+
+void nrf91_poll_set_init(struct nrf91_poll_set *set)
+{
+	k_sem_init(&set->sem, 0, 1);
+	set->wake = false;
 }
 
+int nrf91_poll_set_add(struct nrf91_poll_set *set, int fd, short events)
+{
+	struct nrf_sock_ctx *ctx = poll_set_ctx_get(fd);
+	int err = 0;
+
+	if (ctx == NULL) {
+		return -EBADF;
+	}
+
+	k_mutex_lock(&poll_set_lock, K_FOREVER);
+
+	if (ctx->poll_set != NULL) {
+		err = -EEXIST;
+	} else {
+		ctx->poll_set = set;
+		ctx->fd = fd;
+		ctx->poll_events = events;
+		ctx->poll_revents = 0;
+		atomic_inc(&poll_set_member_cnt);
+
+		/* Get the current events of the socket */
+		k_work_submit(&poll_set_work);
+	}
+
+	k_mutex_unlock(&poll_set_lock);
+
+	return err;
+}
+
+int nrf91_poll_set_remove(struct nrf91_poll_set *set, int fd)
+{
+	struct nrf_sock_ctx *ctx = poll_set_ctx_get(fd);
+	int err = 0;
+
+	if (ctx == NULL) {
+		return -EBADF;
+	}
+
+	k_mutex_lock(&poll_set_lock, K_FOREVER);
+
+	if (ctx->poll_set != set) {
+		err = -ENOENT;
+	} else {
+		ctx->poll_set = NULL;
+		atomic_dec(&poll_set_member_cnt);
+	}
+
+	k_mutex_unlock(&poll_set_lock);
+
+	return err;
+}
+
+int nrf91_poll_set_wait(struct nrf91_poll_set *set, struct zsock_pollfd *fds,
+			int nfds, int32_t timeout)
+{
+	int64_t start = k_uptime_get();
+	int32_t remaining = timeout;
+	int cnt;
+
+	k_mutex_lock(&poll_set_lock, K_FOREVER);
+	poll_set_stats.wait_cnt++;
+	k_mutex_unlock(&poll_set_lock);
+
+	for (;;) {
+		cnt = poll_set_collect(set, fds, nfds);
+		if (cnt > 0) {
+			break;
+		}
+
+		if (timeout != SYS_FOREVER_MS) {
+			remaining = MAX(timeout - (k_uptime_get() - start), 0);
+			if (remaining == 0) {
+				break;
+			}
+		}
+
+		(void)k_sem_take(&set->sem, SYS_TIMEOUT_MS(remaining));
+	}
+
+	return cnt;
+}
+
+void nrf91_poll_set_stats_get(struct nrf91_poll_set_stats *stats)
+{
+	k_mutex_lock(&poll_set_lock, K_FOREVER);
+	*stats = poll_set_stats;
+	k_mutex_unlock(&poll_set_lock);
+}
+#endif /* defined(CONFIG_NRF91_SOCKET_POLL_SET) */
+
 static void nrf91_socket_offload_freeaddrinfo(struct zsock_addrinfo *root)
 {
 	struct zsock_addrinfo *next = root;
@@ -1173,8 +1541,19 @@ static ssize_t nrf91_socket_offload_write(void *obj, const void *buffer,
 static int nrf91_socket_offload_close(void *obj)
 {
 	int sd = OBJ_TO_SD(obj);
+	int retval;
+
+	/* Leave the poll set first, so that the socket is not scanned after
+	 * its descriptor is released and possibly reused.
+	 */
+	poll_set_close(obj);
+
+	retval = nrf_close(sd);
 
-	return nrf_close(sd);
+	/* The fdtable entry is freed even if closing fails */
+	release_ctx(obj);
+
+	return retval;
 }
 
 static const struct socket_op_vtable nrf91_socket_fd_op_vtable = {
@@ -1213,6 +1592,7 @@ static int nrf91_socket_create(int family, int type, int proto)
 {
 	int fd = z_reserve_fd();
 	int sd;
+	struct nrf_sock_ctx *ctx;
 
 	if (fd < 0) {
 		return -1;
@@ -1224,7 +1604,15 @@ static int nrf91_socket_create(int family, int type, int proto)
 		return -1;
 	}
 
-	z_finalize_fd(fd, SD_TO_OBJ(sd),
+	ctx = allocate_ctx(sd);
+	if (ctx == NULL) {
+		nrf_close(sd);
+		z_free_fd(fd);
+		errno = ENOMEM;
+		return -1;
+	}
+
+	z_finalize_fd(fd, ctx,
 		      (const struct fd_op_vtable *)&nrf91_socket_fd_op_vtable);
 
 	return fd;
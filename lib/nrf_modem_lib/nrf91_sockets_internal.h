@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef NRF91_SOCKETS_INTERNAL_H_
+#define NRF91_SOCKETS_INTERNAL_H_
+
+/**
+ * @brief Notify the socket offload of a Modem library event.
+ *
+ * Schedules an update of the readiness of the sockets in poll sets. The
+ * function can be called from an interrupt.
+ */
+void nrf91_socket_event_notify(void);
+
+#endif /* NRF91_SOCKETS_INTERNAL_H_ */
@@ -16,6 +16,8 @@
 #include <pm_config.h>
 #include <logging/log.h>
 
+#include "nrf91_sockets_internal.h"
+
 #ifdef CONFIG_NRF_MODEM_LIB_TRACE_ENABLED
 #include <nrfx_uarte.h>
 #endif
@@ -385,6 +387,11 @@ ISR_DIRECT_DECLARE(rpc_proxy_irq_handler)
 		k_sem_give(&thread->sem);
 	}
 
+#ifdef CONFIG_NRF91_SOCKET_POLL_SET
+	/* Poll sets are updated once per event, instead of by each thread. */
+	nrf91_socket_event_notify();
+#endif
+
 	ISR_DIRECT_PM(); /* PM done after servicing interrupt for best latency
 			  */
 	return 1; /* We should check if scheduling decision should be made */
@@ -38,6 +38,9 @@ LOG_MODULE_REGISTER(sms, CONFIG_SMS_LOG_LEVEL);
 #define AT_SMS_NOTIFICATION "+CMT:"
 #define AT_SMS_NOTIFICATION_LEN (sizeof(AT_SMS_NOTIFICATION) - 1)
 
+/** @brief Name of the AT notification for incoming SMS. */
+#define AT_SMS_NOTIFICATION_PREFIX "+CMT"
+
 static struct k_work sms_ack_work;
 static struct at_param_list resp_list;
 static char resp[AT_SMS_RESPONSE_MAX_LEN];
@@ -228,7 +231,8 @@ int sms_init(void)
 	}
 
 	/* Register for AT commands notifications before creating the client. */
-	ret = at_notif_register_handler(NULL, sms_at_handler);
+	ret = at_notif_register_prefix_handler(NULL, AT_SMS_NOTIFICATION_PREFIX,
+					       sms_at_handler);
 	if (ret) {
 		LOG_ERR("Cannot register AT notification handler, err: %d",
 			ret);
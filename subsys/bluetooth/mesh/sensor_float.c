@@ -0,0 +1,253 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+#include <errno.h>
+#include <stdbool.h>
+#include <string.h>
+#include <sys/util.h>
+#include <sys/math_extras.h>
+#include "sensor_float.h"
+
+#ifdef CONFIG_BT_MESH_SENSOR_INT_FLOAT
+
+/* Software implementation of the few single precision operations needed to
+ * convert between sensor values and IEEE-754 floats. Every operation rounds
+ * to nearest, ties to even, like the FPU does, so the output is bit-identical
+ * to the float implementation below.
+ *
+ * Sensor values are far from the limits of the float range, so subnormal
+ * numbers, infinity and NaN are never produced.
+ */
+
+#define FLOAT_MANT_BITS 23
+#define FLOAT_EXP_BIAS 127
+#define FLOAT_EXP_MAX 0xff
+#define FLOAT_SIGN_BIT 31
+
+#define MILLION 1000000LL
+
+/* Free bits below the significand when adding two numbers. */
+#define ADD_GUARD_BITS 38
+
+/** Unpacked floating point number: (-1)^neg * sig * 2^exp. */
+struct sfloat {
+	bool neg;
+	uint64_t sig;
+	int exp;
+};
+
+/* Round the significand to FLOAT_MANT_BITS + 1 bits.
+ *
+ * An inexact significand must have its lowest bit set to mark that bits were
+ * lost. An odd significand is never exactly halfway between two results, so
+ * it rounds the same way as the exact value it stands for, as long as it has
+ * at least two bits more than the result.
+ */
+static void sfloat_round(struct sfloat *f)
+{
+	if (f->sig == 0) {
+		return;
+	}
+
+	int shift = (63 - u64_count_leading_zeros(f->sig)) - FLOAT_MANT_BITS;
+
+	if (shift <= 0) {
+		f->sig <<= -shift;
+		f->exp += shift;
+		return;
+	}
+
+	uint64_t rem = f->sig & (BIT64(shift) - 1);
+	uint64_t half = BIT64(shift - 1);
+
+	f->sig >>= shift;
+	f->exp += shift;
+
+	if (rem > half || (rem == half && (f->sig & 1))) {
+		f->sig++;
+		if (f->sig == BIT64(FLOAT_MANT_BITS + 1)) {
+			f->sig >>= 1;
+			f->exp++;
+		}
+	}
+}
+
+static struct sfloat sfloat_from_int(int32_t val)
+{
+	struct sfloat f = {
+		.neg = (val < 0),
+		.sig = (val < 0) ? -(int64_t)val : val,
+	};
+
+	sfloat_round(&f);
+
+	return f;
+}
+
+static void sfloat_div_million(struct sfloat *f)
+{
+	if (f->sig == 0) {
+		return;
+	}
+
+	/* The significand has 24 bits, which leaves room for 40 bits of
+	 * quotient below it.
+	 */
+	uint64_t num = f->sig << 40;
+
+	f->sig = (num / MILLION) | !!(num % MILLION);
+	f->exp -= 40;
+	sfloat_round(f);
+}
+
+static void sfloat_mul_million(struct sfloat *f)
+{
+	/* 24 bit significand times 20 bits, always exact before rounding. */
+	f->sig *= MILLION;
+	sfloat_round(f);
+}
+
+static struct sfloat sfloat_add(struct sfloat a, struct sfloat b)
+{
+	if (b.sig == 0) {
+		return a;
+	}
+
+	if (a.sig == 0) {
+		return b;
+	}
+
+	if (a.exp < b.exp) {
+		struct sfloat tmp = a;
+
+		a = b;
+		b = tmp;
+	}
+
+	int diff = a.exp - b.exp;
+
+	a.sig <<= ADD_GUARD_BITS;
+	a.exp -= ADD_GUARD_BITS;
+	b.sig <<= ADD_GUARD_BITS;
+
+	if (diff > 62) {
+		b.sig = 1;
+	} else if (diff > 0) {
+		b.sig = (b.sig >> diff) | !!(b.sig & (BIT64(diff) - 1));
+	}
+
+	if (a.neg == b.neg) {
+		a.sig += b.sig;
+	} else if (a.sig >= b.sig) {
+		a.sig -= b.sig;
+	} else {
+		a.sig = b.sig - a.sig;
+		a.neg = b.neg;
+	}
+
+	if (a.sig == 0) {
+		/* Exact cancellation gives positive zero. */
+		a.neg = false;
+	}
+
+	sfloat_round(&a);
+
+	return a;
+}
+
+/* Truncate towards zero, like a cast to an integer type. */
+static int64_t sfloat_trunc(const struct sfloat *f)
+{
+	int64_t val;
+
+	if (f->exp >= 0) {
+		val = f->sig << f->exp;
+	} else if (f->exp > -64) {
+		val = f->sig >> -f->exp;
+	} else {
+		val = 0;
+	}
+
+	return f->neg ? -val : val;
+}
+
+uint32_t sensor_float32_encode(const struct sensor_value *val)
+{
+	struct sfloat frac = sfloat_from_int(val->val2);
+
+	sfloat_div_million(&frac);
+
+	struct sfloat f = sfloat_add(sfloat_from_int(val->val1), frac);
+
+	if (f.sig == 0) {
+		return 0;
+	}
+
+	return ((uint32_t)f.neg << FLOAT_SIGN_BIT) |
+	       ((f.exp + FLOAT_MANT_BITS + FLOAT_EXP_BIAS) << FLOAT_MANT_BITS) |
+	       (f.sig & BIT_MASK(FLOAT_MANT_BITS));
+}
+
+int sensor_float32_decode(uint32_t bits, struct sensor_value *val)
+{
+	int biased_exp = (bits >> FLOAT_MANT_BITS) & FLOAT_EXP_MAX;
+
+	if (biased_exp == FLOAT_EXP_MAX ||
+	    biased_exp - FLOAT_EXP_BIAS >= 31) {
+		return -ERANGE;
+	}
+
+	if (biased_exp == 0) {
+		/* Zero or subnormal, both too small for a sensor value. */
+		val->val1 = 0;
+		val->val2 = 0;
+		return 0;
+	}
+
+	struct sfloat f = {
+		.neg = (bits >> FLOAT_SIGN_BIT),
+		.sig = (bits & BIT_MASK(FLOAT_MANT_BITS)) |
+		       BIT(FLOAT_MANT_BITS),
+		.exp = biased_exp - FLOAT_EXP_BIAS - FLOAT_MANT_BITS,
+	};
+
+	val->val1 = sfloat_trunc(&f);
+
+	sfloat_mul_million(&f);
+	val->val2 = sfloat_trunc(&f) % MILLION;
+
+	return 0;
+}
+
+#else
+
+uint32_t sensor_float32_encode(const struct sensor_value *val)
+{
+	float fvalue = (float)val->val1 + (float)val->val2 / 1000000L;
+	uint32_t bits;
+
+	memcpy(&bits, &fvalue, sizeof(bits));
+
+	return bits;
+}
+
+int sensor_float32_decode(uint32_t bits, struct sensor_value *val)
+{
+	float fvalue;
+
+	memcpy(&fvalue, &bits, sizeof(fvalue));
+
+	/* Also false for NaN. */
+	if (!(fvalue > -2147483648.0f && fvalue < 2147483648.0f)) {
+		return -ERANGE;
+	}
+
+	val->val1 = (int32_t)fvalue;
+	val->val2 = (int64_t)(fvalue * 1000000.0f) % 1000000L;
+
+	return 0;
+}
+
+#endif /* CONFIG_BT_MESH_SENSOR_INT_FLOAT */
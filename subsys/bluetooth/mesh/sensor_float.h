@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+/**
+ * @file
+ * @brief Internal IEEE-754 sensor value conversion
+ */
+
+#ifndef BT_MESH_INTERNAL_SENSOR_FLOAT_H__
+#define BT_MESH_INTERNAL_SENSOR_FLOAT_H__
+
+#include <stdint.h>
+#include <drivers/sensor.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Convert a sensor value to a 32-bit IEEE-754 floating point number.
+ *
+ *  The result is the same as evaluating
+ *  @code (float)val->val1 + (float)val->val2 / 1000000L @endcode
+ *
+ *  @param[in] val Sensor value.
+ *
+ *  @return The bit pattern of the floating point number.
+ */
+uint32_t sensor_float32_encode(const struct sensor_value *val);
+
+/** @brief Convert a 32-bit IEEE-754 floating point number to a sensor value.
+ *
+ *  @param[in] bits The bit pattern of the floating point number.
+ *  @param[out] val Sensor value.
+ *
+ *  @retval 0 The value was converted.
+ *  @retval -ERANGE The number is not finite, or its magnitude is 2^31 or
+ *  more.
+ */
+int sensor_float32_decode(uint32_t bits, struct sensor_value *val);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* BT_MESH_INTERNAL_SENSOR_FLOAT_H__ */
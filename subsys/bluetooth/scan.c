@@ -7,6 +7,7 @@
 #include <zephyr.h>
 #include <sys/byteorder.h>
 #include <string.h>
+#include <sys/atomic.h>
 #include <bluetooth/scan.h>
 
 #include <logging/log.h>
@@ -18,6 +19,14 @@ LOG_MODULE_REGISTER(nrf_bt_scan, CONFIG_BT_SCAN_LOG_LEVEL);
 	BT_SCAN_SHORT_NAME_FILTER | BT_SCAN_APPEARANCE_FILTER | \
 	BT_SCAN_UUID_FILTER | BT_SCAN_MANUFACTURER_DATA_FILTER)
 
+/* Filters that need the advertising data to be parsed. */
+#define AD_FILTERS (MODE_CHECK & ~BT_SCAN_ADDR_FILTER)
+
+/* Size of the address and UUID filter lookup tables. The tables use open
+ * addressing with linear probing, and are kept less than half full.
+ */
+#define FILTER_HASH_SIZE(cnt) (2 * (cnt) + 1)
+
 /* Scan filter mutex. */
 K_MUTEX_DEFINE(scan_mutex);
 
@@ -25,14 +34,11 @@ K_MUTEX_DEFINE(scan_mutex);
  * compare matching filters, their mode and event generation.
  */
 struct bt_scan_control {
-	/* Number of active filters. */
-	uint8_t filter_cnt;
+	/* Enabled filter types, as a mask of BT_SCAN_*_FILTER flags. */
+	uint8_t filter_mask;
 
-	/* Number of matched filters. */
-	uint8_t filter_match_cnt;
-
-	/* Indicates whether at least one filter has been fitted. */
-	bool filter_match;
+	/* Matched filter types, as a mask of BT_SCAN_*_FILTER flags. */
+	uint8_t match_mask;
 
 	/* Indicates in which mode filters operate. */
 	bool all_mode;
@@ -45,6 +51,9 @@ struct bt_scan_control {
 
 	/* Scan filter status. */
 	struct bt_scan_filter_match filter_status;
+
+	/* UUID filters found in the advertising data. */
+	bool uuid_found[CONFIG_BT_SCAN_UUID_CNT];
 };
 
 /* Name filter structure.
@@ -89,6 +98,11 @@ struct bt_scan_addr_filter {
 	/* Addresses advertised by the peripherals. */
 	bt_addr_le_t target_addr[CONFIG_BT_SCAN_ADDRESS_CNT];
 
+	/* Lookup table of the target addresses. Each slot holds
+	 * the index of an address plus one, or zero if it is free.
+	 */
+	uint8_t hash[FILTER_HASH_SIZE(CONFIG_BT_SCAN_ADDRESS_CNT)];
+
 	/* Address filter counter. */
 	uint8_t cnt;
 
@@ -120,6 +134,11 @@ struct bt_scan_uuid_filter {
 	 */
 	struct bt_scan_uuid uuid[CONFIG_BT_SCAN_UUID_CNT];
 
+	/* Lookup table of the UUIDs. Each slot holds the index of
+	 * a UUID plus one, or zero if it is free.
+	 */
+	uint8_t hash[FILTER_HASH_SIZE(CONFIG_BT_SCAN_UUID_CNT)];
+
 	/* UUID filter counter. */
 	uint8_t cnt;
 
@@ -234,6 +253,27 @@ struct conn_blocklist {
  * This structure stores all module settings. It is used to enable
  * or disable scanning modes and to configure filters.
  */
+#if CONFIG_BT_SCAN_FILTER_STATS
+/* Filter statistics are updated for every advertising report, in the
+ * Bluetooth receive thread. Atomic counters avoid taking the scan mutex
+ * there.
+ */
+struct filter_counters {
+	atomic_t hit;
+	atomic_t miss;
+};
+
+struct filter_stats {
+	atomic_t reports;
+	struct filter_counters name;
+	struct filter_counters short_name;
+	struct filter_counters addr;
+	struct filter_counters uuid;
+	struct filter_counters appearance;
+	struct filter_counters manufacturer_data;
+};
+#endif /* CONFIG_BT_SCAN_FILTER_STATS */
+
 static struct bt_scan {
 	/* Filter data. */
 	struct bt_scan_filters scan_filters;
@@ -264,6 +304,11 @@ static struct bt_scan {
 	struct conn_blocklist blocklist;
 #endif /* CONFIG_BT_SCAN_BLOCKLIST */
 
+#if CONFIG_BT_SCAN_FILTER_STATS
+	/* Filter statistics. */
+	struct filter_stats stats;
+#endif /* CONFIG_BT_SCAN_FILTER_STATS */
+
 } bt_scan;
 
 static sys_slist_t callback_list;
@@ -501,49 +546,68 @@ static void scan_connect_with_target(struct bt_scan_control *control,
 	}
 }
 
-static bool adv_addr_compare(const bt_addr_le_t *target_addr,
-			     struct bt_scan_control *control)
+static void filter_hash_add(uint8_t *table, size_t size, uint32_t key,
+			    uint8_t idx)
 {
-	const bt_addr_le_t *addr =
-			bt_scan.scan_filters.addr.target_addr;
-	uint8_t counter = bt_scan.scan_filters.addr.cnt;
-
-	for (size_t i = 0; i < counter; i++) {
-		if (bt_addr_le_cmp(target_addr, &addr[i]) == 0) {
-			control->filter_status.addr.addr = &addr[i];
+	size_t slot = key % size;
 
-			return true;
-		}
+	while (table[slot]) {
+		slot = (slot + 1) % size;
 	}
 
-	return false;
+	table[slot] = idx + 1;
 }
 
-static bool is_addr_filter_enabled(void)
+static uint32_t addr_hash(const bt_addr_le_t *addr)
 {
-	return bt_scan.scan_filters.addr.enabled;
+	/* The lowest bytes are the most random ones in all address types. */
+	return sys_get_le32(addr->a.val) ^ addr->type;
+}
+
+static int addr_filter_find(const bt_addr_le_t *addr)
+{
+	const struct bt_scan_addr_filter *addr_filter =
+			&bt_scan.scan_filters.addr;
+	size_t slot = addr_hash(addr) % ARRAY_SIZE(addr_filter->hash);
+
+	while (addr_filter->hash[slot]) {
+		uint8_t i = addr_filter->hash[slot] - 1;
+
+		if (bt_addr_le_cmp(addr, &addr_filter->target_addr[i]) == 0) {
+			return i;
+		}
+
+		slot = (slot + 1) % ARRAY_SIZE(addr_filter->hash);
+	}
+
+	return -ENOENT;
 }
 
 static void check_addr(struct bt_scan_control *control,
 		       const bt_addr_le_t *addr)
 {
-	if (is_addr_filter_enabled()) {
-		if (adv_addr_compare(addr, control)) {
-			control->filter_match_cnt++;
+	int i;
 
-			/* Information about the filters matched. */
-			control->filter_status.addr.match = true;
-			control->filter_match = true;
-		}
+	if (!(control->filter_mask & BT_SCAN_ADDR_FILTER)) {
+		return;
+	}
+
+	i = addr_filter_find(addr);
+	if (i >= 0) {
+		/* Information about the filters matched. */
+		control->filter_status.addr.addr =
+			&bt_scan.scan_filters.addr.target_addr[i];
+		control->filter_status.addr.match = true;
+		control->match_mask |= BT_SCAN_ADDR_FILTER;
 	}
 }
 
 static int scan_addr_filter_add(const bt_addr_le_t *target_addr)
 {
 	char addr[BT_ADDR_LE_STR_LEN];
-	bt_addr_le_t *addr_filter =
-			bt_scan.scan_filters.addr.target_addr;
-	uint8_t counter = bt_scan.scan_filters.addr.cnt;
+	struct bt_scan_addr_filter *filter = &bt_scan.scan_filters.addr;
+	bt_addr_le_t *addr_filter = filter->target_addr;
+	uint8_t counter = filter->cnt;
 
 	/* If no memory for filter. */
 	if (counter >= CONFIG_BT_SCAN_ADDRESS_CNT) {
@@ -551,14 +615,14 @@ static int scan_addr_filter_add(const bt_addr_le_t *target_addr)
 	}
 
 	/* Check for duplicated filter. */
-	for (size_t i = 0; i < counter; i++) {
-		if (bt_addr_le_cmp(target_addr, &addr_filter[i]) == 0) {
-			return 0;
-		}
+	if (addr_filter_find(target_addr) >= 0) {
+		return 0;
 	}
 
 	/* Add target address to filter. */
 	bt_addr_le_copy(&addr_filter[counter], target_addr);
+	filter_hash_add(filter->hash, ARRAY_SIZE(filter->hash),
+			addr_hash(target_addr), counter);
 
 	LOG_DBG("Filter set on address type %i",
 		addr_filter[counter].type);
@@ -605,22 +669,17 @@ static bool adv_name_compare(const struct bt_data *data,
 	return false;
 }
 
-static bool is_name_filter_enabled(void)
-{
-	return bt_scan.scan_filters.name.enabled;
-}
-
 static void name_check(struct bt_scan_control *control,
 		       const struct bt_data *data)
 {
-	if (is_name_filter_enabled()) {
-		if (adv_name_compare(data, control)) {
-			control->filter_match_cnt++;
+	if (!(control->filter_mask & BT_SCAN_NAME_FILTER)) {
+		return;
+	}
 
-			/* Information about the filters matched. */
-			control->filter_status.name.match = true;
-			control->filter_match = true;
-		}
+	if (adv_name_compare(data, control)) {
+		/* Information about the filters matched. */
+		control->filter_status.name.match = true;
+		control->match_mask |= BT_SCAN_NAME_FILTER;
 	}
 }
 
@@ -698,22 +757,17 @@ static bool adv_short_name_compare(const struct bt_data *data,
 	return false;
 }
 
-static bool is_short_name_filter_enabled(void)
-{
-	return bt_scan.scan_filters.short_name.enabled;
-}
-
 static void short_name_check(struct bt_scan_control *control,
 			     const struct bt_data *data)
 {
-	if (is_short_name_filter_enabled()) {
-		if (adv_short_name_compare(data, control)) {
-			control->filter_match_cnt++;
+	if (!(control->filter_mask & BT_SCAN_SHORT_NAME_FILTER)) {
+		return;
+	}
 
-			/* Information about the filters matched. */
-			control->filter_status.short_name.match = true;
-			control->filter_match = true;
-		}
+	if (adv_short_name_compare(data, control)) {
+		/* Information about the filters matched. */
+		control->filter_status.short_name.match = true;
+		control->match_mask |= BT_SCAN_SHORT_NAME_FILTER;
 	}
 }
 
@@ -759,13 +813,56 @@ static int scan_short_name_filter_add(const struct bt_scan_short_name *short_nam
 	return 0;
 }
 
-static bool find_uuid(const uint8_t *data,
-		      uint8_t data_len,
-		      uint8_t uuid_type,
-		      const struct bt_scan_uuid *target_uuid)
+static uint32_t uuid_hash(const struct bt_uuid *uuid)
+{
+	/* bt_uuid_cmp() finds 16-bit and 32-bit UUIDs equal to their 128-bit
+	 * form on the Bluetooth Base UUID, so both forms must get the same
+	 * hash. The 128-bit form holds the short value in bytes 12 to 15.
+	 */
+	switch (uuid->type) {
+	case BT_UUID_TYPE_16:
+		return BT_UUID_16(uuid)->val;
+
+	case BT_UUID_TYPE_32:
+		return BT_UUID_32(uuid)->val;
+
+	case BT_UUID_TYPE_128:
+		return sys_get_le32(&BT_UUID_128(uuid)->val[12]);
+
+	default:
+		return 0;
+	}
+}
+
+static int uuid_filter_find(const struct bt_uuid *uuid)
+{
+	const struct bt_scan_uuid_filter *uuid_filter =
+			&bt_scan.scan_filters.uuid;
+	size_t slot = uuid_hash(uuid) % ARRAY_SIZE(uuid_filter->hash);
+
+	while (uuid_filter->hash[slot]) {
+		uint8_t i = uuid_filter->hash[slot] - 1;
+
+		if (bt_uuid_cmp(uuid, uuid_filter->uuid[i].uuid) == 0) {
+			return i;
+		}
+
+		slot = (slot + 1) % ARRAY_SIZE(uuid_filter->hash);
+	}
+
+	return -ENOENT;
+}
+
+static void uuid_check(struct bt_scan_control *control,
+		       const struct bt_data *data,
+		       uint8_t uuid_type)
 {
 	uint8_t uuid_len;
 
+	if (!(control->filter_mask & BT_SCAN_UUID_FILTER)) {
+		return;
+	}
+
 	switch (uuid_type) {
 	case BT_UUID_TYPE_16:
 		uuid_len = sizeof(uint16_t);
@@ -780,92 +877,63 @@ static bool find_uuid(const uint8_t *data,
 		break;
 
 	default:
-		return false;
+		return;
 	}
 
-	for (size_t i = 0; i < data_len; i += uuid_len) {
+	/* Look up each advertised UUID once. The UUIDs may be spread over
+	 * several AD structures, so the match is decided in
+	 * uuid_match_check() when all of them have been parsed.
+	 */
+	for (size_t i = 0; (i + uuid_len) <= data->data_len; i += uuid_len) {
 		struct bt_uuid_128 uuid;
+		int idx;
 
-		if (!bt_uuid_create(&uuid.uuid, &data[i], uuid_len)) {
-			return false;
+		if (!bt_uuid_create(&uuid.uuid, &data->data[i], uuid_len)) {
+			return;
 		}
 
-		if (bt_uuid_cmp(&uuid.uuid, target_uuid->uuid) == 0) {
-			return true;
+		idx = uuid_filter_find(&uuid.uuid);
+		if (idx >= 0) {
+			control->uuid_found[idx] = true;
 		}
 	}
-
-	return false;
 }
 
-static bool adv_uuid_compare(const struct bt_data *data, uint8_t uuid_type,
-			     struct bt_scan_control *control)
+static void uuid_match_check(struct bt_scan_control *control)
 {
 	const struct bt_scan_uuid_filter *uuid_filter =
 			&bt_scan.scan_filters.uuid;
-	const bool all_filters_mode = bt_scan.scan_filters.all_mode;
-	const uint8_t counter = bt_scan.scan_filters.uuid.cnt;
-	uint8_t data_len = data->data_len;
-	uint8_t uuid_match_cnt = 0;
-
-	for (size_t i = 0; i < counter; i++) {
-
-		if (find_uuid(data->data, data_len, uuid_type,
-			      &uuid_filter->uuid[i])) {
-			control->filter_status.uuid.uuid[uuid_match_cnt] =
-				uuid_filter->uuid[i].uuid;
+	struct bt_scan_uuid_filter_status *status =
+			&control->filter_status.uuid;
 
-			uuid_match_cnt++;
-
-			/* In the normal filter mode,
-			 * only one UUID is needed to match.
-			 */
-			if (!all_filters_mode) {
-				break;
-			}
+	if (!(control->filter_mask & BT_SCAN_UUID_FILTER)) {
+		return;
+	}
 
-		} else if (all_filters_mode) {
-			break;
+	for (size_t i = 0; i < uuid_filter->cnt; i++) {
+		if (control->uuid_found[i]) {
+			status->uuid[status->count] = uuid_filter->uuid[i].uuid;
+			status->count++;
 		}
 	}
 
-	control->filter_status.uuid.count = uuid_match_cnt;
-
 	/* In the multifilter mode, all UUIDs must be found in
-	 * the advertisement packets.
+	 * the advertisement packets. In the normal filter mode,
+	 * only one UUID is needed to match.
 	 */
-	if ((all_filters_mode && (uuid_match_cnt == counter)) ||
-	    ((!all_filters_mode) && (uuid_match_cnt > 0))) {
-		return true;
-	}
-
-	return false;
-}
-
-static bool is_uuid_filter_enabled(void)
-{
-	return bt_scan.scan_filters.uuid.enabled;
-}
-
-static void uuid_check(struct bt_scan_control *control,
-		       const struct bt_data *data,
-		       uint8_t type)
-{
-	if (is_uuid_filter_enabled()) {
-		if (adv_uuid_compare(data, type, control)) {
-			control->filter_match_cnt++;
-
-			/* Information about the filters matched. */
-			control->filter_status.uuid.match = true;
-			control->filter_match = true;
-		}
+	if ((status->count > 0) &&
+	    (!control->all_mode || (status->count == uuid_filter->cnt))) {
+		/* Information about the filters matched. */
+		status->match = true;
+		control->match_mask |= BT_SCAN_UUID_FILTER;
 	}
 }
 
 static int scan_uuid_filter_add(struct bt_uuid *uuid)
 {
-	struct bt_scan_uuid *uuid_filter = bt_scan.scan_filters.uuid.uuid;
-	uint8_t counter = bt_scan.scan_filters.uuid.cnt;
+	struct bt_scan_uuid_filter *filter = &bt_scan.scan_filters.uuid;
+	struct bt_scan_uuid *uuid_filter = filter->uuid;
+	uint8_t counter = filter->cnt;
 	struct bt_uuid_16 *uuid_16;
 	struct bt_uuid_32 *uuid_32;
 	struct bt_uuid_128 *uuid_128;
@@ -876,10 +944,8 @@ static int scan_uuid_filter_add(struct bt_uuid *uuid)
 	}
 
 	/* Check for duplicated filter. */
-	for (size_t i = 0; i < counter; i++) {
-		if (bt_uuid_cmp(uuid_filter[i].uuid, uuid) == 0) {
-			return 0;
-		}
+	if (uuid_filter_find(uuid) >= 0) {
+		return 0;
 	}
 
 	/* Add UUID to the filter. */
@@ -912,6 +978,9 @@ static int scan_uuid_filter_add(struct bt_uuid *uuid)
 		return -EINVAL;
 	}
 
+	filter_hash_add(filter->hash, ARRAY_SIZE(filter->hash),
+			uuid_hash(uuid), counter);
+
 	bt_scan.scan_filters.uuid.cnt++;
 	LOG_DBG("Added filter on UUID type %x", uuid->type);
 
@@ -963,22 +1032,17 @@ static bool adv_appearance_compare(const struct bt_data *data,
 	return false;
 }
 
-static bool is_appearance_filter_enabled(void)
-{
-	return bt_scan.scan_filters.appearance.enabled;
-}
-
 static void appearance_check(struct bt_scan_control *control,
 			     const struct bt_data *data)
 {
-	if (is_appearance_filter_enabled()) {
-		if (adv_appearance_compare(data, control)) {
-			control->filter_match_cnt++;
+	if (!(control->filter_mask & BT_SCAN_APPEARANCE_FILTER)) {
+		return;
+	}
 
-			/* Information about the filters matched. */
-			control->filter_status.appearance.match = true;
-			control->filter_match = true;
-		}
+	if (adv_appearance_compare(data, control)) {
+		/* Information about the filters matched. */
+		control->filter_status.appearance.match = true;
+		control->match_mask |= BT_SCAN_APPEARANCE_FILTER;
 	}
 }
 
@@ -1050,22 +1114,17 @@ static bool adv_manufacturer_data_compare(const struct bt_data *data,
 	return false;
 }
 
-static bool is_manufacturer_data_filter_enabled(void)
-{
-	return bt_scan.scan_filters.manufacturer_data.enabled;
-}
-
 static void manufacturer_data_check(struct bt_scan_control *control,
 				    const struct bt_data *data)
 {
-	if (is_manufacturer_data_filter_enabled()) {
-		if (adv_manufacturer_data_compare(data, control)) {
-			control->filter_match_cnt++;
+	if (!(control->filter_mask & BT_SCAN_MANUFACTURER_DATA_FILTER)) {
+		return;
+	}
 
-			/* Information about the filters matched. */
-			control->filter_status.manufacturer_data.match = true;
-			control->filter_match = true;
-		}
+	if (adv_manufacturer_data_compare(data, control)) {
+		/* Information about the filters matched. */
+		control->filter_status.manufacturer_data.match = true;
+		control->match_mask |= BT_SCAN_MANUFACTURER_DATA_FILTER;
 	}
 }
 
@@ -1224,10 +1283,12 @@ void bt_scan_filter_remove_all(void)
 	struct bt_scan_addr_filter *addr_filter =
 			&bt_scan.scan_filters.addr;
 	addr_filter->cnt = 0;
+	memset(addr_filter->hash, 0, sizeof(addr_filter->hash));
 
 	struct bt_scan_uuid_filter *uuid_filter =
 			&bt_scan.scan_filters.uuid;
 	uuid_filter->cnt = 0;
+	memset(uuid_filter->hash, 0, sizeof(uuid_filter->hash));
 
 	struct bt_scan_appearance_filter *appearance_filter =
 			&bt_scan.scan_filters.appearance;
@@ -1369,34 +1430,117 @@ void bt_scan_update_init_conn_params(struct bt_le_conn_param *new_conn_param)
 	bt_scan.conn_param = *new_conn_param;
 }
 
-static void check_enabled_filters(struct bt_scan_control *control)
+static uint8_t enabled_filters_get(void)
 {
-	control->filter_cnt = 0;
+	const struct bt_scan_filters *filters = &bt_scan.scan_filters;
+	uint8_t mask = 0;
+
+	if (filters->addr.enabled) {
+		mask |= BT_SCAN_ADDR_FILTER;
+	}
+
+	if (filters->name.enabled) {
+		mask |= BT_SCAN_NAME_FILTER;
+	}
 
-	if (is_addr_filter_enabled()) {
-		control->filter_cnt++;
+	if (filters->short_name.enabled) {
+		mask |= BT_SCAN_SHORT_NAME_FILTER;
 	}
 
-	if (is_name_filter_enabled()) {
-		control->filter_cnt++;
+	if (filters->uuid.enabled) {
+		mask |= BT_SCAN_UUID_FILTER;
 	}
 
-	if (is_short_name_filter_enabled()) {
-		control->filter_cnt++;
+	if (filters->appearance.enabled) {
+		mask |= BT_SCAN_APPEARANCE_FILTER;
 	}
 
-	if (is_uuid_filter_enabled()) {
-		control->filter_cnt++;
+	if (filters->manufacturer_data.enabled) {
+		mask |= BT_SCAN_MANUFACTURER_DATA_FILTER;
 	}
 
-	if (is_appearance_filter_enabled()) {
-		control->filter_cnt++;
+	return mask;
+}
+
+#if CONFIG_BT_SCAN_FILTER_STATS
+static void filter_counters_update(struct filter_counters *counters,
+				   const struct bt_scan_control *control,
+				   uint8_t filter)
+{
+	if (!(control->filter_mask & filter)) {
+		return;
+	}
+
+	if (control->match_mask & filter) {
+		atomic_inc(&counters->hit);
+	} else {
+		atomic_inc(&counters->miss);
 	}
+}
+
+static void filter_counters_get(struct bt_scan_filter_counters *dst,
+				struct filter_counters *counters)
+{
+	dst->hit = atomic_get(&counters->hit);
+	dst->miss = atomic_get(&counters->miss);
+}
+
+static void filter_counters_clear(struct filter_counters *counters)
+{
+	atomic_clear(&counters->hit);
+	atomic_clear(&counters->miss);
+}
+
+static void filter_stats_update(const struct bt_scan_control *control)
+{
+	struct filter_stats *stats = &bt_scan.stats;
+
+	atomic_inc(&stats->reports);
+
+	filter_counters_update(&stats->name, control, BT_SCAN_NAME_FILTER);
+	filter_counters_update(&stats->short_name, control,
+			       BT_SCAN_SHORT_NAME_FILTER);
+	filter_counters_update(&stats->addr, control, BT_SCAN_ADDR_FILTER);
+	filter_counters_update(&stats->uuid, control, BT_SCAN_UUID_FILTER);
+	filter_counters_update(&stats->appearance, control,
+			       BT_SCAN_APPEARANCE_FILTER);
+	filter_counters_update(&stats->manufacturer_data, control,
+			       BT_SCAN_MANUFACTURER_DATA_FILTER);
+}
 
-	if (is_manufacturer_data_filter_enabled()) {
-		control->filter_cnt++;
+int bt_scan_filter_stats_get(struct bt_scan_filter_stats *stats)
+{
+	struct filter_stats *src = &bt_scan.stats;
+
+	if (!stats) {
+		return -EINVAL;
 	}
+
+	stats->reports = atomic_get(&src->reports);
+	filter_counters_get(&stats->name, &src->name);
+	filter_counters_get(&stats->short_name, &src->short_name);
+	filter_counters_get(&stats->addr, &src->addr);
+	filter_counters_get(&stats->uuid, &src->uuid);
+	filter_counters_get(&stats->appearance, &src->appearance);
+	filter_counters_get(&stats->manufacturer_data,
+			    &src->manufacturer_data);
+
+	return 0;
+}
+
+void bt_scan_filter_stats_reset(void)
+{
+	struct filter_stats *stats = &bt_scan.stats;
+
+	atomic_clear(&stats->reports);
+	filter_counters_clear(&stats->name);
+	filter_counters_clear(&stats->short_name);
+	filter_counters_clear(&stats->addr);
+	filter_counters_clear(&stats->uuid);
+	filter_counters_clear(&stats->appearance);
+	filter_counters_clear(&stats->manufacturer_data);
 }
+#endif /* CONFIG_BT_SCAN_FILTER_STATS */
 
 static bool adv_data_found(struct bt_data *data, void *user_data)
 {
@@ -1456,7 +1600,7 @@ static void filter_state_check(struct bt_scan_control *control,
 	}
 
 	if (control->all_mode &&
-	    (control->filter_match_cnt == control->filter_cnt)) {
+	    (control->match_mask == control->filter_mask)) {
 		notify_filter_matched(&control->device_info,
 				      &control->filter_status,
 				      control->connectable);
@@ -1466,7 +1610,7 @@ static void filter_state_check(struct bt_scan_control *control,
 	/* In the normal filter mode, only one filter match is
 	 * needed to generate the notification to the main application.
 	 */
-	else if ((!control->all_mode) && control->filter_match) {
+	else if ((!control->all_mode) && control->match_mask) {
 		notify_filter_matched(&control->device_info,
 				      &control->filter_status,
 				      control->connectable);
@@ -1486,8 +1630,7 @@ static void scan_recv(const struct bt_le_scan_recv_info *info,
 	memset(&scan_control, 0, sizeof(scan_control));
 
 	scan_control.all_mode = bt_scan.scan_filters.all_mode;
-
-	check_enabled_filters(&scan_control);
+	scan_control.filter_mask = enabled_filters_get();
 
 	/* Check id device is connectable. */
 	scan_control.connectable =
@@ -1496,12 +1639,21 @@ static void scan_recv(const struct bt_le_scan_recv_info *info,
 	/* Check the address filter. */
 	check_addr(&scan_control, info->addr);
 
-	/* Save advertising buffer state to transfer it
+	/* Parse the advertising data once for all enabled filters.
+	 * Save advertising buffer state to transfer it
 	 * data to application if futher processing is needed.
 	 */
-	net_buf_simple_save(ad, &state);
-	bt_data_parse(ad, adv_data_found, (void *)&scan_control);
-	net_buf_simple_restore(ad, &state);
+	if (scan_control.filter_mask & AD_FILTERS) {
+		net_buf_simple_save(ad, &state);
+		bt_data_parse(ad, adv_data_found, (void *)&scan_control);
+		net_buf_simple_restore(ad, &state);
+
+		uuid_match_check(&scan_control);
+	}
+
+#if CONFIG_BT_SCAN_FILTER_STATS
+	filter_stats_update(&scan_control);
+#endif /* CONFIG_BT_SCAN_FILTER_STATS */
 
 	scan_control.device_info.recv_info = info;
 	scan_control.device_info.conn_param = &bt_scan.conn_param;
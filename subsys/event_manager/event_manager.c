@@ -35,12 +35,88 @@ extern uint32_t event_manager_displayed_events;
 static uint32_t event_manager_displayed_events;
 #endif
 
+#if CONFIG_DESKTOP_EVENT_MANAGER_TRACE_DELIVERY_CLASSES
+#define QUEUE_IDS_COUNT EVENT_DELIVERY_CLASS_COUNT
+#else
+#define QUEUE_IDS_COUNT 0
+#endif
+
+#if CONFIG_DESKTOP_EVENT_MANAGER_DELIVERY_CLASSES
+#define EVENT_QUEUE_COUNT EVENT_DELIVERY_CLASS_COUNT
+#else
+#define EVENT_QUEUE_COUNT 1
+#endif
+
+/* Queue of events processed by a single thread. */
+struct event_queue {
+	sys_slist_t events;
+	struct k_work work;
+	struct k_work_q *work_q;
+#if CONFIG_DESKTOP_EVENT_MANAGER_TRACE_DELIVERY_CLASSES
+	atomic_t depth;
+	atomic_t max_depth;
+	uint32_t last_dwell_us;
+	uint32_t max_dwell_us;
+#endif
+};
+
+#define EVENT_QUEUE_INITIALIZER(_queue, _work_q)			\
+	{								\
+		.events = SYS_SLIST_STATIC_INIT(&(_queue).events),	\
+		.work = Z_WORK_INITIALIZER(event_processor_fn),		\
+		.work_q = (_work_q),					\
+	}
+
+#if CONFIG_DESKTOP_EVENT_MANAGER_DELIVERY_CLASSES
+static K_THREAD_STACK_DEFINE(realtime_stack,
+			     CONFIG_DESKTOP_EVENT_MANAGER_REALTIME_THREAD_STACK_SIZE);
+static K_THREAD_STACK_DEFINE(background_stack,
+			     CONFIG_DESKTOP_EVENT_MANAGER_BACKGROUND_THREAD_STACK_SIZE);
+static struct k_work_q realtime_work_q;
+static struct k_work_q background_work_q;
+
+static struct event_queue event_queues[EVENT_QUEUE_COUNT] = {
+	[EVENT_DELIVERY_CLASS_REALTIME] = EVENT_QUEUE_INITIALIZER(
+		event_queues[EVENT_DELIVERY_CLASS_REALTIME],
+		&realtime_work_q),
+	[EVENT_DELIVERY_CLASS_NORMAL] = EVENT_QUEUE_INITIALIZER(
+		event_queues[EVENT_DELIVERY_CLASS_NORMAL],
+		&k_sys_work_q),
+	[EVENT_DELIVERY_CLASS_BACKGROUND] = EVENT_QUEUE_INITIALIZER(
+		event_queues[EVENT_DELIVERY_CLASS_BACKGROUND],
+		&background_work_q),
+};
+
+static const char * const delivery_class_names[] = {
+	[EVENT_DELIVERY_CLASS_REALTIME] = "event_queue_realtime",
+	[EVENT_DELIVERY_CLASS_NORMAL] = "event_queue_normal",
+	[EVENT_DELIVERY_CLASS_BACKGROUND] = "event_queue_background",
+};
+#else
+static struct event_queue event_queues[EVENT_QUEUE_COUNT] = {
+	EVENT_QUEUE_INITIALIZER(event_queues[0], &k_sys_work_q),
+};
+#endif /* CONFIG_DESKTOP_EVENT_MANAGER_DELIVERY_CLASSES */
+
 static uint16_t profiler_event_ids[IDS_COUNT];
-static K_WORK_DEFINE(event_processor, event_processor_fn);
-static sys_slist_t eventq = SYS_SLIST_STATIC_INIT(&eventq);
+static uint16_t profiler_queue_event_ids[QUEUE_IDS_COUNT];
 static struct k_spinlock lock;
 
 
+static struct event_queue *event_queue_get(const struct event_type *et)
+{
+#if CONFIG_DESKTOP_EVENT_MANAGER_DELIVERY_CLASSES
+	if (et->delivery_class) {
+		return &event_queues[*et->delivery_class];
+	}
+
+	return &event_queues[EVENT_DELIVERY_CLASS_NORMAL];
+#else
+	return &event_queues[0];
+#endif
+}
+
+
 static bool log_is_event_displayed(const struct event_type *et)
 {
 	uint32_t event_mask = BIT(et - __start_event_types);
@@ -138,12 +214,75 @@ static void trace_event_execution(const struct event_header *eh, bool is_start)
 	profiler_log_send(&buf, trace_evt_id);
 }
 
-static void trace_event_submission(const struct event_header *eh)
+#if CONFIG_DESKTOP_EVENT_MANAGER_TRACE_DELIVERY_CLASSES
+static void trace_queue_submission(struct event_header *eh,
+				   struct event_queue *queue)
+{
+	atomic_val_t depth = atomic_inc(&queue->depth) + 1;
+	atomic_val_t max_depth;
+
+	eh->submit_cycles = k_cycle_get_32();
+
+	/* Events are submitted concurrently, do not lose a maximum. */
+	do {
+		max_depth = atomic_get(&queue->max_depth);
+		if (depth <= max_depth) {
+			break;
+		}
+	} while (!atomic_cas(&queue->max_depth, max_depth, depth));
+
+	size_t trace_evt_id = profiler_queue_event_ids[queue - event_queues];
+
+	if (!is_profiling_enabled(trace_evt_id)) {
+		return;
+	}
+
+	struct log_event_buf buf;
+	ARG_UNUSED(buf);
+
+	profiler_log_start(&buf);
+	profiler_log_encode_u32(&buf, depth);
+	profiler_log_encode_u32(&buf, atomic_get(&queue->max_depth));
+	profiler_log_encode_u32(&buf, queue->last_dwell_us);
+	profiler_log_encode_u32(&buf, queue->max_dwell_us);
+	profiler_log_send(&buf, trace_evt_id);
+}
+
+static void trace_queue_execution(const struct event_header *eh,
+				  struct event_queue *queue)
+{
+	uint32_t dwell_cycles = k_cycle_get_32() - eh->submit_cycles;
+
+	queue->last_dwell_us = k_cyc_to_us_floor32(dwell_cycles);
+	if (queue->last_dwell_us > queue->max_dwell_us) {
+		queue->max_dwell_us = queue->last_dwell_us;
+	}
+
+	atomic_dec(&queue->depth);
+}
+#else
+static void trace_queue_submission(struct event_header *eh,
+				   struct event_queue *queue)
+{
+}
+
+static void trace_queue_execution(const struct event_header *eh,
+				  struct event_queue *queue)
+{
+}
+#endif /* CONFIG_DESKTOP_EVENT_MANAGER_TRACE_DELIVERY_CLASSES */
+
+static void trace_event_submission(struct event_header *eh,
+				   struct event_queue *queue)
 {
 	if (!IS_ENABLED(CONFIG_DESKTOP_EVENT_MANAGER_PROFILER_ENABLED)) {
 		return;
 	}
 
+	if (queue) {
+		trace_queue_submission(eh, queue);
+	}
+
 	const struct event_type *et = eh->type_id;
 	size_t event_idx = et - __start_event_types;
 	size_t trace_evt_id = profiler_event_ids[event_idx];
@@ -192,6 +331,26 @@ static void trace_register_execution_tracking_events(void)
 	profiler_event_ids[event_cnt + 1] = profiler_event_id;
 }
 
+static void trace_register_queue_events(void)
+{
+#if CONFIG_DESKTOP_EVENT_MANAGER_TRACE_DELIVERY_CLASSES
+	const char *labels[] = {"queue_depth", "max_queue_depth",
+				"dwell_time_us", "max_dwell_time_us"};
+	enum profiler_arg types[] = {PROFILER_ARG_U32, PROFILER_ARG_U32,
+				     PROFILER_ARG_U32, PROFILER_ARG_U32};
+
+	BUILD_ASSERT(ARRAY_SIZE(labels) == ARRAY_SIZE(types));
+	BUILD_ASSERT(ARRAY_SIZE(delivery_class_names) ==
+		     EVENT_DELIVERY_CLASS_COUNT);
+
+	for (size_t i = 0; i < EVENT_DELIVERY_CLASS_COUNT; i++) {
+		profiler_queue_event_ids[i] = profiler_register_event_type(
+				delivery_class_names[i], labels, types,
+				ARRAY_SIZE(labels));
+	}
+#endif
+}
+
 static void trace_register_events(void)
 {
 	for (const struct event_type *et = __start_event_types;
@@ -212,6 +371,8 @@ static void trace_register_events(void)
 	if (IS_ENABLED(CONFIG_DESKTOP_EVENT_MANAGER_TRACE_EVENT_EXECUTION)) {
 		trace_register_execution_tracking_events();
 	}
+
+	trace_register_queue_events();
 }
 
 static int trace_event_init(void)
@@ -228,19 +389,153 @@ static int trace_event_init(void)
 	return 0;
 }
 
+#ifdef CONFIG_DESKTOP_EVENT_MANAGER_EVENT_POOLS
+static void event_pool_update_max_used(struct event_pool *pool)
+{
+	atomic_val_t used = k_mem_slab_num_used_get(pool->slab);
+	atomic_val_t max_used;
+
+	do {
+		max_used = atomic_get(&pool->max_used);
+		if (used <= max_used) {
+			break;
+		}
+	} while (!atomic_cas(&pool->max_used, max_used, used));
+}
+
+static void *event_pool_alloc(const struct event_type *et, size_t size)
+{
+	struct event_pool *pool = et->pool;
+	void *event;
+
+	ARG_UNUSED(size);
+
+	if (k_mem_slab_alloc(pool->slab, &event, K_NO_WAIT)) {
+		atomic_inc(&pool->alloc_failures);
+		return NULL;
+	}
+
+	event_pool_update_max_used(pool);
+
+	return event;
+}
+
+void *_event_manager_alloc(const struct event_type *et, size_t size)
+{
+	if (et->pool) {
+		return event_pool_alloc(et, size);
+	}
+
+	return k_malloc(size);
+}
+
+void _event_manager_free(struct event_header *eh)
+{
+	struct event_pool *pool = eh->type_id->pool;
+
+	if (pool) {
+		void *event = eh;
+
+		k_mem_slab_free(pool->slab, &event);
+	} else {
+		k_free(eh);
+	}
+}
+#else
+void *_event_manager_alloc(const struct event_type *et, size_t size)
+{
+	return k_malloc(size);
+}
+
+void _event_manager_free(struct event_header *eh)
+{
+	k_free(eh);
+}
+#endif /* CONFIG_DESKTOP_EVENT_MANAGER_EVENT_POOLS */
+
+#ifdef CONFIG_DESKTOP_EVENT_MANAGER_EVENT_COALESCING
+static bool event_coalesce(struct event_header *eh)
+{
+	struct event_coalesce *coalesce = eh->type_id->coalesce;
+	bool merged = false;
+
+	if (!coalesce) {
+		return false;
+	}
+
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	if (coalesce->pending) {
+		merged = coalesce->merge(coalesce->pending, eh);
+	}
+
+	k_spin_unlock(&lock, key);
+
+	if (merged) {
+		atomic_inc(&coalesce->merged_cnt);
+	}
+
+	return merged;
+}
+
+static void event_coalesce_set_pending(struct event_header *eh)
+{
+	struct event_coalesce *coalesce = eh->type_id->coalesce;
+
+	if (coalesce) {
+		coalesce->pending = eh;
+	}
+}
+
+static void event_coalesce_clear_pending(struct event_header *eh)
+{
+	struct event_coalesce *coalesce = eh->type_id->coalesce;
+
+	if (!coalesce) {
+		return;
+	}
+
+	/* Event cannot be merged into once its processing has started. */
+	k_spinlock_key_t key = k_spin_lock(&lock);
+
+	if (coalesce->pending == eh) {
+		coalesce->pending = NULL;
+	}
+
+	k_spin_unlock(&lock, key);
+
+	atomic_inc(&coalesce->delivered_cnt);
+}
+#else
+static bool event_coalesce(struct event_header *eh)
+{
+	return false;
+}
+
+static void event_coalesce_set_pending(struct event_header *eh)
+{
+}
+
+static void event_coalesce_clear_pending(struct event_header *eh)
+{
+}
+#endif /* CONFIG_DESKTOP_EVENT_MANAGER_EVENT_COALESCING */
+
 static void event_processor_fn(struct k_work *work)
 {
+	struct event_queue *queue = CONTAINER_OF(work, struct event_queue,
+						 work);
 	sys_slist_t events = SYS_SLIST_STATIC_INIT(&events);
 
 	/* Make current event list local. */
 	k_spinlock_key_t key = k_spin_lock(&lock);
 
-	if (sys_slist_is_empty(&eventq)) {
+	if (sys_slist_is_empty(&queue->events)) {
 		k_spin_unlock(&lock, key);
 		return;
 	}
 
-	sys_slist_merge_slist(&events, &eventq);
+	sys_slist_merge_slist(&events, &queue->events);
 
 	k_spin_unlock(&lock, key);
 
@@ -256,40 +551,39 @@ static void event_processor_fn(struct k_work *work)
 
 		const struct event_type *et = eh->type_id;
 
+		event_coalesce_clear_pending(eh);
+
+		trace_queue_execution(eh, queue);
+
 		trace_event_execution(eh, true);
 
 		log_event(eh);
 
 		bool consumed = false;
 
-		for (size_t prio = SUBS_PRIO_MIN;
-		     (prio <= SUBS_PRIO_MAX) && !consumed;
-		     prio++) {
-			for (const struct event_subscriber *es =
-					et->subs_start[prio];
-			     (es != et->subs_stop[prio]) && !consumed;
-			     es++) {
+		for (const struct event_subscriber *es = et->subs_start;
+		     (es != et->subs_stop) && !consumed;
+		     es++) {
 
-				__ASSERT_NO_MSG(es != NULL);
+			__ASSERT_NO_MSG(es != NULL);
 
-				const struct event_listener *el = es->listener;
+			const struct event_listener *el = es->listener;
 
-				__ASSERT_NO_MSG(el != NULL);
-				__ASSERT_NO_MSG(el->notification != NULL);
+			__ASSERT_NO_MSG(el != NULL);
+			__ASSERT_NO_MSG(el->notification != NULL);
 
-				log_event_progress(et, el);
+			log_event_progress(et, el);
 
-				consumed = el->notification(eh);
+			consumed = el->notification(eh);
 
-				if (consumed) {
-					log_event_consumed(et);
-				}
+			if (consumed) {
+				log_event_consumed(et);
 			}
 		}
 
 		trace_event_execution(eh, false);
 
-		k_free(eh);
+		_event_manager_free(eh);
 	}
 }
 
@@ -298,17 +592,55 @@ void _event_submit(struct event_header *eh)
 	__ASSERT_NO_MSG(eh);
 	ASSERT_EVENT_ID(eh->type_id);
 
-	trace_event_submission(eh);
+	/* Subscriber arrays are resolved by the linker. Event without
+	 * subscribers would not be processed by anyone, so it is released
+	 * right away instead of being queued.
+	 */
+	if (eh->type_id->subs_start == eh->type_id->subs_stop) {
+		trace_event_submission(eh, NULL);
+		_event_manager_free(eh);
+		return;
+	}
+
+	/* Event merged into the pending event of the same type is not
+	 * processed on its own.
+	 */
+	if (event_coalesce(eh)) {
+		_event_manager_free(eh);
+		return;
+	}
+
+	struct event_queue *queue = event_queue_get(eh->type_id);
+
+	trace_event_submission(eh, queue);
 
 	k_spinlock_key_t key = k_spin_lock(&lock);
-	sys_slist_append(&eventq, &eh->node);
+	sys_slist_append(&queue->events, &eh->node);
+	event_coalesce_set_pending(eh);
 	k_spin_unlock(&lock, key);
 
-	k_work_submit(&event_processor);
+	k_work_submit_to_queue(queue->work_q, &queue->work);
+}
+
+static void event_queues_init(void)
+{
+#if CONFIG_DESKTOP_EVENT_MANAGER_DELIVERY_CLASSES
+	k_work_q_start(&realtime_work_q, realtime_stack,
+		       K_THREAD_STACK_SIZEOF(realtime_stack),
+		       CONFIG_DESKTOP_EVENT_MANAGER_REALTIME_THREAD_PRIORITY);
+	k_thread_name_set(&realtime_work_q.thread, "event_manager_rt");
+
+	k_work_q_start(&background_work_q, background_stack,
+		       K_THREAD_STACK_SIZEOF(background_stack),
+		       CONFIG_DESKTOP_EVENT_MANAGER_BACKGROUND_THREAD_PRIORITY);
+	k_thread_name_set(&background_work_q.thread, "event_manager_bg");
+#endif
 }
 
 int event_manager_init(void)
 {
+	event_queues_init();
+
 	log_event_init();
 
 	return trace_event_init();
@@ -26,55 +26,49 @@ extern "C" {
 #define _SUBS_PRIO_FINAL  2
 
 
-/* Convenience macros generating section names. */
-
-#define _SUBS_PRIO_ID(level) _CONCAT(_CONCAT(_prio, level), _)
-
-#define _EVENT_SUBSCRIBERS_SECTION_PREFIX(ename, prio)	_CONCAT(_CONCAT(event_subscribers_, ename), prio)
-
-#define _EVENT_SUBSCRIBERS_SECTION_NAME(ename, prio)	STRINGIFY(_EVENT_SUBSCRIBERS_SECTION_PREFIX(ename, prio))
-
-
-/* Declare a zero-length subscriber. */
-#define _EVENT_SUBSCRIBERS_EMPTY(ename, prio)								\
-	const struct {} _CONCAT(_EVENT_SUBSCRIBERS_SECTION_PREFIX(ename, prio), empty)			\
-	__attribute__((__section__(STRINGIFY(_EVENT_SUBSCRIBERS_SECTION_NAME(ename, prio))))) = {};
+/* Subscribers of all event types are placed in sections sorted by name by
+ * the linker (see em.ld). Section name of a subscriber is composed of the
+ * event name and the priority level. Zero-length markers placed before and
+ * after the subscribers delimit one contiguous, priority-ordered array of
+ * subscribers for every event type.
+ *
+ * The dot separating the event name from the suffix sorts before any
+ * character allowed in an identifier. This ensures that sections of events
+ * whose names share a common prefix do not interleave.
+ */
 
+#define _EVENT_SUBSCRIBERS_SECTION_NAME(ename, suffix) \
+	"event_subscribers_" STRINGIFY(ename) "." suffix
 
-/* Convenience macros generating section start and stop markers. */
+#define _EVENT_SUBSCRIBERS_PRIO_SECTION_NAME(ename, prio) \
+	_EVENT_SUBSCRIBERS_SECTION_NAME(ename, "b" STRINGIFY(prio))
 
-#define _EVENT_SUBSCRIBERS_START(ename, prio)	_CONCAT(__start_, _EVENT_SUBSCRIBERS_SECTION_PREFIX(ename, prio))
 
-#define _EVENT_SUBSCRIBERS_STOP(ename, prio)	_CONCAT(__stop_,  _EVENT_SUBSCRIBERS_SECTION_PREFIX(ename, prio))
+/* Convenience macros generating subscriber array start and stop markers. */
 
+#define _EVENT_SUBSCRIBERS_START(ename)	_CONCAT(__start_event_subscribers_, ename)
 
-#define _EVENT_SUBSCRIBERS_DECLARE(ename)										\
-	extern const struct event_subscriber _EVENT_SUBSCRIBERS_START(ename, _SUBS_PRIO_ID(_SUBS_PRIO_FIRST))[];	\
-	extern const struct event_subscriber _EVENT_SUBSCRIBERS_STOP(ename,  _SUBS_PRIO_ID(_SUBS_PRIO_FIRST))[];	\
-	extern const struct event_subscriber _EVENT_SUBSCRIBERS_START(ename, _SUBS_PRIO_ID(_SUBS_PRIO_NORMAL))[];	\
-	extern const struct event_subscriber _EVENT_SUBSCRIBERS_STOP(ename,  _SUBS_PRIO_ID(_SUBS_PRIO_NORMAL))[];	\
-	extern const struct event_subscriber _EVENT_SUBSCRIBERS_START(ename, _SUBS_PRIO_ID(_SUBS_PRIO_FINAL))[];	\
-	extern const struct event_subscriber _EVENT_SUBSCRIBERS_STOP(ename,  _SUBS_PRIO_ID(_SUBS_PRIO_FINAL))[];
+#define _EVENT_SUBSCRIBERS_STOP(ename)	_CONCAT(__stop_event_subscribers_, ename)
 
 
-/* Macro defining empty subscribers on each priority level.
- * Each event type keeps an array of subscribers for every priority level.
- * It can happen that for a given priority no subscriber will be registered.
- * This macro declares zero-length subscriber that will cause required section
- * to be generated by the linker. If no subscriber is registered at this
- * level section will remain empty.
+/* Macro defining zero-length markers of the subscriber array.
+ * Start marker is sorted before subscribers of all priority levels and stop
+ * marker is sorted after them. If no subscriber is registered for the event
+ * type both markers point to the same address.
  */
-#define _EVENT_SUBSCRIBERS_DEFINE(ename)					\
-	_EVENT_SUBSCRIBERS_EMPTY(ename, _SUBS_PRIO_ID(_SUBS_PRIO_FIRST))	\
-	_EVENT_SUBSCRIBERS_EMPTY(ename, _SUBS_PRIO_ID(_SUBS_PRIO_NORMAL))	\
-	_EVENT_SUBSCRIBERS_EMPTY(ename, _SUBS_PRIO_ID(_SUBS_PRIO_FINAL))
+#define _EVENT_SUBSCRIBERS_DEFINE(ename)							\
+	const struct event_subscriber _EVENT_SUBSCRIBERS_START(ename)[0] __used			\
+	__attribute__((__section__(_EVENT_SUBSCRIBERS_SECTION_NAME(ename, "a")))) = {};		\
+	const struct event_subscriber _EVENT_SUBSCRIBERS_STOP(ename)[0] __used			\
+	__attribute__((__section__(_EVENT_SUBSCRIBERS_SECTION_NAME(ename, "c")))) = {}
 
 
 /* Subscribe a listener to an event. */
-#define _EVENT_SUBSCRIBE(lname, ename, prio)								\
+#define _EVENT_SUBSCRIBE(lname, ename, level)							\
 	const struct event_subscriber _CONCAT(_CONCAT(__event_subscriber_, ename), lname) __used	\
-	__attribute__((__section__(_EVENT_SUBSCRIBERS_SECTION_NAME(ename, prio)))) = {			\
+	__attribute__((__section__(_EVENT_SUBSCRIBERS_PRIO_SECTION_NAME(ename, level)))) = {		\
 		.listener = &_CONCAT(__event_listener_, lname),						\
+		.prio = (level),										\
 	}
 
 
@@ -82,16 +76,34 @@ extern "C" {
 #define _EVENT_ID(ename) (&_CONCAT(__event_type_, ename))
 
 
+/* Event memory allocation. When event pools are enabled, the event type
+ * decides whether the event is taken from its own memory slab or from the
+ * heap.
+ */
+#ifdef CONFIG_DESKTOP_EVENT_MANAGER_EVENT_POOLS
+#define _EVENT_ALLOC(ename, size) _event_manager_alloc(_EVENT_ID(ename), (size))
+#define _EVENT_HAS_POOL(ename) (_EVENT_ID(ename)->pool != NULL)
+#else
+#define _EVENT_ALLOC(ename, size) k_malloc(size)
+#define _EVENT_HAS_POOL(ename) false
+#endif /* CONFIG_DESKTOP_EVENT_MANAGER_EVENT_POOLS */
+
+
 /* Macro generates a function of name new_ename where ename is provided as
  * an argument. Allocator function is used to create an event of the given
- * ename type.
+ * ename type. An exhausted event pool is counted in the pool statistics and
+ * NULL is returned, a heap allocation failure is fatal.
  */
 #define _EVENT_ALLOCATOR_FN(ename)					\
 	static inline struct ename *_CONCAT(new_, ename)(void)		\
 	{								\
-		struct ename *event = (struct ename *)k_malloc(sizeof(*event));\
+		struct ename *event =					\
+			(struct ename *)_EVENT_ALLOC(ename, sizeof(*event));\
 		BUILD_ASSERT(offsetof(struct ename, header) == 0,	\
 				 "");					\
+		if (unlikely(!event) && _EVENT_HAS_POOL(ename)) {	\
+			return NULL;					\
+		}							\
 		if (unlikely(!event)) {					\
 			printk("Event Manager OOM error\n");		\
 			LOG_PANIC();					\
@@ -111,7 +123,8 @@ extern "C" {
 #define _EVENT_ALLOCATOR_DYNDATA_FN(ename)				\
 	static inline struct ename *_CONCAT(new_, ename)(size_t size)	\
 	{								\
-		struct ename *event = (struct ename *)k_malloc(sizeof(*event) + size);\
+		struct ename *event =					\
+			(struct ename *)_EVENT_ALLOC(ename, sizeof(*event) + size);\
 		BUILD_ASSERT((offsetof(struct ename, dyndata) +		\
 				  sizeof(event->dyndata.size)) ==	\
 				 sizeof(*event), "");			\
@@ -204,20 +217,111 @@ extern "C" {
 	}
 
 
+/* Event pool is declared as a weak symbol. Event type refers to it and the
+ * reference resolves to NULL unless the pool is defined for the event type.
+ */
+#ifdef CONFIG_DESKTOP_EVENT_MANAGER_EVENT_POOLS
+#define _EVENT_POOL_DECLARE(ename) \
+	extern struct event_pool _EVENT_POOL_NAME(ename) __weak
+#define _EVENT_POOL_INIT(ename) \
+	.pool = &_EVENT_POOL_NAME(ename),
+#else
+#define _EVENT_POOL_DECLARE(ename)
+#define _EVENT_POOL_INIT(ename)
+#endif /* CONFIG_DESKTOP_EVENT_MANAGER_EVENT_POOLS */
+
+
+#define _EVENT_POOL_NAME(ename) _CONCAT(__event_pool_, ename)
+#define _EVENT_DYNDATA_NAME(ename) _CONCAT(__event_dyndata_, ename)
+#define _EVENT_POOL_SLAB_NAME(ename) _CONCAT(__event_pool_slab_, ename)
+#define _EVENT_POOL_ALIGN(ename) MAX(__alignof__(struct ename), sizeof(void *))
+
+/* Slab name must be expanded before it is pasted by K_MEM_SLAB_DEFINE. */
+#define _EVENT_POOL_SLAB_DEFINE(name, block_size, count, align) \
+	K_MEM_SLAB_DEFINE(name, block_size, count, align)
+
+
+#define _EVENT_POOL_DEFINE(ename, count)					\
+	BUILD_ASSERT((count) > 0, "Event pool cannot be empty");		\
+	BUILD_ASSERT(!_EVENT_DYNDATA_NAME(ename),				\
+		     "Event pool cannot hold events with dynamic data");	\
+	_EVENT_POOL_SLAB_DEFINE(_EVENT_POOL_SLAB_NAME(ename),			\
+			  ROUND_UP(sizeof(struct ename), _EVENT_POOL_ALIGN(ename)),\
+			  (count), _EVENT_POOL_ALIGN(ename));			\
+	struct event_pool _EVENT_POOL_NAME(ename) = {				\
+		.slab = &_EVENT_POOL_SLAB_NAME(ename),				\
+	}
+
+
+/* Delivery class is declared as a weak symbol. Event type refers to it and
+ * the reference resolves to NULL unless the delivery class is defined for
+ * the event type.
+ */
+#ifdef CONFIG_DESKTOP_EVENT_MANAGER_DELIVERY_CLASSES
+#define _EVENT_DELIVERY_CLASS_DECLARE(ename) \
+	extern const enum event_delivery_class _EVENT_DELIVERY_CLASS_NAME(ename) __weak
+#define _EVENT_DELIVERY_CLASS_INIT(ename) \
+	.delivery_class = &_EVENT_DELIVERY_CLASS_NAME(ename),
+#else
+#define _EVENT_DELIVERY_CLASS_DECLARE(ename)
+#define _EVENT_DELIVERY_CLASS_INIT(ename)
+#endif /* CONFIG_DESKTOP_EVENT_MANAGER_DELIVERY_CLASSES */
+
+
+#define _EVENT_DELIVERY_CLASS_NAME(ename) _CONCAT(__event_delivery_class_, ename)
+
+
+#define _EVENT_DELIVERY_CLASS_DEFINE(ename, dclass)				\
+	BUILD_ASSERT((dclass) < EVENT_DELIVERY_CLASS_COUNT,			\
+		     "Invalid delivery class");					\
+	const enum event_delivery_class _EVENT_DELIVERY_CLASS_NAME(ename) = (dclass)
+
+
+/* Event coalescing is declared as a weak symbol. Event type refers to it and
+ * the reference resolves to NULL unless coalescing is defined for the event
+ * type.
+ */
+#ifdef CONFIG_DESKTOP_EVENT_MANAGER_EVENT_COALESCING
+#define _EVENT_COALESCE_DECLARE(ename) \
+	extern struct event_coalesce _EVENT_COALESCE_NAME(ename) __weak
+#define _EVENT_COALESCE_INIT(ename) \
+	.coalesce = &_EVENT_COALESCE_NAME(ename),
+#else
+#define _EVENT_COALESCE_DECLARE(ename)
+#define _EVENT_COALESCE_INIT(ename)
+#endif /* CONFIG_DESKTOP_EVENT_MANAGER_EVENT_COALESCING */
+
+
+#define _EVENT_COALESCE_NAME(ename) _CONCAT(__event_coalesce_, ename)
+
+
+#define _EVENT_COALESCE_DEFINE(ename, merge_fn)				\
+	struct event_coalesce _EVENT_COALESCE_NAME(ename) = {		\
+		.merge = (merge_fn),					\
+	}
+
+
 #define _EVENT_TYPE_DECLARE_COMMON(ename)				\
 	extern const struct event_type _CONCAT(__event_type_, ename);	\
-	_EVENT_SUBSCRIBERS_DECLARE(ename);				\
+	_EVENT_POOL_DECLARE(ename);					\
+	_EVENT_DELIVERY_CLASS_DECLARE(ename);				\
+	_EVENT_COALESCE_DECLARE(ename);					\
 	_EVENT_CASTER_FN(ename);					\
 	_EVENT_TYPECHECK_FN(ename)
 
 
+/* Whether the event type has dynamic data is known at build time, so that
+ * an event pool cannot be defined for it.
+ */
 #define _EVENT_TYPE_DECLARE(ename)					\
 	_EVENT_TYPE_DECLARE_COMMON(ename);				\
+	enum { _EVENT_DYNDATA_NAME(ename) = 0 };			\
 	_EVENT_ALLOCATOR_FN(ename)
 
 
 #define _EVENT_TYPE_DYNDATA_DECLARE(ename)				\
 	_EVENT_TYPE_DECLARE_COMMON(ename);				\
+	enum { _EVENT_DYNDATA_NAME(ename) = 1 };			\
 	_EVENT_ALLOCATOR_DYNDATA_FN(ename)
 
 
@@ -226,19 +330,14 @@ extern "C" {
 	const struct event_type _CONCAT(__event_type_, ename) __used							\
 	__attribute__((__section__("event_types"))) = {									\
 		.name				= STRINGIFY(ename),							\
-		.subs_start	= {											\
-			[_SUBS_PRIO_FIRST]	= _EVENT_SUBSCRIBERS_START(ename, _SUBS_PRIO_ID(_SUBS_PRIO_FIRST)),	\
-			[_SUBS_PRIO_NORMAL]	= _EVENT_SUBSCRIBERS_START(ename, _SUBS_PRIO_ID(_SUBS_PRIO_NORMAL)),	\
-			[_SUBS_PRIO_FINAL]	= _EVENT_SUBSCRIBERS_START(ename, _SUBS_PRIO_ID(_SUBS_PRIO_FINAL)),	\
-		},													\
-		.subs_stop	= {											\
-			[_SUBS_PRIO_FIRST]	= _EVENT_SUBSCRIBERS_STOP(ename, _SUBS_PRIO_ID(_SUBS_PRIO_FIRST)),	\
-			[_SUBS_PRIO_NORMAL]	= _EVENT_SUBSCRIBERS_STOP(ename, _SUBS_PRIO_ID(_SUBS_PRIO_NORMAL)),	\
-			[_SUBS_PRIO_FINAL]	= _EVENT_SUBSCRIBERS_STOP(ename, _SUBS_PRIO_ID(_SUBS_PRIO_FINAL)),	\
-		},													\
+		.subs_start			= _EVENT_SUBSCRIBERS_START(ename),					\
+		.subs_stop			= _EVENT_SUBSCRIBERS_STOP(ename),					\
 		.init_log_enable		= init_log_en,								\
 		.log_event			= log_fn,								\
 		.ev_info			= ev_info_struct,							\
+		_EVENT_POOL_INIT(ename)											\
+		_EVENT_DELIVERY_CLASS_INIT(ename)									\
+		_EVENT_COALESCE_INIT(ename)										\
 	}
 
 
@@ -56,35 +56,82 @@ static int show_subscribers(const struct shell *shell, size_t argc,
 	     (et != NULL) && (et != __stop_event_types);
 	     et++) {
 
-		bool is_subscribed = false;
+		if (et->subs_start == et->subs_stop) {
+			shell_fprintf(shell, SHELL_NORMAL,
+				      "|\t[E:%s] has no subscribers\n",
+				      et->name);
+		}
 
-		for (size_t prio = SUBS_PRIO_MIN;
-		     prio <= SUBS_PRIO_MAX;
-		     prio++) {
-			for (const struct event_subscriber *es =
-					et->subs_start[prio];
-			     es != et->subs_stop[prio];
-			     es++) {
+		for (const struct event_subscriber *es = et->subs_start;
+		     es != et->subs_stop;
+		     es++) {
 
-				__ASSERT_NO_MSG(es != NULL);
-				const struct event_listener *el = es->listener;
+			__ASSERT_NO_MSG(es != NULL);
+			const struct event_listener *el = es->listener;
 
-				__ASSERT_NO_MSG(el != NULL);
-				shell_fprintf(shell, SHELL_NORMAL,
-					      "|\tprio:%u\t[E:%s] -> [L:%s]\n",
-					      prio, et->name, el->name);
+			__ASSERT_NO_MSG(el != NULL);
+			shell_fprintf(shell, SHELL_NORMAL,
+				      "|\tprio:%u\t[E:%s] -> [L:%s]\n",
+				      es->prio, et->name, el->name);
+		}
 
-				is_subscribed = true;
-			}
+		shell_fprintf(shell, SHELL_NORMAL, "\n");
+	}
+
+	return 0;
+}
+
+static int show_pools(const struct shell *shell, size_t argc,
+		      char **argv)
+{
+#ifdef CONFIG_DESKTOP_EVENT_MANAGER_EVENT_POOLS
+	shell_fprintf(shell, SHELL_NORMAL, "Event pools:\n");
+	for (const struct event_type *et = __start_event_types;
+	     (et != NULL) && (et != __stop_event_types);
+	     et++) {
+
+		const struct event_pool *pool = et->pool;
+
+		if (!pool) {
+			continue;
 		}
 
-		if (!is_subscribed) {
-			shell_fprintf(shell, SHELL_NORMAL,
-				      "|\t[E:%s] has no subscribers\n",
-				      et->name);
+		shell_fprintf(shell, SHELL_NORMAL,
+			      "|\t[E:%s] size:%zu used:%u/%u max_used:%u "
+			      "failures:%u\n",
+			      et->name, pool->slab->block_size,
+			      k_mem_slab_num_used_get(pool->slab),
+			      pool->slab->num_blocks,
+			      (uint32_t)atomic_get(&pool->max_used),
+			      (uint32_t)atomic_get(&pool->alloc_failures));
+	}
+#endif /* CONFIG_DESKTOP_EVENT_MANAGER_EVENT_POOLS */
+
+	return 0;
+}
+
+static int show_coalescing(const struct shell *shell, size_t argc,
+			   char **argv)
+{
+#ifdef CONFIG_DESKTOP_EVENT_MANAGER_EVENT_COALESCING
+	shell_fprintf(shell, SHELL_NORMAL, "Event coalescing:\n");
+	for (const struct event_type *et = __start_event_types;
+	     (et != NULL) && (et != __stop_event_types);
+	     et++) {
+
+		const struct event_coalesce *coalesce = et->coalesce;
+
+		if (!coalesce) {
+			continue;
 		}
-		shell_fprintf(shell, SHELL_NORMAL, "\n");
+
+		shell_fprintf(shell, SHELL_NORMAL,
+			      "|\t[E:%s] merged:%u delivered:%u\n",
+			      et->name,
+			      (uint32_t)atomic_get(&coalesce->merged_cnt),
+			      (uint32_t)atomic_get(&coalesce->delivered_cnt));
 	}
+#endif /* CONFIG_DESKTOP_EVENT_MANAGER_EVENT_COALESCING */
 
 	return 0;
 }
@@ -168,6 +215,13 @@ SHELL_STATIC_SUBCMD_SET_CREATE(sub_event_manager,
 	SHELL_CMD_ARG(show_subscribers, NULL, "Show subscribers",
 		      show_subscribers, 0, 0),
 	SHELL_CMD_ARG(show_events, NULL, "Show events", show_events, 0, 0),
+	SHELL_COND_CMD_ARG(CONFIG_DESKTOP_EVENT_MANAGER_EVENT_POOLS,
+			   show_pools, NULL, "Show event pools statistics",
+			   show_pools, 0, 0),
+	SHELL_COND_CMD_ARG(CONFIG_DESKTOP_EVENT_MANAGER_EVENT_COALESCING,
+			   show_coalescing, NULL,
+			   "Show event coalescing statistics",
+			   show_coalescing, 0, 0),
 	SHELL_CMD_ARG(disable, NULL, "Disable displaying event with given ID",
 		      disable_event_displaying, 0,
 		      sizeof(event_manager_displayed_events) * 8 - 1),
@@ -337,6 +337,38 @@ int socket_send(const struct download_client *client, size_t len)
 	return 0;
 }
 
+int socket_send_iov(const struct download_client *client,
+		    struct iovec *iov, size_t iovcnt)
+{
+	ssize_t sent;
+	struct msghdr msg = {
+		.msg_iov = iov,
+		.msg_iovlen = iovcnt,
+	};
+
+	while (msg.msg_iovlen) {
+		sent = sendmsg(client->fd, &msg, 0);
+		if (sent <= 0) {
+			return -errno;
+		}
+
+		/* Skip the buffers that have been sent entirely */
+		while (msg.msg_iovlen && sent >= msg.msg_iov->iov_len) {
+			sent -= msg.msg_iov->iov_len;
+			msg.msg_iov++;
+			msg.msg_iovlen--;
+		}
+
+		if (msg.msg_iovlen) {
+			msg.msg_iov->iov_base =
+				(uint8_t *)msg.msg_iov->iov_base + sent;
+			msg.msg_iov->iov_len -= sent;
+		}
+	}
+
+	return 0;
+}
+
 static int request_send(struct download_client *dl)
 {
 	switch (dl->proto) {
@@ -369,6 +401,17 @@ static int fragment_evt_send(const struct download_client *client)
 	return client->callback(&evt);
 }
 
+static void throughput_update(struct download_client *dl)
+{
+	int64_t elapsed = k_uptime_get() - dl->stats.start;
+
+	if (elapsed > 0) {
+		dl->stats.throughput = ((uint64_t)(dl->progress -
+						   dl->stats.from) *
+					MSEC_PER_SEC) / elapsed;
+	}
+}
+
 static int error_evt_send(const struct download_client *dl, int error)
 {
 	/* Error will be sent as negative. */
@@ -420,11 +463,20 @@ restart_and_suspend:
 			break;
 		}
 
-		LOG_DBG("Receiving up to %d bytes at %p...",
-			(sizeof(dl->buf) - dl->offset), (dl->buf + dl->offset));
+		if (dl->http.carry) {
+			/* Parse the beginning of the next pipelined response,
+			 * which was read along with the previous one.
+			 */
+			len = dl->http.carry;
+			dl->http.carry = 0;
+		} else {
+			LOG_DBG("Receiving up to %d bytes at %p...",
+				(sizeof(dl->buf) - dl->offset),
+				(dl->buf + dl->offset));
 
-		len = recv(dl->fd, dl->buf + dl->offset,
-			   sizeof(dl->buf) - dl->offset, 0);
+			len = recv(dl->fd, dl->buf + dl->offset,
+				   sizeof(dl->buf) - dl->offset, 0);
+		}
 
 		if ((len == 0) || (len == -1)) {
 			/* We just had an unexpected socket error or closure */
@@ -500,6 +552,8 @@ restart_and_suspend:
 			break;
 		}
 
+		throughput_update(dl);
+
 		if (dl->file_size) {
 			LOG_INF("Downloaded %u/%u bytes (%d%%)",
 				dl->progress, dl->file_size,
@@ -519,7 +573,8 @@ restart_and_suspend:
 		}
 
 		if (dl->progress == dl->file_size) {
-			LOG_INF("Download complete");
+			LOG_INF("Download complete, %u bytes/s",
+				dl->stats.throughput);
 			const struct download_client_evt evt = {
 				.id = DOWNLOAD_CLIENT_EVT_DONE,
 			};
@@ -535,6 +590,13 @@ restart_and_suspend:
 		}
 
 send_again:
+		if (dl->http.carry) {
+			/* Move the beginning of the next pipelined response
+			 * at the beginning of the buffer.
+			 */
+			memmove(dl->buf, dl->buf + dl->offset, dl->http.carry);
+		}
+
 		dl->offset = 0;
 		/* Request next fragment, if necessary (HTTPS/CoAP) */
 		if (dl->proto != IPPROTO_TCP || len == 0
@@ -628,6 +690,11 @@ int download_client_connect(struct download_client *client, const char *host,
 		return err;
 	}
 
+	/* Requests sent on a previous connection are never answered */
+	client->http.next_req = client->progress;
+	client->http.pending = 0;
+	client->http.carry = 0;
+
 	return 0;
 }
 
@@ -663,12 +730,27 @@ int download_client_start(struct download_client *client, const char *file,
 		return -ENOTCONN;
 	}
 
+	if (client->http.pending) {
+		/* A stopped download still has responses in flight,
+		 * drop them along with the connection.
+		 */
+		err = reconnect(client);
+		if (err) {
+			return err;
+		}
+	}
+
 	client->file = file;
 	client->file_size = 0;
 	client->progress = from;
 
 	client->offset = 0;
 	client->http.has_header = false;
+	client->http.next_req = from;
+
+	client->stats.start = k_uptime_get();
+	client->stats.from = from;
+	client->stats.throughput = 0;
 
 	if (client->proto == IPPROTO_UDP || client->proto == IPPROTO_DTLS_1_2) {
 		if (IS_ENABLED(CONFIG_COAP)) {
@@ -710,3 +792,15 @@ int download_client_file_size_get(struct download_client *client, size_t *size)
 
 	return 0;
 }
+
+int download_client_throughput_get(struct download_client *client,
+				   uint32_t *throughput)
+{
+	if (!client || !throughput) {
+		return -EINVAL;
+	}
+
+	*throughput = client->stats.throughput;
+
+	return 0;
+}
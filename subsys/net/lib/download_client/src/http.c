@@ -10,6 +10,7 @@
 #include <string.h>
 #include <logging/log.h>
 #include <sys/__assert.h>
+#include <net/socket.h>
 #include <net/download_client.h>
 
 LOG_MODULE_DECLARE(download_client, CONFIG_DOWNLOAD_CLIENT_LOG_LEVEL);
@@ -17,29 +18,112 @@ LOG_MODULE_DECLARE(download_client, CONFIG_DOWNLOAD_CLIENT_LOG_LEVEL);
 #define HOSTNAME_SIZE CONFIG_DOWNLOAD_CLIENT_MAX_HOSTNAME_SIZE
 #define FILENAME_SIZE CONFIG_DOWNLOAD_CLIENT_MAX_FILENAME_SIZE
 
-#define GET_HTTP_TEMPLATE                                                      \
-	"GET /%s HTTP/1.1\r\n"                                                 \
-	"Host: %s\r\n"                                                         \
-	"Range: bytes=%u-\r\n"                                                 \
-	"Connection: keep-alive\r\n"                                           \
-	"\r\n"
-
-#define GET_HTTPS_TEMPLATE                                                     \
-	"GET /%s HTTP/1.1\r\n"                                                 \
-	"Host: %s\r\n"                                                         \
-	"Range: bytes=%u-%u\r\n"                                               \
-	"Connection: keep-alive\r\n"                                           \
-	"\r\n"
+#define GET_HTTP_REQUEST_LINE "GET /"
+#define GET_HTTP_HOST_FIELD " HTTP/1.1\r\nHost: "
+#define GET_HTTP_RANGE_FIELD "\r\nRange: bytes=%u-"
+#define GET_HTTP_TRAILER "\r\nConnection: keep-alive\r\n\r\n"
 
 int url_parse_host(const char *url, char *host, size_t len);
 int url_parse_file(const char *url, char *file, size_t len);
-int socket_send(const struct download_client *client, size_t len);
+int socket_send_iov(const struct download_client *client,
+		    struct iovec *iov, size_t iovcnt);
 
-int http_get_request_send(struct download_client *client)
+static bool range_requests(const struct download_client *client)
+{
+	/* We use range requests only for HTTPS, due to memory limitations.
+	 * When using HTTP, we request the whole resource to minimize
+	 * network usage (only one request/response are sent).
+	 */
+	return client->proto == IPPROTO_TLS_1_2 ||
+	       IS_ENABLED(CONFIG_DOWNLOAD_CLIENT_RANGE_REQUESTS);
+}
+
+static size_t frag_size(const struct download_client *client)
+{
+	if (client->config.frag_size_override) {
+		return client->config.frag_size_override;
+	}
+
+	return CONFIG_DOWNLOAD_CLIENT_HTTP_FRAG_SIZE;
+}
+
+static size_t pipeline_depth(const struct download_client *client)
+{
+	/* Until the first response tells the file size, there is no telling
+	 * how many fragments can be requested.
+	 */
+	if (!range_requests(client) || client->file_size == 0) {
+		return 1;
+	}
+
+	if (client->config.pipeline_depth) {
+		return client->config.pipeline_depth;
+	}
+
+	return CONFIG_DOWNLOAD_CLIENT_HTTP_PIPELINE_DEPTH;
+}
+
+static int http_request_send(struct download_client *client,
+			     const char *host, const char *file)
 {
 	int err;
 	int len;
 	size_t off;
+	char range[sizeof(GET_HTTP_RANGE_FIELD) + 20];
+	struct iovec iov[] = {
+		{ .iov_base = GET_HTTP_REQUEST_LINE,
+		  .iov_len = strlen(GET_HTTP_REQUEST_LINE) },
+		{ .iov_base = (char *)file, .iov_len = strlen(file) },
+		{ .iov_base = GET_HTTP_HOST_FIELD,
+		  .iov_len = strlen(GET_HTTP_HOST_FIELD) },
+		{ .iov_base = (char *)host, .iov_len = strlen(host) },
+		{ .iov_base = range },
+		{ .iov_base = GET_HTTP_TRAILER,
+		  .iov_len = strlen(GET_HTTP_TRAILER) },
+	};
+
+	len = snprintf(range, sizeof(range), GET_HTTP_RANGE_FIELD,
+		       client->http.next_req);
+
+	/* Offset of last byte in range (Content-Range) */
+	off = client->http.next_req + frag_size(client) - 1;
+
+	if (client->file_size != 0) {
+		/* Don't request bytes past the end of file */
+		off = MIN(off, client->file_size - 1);
+	}
+
+	if (range_requests(client)) {
+		len += snprintf(range + len, sizeof(range) - len, "%u", off);
+	}
+
+	iov[4].iov_len = len;
+
+	if (IS_ENABLED(CONFIG_DOWNLOAD_CLIENT_LOG_HEADERS)) {
+		for (size_t i = 0; i < ARRAY_SIZE(iov); i++) {
+			LOG_HEXDUMP_DBG(iov[i].iov_base, iov[i].iov_len,
+					"HTTP request");
+		}
+	}
+
+	err = socket_send_iov(client, iov, ARRAY_SIZE(iov));
+	if (err) {
+		LOG_ERR("Failed to send HTTP request, errno %d", errno);
+		return err;
+	}
+
+	if (range_requests(client)) {
+		client->http.next_req = off + 1;
+	}
+
+	client->http.pending++;
+
+	return 0;
+}
+
+int http_get_request_send(struct download_client *client)
+{
+	int err;
 	char host[HOSTNAME_SIZE];
 	char file[FILENAME_SIZE];
 
@@ -56,47 +140,76 @@ int http_get_request_send(struct download_client *client)
 		return err;
 	}
 
-	/* Offset of last byte in range (Content-Range) */
-	if (client->config.frag_size_override) {
-		off = client->progress + client->config.frag_size_override - 1;
-	} else {
-		off = client->progress +
-			CONFIG_DOWNLOAD_CLIENT_HTTP_FRAG_SIZE - 1;
+	/* Keep the pipeline full. The requests are built from pieces,
+	 * because the buffer may hold the beginning of the next response.
+	 */
+	while (client->http.pending < pipeline_depth(client)) {
+		if (client->file_size != 0 &&
+		    client->http.next_req >= client->file_size) {
+			/* Every fragment has been requested */
+			break;
+		}
+
+		err = http_request_send(client, host, file);
+		if (err) {
+			return err;
+		}
 	}
 
-	if (client->file_size != 0) {
-		/* Don't request bytes past the end of file */
-		off = MIN(off, client->file_size);
+	return 0;
+}
+
+static char *header_end_find(const char *buf, size_t len)
+{
+	static const char end[] = "\r\n\r\n";
+
+	for (size_t i = 0; i + strlen(end) <= len; i++) {
+		if (memcmp(buf + i, end, strlen(end)) == 0) {
+			return (char *)buf + i;
+		}
 	}
 
-	/* We use range requests only for HTTPS, due to memory limitations.
-	 * When using HTTP, we request the whole resource to minimize
-	 * network usage (only one request/response are sent).
-	 */
-	if (client->proto == IPPROTO_TLS_1_2
-	   || IS_ENABLED(CONFIG_DOWNLOAD_CLIENT_RANGE_REQUESTS)) {
-		len = snprintf(client->buf,
-			CONFIG_DOWNLOAD_CLIENT_BUF_SIZE,
-			GET_HTTPS_TEMPLATE, file, host, client->progress, off);
-	} else {
-		len = snprintf(client->buf,
-			CONFIG_DOWNLOAD_CLIENT_BUF_SIZE,
-			GET_HTTP_TEMPLATE, file, host, client->progress);
+	return NULL;
+}
+
+static int content_range_parse(struct download_client *client, char *p)
+{
+	char *end;
+	unsigned long first;
+	unsigned long last;
+
+	p = strstr(p, "bytes");
+	if (!p) {
+		LOG_ERR("No byte range in response");
+		return -1;
 	}
 
-	if (len < 0 || len > CONFIG_DOWNLOAD_CLIENT_BUF_SIZE) {
-		LOG_ERR("Cannot create GET request, buffer too small");
-		return -ENOMEM;
+	first = strtoul(p + strlen("bytes"), &end, 10);
+	if (*end != '-') {
+		LOG_ERR("Malformed byte range in response");
+		return -1;
 	}
 
-	if (IS_ENABLED(CONFIG_DOWNLOAD_CLIENT_LOG_HEADERS)) {
-		LOG_HEXDUMP_DBG(client->buf, len, "HTTP request");
+	last = strtoul(end + 1, &end, 10);
+	if (*end != '/' || last < first) {
+		LOG_ERR("Malformed byte range in response");
+		return -1;
 	}
 
-	err = socket_send(client, len);
-	if (err) {
-		LOG_ERR("Failed to send HTTP request, errno %d", errno);
-		return err;
+	/* Responses to pipelined requests must follow the order in which
+	 * the fragments were requested, or the data would be misplaced.
+	 */
+	if (first != client->progress) {
+		LOG_ERR("Unexpected range %lu-%lu, expected offset %u",
+			first, last, client->progress);
+		return -1;
+	}
+
+	client->http.remaining = last - first + 1;
+
+	if (client->file_size == 0) {
+		client->file_size = atoi(end + 1);
+		LOG_DBG("File size = %u", client->file_size);
 	}
 
 	return 0;
@@ -111,7 +224,7 @@ static int http_header_parse(struct download_client *client, size_t *hdr_len)
 {
 	char *p;
 
-	p = strstr(client->buf, "\r\n\r\n");
+	p = header_end_find(client->buf, client->offset);
 	if (!p) {
 		/* Waiting full HTTP header */
 		LOG_DBG("Waiting full header in response");
@@ -130,10 +243,14 @@ static int http_header_parse(struct download_client *client, size_t *hdr_len)
 		client->buf[i] = tolower(client->buf[i]);
 	}
 
+	/* Terminate the header, so that it is searched for fields
+	 * without running into the payload that follows it.
+	 */
+	client->buf[*hdr_len - 1] = '\0';
+
 	p = strstr(client->buf, "http/1.1 206");
 	if (!p) {
-		if (client->proto == IPPROTO_TLS_1_2
-		   || IS_ENABLED(CONFIG_DOWNLOAD_CLIENT_RANGE_REQUESTS)) {
+		if (range_requests(client)) {
 			LOG_ERR("Server did not honor partial content request");
 			return -1;
 		}
@@ -144,42 +261,36 @@ static int http_header_parse(struct download_client *client, size_t *hdr_len)
 		}
 	}
 
-	/* The file size is returned via "Content-Length" in case of HTTP,
-	 * and via "Content-Range" in case of HTTPS with range requests.
+	/* The file size is returned via "Content-Range" in case of
+	 * range requests, which also tells which fragment this is.
 	 */
-	if (client->file_size == 0) {
-		if (client->proto == IPPROTO_TLS_1_2
-		   || IS_ENABLED(CONFIG_DOWNLOAD_CLIENT_RANGE_REQUESTS)) {
-			p = strstr(client->buf, "content-range");
-			if (!p) {
-				LOG_ERR("Server did not send "
-					"\"Content-Range\" in response");
-				return -1;
-			}
-			p = strstr(p, "/");
-			if (!p) {
-				LOG_ERR("No file size in response");
-				return -1;
-			}
-		} else { /* proto == PROTO_HTTP */
-			p = strstr(client->buf, "content-length");
-			if (!p) {
-				LOG_WRN("Server did not send "
-					"\"Content-Length\" in response");
-					return -1;
-			}
-			p = strstr(p, ":");
-			if (!p) {
-				LOG_ERR("No file size in response");
+	if (range_requests(client)) {
+		p = strstr(client->buf, "content-range");
+		if (!p) {
+			LOG_ERR("Server did not send "
+				"\"Content-Range\" in response");
+			return -1;
+		}
+		if (content_range_parse(client, p)) {
+			return -1;
+		}
+	} else if (client->file_size == 0) {
+		/* The file size is returned via "Content-Length" */
+		p = strstr(client->buf, "content-length");
+		if (!p) {
+			LOG_WRN("Server did not send "
+				"\"Content-Length\" in response");
 				return -1;
-			}
-			/* Accumulate any eventual progress (starting offset)
-			 * when reading the file size from Content-Length
-			 */
-			client->file_size = client->progress;
 		}
-
-		client->file_size += atoi(p + 1);
+		p = strstr(p, ":");
+		if (!p) {
+			LOG_ERR("No file size in response");
+			return -1;
+		}
+		/* Accumulate any eventual progress (starting offset)
+		 * when reading the file size from Content-Length
+		 */
+		client->file_size = client->progress + atoi(p + 1);
 		LOG_DBG("File size = %u", client->file_size);
 	}
 
@@ -225,8 +336,8 @@ int http_parse(struct download_client *client, size_t len)
 			 */
 			LOG_DBG("Copying %u payload bytes",
 				client->offset - hdr_len);
-			memcpy(client->buf, client->buf + hdr_len,
-			       client->offset - hdr_len);
+			memmove(client->buf, client->buf + hdr_len,
+				client->offset - hdr_len);
 
 			client->offset -= hdr_len;
 		} else {
@@ -237,20 +348,49 @@ int http_parse(struct download_client *client, size_t len)
 		}
 	}
 
-	/* Accumulate overall file progress.
-	 * If the last recv() call read an HTTP header,
-	 * `offset` has been moved at the end of any trailing
-	 * payload bytes by http_header_parse(). In this case,
+	/* Payload bytes read by the last recv() call.
+	 * If the call read an HTTP header, `offset` has been moved
+	 * at the end of any trailing payload bytes. In this case,
 	 * `offset` is less than `len` and it represents
 	 * the actual payload bytes.
 	 */
-	client->progress += MIN(client->offset, len);
+	len = MIN(client->offset, len);
+
+	if (range_requests(client)) {
+		if (len > client->http.remaining) {
+			/* The bytes past the end of this response belong to
+			 * the next pipelined response. Keep them in the buffer,
+			 * to be parsed once this fragment has been handled.
+			 */
+			client->http.carry = len - client->http.remaining;
+			client->offset -= client->http.carry;
+			len = client->http.remaining;
+		}
+
+		client->http.remaining -= len;
+		client->progress += len;
+
+		if (client->http.remaining) {
+			return 1;
+		}
+
+		/* Response complete, the next one begins with a header */
+		client->http.has_header = false;
+		client->http.pending--;
+
+		return 0;
+	}
+
+	/* Accumulate overall file progress */
+	client->progress += len;
+
+	if (client->progress == client->file_size) {
+		client->http.pending = 0;
+		return 0;
+	}
 
-	/* Have we received a whole fragment or the whole file? */
-	if (client->progress != client->file_size &&
-	    client->offset < (client->config.frag_size_override != 0 ?
-			      client->config.frag_size_override :
-			      CONFIG_DOWNLOAD_CLIENT_HTTP_FRAG_SIZE)) {
+	/* Have we received a whole fragment? */
+	if (client->offset < frag_size(client)) {
 		return 1;
 	}
 
@@ -29,6 +29,7 @@ static int callback(const struct download_client_evt *event)
 {
 	static size_t downloaded;
 	static size_t file_size;
+	uint32_t throughput;
 
 	if (downloaded == 0) {
 		download_client_file_size_get(&downloader, &file_size);
@@ -47,7 +48,9 @@ static int callback(const struct download_client_evt *event)
 		}
 		break;
 	case DOWNLOAD_CLIENT_EVT_DONE:
-		shell_print(shell_instance, "done (%d bytes)", downloaded);
+		download_client_throughput_get(&downloader, &throughput);
+		shell_print(shell_instance, "done (%d bytes, %u bytes/s)",
+			    downloaded, throughput);
 		downloaded = 0;
 		break;
 	case DOWNLOAD_CLIENT_EVT_ERROR:
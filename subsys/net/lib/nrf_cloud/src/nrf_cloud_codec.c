@@ -13,6 +13,7 @@
 #include <logging/log.h>
 #include "cJSON.h"
 #include "cJSON_os.h"
+#include <json_writer.h>
 
 LOG_MODULE_REGISTER(nrf_cloud_codec, CONFIG_NRF_CLOUD_LOG_LEVEL);
 
@@ -161,38 +162,50 @@ int nrf_cloud_encode_shadow_data(const struct nrf_cloud_sensor_data *sensor,
 	return 0;
 }
 
+static void sensor_data_write(struct json_writer *writer,
+			      const struct nrf_cloud_sensor_data *sensor)
+{
+	json_writer_obj_start(writer);
+	json_writer_key_str(writer, "appId", sensor_type_str[sensor->type]);
+	json_writer_key_str(writer, "data", sensor->data.ptr);
+	json_writer_key_str(writer, "messageType", "DATA");
+	json_writer_obj_end(writer);
+}
+
 int nrf_cloud_encode_sensor_data(const struct nrf_cloud_sensor_data *sensor,
 				 struct nrf_cloud_data *output)
 {
-	int ret;
+	struct json_writer writer;
+	char *buffer;
+	size_t len;
 
 	__ASSERT_NO_MSG(sensor != NULL);
 	__ASSERT_NO_MSG(sensor->data.ptr != NULL);
 	__ASSERT_NO_MSG(sensor->data.len != 0);
 	__ASSERT_NO_MSG(output != NULL);
 
-	cJSON *root_obj = cJSON_CreateObject();
+	/* Get the length of the message first, then write it directly into
+	 * a buffer of the exact size.
+	 */
+	json_writer_init(&writer, NULL, 0);
+	sensor_data_write(&writer, sensor);
+	len = json_writer_len(&writer);
 
-	if (root_obj == NULL) {
+	buffer = nrf_cloud_malloc(len + 1);
+	if (buffer == NULL) {
 		return -ENOMEM;
 	}
 
-	ret = json_add_str(root_obj, "appId", sensor_type_str[sensor->type]);
-	ret += json_add_str(root_obj, "data", sensor->data.ptr);
-	ret += json_add_str(root_obj, "messageType", "DATA");
+	json_writer_init(&writer, buffer, len + 1);
+	sensor_data_write(&writer, sensor);
 
-	if (ret != 0) {
-		cJSON_Delete(root_obj);
+	if (json_writer_finish(&writer)) {
+		nrf_cloud_free(buffer);
 		return -ENOMEM;
 	}
 
-	char *buffer;
-
-	buffer = cJSON_PrintUnformatted(root_obj);
-	cJSON_Delete(root_obj);
-
 	output->ptr = buffer;
-	output->len = strlen(buffer);
+	output->len = len;
 
 	return 0;
 }
@@ -0,0 +1,386 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <kernel.h>
+#include <tinycbor/cbor.h>
+#include <tinycbor/cbor_buf_reader.h>
+
+#include "cloud_codec.h"
+
+#define TEST_BUF_COUNT		20
+#define TEST_BENCHMARK_CNT	10
+#define TEST_UNIX_OFFSET_MS	1600000000000LL
+#define TEST_ALLOC_MAX		1024
+
+/* JSON variants of the functions, renamed by the build. */
+int json_codec_encode_ui_data(struct cloud_codec_data *output,
+			      struct cloud_data_ui *ui_buf);
+int json_codec_encode_batch_data(
+				struct cloud_codec_data *output,
+				struct cloud_data_gps *gps_buf,
+				struct cloud_data_sensors *sensor_buf,
+				struct cloud_data_modem_dynamic *modem_dyn_buf,
+				struct cloud_data_ui *ui_buf,
+				struct cloud_data_accelerometer *accel_buf,
+				struct cloud_data_battery *bat_buf,
+				size_t gps_buf_count,
+				size_t sensor_buf_count,
+				size_t modem_dyn_buf_count,
+				size_t ui_buf_count,
+				size_t accel_buf_count,
+				size_t bat_buf_count);
+
+typedef int (*batch_encode_fn)(struct cloud_codec_data *output,
+			       struct cloud_data_gps *gps_buf,
+			       struct cloud_data_sensors *sensor_buf,
+			       struct cloud_data_modem_dynamic *modem_dyn_buf,
+			       struct cloud_data_ui *ui_buf,
+			       struct cloud_data_accelerometer *accel_buf,
+			       struct cloud_data_battery *bat_buf,
+			       size_t gps_buf_count,
+			       size_t sensor_buf_count,
+			       size_t modem_dyn_buf_count,
+			       size_t ui_buf_count,
+			       size_t accel_buf_count,
+			       size_t bat_buf_count);
+
+struct encode_stats {
+	size_t len;
+	size_t heap_peak;
+	uint32_t cycles;
+};
+
+static struct cloud_data_gps gps_buf[TEST_BUF_COUNT];
+static struct cloud_data_sensors sensor_buf[TEST_BUF_COUNT];
+static struct cloud_data_modem_dynamic modem_dyn_buf[TEST_BUF_COUNT];
+static struct cloud_data_ui ui_buf[TEST_BUF_COUNT];
+static struct cloud_data_accelerometer accel_buf[TEST_BUF_COUNT];
+static struct cloud_data_battery bat_buf[TEST_BUF_COUNT];
+
+static bool date_time_fail;
+
+/* Heap usage tracking. Allocations of both encoders, including the
+ * allocation hooks of cJSON, go through k_malloc() and k_free() that are
+ * wrapped at link time.
+ */
+static struct {
+	void *ptr;
+	size_t size;
+} allocs[TEST_ALLOC_MAX];
+static size_t heap_used;
+static size_t heap_peak;
+
+void *__real_k_malloc(size_t size);
+void __real_k_free(void *ptr);
+
+void *__wrap_k_malloc(size_t size)
+{
+	void *ptr = __real_k_malloc(size);
+
+	if (ptr == NULL) {
+		return NULL;
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(allocs); i++) {
+		if (allocs[i].ptr == NULL) {
+			allocs[i].ptr = ptr;
+			allocs[i].size = size;
+			heap_used += size;
+			heap_peak = MAX(heap_peak, heap_used);
+			break;
+		}
+	}
+
+	return ptr;
+}
+
+void __wrap_k_free(void *ptr)
+{
+	for (size_t i = 0; (ptr != NULL) && (i < ARRAY_SIZE(allocs)); i++) {
+		if (allocs[i].ptr == ptr) {
+			heap_used -= allocs[i].size;
+			allocs[i].ptr = NULL;
+			break;
+		}
+	}
+
+	__real_k_free(ptr);
+}
+
+/* Stub of the date_time library. */
+int date_time_uptime_to_unix_time_ms(int64_t *uptime)
+{
+	if (date_time_fail) {
+		return -ENODATA;
+	}
+
+	*uptime += TEST_UNIX_OFFSET_MS;
+
+	return 0;
+}
+
+static void data_fill(void)
+{
+	for (size_t i = 0; i < TEST_BUF_COUNT; i++) {
+		gps_buf[i] = (struct cloud_data_gps) {
+			.gps_ts = 1000 + i,
+			.longi = 10.4176832 + i,
+			.lat = 63.4214729 - i,
+			.alt = 150.5f,
+			.acc = 4.2f,
+			.spd = 1.25f,
+			.hdg = 270.0f,
+			.queued = true,
+		};
+		sensor_buf[i] = (struct cloud_data_sensors) {
+			.env_ts = 2000 + i,
+			.temp = 22.5,
+			.hum = 41.75,
+			.queued = true,
+		};
+		modem_dyn_buf[i] = (struct cloud_data_modem_dynamic) {
+			.ts = 3000 + i,
+			.rsrp = -90,
+			.area = 12345,
+			.cell = 33703712,
+			.mccmnc = "24202",
+			.ip = "10.81.183.99",
+			.queued = true,
+		};
+		ui_buf[i] = (struct cloud_data_ui) {
+			.btn_ts = 4000 + i,
+			.btn = 1 + (i % 2),
+			.queued = true,
+		};
+		accel_buf[i] = (struct cloud_data_accelerometer) {
+			.ts = 5000 + i,
+			.values = { 0.1 * i, -9.81, 0.25 },
+			.queued = true,
+		};
+		bat_buf[i] = (struct cloud_data_battery) {
+			.bat_ts = 6000 + i,
+			.bat = 3600 + i,
+			.queued = true,
+		};
+	}
+}
+
+static int batch_encode(batch_encode_fn fn, struct cloud_codec_data *output)
+{
+	return fn(output, gps_buf, sensor_buf, modem_dyn_buf, ui_buf,
+		  accel_buf, bat_buf, TEST_BUF_COUNT, TEST_BUF_COUNT,
+		  TEST_BUF_COUNT, TEST_BUF_COUNT, TEST_BUF_COUNT,
+		  TEST_BUF_COUNT);
+}
+
+static void batch_stats_get(batch_encode_fn fn, struct encode_stats *stats)
+{
+	struct cloud_codec_data output;
+	uint32_t start;
+	int err;
+
+	stats->cycles = 0;
+
+	for (size_t i = 0; i < TEST_BENCHMARK_CNT; i++) {
+		data_fill();
+		heap_used = 0;
+		heap_peak = 0;
+
+		start = k_cycle_get_32();
+		err = batch_encode(fn, &output);
+		stats->cycles += k_cycle_get_32() - start;
+
+		zassert_equal(0, err, "Encoding failed, error: %d", err);
+
+		stats->len = output.len;
+		stats->heap_peak = heap_peak;
+		cloud_codec_release_data(&output);
+	}
+
+	stats->cycles /= TEST_BENCHMARK_CNT;
+}
+
+static void cbor_map_enter(CborValue *map, const char *key, CborValue *value)
+{
+	zassert_true(cbor_value_is_map(map), "Map expected");
+	zassert_equal(CborNoError, cbor_value_map_find_value(map, key, value),
+		      "Failed to find %s", key);
+	zassert_false(cbor_value_get_type(value) == CborInvalidType,
+		      "Key %s not found", key);
+}
+
+static int64_t cbor_int_get(CborValue *map, const char *key)
+{
+	CborValue value;
+	int64_t result;
+
+	cbor_map_enter(map, key, &value);
+	zassert_equal(CborNoError, cbor_value_get_int64(&value, &result),
+		      "Integer expected for %s", key);
+
+	return result;
+}
+
+static void test_batch_cbor_content(void)
+{
+	struct cloud_codec_data output;
+	struct cbor_buf_reader reader;
+	CborParser parser;
+	CborValue root;
+	CborValue array;
+	CborValue entry;
+	CborValue value;
+	size_t len;
+	int err;
+
+	data_fill();
+
+	err = batch_encode(cloud_codec_encode_batch_data, &output);
+	zassert_equal(0, err, "Encoding failed, error: %d", err);
+
+	cbor_buf_reader_init(&reader, (uint8_t *)output.buf, output.len);
+	zassert_equal(CborNoError,
+		      cbor_parser_init(&reader.r, 0, &parser, &root),
+		      "Failed to parse output");
+	zassert_equal(CborNoError, cbor_value_get_map_length(&root, &len),
+		      "Map expected");
+	zassert_equal(6, len, "All data types should be encoded");
+
+	const char * const keys[] = { "gps", "env", "btn", "acc", "bat",
+				      "roam" };
+
+	for (size_t i = 0; i < ARRAY_SIZE(keys); i++) {
+		cbor_map_enter(&root, keys[i], &array);
+		zassert_equal(CborNoError,
+			      cbor_value_get_array_length(&array, &len),
+			      "Array expected for %s", keys[i]);
+		zassert_equal(TEST_BUF_COUNT, len, "Invalid %s count",
+			      keys[i]);
+	}
+
+	cbor_map_enter(&root, "bat", &array);
+	zassert_equal(CborNoError, cbor_value_enter_container(&array, &entry),
+		      "Failed to enter array");
+	zassert_equal(3600, cbor_int_get(&entry, "v"), "Invalid value");
+	zassert_equal(6000 + TEST_UNIX_OFFSET_MS, cbor_int_get(&entry, "ts"),
+		      "Invalid timestamp");
+
+	cbor_map_enter(&root, "roam", &array);
+	zassert_equal(CborNoError, cbor_value_enter_container(&array, &entry),
+		      "Failed to enter array");
+	cbor_map_enter(&entry, "v", &value);
+	zassert_equal(24202, cbor_int_get(&value, "mccmnc"), "Invalid MCCMNC");
+	zassert_equal(-90, cbor_int_get(&value, "rsrp"), "Invalid RSRP");
+
+	for (size_t i = 0; i < TEST_BUF_COUNT; i++) {
+		zassert_false(gps_buf[i].queued, "Entry should be dequeued");
+		zassert_false(modem_dyn_buf[i].queued,
+			      "Entry should be dequeued");
+		zassert_equal(1000 + i, gps_buf[i].gps_ts,
+			      "Buffered timestamp should not be modified");
+	}
+
+	cloud_codec_release_data(&output);
+}
+
+static void test_batch_cbor_error(void)
+{
+	struct cloud_codec_data output = { 0 };
+	int err;
+
+	data_fill();
+
+	date_time_fail = true;
+	err = batch_encode(cloud_codec_encode_batch_data, &output);
+	date_time_fail = false;
+
+	zassert_not_equal(0, err, "Encoding should fail");
+	zassert_is_null(output.buf, "No output expected");
+
+	for (size_t i = 0; i < TEST_BUF_COUNT; i++) {
+		zassert_true(gps_buf[i].queued, "Entry should stay queued");
+		zassert_equal(1000 + i, gps_buf[i].gps_ts,
+			      "Timestamp should not be modified");
+	}
+
+	for (size_t i = 0; i < TEST_BUF_COUNT; i++) {
+		gps_buf[i].queued = false;
+		sensor_buf[i].queued = false;
+		modem_dyn_buf[i].queued = false;
+		ui_buf[i].queued = false;
+		accel_buf[i].queued = false;
+		bat_buf[i].queued = false;
+	}
+
+	err = batch_encode(cloud_codec_encode_batch_data, &output);
+	zassert_equal(-ENODATA, err, "No data should be encoded");
+}
+
+static void test_ui_cbor_content(void)
+{
+	struct cloud_codec_data output;
+	struct cbor_buf_reader reader;
+	CborParser parser;
+	CborValue root;
+	CborValue entry;
+	int err;
+
+	data_fill();
+
+	err = cloud_codec_encode_ui_data(&output, &ui_buf[1]);
+	zassert_equal(0, err, "Encoding failed, error: %d", err);
+	zassert_false(ui_buf[1].queued, "Entry should be dequeued");
+
+	cbor_buf_reader_init(&reader, (uint8_t *)output.buf, output.len);
+	zassert_equal(CborNoError,
+		      cbor_parser_init(&reader.r, 0, &parser, &root),
+		      "Failed to parse output");
+
+	cbor_map_enter(&root, "btn", &entry);
+	zassert_equal(2, cbor_int_get(&entry, "v"), "Invalid button");
+	zassert_equal(4001 + TEST_UNIX_OFFSET_MS, cbor_int_get(&entry, "ts"),
+		      "Invalid timestamp");
+
+	cloud_codec_release_data(&output);
+}
+
+static void test_batch_compare(void)
+{
+	struct encode_stats json;
+	struct encode_stats cbor;
+
+	batch_stats_get(json_codec_encode_batch_data, &json);
+	batch_stats_get(cloud_codec_encode_batch_data, &cbor);
+
+	TC_PRINT("Batch of %u entries per data type\n", TEST_BUF_COUNT);
+	TC_PRINT("JSON: %zu B, %zu B peak heap, %u us\n", json.len,
+		 json.heap_peak, k_cyc_to_us_floor32(json.cycles));
+	TC_PRINT("CBOR: %zu B, %zu B peak heap, %u us\n", cbor.len,
+		 cbor.heap_peak, k_cyc_to_us_floor32(cbor.cycles));
+
+	zassert_true(cbor.len < json.len,
+		     "CBOR output should be smaller than JSON");
+	zassert_equal(cbor.len, cbor.heap_peak,
+		      "CBOR encoding should allocate only the output");
+	zassert_true(cbor.heap_peak < json.heap_peak,
+		     "CBOR should use less heap than JSON");
+}
+
+void test_main(void)
+{
+	cloud_codec_init();
+
+	ztest_test_suite(cloud_codec_tests,
+			 ztest_unit_test(test_batch_cbor_content),
+			 ztest_unit_test(test_batch_cbor_error),
+			 ztest_unit_test(test_ui_cbor_content),
+			 ztest_unit_test(test_batch_compare)
+			 );
+
+	ztest_run_test_suite(cloud_codec_tests);
+}
@@ -0,0 +1,405 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <kernel.h>
+#include <storage/flash_map.h>
+
+#include "data_log.h"
+
+#define TEST_AREA_ID		FLASH_AREA_ID(data_log_storage)
+#define TEST_UNIX_OFFSET_MS	1600000000000LL
+#define TEST_SAMPLE_CNT		5
+/* Upper bound of bytes written to flash per payload byte. */
+#define TEST_WRITE_AMP_MAX	2
+
+static struct data_log_batch batch;
+static bool date_time_valid;
+
+/* Date time library stubs. UNIX time is uptime shifted by a fixed offset. */
+bool date_time_is_valid(void)
+{
+	return date_time_valid;
+}
+
+int date_time_uptime_to_unix_time_ms(int64_t *ts)
+{
+	if (!date_time_valid) {
+		return -ENODATA;
+	}
+
+	*ts += TEST_UNIX_OFFSET_MS;
+
+	return 0;
+}
+
+int date_time_now(int64_t *ts)
+{
+	if (!date_time_valid) {
+		return -ENODATA;
+	}
+
+	*ts = k_uptime_get() + TEST_UNIX_OFFSET_MS;
+
+	return 0;
+}
+
+static struct cloud_data_gps gps_sample(int i)
+{
+	return (struct cloud_data_gps) {
+		.gps_ts = 1000 + i,
+		.longi = 10.4 + i,
+		.lat = 63.4 + i,
+		.alt = 100.0f + i,
+		.acc = 5.0f,
+		.spd = 1.5f,
+		.hdg = 90.0f,
+		.queued = true,
+	};
+}
+
+static void gps_append(int first, int count)
+{
+	for (int i = first; i < first + count; i++) {
+		struct cloud_data_gps gps = gps_sample(i);
+
+		zassert_equal(0, data_log_append(DATA_LOG_GPS, &gps),
+			      "Append should succeed");
+	}
+}
+
+static void gps_check(int first, int count)
+{
+	zassert_equal(count, batch.gps_count, "Unexpected sample count");
+
+	for (int i = 0; i < count; i++) {
+		struct cloud_data_gps expected = gps_sample(first + i);
+
+		zassert_true(batch.gps[i].queued, "Sample should be queued");
+		zassert_equal(expected.gps_ts, batch.gps[i].gps_ts,
+			      "Timestamp should be restored");
+		zassert_equal(expected.lat, batch.gps[i].lat,
+			      "Latitude mismatch");
+		zassert_equal(expected.longi, batch.gps[i].longi,
+			      "Longitude mismatch");
+		zassert_equal(expected.alt, batch.gps[i].alt,
+			      "Altitude mismatch");
+	}
+}
+
+static void log_setup(void)
+{
+	const struct flash_area *fa;
+
+	zassert_equal(0, flash_area_open(TEST_AREA_ID, &fa),
+		      "Log partition should exist");
+	zassert_equal(0, flash_area_erase(fa, 0, fa->fa_size),
+		      "Erasing the partition should succeed");
+	flash_area_close(fa);
+
+	date_time_valid = true;
+
+	zassert_equal(0, data_log_init(), "Init should succeed");
+}
+
+static void test_append_read(void)
+{
+	struct cloud_data_sensors sensors = {
+		.env_ts = 2000,
+		.temp = 21.5,
+		.hum = 40.0,
+		.queued = true,
+	};
+	struct cloud_data_modem_dynamic modem = {
+		.ts = 3000,
+		.area = 1234,
+		.cell = 5678,
+		.rsrp = 40,
+		.ip = "10.81.183.99",
+		.mccmnc = "24202",
+		.queued = true,
+	};
+	struct cloud_data_battery bat = {
+		.bat_ts = 4000,
+		.bat = 3600,
+		.queued = false,
+	};
+
+	zassert_equal(-ENODATA, data_log_batch_read(&batch),
+		      "Empty log should have no data");
+
+	gps_append(0, TEST_SAMPLE_CNT);
+	zassert_equal(0, data_log_append(DATA_LOG_SENSORS, &sensors), "");
+	zassert_equal(0, data_log_append(DATA_LOG_MODEM_DYNAMIC, &modem), "");
+	/* Samples that are not queued have already been sent. */
+	zassert_equal(0, data_log_append(DATA_LOG_BATTERY, &bat), "");
+
+	zassert_equal(0, data_log_batch_read(&batch), "Read should succeed");
+	gps_check(0, TEST_SAMPLE_CNT);
+
+	zassert_equal(1, batch.sensors_count, "One sensor sample expected");
+	zassert_equal(sensors.temp, batch.sensors[0].temp, "");
+	zassert_equal(sensors.env_ts, batch.sensors[0].env_ts, "");
+
+	zassert_equal(1, batch.modem_dyn_count, "One modem sample expected");
+	zassert_equal(modem.cell, batch.modem_dyn[0].cell, "");
+	zassert_true(strcmp(modem.ip, batch.modem_dyn[0].ip) == 0, "");
+	zassert_true(strcmp(modem.mccmnc, batch.modem_dyn[0].mccmnc) == 0, "");
+
+	zassert_equal(0, batch.bat_count, "Sent samples should be ignored");
+
+	zassert_equal(-ENODATA, data_log_batch_read(&batch),
+		      "All samples should have been read");
+}
+
+static void test_batch_limit(void)
+{
+	gps_append(0, CONFIG_DATA_LOG_BATCH_ENTRIES + TEST_SAMPLE_CNT);
+
+	zassert_equal(0, data_log_batch_read(&batch), "");
+	gps_check(0, CONFIG_DATA_LOG_BATCH_ENTRIES);
+
+	zassert_equal(0, data_log_batch_read(&batch), "");
+	gps_check(CONFIG_DATA_LOG_BATCH_ENTRIES, TEST_SAMPLE_CNT);
+}
+
+static void test_commit_persists(void)
+{
+	struct data_log_pos end;
+
+	gps_append(0, TEST_SAMPLE_CNT);
+
+	zassert_equal(0, data_log_batch_read(&batch), "");
+	end = batch.end;
+
+	gps_append(TEST_SAMPLE_CNT, TEST_SAMPLE_CNT);
+
+	/* Samples that are not committed are read again after a reboot. */
+	zassert_equal(0, data_log_init(), "");
+	zassert_equal(0, data_log_batch_read(&batch), "");
+	gps_check(0, 2 * TEST_SAMPLE_CNT);
+
+	zassert_equal(0, data_log_init(), "");
+	zassert_equal(0, data_log_commit(&end), "Commit should succeed");
+
+	zassert_equal(0, data_log_init(), "");
+	zassert_equal(0, data_log_batch_read(&batch), "");
+	gps_check(TEST_SAMPLE_CNT, TEST_SAMPLE_CNT);
+}
+
+static void test_rewind(void)
+{
+	gps_append(0, TEST_SAMPLE_CNT);
+
+	zassert_equal(0, data_log_batch_read(&batch), "");
+	zassert_equal(-ENODATA, data_log_batch_read(&batch), "");
+
+	/* The batch was not delivered. */
+	data_log_rewind();
+
+	zassert_equal(0, data_log_batch_read(&batch), "");
+	gps_check(0, TEST_SAMPLE_CNT);
+}
+
+static void test_wrap_drops_oldest(void)
+{
+	const struct flash_area *fa;
+	struct data_log_stats stats;
+	int count = 0;
+	int first;
+
+	zassert_equal(0, flash_area_open(TEST_AREA_ID, &fa), "");
+
+	/* Fill the log until the oldest sector has been reused. */
+	do {
+		gps_append(count++, 1);
+		data_log_stats_get(&stats);
+		zassert_true(stats.bytes_written <= 2 * fa->fa_size,
+			     "Log should have wrapped");
+	} while (stats.dropped == 0);
+
+	flash_area_close(fa);
+
+	TC_PRINT("%d samples appended, %d dropped, %d sectors erased\n",
+		 stats.appended, stats.dropped, stats.erased);
+
+	/* The remaining samples are the newest ones, in order. */
+	first = stats.dropped;
+	while (data_log_batch_read(&batch) == 0) {
+		gps_check(first, batch.gps_count);
+		first += batch.gps_count;
+	}
+
+	zassert_equal(count, first, "All remaining samples should be read");
+}
+
+static void test_corrupt_record_skipped(void)
+{
+	const struct flash_area *fa;
+	struct cloud_data_gps corrupted = gps_sample(1);
+	struct data_log_stats stats;
+	uint8_t buf[2 * sizeof(corrupted.lat)];
+	size_t align;
+	off_t start;
+	off_t off;
+
+	gps_append(0, 3);
+
+	/* Find the latitude of the second sample and clear it. */
+	zassert_equal(0, flash_area_open(TEST_AREA_ID, &fa), "");
+	for (off = 0; off < fa->fa_size - sizeof(buf); off++) {
+		zassert_equal(0, flash_area_read(fa, off, buf,
+						 sizeof(corrupted.lat)), "");
+		if (memcmp(buf, &corrupted.lat, sizeof(corrupted.lat)) == 0) {
+			break;
+		}
+	}
+
+	zassert_true(off < fa->fa_size - sizeof(buf), "Sample not found");
+
+	/* Rewrite the whole write blocks that hold the latitude. */
+	align = flash_area_align(fa);
+	start = ROUND_DOWN(off, align);
+	memset(buf, 0, sizeof(buf));
+	zassert_equal(0, flash_area_write(fa, start, buf,
+			ROUND_UP(off + sizeof(corrupted.lat) - start, align)),
+		      "");
+	flash_area_close(fa);
+
+	zassert_equal(0, data_log_batch_read(&batch), "");
+	zassert_equal(2, batch.gps_count, "Corrupted sample should be skipped");
+	zassert_equal(gps_sample(0).lat, batch.gps[0].lat, "");
+	zassert_equal(gps_sample(2).lat, batch.gps[1].lat, "");
+
+	data_log_stats_get(&stats);
+	zassert_equal(1, stats.dropped, "Corrupted sample should be counted");
+
+	/* The corrupted sample is skipped again after a rewind. */
+	data_log_rewind();
+	zassert_equal(0, data_log_batch_read(&batch), "");
+	zassert_equal(2, batch.gps_count, "");
+
+	data_log_stats_get(&stats);
+	zassert_equal(1, stats.dropped, "Corrupted sample counted twice");
+
+	/* Records after the corrupted one are recovered after a reboot. */
+	zassert_equal(0, data_log_init(), "");
+	gps_append(3, 1);
+	zassert_equal(0, data_log_batch_read(&batch), "");
+	zassert_equal(3, batch.gps_count, "");
+	zassert_equal(gps_sample(3).lat, batch.gps[2].lat, "");
+}
+
+static void test_uptime_timestamps(void)
+{
+	struct data_log_stats stats;
+	int count = TEST_SAMPLE_CNT;
+	int first;
+
+	/* Without valid time, samples are stored with the uptime of the
+	 * current boot.
+	 */
+	date_time_valid = false;
+	gps_append(0, TEST_SAMPLE_CNT);
+
+	/* The samples cannot be read before the time is known. */
+	zassert_equal(-EAGAIN, data_log_batch_read(&batch), "");
+	date_time_valid = true;
+
+	zassert_equal(0, data_log_batch_read(&batch), "");
+	gps_check(0, TEST_SAMPLE_CNT);
+
+	/* Uptime of a previous boot cannot be converted. */
+	zassert_equal(0, data_log_init(), "");
+	zassert_equal(0, data_log_batch_read(&batch), "");
+	zassert_equal(TEST_SAMPLE_CNT, batch.gps_count, "");
+
+	for (size_t i = 0; i < batch.gps_count; i++) {
+		zassert_false(batch.gps[i].queued,
+			      "Samples of a previous boot should be dropped");
+	}
+
+	data_log_stats_get(&stats);
+	zassert_equal(TEST_SAMPLE_CNT, stats.dropped, "");
+
+	/* The batch was not delivered, the samples are read again. */
+	data_log_rewind();
+	zassert_equal(0, data_log_batch_read(&batch), "");
+	zassert_equal(TEST_SAMPLE_CNT, batch.gps_count, "");
+
+	data_log_stats_get(&stats);
+	zassert_equal(TEST_SAMPLE_CNT, stats.dropped,
+		      "Samples should not be counted twice after a rewind");
+
+	/* Nor when their sector is reused. */
+	data_log_rewind();
+
+	do {
+		gps_append(count++, 1);
+		data_log_stats_get(&stats);
+	} while (stats.dropped == TEST_SAMPLE_CNT);
+
+	first = stats.dropped;
+	while (data_log_batch_read(&batch) == 0) {
+		gps_check(first, batch.gps_count);
+		first += batch.gps_count;
+	}
+
+	zassert_equal(count, first, "All remaining samples should be read");
+}
+
+static void test_write_amplification(void)
+{
+	struct data_log_stats stats;
+	int count = 0;
+
+	/* Deliver every batch, as the Data module does when connected. */
+	for (int i = 0; i < 20; i++) {
+		gps_append(count, TEST_SAMPLE_CNT);
+		count += TEST_SAMPLE_CNT;
+
+		zassert_equal(0, data_log_batch_read(&batch), "");
+		zassert_equal(0, data_log_commit(&batch.end), "");
+	}
+
+	data_log_stats_get(&stats);
+
+	TC_PRINT("%d payload bytes, %d bytes written, %d sectors erased\n",
+		 stats.payload_bytes, stats.bytes_written, stats.erased);
+
+	zassert_true(stats.bytes_written <=
+		     TEST_WRITE_AMP_MAX * stats.payload_bytes,
+		     "Write amplification too high");
+
+	zassert_equal(0, data_log_init(), "");
+	zassert_equal(-ENODATA, data_log_batch_read(&batch),
+		      "Delivered samples should not be read again");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(data_log_tests,
+		ztest_unit_test_setup_teardown(test_append_read,
+					       log_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_batch_limit,
+					       log_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_commit_persists,
+					       log_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_rewind,
+					       log_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_wrap_drops_oldest,
+					       log_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_corrupt_record_skipped,
+					       log_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_uptime_timestamps,
+					       log_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_write_amplification,
+					       log_setup, unit_test_noop)
+		);
+
+	ztest_run_test_suite(data_log_tests);
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+
+#include "data_sched.h"
+
+#define TEST_MSG_LEN		300
+#define TEST_MAX_AGE_MS		(CONFIG_DATA_SCHED_MAX_AGE_SEC * MSEC_PER_SEC)
+#define TEST_ACTIVE_TIME_SEC	10
+/* Sampling interval of the simulated device. */
+#define TEST_INTERVAL_MS	20000
+#define TEST_CYCLES		30
+
+static void sched_setup(void)
+{
+	data_sched_init();
+}
+
+static void test_hold_until_size_limit(void)
+{
+	int64_t now = 1000;
+	size_t count = 0;
+
+	zassert_equal(-1, data_sched_deadline(), "Nothing should be held");
+
+	while (!data_sched_add(TEST_MSG_LEN, false, now)) {
+		count++;
+	}
+
+	zassert_equal(CONFIG_DATA_SCHED_MAX_BYTES / TEST_MSG_LEN, count,
+		      "Messages should be held until the size limit");
+}
+
+static void test_age_limit(void)
+{
+	int64_t now = 1000;
+
+	zassert_false(data_sched_add(TEST_MSG_LEN, false, now), "");
+	zassert_false(data_sched_add(TEST_MSG_LEN, false, now + 100), "");
+	zassert_equal(now + TEST_MAX_AGE_MS, data_sched_deadline(),
+		      "Deadline should follow the first held message");
+
+	zassert_false(data_sched_timeout(now + TEST_MAX_AGE_MS - 1), "");
+	zassert_true(data_sched_timeout(now + TEST_MAX_AGE_MS), "");
+
+	data_sched_flushed(now + TEST_MAX_AGE_MS);
+	zassert_equal(-1, data_sched_deadline(), "");
+	zassert_false(data_sched_timeout(now + 2 * TEST_MAX_AGE_MS), "");
+}
+
+static void test_urgent(void)
+{
+	zassert_false(data_sched_add(TEST_MSG_LEN, false, 0), "");
+	zassert_true(data_sched_add(TEST_MSG_LEN, true, 0),
+		     "Urgent message should be published right away");
+}
+
+static void test_rrc_connected(void)
+{
+	zassert_false(data_sched_rrc_update(true, 0),
+		      "Nothing to publish without held messages");
+	zassert_true(data_sched_add(TEST_MSG_LEN, false, 10),
+		     "Publish while the RRC connection is open");
+	data_sched_flushed(10);
+
+	zassert_false(data_sched_rrc_update(false, 1000), "");
+	zassert_false(data_sched_add(TEST_MSG_LEN, false, 2000),
+		      "Hold while idle without PSM active time");
+
+	zassert_true(data_sched_rrc_update(true, 3000),
+		     "Publish held messages when a connection opens");
+}
+
+static void test_psm_active_time(void)
+{
+	int64_t idle = 1000;
+
+	data_sched_psm_update(TEST_ACTIVE_TIME_SEC);
+	data_sched_rrc_update(true, 0);
+	data_sched_rrc_update(false, idle);
+
+	zassert_true(data_sched_add(TEST_MSG_LEN, false, idle + 100),
+		     "Publish during the active time");
+	data_sched_flushed(idle + 100);
+
+	zassert_false(data_sched_add(TEST_MSG_LEN, false,
+				     idle + TEST_ACTIVE_TIME_SEC * MSEC_PER_SEC),
+		      "Hold after the active time has expired");
+
+	/* PSM not in use. */
+	data_sched_psm_update(-1);
+	data_sched_rrc_update(true, 100000);
+	data_sched_rrc_update(false, 101000);
+	zassert_false(data_sched_add(TEST_MSG_LEN, false, 101100), "");
+}
+
+/* Simulate a device that samples periodically and publishes two messages
+ * per cycle. Publishing with the radio idle opens an RRC connection, which
+ * is released after an inactivity timeout.
+ */
+static void test_publishes_saved(void)
+{
+	struct data_sched_stats stats;
+	const int64_t rrc_inactivity_ms = 5000;
+	uint32_t wakeups = 0;
+	int64_t radio_on_ms = 0;
+	int64_t connected_at = 0;
+	int64_t idle_at = -1;
+	int64_t now = 0;
+
+	data_sched_psm_update(TEST_ACTIVE_TIME_SEC);
+
+	for (int i = 0; i < TEST_CYCLES; i++) {
+		now += TEST_INTERVAL_MS;
+
+		if ((idle_at >= 0) && (now >= idle_at)) {
+			data_sched_rrc_update(false, idle_at);
+			radio_on_ms += idle_at - connected_at;
+			idle_at = -1;
+		}
+
+		for (int msg = 0; msg < 2; msg++) {
+			if (!data_sched_add(TEST_MSG_LEN / 2, false, now) &&
+			    !data_sched_timeout(now)) {
+				continue;
+			}
+
+			data_sched_flushed(now);
+
+			if (idle_at < 0) {
+				wakeups++;
+				connected_at = now;
+				data_sched_rrc_update(true, now);
+			}
+
+			idle_at = now + rrc_inactivity_ms;
+		}
+	}
+
+	/* Publish the remaining messages, after the connection has been
+	 * released.
+	 */
+	now += TEST_INTERVAL_MS;
+	if (idle_at >= 0) {
+		data_sched_rrc_update(false, idle_at);
+		radio_on_ms += idle_at - connected_at;
+	}
+
+	if (data_sched_deadline() >= 0) {
+		data_sched_flushed(now);
+		wakeups++;
+	}
+
+	data_sched_stats_get(&stats, now);
+
+	TC_PRINT("%d messages, %d flushes, %d saved, radio on %d ms\n",
+		 stats.held, stats.flushes, stats.saved, stats.radio_on_ms);
+
+	zassert_equal(2 * TEST_CYCLES, stats.held, "");
+	zassert_true(wakeups < TEST_CYCLES / 2,
+		     "Messages should be published together");
+	zassert_equal(stats.held - wakeups, stats.saved,
+		      "Only one message per wake-up should be counted");
+	zassert_equal(radio_on_ms, stats.radio_on_ms,
+		      "Radio on time should follow the RRC connections");
+}
+
+void test_main(void)
+{
+	ztest_test_suite(data_sched_tests,
+		ztest_unit_test_setup_teardown(test_hold_until_size_limit,
+					       sched_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_age_limit,
+					       sched_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_urgent,
+					       sched_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_rrc_connected,
+					       sched_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_psm_active_time,
+					       sched_setup, unit_test_noop),
+		ztest_unit_test_setup_teardown(test_publishes_saved,
+					       sched_setup, unit_test_noop)
+		);
+
+	ztest_run_test_suite(data_sched_tests);
+}
@@ -0,0 +1,215 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <bluetooth/conn.h>
+#include <bluetooth/gatt_dm.h>
+#include <bluetooth/services/hogp.h>
+
+#include "hogp_mock.h"
+
+struct bt_hogp_rep_info {
+	bt_hogp_read_cb read_cb;
+};
+
+/* Instances are only compared by address. */
+static uint8_t dm_instances[CONFIG_BT_MAX_CONN];
+static uint8_t conn_instances[CONFIG_BT_MAX_CONN];
+
+static struct {
+	struct bt_hogp *hogp;
+	struct bt_hogp_rep_info rep;
+	bt_addr_le_t addr;
+} peers[CONFIG_BT_MAX_CONN];
+
+static uint8_t rep_id;
+static size_t rep_size;
+
+const bt_addr_le_t bt_addr_le_none = { 0, { { 0xff, 0xff, 0xff, 0xff,
+					      0xff, 0xff } } };
+
+struct bt_gatt_dm *hogp_mock_dm_get(size_t peer)
+{
+	__ASSERT_NO_MSG(peer < ARRAY_SIZE(dm_instances));
+
+	return (struct bt_gatt_dm *)&dm_instances[peer];
+}
+
+struct bt_conn *hogp_mock_conn_get(size_t peer)
+{
+	__ASSERT_NO_MSG(peer < ARRAY_SIZE(conn_instances));
+
+	return (struct bt_conn *)&conn_instances[peer];
+}
+
+void hogp_mock_report_set(uint8_t report_id, size_t size)
+{
+	rep_id = report_id;
+	rep_size = size;
+}
+
+int hogp_mock_notify(size_t peer, const uint8_t *data)
+{
+	__ASSERT_NO_MSG(peer < ARRAY_SIZE(peers));
+
+	struct bt_hogp *hogp = peers[peer].hogp;
+	struct bt_hogp_rep_info *rep = &peers[peer].rep;
+
+	if (!hogp || !rep->read_cb) {
+		return -ENOTCONN;
+	}
+
+	k_sched_lock();
+	rep->read_cb(hogp, rep, 0, data);
+	k_sched_unlock();
+
+	return 0;
+}
+
+static size_t peer_get(const struct bt_hogp *hogp)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(peers); i++) {
+		if (peers[i].hogp == hogp) {
+			return i;
+		}
+	}
+
+	__ASSERT(false, "HOGP object not assigned");
+
+	return 0;
+}
+
+struct bt_conn *bt_gatt_dm_conn_get(struct bt_gatt_dm *dm)
+{
+	size_t peer = (uint8_t *)dm - dm_instances;
+
+	__ASSERT_NO_MSG(peer < ARRAY_SIZE(dm_instances));
+
+	return hogp_mock_conn_get(peer);
+}
+
+const bt_addr_le_t *bt_conn_get_dst(const struct bt_conn *conn)
+{
+	size_t peer = (const uint8_t *)conn - conn_instances;
+
+	__ASSERT_NO_MSG(peer < ARRAY_SIZE(peers));
+
+	peers[peer].addr.a.val[0] = peer;
+
+	return &peers[peer].addr;
+}
+
+void bt_hogp_init(struct bt_hogp *hogp,
+		  const struct bt_hogp_init_params *params)
+{
+	memset(hogp, 0, sizeof(*hogp));
+	hogp->ready_cb = params->ready_cb;
+	hogp->prep_error_cb = params->prep_error_cb;
+	hogp->pm_update_cb = params->pm_update_cb;
+}
+
+int bt_hogp_handles_assign(struct bt_gatt_dm *dm, struct bt_hogp *hogp)
+{
+	size_t peer = (uint8_t *)dm - dm_instances;
+
+	__ASSERT_NO_MSG(peer < ARRAY_SIZE(peers));
+	__ASSERT_NO_MSG(!peers[peer].hogp);
+
+	hogp->conn = bt_gatt_dm_conn_get(dm);
+	peers[peer].hogp = hogp;
+	peers[peer].rep.read_cb = NULL;
+
+	hogp->ready_cb(hogp);
+
+	return 0;
+}
+
+void bt_hogp_release(struct bt_hogp *hogp)
+{
+	peers[peer_get(hogp)].hogp = NULL;
+	hogp->conn = NULL;
+}
+
+bool bt_hogp_assign_check(const struct bt_hogp *hogp)
+{
+	return (hogp->conn != NULL);
+}
+
+bool bt_hogp_ready_check(const struct bt_hogp *hogp)
+{
+	return bt_hogp_assign_check(hogp);
+}
+
+struct bt_conn *bt_hogp_conn(const struct bt_hogp *hogp)
+{
+	return hogp->conn;
+}
+
+struct bt_hogp_rep_info *bt_hogp_rep_next(struct bt_hogp *hogp,
+					  const struct bt_hogp_rep_info *rep)
+{
+	if (rep) {
+		return NULL;
+	}
+
+	return &peers[peer_get(hogp)].rep;
+}
+
+struct bt_hogp_rep_info *bt_hogp_rep_find(struct bt_hogp *hogp,
+					  enum bt_hids_report_type type,
+					  uint8_t id)
+{
+	if ((type == BT_HIDS_REPORT_TYPE_INPUT) && (id == rep_id)) {
+		return &peers[peer_get(hogp)].rep;
+	}
+
+	return NULL;
+}
+
+uint8_t bt_hogp_rep_id(const struct bt_hogp_rep_info *rep)
+{
+	return rep_id;
+}
+
+enum bt_hids_report_type bt_hogp_rep_type(const struct bt_hogp_rep_info *rep)
+{
+	return BT_HIDS_REPORT_TYPE_INPUT;
+}
+
+size_t bt_hogp_rep_size(const struct bt_hogp_rep_info *rep)
+{
+	return rep_size;
+}
+
+int bt_hogp_rep_subscribe(struct bt_hogp *hogp, struct bt_hogp_rep_info *rep,
+			  bt_hogp_read_cb func)
+{
+	rep->read_cb = func;
+
+	return 0;
+}
+
+int bt_hogp_rep_read(struct bt_hogp *hogp, struct bt_hogp_rep_info *rep,
+		     bt_hogp_read_cb func)
+{
+	return -ENOTSUP;
+}
+
+int bt_hogp_rep_write(struct bt_hogp *hogp, struct bt_hogp_rep_info *rep,
+		      bt_hogp_write_cb func,
+		      const void *data, uint8_t length)
+{
+	return -ENOTSUP;
+}
+
+int bt_hogp_rep_write_wo_rsp(struct bt_hogp *hogp,
+			     struct bt_hogp_rep_info *rep,
+			     const void *data, uint8_t length,
+			     bt_hogp_write_cb func)
+{
+	return -ENOTSUP;
+}
@@ -0,0 +1,59 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef HOGP_MOCK_H_
+#define HOGP_MOCK_H_
+
+#include <zephyr.h>
+#include <bluetooth/gatt_dm.h>
+
+/**
+ * @file
+ * @brief Mock of the HOGP client and of the Bluetooth connections.
+ *
+ * Every mocked peripheral has a single input report. The mock calls the
+ * ready callback of the HOGP object as soon as the handles are assigned.
+ */
+
+/** @brief Get the discovery manager instance of a peripheral.
+ *
+ * @param peer Index of the peripheral, lower than CONFIG_BT_MAX_CONN.
+ *
+ * @return Discovery manager instance to be passed in
+ *         ble_discovery_complete_event.
+ */
+struct bt_gatt_dm *hogp_mock_dm_get(size_t peer);
+
+/** @brief Get the connection of a peripheral.
+ *
+ * @param peer Index of the peripheral, lower than CONFIG_BT_MAX_CONN.
+ *
+ * @return Connection to be passed in ble_peer_event.
+ */
+struct bt_conn *hogp_mock_conn_get(size_t peer);
+
+/** @brief Set the ID and the size of the input report of the peripherals.
+ *
+ * @param report_id Report ID.
+ * @param size      Report size, without the report ID.
+ */
+void hogp_mock_report_set(uint8_t report_id, size_t size);
+
+/** @brief Notify the input report of a peripheral.
+ *
+ * The subscribed callback is called from the calling thread with the
+ * scheduler locked, as it would be from the Bluetooth receive thread.
+ *
+ * @param peer Index of the peripheral.
+ * @param data Report data of the size set with @ref hogp_mock_report_set.
+ *
+ * @retval 0 If the report was notified.
+ * @retval -ENOTCONN If the peripheral is not registered or the report is
+ *         not subscribed.
+ */
+int hogp_mock_notify(size_t peer, const uint8_t *data);
+
+#endif /* HOGP_MOCK_H_ */
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <profiler.h>
+
+#include "profiler_mock.h"
+
+uint32_t profiler_enabled_events = UINT32_MAX;
+
+static const char *event_names[CONFIG_MAX_NUMBER_OF_CUSTOM_EVENTS];
+static size_t event_cnt[CONFIG_MAX_NUMBER_OF_CUSTOM_EVENTS];
+static uint16_t registered_cnt;
+static uint32_t last_values[PROFILER_MOCK_MAX_ARGS];
+
+void profiler_mock_reset(void)
+{
+	memset(event_cnt, 0, sizeof(event_cnt));
+	memset(last_values, 0, sizeof(last_values));
+}
+
+size_t profiler_mock_event_cnt(const char *name)
+{
+	for (size_t i = 0; i < registered_cnt; i++) {
+		if (!strcmp(event_names[i], name)) {
+			return event_cnt[i];
+		}
+	}
+
+	return 0;
+}
+
+uint32_t profiler_mock_last_value(size_t idx)
+{
+	__ASSERT_NO_MSG(idx < ARRAY_SIZE(last_values));
+
+	return last_values[idx];
+}
+
+int profiler_init(void)
+{
+	return 0;
+}
+
+void profiler_term(void)
+{
+}
+
+const char *profiler_get_event_descr(size_t profiler_event_id)
+{
+	return NULL;
+}
+
+uint16_t profiler_register_event_type(const char *name, const char **args,
+				      const enum profiler_arg *arg_types,
+				      uint8_t arg_cnt)
+{
+	__ASSERT_NO_MSG(registered_cnt < ARRAY_SIZE(event_names));
+	__ASSERT_NO_MSG(arg_cnt <= PROFILER_MOCK_MAX_ARGS);
+
+	event_names[registered_cnt] = name;
+
+	return registered_cnt++;
+}
+
+void profiler_log_start(struct log_event_buf *buf)
+{
+	buf->payload = buf->payload_start;
+}
+
+void profiler_log_encode_u32(struct log_event_buf *buf, uint32_t data)
+{
+	__ASSERT_NO_MSG(buf->payload + sizeof(data) <=
+			buf->payload_start + sizeof(buf->payload_start));
+
+	memcpy(buf->payload, &data, sizeof(data));
+	buf->payload += sizeof(data);
+}
+
+void profiler_log_add_mem_address(struct log_event_buf *buf,
+				  const void *mem_address)
+{
+	profiler_log_encode_u32(buf, (uint32_t)(uintptr_t)mem_address);
+}
+
+void profiler_log_send(struct log_event_buf *buf, uint16_t event_type_id)
+{
+	size_t cnt = (buf->payload - buf->payload_start) / sizeof(uint32_t);
+
+	__ASSERT_NO_MSG(event_type_id < registered_cnt);
+
+	memset(last_values, 0, sizeof(last_values));
+	memcpy(last_values, buf->payload_start,
+	       MIN(cnt, ARRAY_SIZE(last_values)) * sizeof(uint32_t));
+	event_cnt[event_type_id]++;
+}
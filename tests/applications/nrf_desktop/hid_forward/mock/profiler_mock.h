@@ -0,0 +1,42 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef PROFILER_MOCK_H_
+#define PROFILER_MOCK_H_
+
+#include <zephyr.h>
+#include <profiler.h>
+
+/**
+ * @file
+ * @brief Mock of the profiler.
+ *
+ * The mock records the number of logged events and the unsigned values of
+ * the last logged event. Profiling of all events is enabled.
+ */
+
+#define PROFILER_MOCK_MAX_ARGS	4
+
+/** @brief Clear the recorded events. */
+void profiler_mock_reset(void);
+
+/** @brief Get the number of logged events.
+ *
+ * @param name Name of the event type.
+ *
+ * @return Number of events logged since the last reset.
+ */
+size_t profiler_mock_event_cnt(const char *name);
+
+/** @brief Get a value of the last logged event.
+ *
+ * @param idx Index of the value.
+ *
+ * @return Value.
+ */
+uint32_t profiler_mock_last_value(size_t idx);
+
+#endif /* PROFILER_MOCK_H_ */
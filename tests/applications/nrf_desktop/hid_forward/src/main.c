@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <kernel.h>
+
+#include "hid_event.h"
+#include "ble_event.h"
+#include "hid_report_desc.h"
+
+#include "hogp_mock.h"
+#include "profiler_mock.h"
+
+/* hid_forward is initialized when the Bluetooth state module is ready. */
+#define MODULE ble_state
+#include "module_state_event.h"
+
+#define TEST_REPORT_ID		REPORT_ID_MOUSE
+#define TEST_REPORT_SIZE	REPORT_SIZE_MOUSE
+#define TEST_REPORT_TIMEOUT	K_MSEC(100)
+#define TEST_EVENT_TIMEOUT	K_MSEC(20)
+#define TEST_LATENCY_EVENT	"hid_forward_latency"
+
+#define TEST_PEER_0		0
+#define TEST_PEER_1		1
+
+static int subscriber;
+
+static K_SEM_DEFINE(report_sem, 0, UINT_MAX);
+/* First data byte of the received reports. A release report is all zeros. */
+static uint8_t received[16];
+static size_t received_cnt;
+
+/* Wait until the submitted events are handled. */
+static void events_wait(void)
+{
+	k_sleep(TEST_EVENT_TIMEOUT);
+}
+
+static void peer_connect(size_t peer)
+{
+	struct ble_discovery_complete_event *event =
+		new_ble_discovery_complete_event();
+
+	event->dm = hogp_mock_dm_get(peer);
+	memset(event->hwid, peer, sizeof(event->hwid));
+	EVENT_SUBMIT(event);
+
+	events_wait();
+}
+
+static void peer_disconnect(size_t peer)
+{
+	struct ble_peer_event *event = new_ble_peer_event();
+
+	event->id = hogp_mock_conn_get(peer);
+	event->state = PEER_STATE_DISCONNECTED;
+	EVENT_SUBMIT(event);
+
+	events_wait();
+}
+
+static void peer_report_send(size_t peer, uint8_t value)
+{
+	uint8_t data[TEST_REPORT_SIZE] = {value};
+	int err = hogp_mock_notify(peer, data);
+
+	zassert_equal(err, 0, "Cannot notify report (err %d)", err);
+}
+
+static void subscription_set(bool enabled)
+{
+	struct hid_report_subscription_event *event =
+		new_hid_report_subscription_event();
+
+	event->subscriber = &subscriber;
+	event->report_id = TEST_REPORT_ID;
+	event->enabled = enabled;
+	EVENT_SUBMIT(event);
+
+	events_wait();
+}
+
+/* Confirm that the report was sent, as the USB HID device would. */
+static void report_sent(void)
+{
+	struct hid_report_sent_event *event = new_hid_report_sent_event();
+
+	event->subscriber = &subscriber;
+	event->report_id = TEST_REPORT_ID;
+	event->error = false;
+	EVENT_SUBMIT(event);
+}
+
+static void report_wait(void)
+{
+	zassert_equal(0, k_sem_take(&report_sem, TEST_REPORT_TIMEOUT),
+		      "Report should be forwarded");
+}
+
+/* Confirm the sent reports until no report is left. */
+static void reports_drain(void)
+{
+	do {
+		report_sent();
+	} while (!k_sem_take(&report_sem, TEST_REPORT_TIMEOUT));
+}
+
+static size_t received_value_cnt(uint8_t value)
+{
+	size_t cnt = 0;
+
+	for (size_t i = 0; i < received_cnt; i++) {
+		if (received[i] == value) {
+			cnt++;
+		}
+	}
+
+	return cnt;
+}
+
+static void test_setup(void)
+{
+	received_cnt = 0;
+	profiler_mock_reset();
+}
+
+static void test_latency_first_sample(void)
+{
+	peer_connect(TEST_PEER_0);
+
+	/* Sent report that was not forwarded by hid_forward. */
+	report_sent();
+	events_wait();
+
+	zassert_equal(0, profiler_mock_event_cnt(TEST_LATENCY_EVENT),
+		      "No latency should be logged");
+
+	peer_report_send(TEST_PEER_0, 1);
+	report_wait();
+	report_sent();
+	events_wait();
+
+	zassert_equal(1, profiler_mock_event_cnt(TEST_LATENCY_EVENT),
+		      "Latency should be logged");
+	zassert_equal(TEST_REPORT_ID, profiler_mock_last_value(0),
+		      "Invalid report ID");
+
+	peer_disconnect(TEST_PEER_0);
+	reports_drain();
+}
+
+static void test_disconnect_migration(void)
+{
+	BUILD_ASSERT(CONFIG_DESKTOP_HID_FORWARD_MAX_ENQUEUED_REPORTS == 2);
+
+	peer_connect(TEST_PEER_0);
+	peer_connect(TEST_PEER_1);
+
+	/* The first report is sent, the subscriber is busy afterwards. */
+	peer_report_send(TEST_PEER_0, 1);
+	report_wait();
+	peer_report_send(TEST_PEER_0, 2);
+	peer_report_send(TEST_PEER_0, 3);
+	peer_report_send(TEST_PEER_1, 4);
+	peer_report_send(TEST_PEER_1, 5);
+
+	/* The release report drops report 2. Reports 3 and the release are
+	 * moved to the subscriber.
+	 */
+	peer_disconnect(TEST_PEER_0);
+
+	/* The reports left at the subscriber are moved to the reconnected
+	 * peripheral, so that the next disconnection does not drop them.
+	 */
+	peer_connect(TEST_PEER_0);
+	peer_disconnect(TEST_PEER_1);
+
+	reports_drain();
+
+	zassert_equal(5, received_cnt, "Invalid number of forwarded reports");
+	zassert_equal(1, received_value_cnt(1), "Report 1 not forwarded");
+	zassert_equal(1, received_value_cnt(3), "Report 3 not forwarded");
+	zassert_equal(1, received_value_cnt(5), "Report 5 not forwarded");
+	zassert_equal(2, received_value_cnt(0),
+		      "Both release reports should be forwarded");
+	zassert_equal(0, received_value_cnt(2) + received_value_cnt(4),
+		      "Oldest reports should be dropped");
+
+	peer_disconnect(TEST_PEER_0);
+	reports_drain();
+}
+
+static bool event_handler(const struct event_header *eh)
+{
+	if (is_hid_report_event(eh)) {
+		const struct hid_report_event *event =
+			cast_hid_report_event(eh);
+
+		zassert_equal(&subscriber, event->subscriber,
+			      "Unexpected subscriber");
+		zassert_equal(TEST_REPORT_ID, event->dyndata.data[0],
+			      "Unexpected report ID");
+		zassert_equal(TEST_REPORT_SIZE + 1, event->dyndata.size,
+			      "Unexpected report size");
+
+		if (received_cnt < ARRAY_SIZE(received)) {
+			received[received_cnt] = event->dyndata.data[1];
+		}
+		received_cnt++;
+
+		k_sem_give(&report_sem);
+
+		return false;
+	}
+
+	/* Event not handled but subscribed. */
+	__ASSERT_NO_MSG(false);
+
+	return false;
+}
+
+EVENT_LISTENER(test, event_handler);
+EVENT_SUBSCRIBE(test, hid_report_event);
+
+void test_main(void)
+{
+	zassert_false(event_manager_init(),
+		      "Error when initializing event manager");
+
+	hogp_mock_report_set(TEST_REPORT_ID, TEST_REPORT_SIZE);
+
+	module_set_state(MODULE_STATE_READY);
+	subscription_set(true);
+
+	ztest_test_suite(hid_forward_tests,
+			 ztest_unit_test_setup_teardown(test_latency_first_sample,
+							test_setup,
+							unit_test_noop),
+			 ztest_unit_test_setup_teardown(test_disconnect_migration,
+							test_setup,
+							unit_test_noop)
+			 );
+
+	ztest_run_test_suite(hid_forward_tests);
+}
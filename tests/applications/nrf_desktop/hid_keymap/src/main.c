@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <kernel.h>
+
+#include "hid_keymap_def.h"
+#include "hid_keymap_table.h"
+
+#define TEST_KEY_ID_CNT		BIT(_FN_POS + 1)
+#define TEST_BENCHMARK_CNT	100
+
+/* Binary search over the sorted keymap used as a reference. */
+static const struct hid_keymap *hid_keymap_bsearch(uint16_t key_id)
+{
+	size_t lower = 0;
+	size_t upper = ARRAY_SIZE(hid_keymap);
+
+	while (lower < upper) {
+		size_t m = (lower + upper) / 2;
+
+		if (hid_keymap[m].key_id == key_id) {
+			return &hid_keymap[m];
+		} else if (hid_keymap[m].key_id > key_id) {
+			upper = m;
+		} else {
+			lower = m + 1;
+		}
+	}
+
+	return NULL;
+}
+
+static void test_keymap_sorted(void)
+{
+	for (size_t i = 1; i < ARRAY_SIZE(hid_keymap); i++) {
+		zassert_true(hid_keymap[i - 1].key_id < hid_keymap[i].key_id,
+			     "Reference keymap must be sorted by key ID");
+	}
+}
+
+static void test_lookup_all_key_ids(void)
+{
+	size_t found = 0;
+
+	for (size_t key_id = 0; key_id < TEST_KEY_ID_CNT; key_id++) {
+		const struct hid_keymap *map = hid_keymap_get(key_id);
+
+		zassert_equal_ptr(hid_keymap_bsearch(key_id), map,
+				  "Invalid lookup of key ID 0x%zx", key_id);
+		if (map) {
+			found++;
+		}
+	}
+
+	zassert_equal(ARRAY_SIZE(hid_keymap), found,
+		      "Every keymap entry should be found");
+}
+
+/* Print the lookup time. Timing depends on the platform, so it is not
+ * checked.
+ */
+static void test_lookup_benchmark(void)
+{
+	uint32_t start;
+	uint32_t table_cycles;
+	uint32_t bsearch_cycles;
+	volatile uintptr_t sink = 0;
+
+	start = k_cycle_get_32();
+	for (size_t n = 0; n < TEST_BENCHMARK_CNT; n++) {
+		for (size_t i = 0; i < ARRAY_SIZE(hid_keymap); i++) {
+			sink += (uintptr_t)hid_keymap_get(hid_keymap[i].key_id);
+		}
+	}
+	table_cycles = k_cycle_get_32() - start;
+
+	start = k_cycle_get_32();
+	for (size_t n = 0; n < TEST_BENCHMARK_CNT; n++) {
+		for (size_t i = 0; i < ARRAY_SIZE(hid_keymap); i++) {
+			sink += (uintptr_t)hid_keymap_bsearch(hid_keymap[i].key_id);
+		}
+	}
+	bsearch_cycles = k_cycle_get_32() - start;
+
+	const uint32_t lookup_cnt = TEST_BENCHMARK_CNT * ARRAY_SIZE(hid_keymap);
+
+	TC_PRINT("Keymap of %zu keys, %zu B lookup table\n",
+		 ARRAY_SIZE(hid_keymap), sizeof(hid_keymap_table));
+	TC_PRINT("Table lookup: %u cycles per key\n",
+		 table_cycles / lookup_cnt);
+	TC_PRINT("Binary search: %u cycles per key\n",
+		 bsearch_cycles / lookup_cnt);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(hid_keymap_tests,
+			 ztest_unit_test(test_keymap_sorted),
+			 ztest_unit_test(test_lookup_all_key_ids),
+			 ztest_unit_test(test_lookup_benchmark)
+			 );
+
+	ztest_run_test_suite(hid_keymap_tests);
+}
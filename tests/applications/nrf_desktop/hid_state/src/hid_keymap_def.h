@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include "hid_keymap.h"
+#include "key_id.h"
+
+/* This configuration file is included only once from hid_state module and holds
+ * information about mapping between buttons and generated reports.
+ */
+
+/* This structure enforces the header file is included only once in the build.
+ * Violating this requirement triggers a multiple definition error at link time.
+ */
+const struct {} hid_keymap_def_include_once;
+
+static const struct hid_keymap hid_keymap[] = {
+	{ KEY_ID(0x00, 0x00), 0x0004, REPORT_ID_KEYBOARD_KEYS }, /* A */
+	{ KEY_ID(0x00, 0x01), 0x0005, REPORT_ID_KEYBOARD_KEYS }, /* B */
+	{ KEY_ID(0x00, 0x02), 0x0006, REPORT_ID_KEYBOARD_KEYS }, /* C */
+	{ KEY_ID(0x00, 0x03), 0x0007, REPORT_ID_KEYBOARD_KEYS }, /* D */
+};
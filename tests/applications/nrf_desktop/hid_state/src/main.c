@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <kernel.h>
+
+#include "button_event.h"
+#include "hid_event.h"
+#include "ble_event.h"
+#include "hid_report_desc.h"
+#include "key_id.h"
+
+#define MODULE main
+#include "module_state_event.h"
+
+#define TEST_BENCHMARK_CNT	100
+#define TEST_REPORT_TIMEOUT	K_MSEC(100)
+#define TEST_IDLE_TIMEOUT	K_MSEC(20)
+
+/* Key IDs as defined in the test hid_keymap_def.h. */
+#define TEST_KEY_A		KEY_ID(0x00, 0x00)
+#define TEST_KEY_B		KEY_ID(0x00, 0x01)
+#define TEST_KEY_C		KEY_ID(0x00, 0x02)
+
+#define TEST_USAGE_A		0x04
+#define TEST_USAGE_B		0x05
+
+#define TEST_KEYS_OFFSET	3 /* Report ID, modifiers, reserved byte. */
+#define TEST_KEYS_LEN		(REPORT_SIZE_KEYBOARD_KEYS - 2)
+
+static int subscriber;
+
+static K_SEM_DEFINE(report_sem, 0, UINT_MAX);
+static uint8_t last_keys[TEST_KEYS_LEN];
+static uint32_t press_cycles;
+static uint32_t report_cycles;
+static bool key_a_reported;
+
+static void button_submit(uint16_t key_id, bool pressed)
+{
+	struct button_event *event = new_button_event();
+
+	event->key_id = key_id;
+	event->pressed = pressed;
+
+	press_cycles = k_cycle_get_32();
+	EVENT_SUBMIT(event);
+}
+
+static void subscription_set(bool enabled)
+{
+	struct hid_report_subscription_event *event =
+		new_hid_report_subscription_event();
+
+	event->subscriber = &subscriber;
+	event->report_id = REPORT_ID_KEYBOARD_KEYS;
+	event->enabled = enabled;
+
+	EVENT_SUBMIT(event);
+}
+
+/* Wait until hid_state stops generating reports. */
+static void reports_wait_idle(void)
+{
+	while (!k_sem_take(&report_sem, TEST_IDLE_TIMEOUT)) {
+	}
+}
+
+static size_t pressed_keys_get(uint8_t *keys)
+{
+	size_t cnt = 0;
+
+	for (size_t i = 0; i < TEST_KEYS_LEN; i++) {
+		if (last_keys[i]) {
+			keys[cnt++] = last_keys[i];
+		}
+	}
+
+	return cnt;
+}
+
+static void test_setup(void)
+{
+	subscription_set(true);
+	reports_wait_idle();
+}
+
+static void test_teardown(void)
+{
+	subscription_set(false);
+	reports_wait_idle();
+}
+
+/* Print the button to report latency. Timing depends on the platform, so it
+ * is not checked.
+ */
+static void test_report_latency(void)
+{
+	uint32_t total = 0;
+	uint32_t max = 0;
+	size_t cnt = 0;
+
+	for (size_t i = 0; i < TEST_BENCHMARK_CNT; i++) {
+		bool pressed = ((i % 2) == 0);
+
+		button_submit(TEST_KEY_A, pressed);
+		if (k_sem_take(&report_sem, TEST_REPORT_TIMEOUT)) {
+			continue;
+		}
+
+		uint32_t latency = report_cycles - press_cycles;
+
+		total += latency;
+		max = MAX(max, latency);
+		cnt++;
+	}
+
+	TC_PRINT("Button to report latency: %u us average, %u us max "
+		 "(%zu reports)\n",
+		 cnt ? k_cyc_to_us_floor32(total / cnt) : 0,
+		 k_cyc_to_us_floor32(max), cnt);
+
+	reports_wait_idle();
+}
+
+static void test_enqueue_replay(void)
+{
+	uint8_t keys[TEST_KEYS_LEN];
+
+	subscription_set(false);
+	reports_wait_idle();
+
+	button_submit(TEST_KEY_A, true);
+	button_submit(TEST_KEY_B, true);
+	button_submit(TEST_KEY_A, false);
+
+	subscription_set(true);
+	reports_wait_idle();
+
+	zassert_equal(1, pressed_keys_get(keys), "One key should be pressed");
+	zassert_equal(TEST_USAGE_B, keys[0], "Key B should be pressed");
+
+	button_submit(TEST_KEY_B, false);
+	reports_wait_idle();
+
+	zassert_equal(0, pressed_keys_get(keys), "No key should be pressed");
+}
+
+static void test_enqueue_overflow(void)
+{
+	uint8_t keys[TEST_KEYS_LEN];
+
+	BUILD_ASSERT(CONFIG_DESKTOP_HID_EVENT_QUEUE_SIZE == 12);
+
+	subscription_set(false);
+	reports_wait_idle();
+
+	/* Fill the queue with the presses of keys A and B and five taps of
+	 * key C. Releasing key A overflows the queue.
+	 */
+	button_submit(TEST_KEY_A, true);
+	button_submit(TEST_KEY_B, true);
+	for (size_t i = 0; i < 5; i++) {
+		button_submit(TEST_KEY_C, true);
+		button_submit(TEST_KEY_C, false);
+	}
+	button_submit(TEST_KEY_A, false);
+
+	key_a_reported = false;
+	subscription_set(true);
+	reports_wait_idle();
+
+	if (IS_ENABLED(CONFIG_DESKTOP_HID_EVENT_QUEUE_COALESCE)) {
+		/* Only the first tap of key C is dropped. */
+		zassert_true(key_a_reported, "Key A should be reported");
+		zassert_equal(1, pressed_keys_get(keys),
+			      "One key should be pressed");
+		zassert_equal(TEST_USAGE_B, keys[0], "Key B should be pressed");
+
+		button_submit(TEST_KEY_B, false);
+		reports_wait_idle();
+	} else if (IS_ENABLED(CONFIG_DESKTOP_HID_EVENT_QUEUE_DROP_OLDEST)) {
+		/* Only the press of key A is dropped. */
+		zassert_false(key_a_reported, "Key A should not be reported");
+		zassert_equal(1, pressed_keys_get(keys),
+			      "One key should be pressed");
+		zassert_equal(TEST_USAGE_B, keys[0], "Key B should be pressed");
+
+		button_submit(TEST_KEY_B, false);
+		reports_wait_idle();
+	} else {
+		/* All enqueued events are dropped. */
+		zassert_equal(0, pressed_keys_get(keys),
+			      "No key should be pressed");
+	}
+}
+
+static bool event_handler(const struct event_header *eh)
+{
+	if (is_hid_report_event(eh)) {
+		const struct hid_report_event *event =
+			cast_hid_report_event(eh);
+
+		zassert_equal(&subscriber, event->subscriber,
+			      "Unexpected subscriber");
+		zassert_equal(REPORT_ID_KEYBOARD_KEYS, event->dyndata.data[0],
+			      "Unexpected report ID");
+
+		report_cycles = k_cycle_get_32();
+		memcpy(last_keys, &event->dyndata.data[TEST_KEYS_OFFSET],
+		       sizeof(last_keys));
+		if (memchr(last_keys, TEST_USAGE_A, sizeof(last_keys))) {
+			key_a_reported = true;
+		}
+
+		struct hid_report_sent_event *sent =
+			new_hid_report_sent_event();
+
+		sent->subscriber = event->subscriber;
+		sent->report_id = event->dyndata.data[0];
+		sent->error = false;
+		EVENT_SUBMIT(sent);
+
+		k_sem_give(&report_sem);
+
+		return false;
+	}
+
+	/* Event not handled but subscribed. */
+	__ASSERT_NO_MSG(false);
+
+	return false;
+}
+
+EVENT_LISTENER(test, event_handler);
+EVENT_SUBSCRIBE(test, hid_report_event);
+
+void test_main(void)
+{
+	zassert_false(event_manager_init(),
+		      "Error when initializing event manager");
+
+	module_set_state(MODULE_STATE_READY);
+
+	struct ble_peer_event *event = new_ble_peer_event();
+
+	event->id = &subscriber;
+	event->state = PEER_STATE_CONNECTED;
+	EVENT_SUBMIT(event);
+
+	ztest_test_suite(hid_state_tests,
+			 ztest_unit_test_setup_teardown(test_report_latency,
+							test_setup,
+							test_teardown),
+			 ztest_unit_test_setup_teardown(test_enqueue_replay,
+							test_setup,
+							test_teardown),
+			 ztest_unit_test_setup_teardown(test_enqueue_overflow,
+							test_setup,
+							test_teardown)
+			 );
+
+	ztest_run_test_suite(hid_state_tests);
+}
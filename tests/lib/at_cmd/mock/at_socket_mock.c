@@ -0,0 +1,143 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <net/socket.h>
+#include <modem/nrf_modem_lib.h>
+
+#include "at_socket_mock.h"
+
+#define MOCK_MSG_MAX		16
+#define MOCK_CMD_MAX_LEN	64
+#define MOCK_AT_FD		1
+
+struct mock_msg {
+	const char *cmd;
+	const char *msg;
+};
+
+static struct mock_msg mock_msgs[MOCK_MSG_MAX];
+static size_t mock_msg_cnt;
+
+static const char *pending[MOCK_MSG_MAX];
+static size_t pending_head;
+static size_t pending_cnt;
+
+static char last_cmd[MOCK_CMD_MAX_LEN];
+static uint32_t cmd_cnt;
+
+static K_MUTEX_DEFINE(mock_mutex);
+static K_SEM_DEFINE(pending_sem, 0, K_SEM_MAX_LIMIT);
+
+void at_socket_mock_reset(void)
+{
+	k_mutex_lock(&mock_mutex, K_FOREVER);
+	mock_msg_cnt = 0;
+	pending_head = 0;
+	pending_cnt = 0;
+	cmd_cnt = 0;
+	last_cmd[0] = '\0';
+	k_sem_reset(&pending_sem);
+	k_mutex_unlock(&mock_mutex);
+}
+
+void at_socket_mock_msg_add(const char *cmd, const char *msg)
+{
+	k_mutex_lock(&mock_mutex, K_FOREVER);
+	__ASSERT_NO_MSG(mock_msg_cnt < ARRAY_SIZE(mock_msgs));
+	mock_msgs[mock_msg_cnt].cmd = cmd;
+	mock_msgs[mock_msg_cnt].msg = msg;
+	mock_msg_cnt++;
+	k_mutex_unlock(&mock_mutex);
+}
+
+uint32_t at_socket_mock_cmd_cnt(void)
+{
+	return cmd_cnt;
+}
+
+const char *at_socket_mock_last_cmd(void)
+{
+	return last_cmd;
+}
+
+static void pending_put(const char *msg)
+{
+	__ASSERT_NO_MSG(pending_cnt < ARRAY_SIZE(pending));
+	pending[(pending_head + pending_cnt) % ARRAY_SIZE(pending)] = msg;
+	pending_cnt++;
+	k_sem_give(&pending_sem);
+}
+
+int z_impl_zsock_socket(int family, int type, int proto)
+{
+	return MOCK_AT_FD;
+}
+
+int z_impl_zsock_close(int sock)
+{
+	return 0;
+}
+
+ssize_t z_impl_zsock_sendto(int sock, const void *buf, size_t len, int flags,
+			    const struct sockaddr *dest_addr, socklen_t addrlen)
+{
+	k_mutex_lock(&mock_mutex, K_FOREVER);
+
+	len = MIN(len, sizeof(last_cmd) - 1);
+	memcpy(last_cmd, buf, len);
+	last_cmd[len] = '\0';
+	cmd_cnt++;
+
+	/* The messages are sent by the modem once the command is written */
+	for (size_t i = 0; i < mock_msg_cnt; i++) {
+		if (!strcmp(mock_msgs[i].cmd, last_cmd)) {
+			pending_put(mock_msgs[i].msg);
+		}
+	}
+
+	k_mutex_unlock(&mock_mutex);
+
+	return len;
+}
+
+ssize_t z_impl_zsock_recvfrom(int sock, void *buf, size_t max_len, int flags,
+			      struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	const char *msg;
+	size_t len;
+
+	k_sem_take(&pending_sem, K_FOREVER);
+
+	k_mutex_lock(&mock_mutex, K_FOREVER);
+	msg = pending[pending_head];
+	pending_head = (pending_head + 1) % ARRAY_SIZE(pending);
+	pending_cnt--;
+	k_mutex_unlock(&mock_mutex);
+
+	/* The message is delivered as a whole, including the terminating
+	 * null character. The part that does not fit is discarded.
+	 */
+	len = MIN(strlen(msg) + 1, max_len);
+	memcpy(buf, msg, len);
+
+	return len;
+}
+
+int z_impl_zsock_poll(struct zsock_pollfd *fds, int nfds, int timeout)
+{
+	k_sem_take(&pending_sem, K_FOREVER);
+	k_sem_give(&pending_sem);
+
+	fds[0].revents = ZSOCK_POLLIN;
+
+	return 1;
+}
+
+void nrf_modem_lib_shutdown_wait(void)
+{
+}
@@ -0,0 +1,48 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef AT_SOCKET_MOCK_H_
+#define AT_SOCKET_MOCK_H_
+
+#include <zephyr.h>
+
+/**
+ * @file
+ * @brief Mock of the AT socket.
+ *
+ * The mock answers the commands written to the AT socket with preset
+ * messages. Like the AT socket, it delivers every message as a whole: the
+ * part of a message that does not fit into the receive buffer is discarded.
+ */
+
+/** @brief Clear the preset messages and the counters. */
+void at_socket_mock_reset(void);
+
+/** @brief Add a message sent by the modem when a command is written.
+ *
+ * Several messages can be added for the same command. They are delivered in
+ * the order they were added, for example a notification followed by the
+ * response.
+ *
+ * @param cmd Command.
+ * @param msg Null terminated message. The pointer must remain valid until
+ *            the mock is reset.
+ */
+void at_socket_mock_msg_add(const char *cmd, const char *msg);
+
+/** @brief Get the number of commands written to the AT socket.
+ *
+ * @return Number of commands.
+ */
+uint32_t at_socket_mock_cmd_cnt(void);
+
+/** @brief Get the last command written to the AT socket.
+ *
+ * @return Null terminated command.
+ */
+const char *at_socket_mock_last_cmd(void);
+
+#endif /* AT_SOCKET_MOCK_H_ */
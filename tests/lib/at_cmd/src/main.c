@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <modem/at_cmd.h>
+
+#include "at_socket_mock.h"
+
+/* Response buffer large enough to receive the response directly */
+#define TEST_ZERO_COPY_BUF_LEN	(2 * CONFIG_AT_CMD_RESPONSE_MAX_LEN)
+/* Length of a response that does not fit into the internal buffer */
+#define TEST_LONG_RSP_LEN	(CONFIG_AT_CMD_RESPONSE_MAX_LEN + 64)
+#define TEST_LONG_LINE		"+LONG: 0123456789abcdef\r\n"
+
+#define TEST_NOTIF		"+CEREG: 1,\"0140\",\"0199F10A\",7\r\n"
+
+static char rsp_buf[TEST_ZERO_COPY_BUF_LEN];
+static char long_rsp[TEST_LONG_RSP_LEN + sizeof(TEST_LONG_LINE)];
+static size_t long_rsp_payload_len;
+
+static char notif_buf[CONFIG_AT_CMD_RESPONSE_MAX_LEN];
+static uint32_t notif_cnt;
+static bool notif_in_rsp_buf;
+
+static uint32_t chunk_cnt;
+static size_t stream_len;
+
+static void notif_handler(const char *notif)
+{
+	notif_in_rsp_buf = (notif >= rsp_buf &&
+			    notif < rsp_buf + sizeof(rsp_buf)) ||
+			   (strstr(rsp_buf, TEST_NOTIF) != NULL);
+
+	strncpy(notif_buf, notif, sizeof(notif_buf) - 1);
+	notif_cnt++;
+}
+
+static void stream_handler(const char *chunk, size_t len)
+{
+	zassert_true(len > 0, "Empty chunk");
+	zassert_equal(chunk[len - 1], '\n', "Chunk is not a line");
+
+	chunk_cnt++;
+	stream_len += len;
+}
+
+static void test_reset(void)
+{
+	at_socket_mock_reset();
+	memset(rsp_buf, 0, sizeof(rsp_buf));
+	memset(notif_buf, 0, sizeof(notif_buf));
+	notif_cnt = 0;
+	notif_in_rsp_buf = false;
+	chunk_cnt = 0;
+	stream_len = 0;
+}
+
+/* Build a response made of lines, which is longer than the internal buffer */
+static void long_rsp_init(void)
+{
+	size_t len = 0;
+
+	while (len < TEST_LONG_RSP_LEN) {
+		strcpy(&long_rsp[len], TEST_LONG_LINE);
+		len += strlen(TEST_LONG_LINE);
+	}
+	long_rsp_payload_len = len;
+
+	strcpy(&long_rsp[len], "OK\r\n");
+}
+
+static void test_response(void)
+{
+	enum at_cmd_state state;
+	char buf[32];
+	int err;
+
+	test_reset();
+	at_socket_mock_msg_add("AT+CGMR", "mfw_nrf9160_1.2.3\r\nOK\r\n");
+
+	err = at_cmd_write("AT+CGMR", buf, sizeof(buf), &state);
+	zassert_equal(err, 0, "Command failed (err %d)", err);
+	zassert_equal(state, AT_CMD_OK, "Wrong state");
+	zassert_equal(strcmp(buf, "mfw_nrf9160_1.2.3\r\n"), 0,
+		      "Wrong response");
+}
+
+static void test_error_response(void)
+{
+	enum at_cmd_state state;
+	char buf[32];
+	int err;
+
+	test_reset();
+	at_socket_mock_msg_add("AT+CMEE", "+CME ERROR: 10\r\n");
+
+	err = at_cmd_write("AT+CMEE", buf, sizeof(buf), &state);
+	zassert_equal(err, 10, "Wrong error (err %d)", err);
+	zassert_equal(state, AT_CMD_ERROR_CME, "Wrong state");
+}
+
+static void test_long_response(void)
+{
+	enum at_cmd_state state;
+	int err;
+
+	test_reset();
+	at_socket_mock_msg_add("AT%XLONG", long_rsp);
+
+	/* The response does not fit into the internal buffer, it is received
+	 * directly into the caller's buffer.
+	 */
+	err = at_cmd_write("AT%XLONG", rsp_buf, sizeof(rsp_buf), &state);
+	zassert_equal(err, 0, "Command failed (err %d)", err);
+	zassert_equal(state, AT_CMD_OK, "Wrong state");
+	zassert_equal(strlen(rsp_buf), long_rsp_payload_len,
+		      "Wrong response length");
+	zassert_mem_equal(rsp_buf, long_rsp, long_rsp_payload_len,
+			  "Wrong response");
+}
+
+static void test_long_response_small_buffer(void)
+{
+	enum at_cmd_state state;
+	char buf[CONFIG_AT_CMD_RESPONSE_MAX_LEN / 2];
+	int err;
+
+	test_reset();
+	at_socket_mock_msg_add("AT%XLONG", long_rsp);
+
+	/* The response is received into the internal buffer */
+	err = at_cmd_write("AT%XLONG", buf, sizeof(buf), &state);
+	zassert_equal(err, -ENOBUFS, "Wrong error (err %d)", err);
+	zassert_equal(state, AT_CMD_ERROR_READ, "Wrong state");
+}
+
+static void test_stream(void)
+{
+	enum at_cmd_state state;
+	int err;
+
+	test_reset();
+	at_socket_mock_msg_add("AT%CMNG=1",
+			       "%CMNG: 16842753,0,\"0123\"\r\n"
+			       "%CMNG: 16842753,1,\"4567\"\r\n"
+			       "%CMNG: 16842753,2,\"89ab\"\r\n"
+			       "OK\r\n");
+
+	err = at_cmd_write_stream("AT%CMNG=1", stream_handler, &state);
+	zassert_equal(err, 0, "Command failed (err %d)", err);
+	zassert_equal(state, AT_CMD_OK, "Wrong state");
+	zassert_equal(chunk_cnt, 3, "Wrong number of chunks");
+	zassert_equal(stream_len, 3 * strlen("%CMNG: 16842753,0,\"0123\"\r\n"),
+		      "Wrong response length");
+}
+
+static void test_stream_long_response(void)
+{
+	enum at_cmd_state state;
+	int err;
+
+	test_reset();
+	at_socket_mock_msg_add("AT%XLONG", long_rsp);
+
+	/* Streamed responses are limited by the internal buffer */
+	err = at_cmd_write_stream("AT%XLONG", stream_handler, &state);
+	zassert_equal(err, -ENOBUFS, "Wrong error (err %d)", err);
+	zassert_equal(chunk_cnt, 0, "Truncated response delivered");
+}
+
+static void test_notification_during_command(void)
+{
+	enum at_cmd_state state;
+	int err;
+
+	test_reset();
+	at_socket_mock_msg_add("AT+CFUN?", TEST_NOTIF);
+	at_socket_mock_msg_add("AT+CFUN?", "+CFUN: 1\r\nOK\r\n");
+
+	err = at_cmd_write("AT+CFUN?", rsp_buf, sizeof(rsp_buf), &state);
+	zassert_equal(err, 0, "Command failed (err %d)", err);
+	zassert_equal(state, AT_CMD_OK, "Wrong state");
+	zassert_equal(strcmp(rsp_buf, "+CFUN: 1\r\n"), 0, "Wrong response");
+
+	zassert_equal(notif_cnt, 1, "Notification not delivered");
+	zassert_equal(strcmp(notif_buf, TEST_NOTIF), 0,
+		      "Wrong notification");
+	zassert_false(notif_in_rsp_buf,
+		      "Notification delivered from the response buffer");
+}
+
+static void batch_rsp_add(void)
+{
+	at_socket_mock_msg_add("AT+CFUN=1", "OK\r\n");
+	at_socket_mock_msg_add("AT+CGSN", "352656100000000\r\nOK\r\n");
+	at_socket_mock_msg_add("AT+CEREG=5", "OK\r\n");
+	at_socket_mock_msg_add("AT%XFAIL", "ERROR\r\n");
+}
+
+static void batch_check_stats(const struct at_cmd_batch_item *items,
+			      size_t count,
+			      const struct at_cmd_batch_stats *stats)
+{
+	uint32_t max_rtt_us = 0;
+
+	for (size_t i = 0; i < stats->exec_cnt; i++) {
+		max_rtt_us = MAX(max_rtt_us, items[i].rtt_us);
+	}
+
+	zassert_equal(stats->max_rtt_us, max_rtt_us, "Wrong max rtt");
+
+	for (size_t i = stats->exec_cnt; i < count; i++) {
+		zassert_equal(items[i].state, AT_CMD_ERROR_QUEUE,
+			      "Command %zu not skipped", i);
+		zassert_equal(items[i].code, -ECANCELED,
+			      "Wrong code of command %zu", i);
+	}
+}
+
+static void test_batch(void)
+{
+	struct at_cmd_batch_stats stats;
+	char buf[32];
+	struct at_cmd_batch_item items[] = {
+		{ .cmd = "AT+CFUN=1" },
+		{ .cmd = "AT+CGSN", .buf = buf, .buf_len = sizeof(buf) },
+		{ .cmd = "AT+CEREG=5" },
+	};
+	int err;
+
+	test_reset();
+	batch_rsp_add();
+
+	err = at_cmd_write_batch(items, ARRAY_SIZE(items), true, &stats);
+	zassert_equal(err, 0, "Batch failed (err %d)", err);
+	zassert_equal(stats.exec_cnt, ARRAY_SIZE(items),
+		      "Wrong number of executed commands");
+	zassert_equal(at_socket_mock_cmd_cnt(), ARRAY_SIZE(items),
+		      "Wrong number of written commands");
+
+	for (size_t i = 0; i < ARRAY_SIZE(items); i++) {
+		zassert_equal(items[i].state, AT_CMD_OK,
+			      "Command %zu failed", i);
+		zassert_equal(items[i].code, 0, "Command %zu failed", i);
+	}
+
+	zassert_equal(strcmp(buf, "352656100000000\r\n"), 0,
+		      "Wrong response");
+
+	batch_check_stats(items, ARRAY_SIZE(items), &stats);
+}
+
+static void test_batch_stop_on_error(void)
+{
+	struct at_cmd_batch_stats stats;
+	struct at_cmd_batch_item items[] = {
+		{ .cmd = "AT+CFUN=1" },
+		{ .cmd = "AT%XFAIL" },
+		{ .cmd = "AT+CEREG=5" },
+	};
+	int err;
+
+	test_reset();
+	batch_rsp_add();
+
+	err = at_cmd_write_batch(items, ARRAY_SIZE(items), true, &stats);
+	zassert_equal(err, -ENOEXEC, "Wrong error (err %d)", err);
+	zassert_equal(stats.exec_cnt, 2, "Wrong number of executed commands");
+	zassert_equal(at_socket_mock_cmd_cnt(), 2,
+		      "Command written after an error");
+	zassert_equal(strcmp(at_socket_mock_last_cmd(), "AT%XFAIL"), 0,
+		      "Wrong last command");
+
+	zassert_equal(items[0].state, AT_CMD_OK, "Wrong state");
+	zassert_equal(items[1].state, AT_CMD_ERROR, "Wrong state");
+	zassert_equal(items[1].code, -ENOEXEC, "Wrong code");
+
+	batch_check_stats(items, ARRAY_SIZE(items), &stats);
+}
+
+static void test_batch_continue_on_error(void)
+{
+	struct at_cmd_batch_stats stats;
+	struct at_cmd_batch_item items[] = {
+		{ .cmd = "AT%XFAIL" },
+		{ .cmd = "AT+CFUN=1" },
+		{ .cmd = "AT+CEREG=5" },
+	};
+	int err;
+
+	test_reset();
+	batch_rsp_add();
+
+	err = at_cmd_write_batch(items, ARRAY_SIZE(items), false, &stats);
+	zassert_equal(err, -ENOEXEC, "Wrong error (err %d)", err);
+	zassert_equal(stats.exec_cnt, ARRAY_SIZE(items),
+		      "Wrong number of executed commands");
+	zassert_equal(at_socket_mock_cmd_cnt(), ARRAY_SIZE(items),
+		      "Wrong number of written commands");
+
+	zassert_equal(items[0].state, AT_CMD_ERROR, "Wrong state");
+	zassert_equal(items[1].state, AT_CMD_OK, "Wrong state");
+	zassert_equal(items[2].state, AT_CMD_OK, "Wrong state");
+
+	batch_check_stats(items, ARRAY_SIZE(items), &stats);
+}
+
+static void test_batch_small_buffer(void)
+{
+	struct at_cmd_batch_stats stats;
+	char buf[8];
+	struct at_cmd_batch_item items[] = {
+		{ .cmd = "AT+CFUN=1" },
+		{ .cmd = "AT+CGSN", .buf = buf, .buf_len = sizeof(buf) },
+		{ .cmd = "AT+CEREG=5" },
+	};
+	int err;
+
+	test_reset();
+	batch_rsp_add();
+
+	err = at_cmd_write_batch(items, ARRAY_SIZE(items), true, &stats);
+	zassert_equal(err, -EMSGSIZE, "Wrong error (err %d)", err);
+	zassert_equal(stats.exec_cnt, 2, "Wrong number of executed commands");
+	zassert_equal(at_socket_mock_cmd_cnt(), 2,
+		      "Command written after an error");
+
+	zassert_equal(items[0].code, 0, "Wrong code");
+	zassert_equal(items[1].code, -EMSGSIZE, "Wrong code");
+
+	batch_check_stats(items, ARRAY_SIZE(items), &stats);
+}
+
+static void test_batch_invalid(void)
+{
+	struct at_cmd_batch_item items[] = {
+		{ .cmd = "AT+CFUN=1" },
+		{ .cmd = "  " },
+	};
+	int err;
+
+	test_reset();
+
+	err = at_cmd_write_batch(items, ARRAY_SIZE(items), true, NULL);
+	zassert_equal(err, -EINVAL, "Wrong error (err %d)", err);
+	zassert_equal(at_socket_mock_cmd_cnt(), 0, "Command written");
+
+	err = at_cmd_write_batch(items, 0, true, NULL);
+	zassert_equal(err, -EINVAL, "Wrong error (err %d)", err);
+}
+
+void test_main(void)
+{
+	int err = at_cmd_init();
+
+	zassert_equal(err, 0, "Cannot initialize driver (err %d)", err);
+
+	at_cmd_set_notification_handler(notif_handler);
+	long_rsp_init();
+
+	ztest_test_suite(at_cmd_test,
+			 ztest_unit_test(test_response),
+			 ztest_unit_test(test_error_response),
+			 ztest_unit_test(test_long_response),
+			 ztest_unit_test(test_long_response_small_buffer),
+			 ztest_unit_test(test_stream),
+			 ztest_unit_test(test_stream_long_response),
+			 ztest_unit_test(test_notification_during_command),
+			 ztest_unit_test(test_batch),
+			 ztest_unit_test(test_batch_stop_on_error),
+			 ztest_unit_test(test_batch_continue_on_error),
+			 ztest_unit_test(test_batch_small_buffer),
+			 ztest_unit_test(test_batch_invalid));
+
+	ztest_run_test_suite(at_cmd_test);
+}
@@ -733,6 +733,79 @@ static void test_at_cmd_test_teardown(void)
 	at_params_list_free(&test_list2);
 }
 
+static void test_params_incremental_feeding_setup(void)
+{
+	at_params_list_init(&test_list, TEST_PARAMS2);
+	at_params_list_init(&test_list2, TEST_PARAMS2);
+}
+
+static void test_params_incremental_feeding(void)
+{
+	int ret;
+	struct at_parser parser;
+	char buf[128];
+	char *remainder = NULL;
+	int16_t tmpshort;
+
+	ret = at_parser_init(&parser, &test_list, buf, sizeof(buf));
+	zassert_true(ret == 0, "at_parser_init should return 0");
+
+	ret = at_parser_feed(&parser, "+CEREG: 2,\"76", 13);
+	zassert_true(ret == -EINPROGRESS,
+		     "at_parser_feed should return -EINPROGRESS");
+	zassert_equal(2, at_params_valid_count_get(&test_list),
+		      "Complete parameters should be parsed right away");
+
+	ret = at_parser_feed(&parser, "C1\",\"0102DA04\", 7\r\n", 19);
+	zassert_true(ret == -EINPROGRESS,
+		     "at_parser_feed should return -EINPROGRESS");
+
+	ret = at_parser_finish(&parser, &remainder);
+	zassert_true(ret == 0, "at_parser_finish should return 0");
+	zassert_true(*remainder == '\0', "Remainder should be empty");
+
+	ret = at_parser_params_from_str(singleline, NULL, &test_list2);
+	zassert_true(ret == 0, "at_parser_params_from_str should return 0");
+	zassert_equal(at_params_valid_count_get(&test_list2),
+		      at_params_valid_count_get(&test_list),
+		      "Incremental and complete parsing should match");
+
+	zassert_equal(0, at_params_short_get(&test_list, 4, &tmpshort),
+		      "Get short should not fail");
+	zassert_equal(7, tmpshort, "Short should be 7");
+
+	/* Feeding one character at a time gives the same result */
+	at_parser_init(&parser, &test_list, buf, sizeof(buf));
+
+	for (const char *c = emptyparamline; *c != '\0'; c++) {
+		ret = at_parser_feed(&parser, c, 1);
+		zassert_true(ret == -EINPROGRESS,
+			     "at_parser_feed should return -EINPROGRESS");
+	}
+
+	ret = at_parser_finish(&parser, NULL);
+	zassert_true(ret == 0, "at_parser_finish should return 0");
+	zassert_equal(EMPTYPARAMLINE_PARAM_COUNT,
+		      at_params_valid_count_get(&test_list),
+		      "There should be 6 parameters in the list");
+
+	/* A second notification completes the first one */
+	at_parser_init(&parser, &test_list, buf, sizeof(buf));
+
+	ret = at_parser_feed(&parser, multiline, strlen(multiline));
+	zassert_true(ret == -EAGAIN, "at_parser_feed should return -EAGAIN");
+
+	zassert_equal(-ENOMEM, at_parser_feed(&parser, certificate,
+					      strlen(certificate)),
+		      "Data larger than the buffer should be rejected");
+}
+
+static void test_params_incremental_feeding_teardown(void)
+{
+	at_params_list_free(&test_list);
+	at_params_list_free(&test_list2);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(at_cmd_parser,
@@ -748,6 +821,10 @@ void test_main(void)
 				test_params_empty_params,
 				test_params_empty_params_setup,
 				test_params_empty_params_teardown),
+			 ztest_unit_test_setup_teardown(
+				test_params_incremental_feeding,
+				test_params_incremental_feeding_setup,
+				test_params_incremental_feeding_teardown),
 			 ztest_unit_test_setup_teardown(
 				test_testcases,
 				test_testcases_setup,
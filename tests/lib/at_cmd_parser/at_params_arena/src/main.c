@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2020 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <stdio.h>
+#include <string.h>
+#include <kernel.h>
+
+#include <modem/at_cmd_parser.h>
+#include <modem/at_params.h>
+
+#define TEST_PARAMS		16
+#define TEST_ARRAY_SIZE		(8 * sizeof(uint32_t))
+#define TEST_BENCHMARK_CNT	200
+
+static const char cereg[] = "+CEREG: 2,\"76C1\",\"0102DA04\", 7\r\n";
+static const char xmonitor[] = "%XMONITOR: 1,\"EDAV\",\"EDAV\",\"26295\","
+			       "\"00B7\",7,4,\"00011B07\",7,2300,63,39,\"\","
+			       "\"11100000\",\"11100000\"\r\n";
+static const char array[] = "+TEST: 1,(2,3,4)\r\n";
+
+static AT_PARAMS_ARENA_DEFINE(arena, TEST_PARAMS, TEST_ARRAY_SIZE);
+static struct at_param_list arena_list;
+static struct at_param_list heap_list;
+
+static size_t malloc_cnt;
+
+void *__real_k_malloc(size_t size);
+
+void *__wrap_k_malloc(size_t size)
+{
+	malloc_cnt++;
+	return __real_k_malloc(size);
+}
+
+static void test_arena_init_invalid(void)
+{
+	struct at_param_list list;
+
+	zassert_equal(-EINVAL, at_params_list_init_arena(NULL, TEST_PARAMS,
+							 arena, sizeof(arena)),
+		      "NULL list should be rejected");
+	zassert_equal(-EINVAL, at_params_list_init_arena(&list, TEST_PARAMS,
+							 NULL, sizeof(arena)),
+		      "NULL arena should be rejected");
+	zassert_equal(-EINVAL, at_params_list_init_arena(&list, TEST_PARAMS,
+							 arena + 1,
+							 sizeof(arena) - 1),
+		      "Unaligned arena should be rejected");
+	zassert_equal(-EINVAL, at_params_list_init_arena(&list, TEST_PARAMS,
+							 arena +
+							 AT_PARAMS_ARENA_ALIGN / 2,
+							 sizeof(arena) -
+							 AT_PARAMS_ARENA_ALIGN / 2),
+		      "Arena not aligned to the parameters should be rejected");
+	zassert_equal(-ENOMEM, at_params_list_init_arena(&list, TEST_PARAMS,
+							 arena, sizeof(uint32_t)),
+		      "Too small arena should be rejected");
+}
+
+static void test_arena_setup(void)
+{
+	at_params_list_init_arena(&arena_list, TEST_PARAMS,
+				  arena, sizeof(arena));
+}
+
+static void test_arena_string_slices(void)
+{
+	int ret;
+	const char *str;
+	size_t len;
+	char tmpbuf[16];
+	size_t tmpbuf_len = sizeof(tmpbuf);
+	int16_t tmpshort;
+
+	malloc_cnt = 0;
+
+	ret = at_parser_params_from_str(cereg, NULL, &arena_list);
+	zassert_equal(0, ret, "at_parser_params_from_str should return 0");
+	zassert_equal(0, malloc_cnt, "Arena list should not use the heap");
+	zassert_equal(5, at_params_valid_count_get(&arena_list),
+		      "There should be 5 parameters in the list");
+
+	zassert_equal(0, at_params_string_ptr_get(&arena_list, 2, &str, &len),
+		      "Get string pointer should not fail");
+	zassert_true((str > cereg) && (str < cereg + sizeof(cereg)),
+		     "String should refer to the parsed response");
+	zassert_equal(4, len, "String length should be 4");
+	zassert_equal(0, memcmp("76C1", str, len), "String should be 76C1");
+
+	zassert_equal(0, at_params_string_get(&arena_list, 3,
+					      tmpbuf, &tmpbuf_len),
+		      "Get string should not fail");
+	zassert_equal(8, tmpbuf_len, "String length should be 8");
+	zassert_equal(0, memcmp("0102DA04", tmpbuf, tmpbuf_len),
+		      "String should be copied on request");
+
+	zassert_equal(0, at_params_short_get(&arena_list, 4, &tmpshort),
+		      "Get short should not fail");
+	zassert_equal(7, tmpshort, "Short should be 7");
+}
+
+static void test_arena_array(void)
+{
+	int ret;
+	uint32_t tmparray[4];
+	size_t tmparray_len = sizeof(tmparray);
+
+	malloc_cnt = 0;
+
+	ret = at_parser_params_from_str(array, NULL, &arena_list);
+	zassert_equal(0, ret, "at_parser_params_from_str should return 0");
+	zassert_equal(0, malloc_cnt, "Arena list should not use the heap");
+	zassert_equal(AT_PARAM_TYPE_ARRAY, at_params_type_get(&arena_list, 2),
+		      "Param type at index 2 should be an array");
+
+	zassert_equal(0, at_params_array_get(&arena_list, 2,
+					     tmparray, &tmparray_len),
+		      "Get array should not fail");
+	zassert_equal(3 * sizeof(uint32_t), tmparray_len,
+		      "Array should have 3 elements");
+	zassert_equal(4, tmparray[2], "Last element should be 4");
+
+	/* The arena is reclaimed when the list is cleared */
+	for (size_t i = 0; i < 10; i++) {
+		ret = at_parser_params_from_str(array, NULL, &arena_list);
+		zassert_equal(0, ret, "Arena should be reclaimed on clear");
+	}
+
+	/* Fill the arena without clearing the list */
+	at_params_array_put(&arena_list, 0, tmparray, TEST_ARRAY_SIZE / 2);
+	zassert_equal(-ENOMEM, at_params_array_put(&arena_list, 1, tmparray,
+						   TEST_ARRAY_SIZE / 2),
+		      "Array should not fit in the exhausted arena");
+}
+
+static void test_arena_teardown(void)
+{
+	at_params_list_free(&arena_list);
+}
+
+static void test_arena_benchmark_setup(void)
+{
+	at_params_list_init(&heap_list, TEST_PARAMS);
+	at_params_list_init_arena(&arena_list, TEST_PARAMS,
+				  arena, sizeof(arena));
+}
+
+static void benchmark(struct at_param_list *list, const char *name,
+		      size_t *allocs)
+{
+	uint32_t start;
+	uint32_t cycles;
+
+	malloc_cnt = 0;
+	start = k_cycle_get_32();
+
+	for (size_t i = 0; i < TEST_BENCHMARK_CNT; i++) {
+		at_parser_params_from_str(cereg, NULL, list);
+		at_parser_params_from_str(xmonitor, NULL, list);
+	}
+
+	cycles = k_cycle_get_32() - start;
+	*allocs = malloc_cnt;
+
+	TC_PRINT("%s list: %u allocations, %u cycles per parse\n", name,
+		 *allocs / (2 * TEST_BENCHMARK_CNT),
+		 cycles / (2 * TEST_BENCHMARK_CNT));
+}
+
+static void test_arena_benchmark(void)
+{
+	size_t heap_allocs;
+	size_t arena_allocs;
+
+	benchmark(&heap_list, "Heap", &heap_allocs);
+	benchmark(&arena_list, "Arena", &arena_allocs);
+
+	zassert_true(heap_allocs > 0, "Heap list should use the heap");
+	zassert_equal(0, arena_allocs, "Arena list should not use the heap");
+}
+
+static void test_arena_benchmark_teardown(void)
+{
+	at_params_list_free(&arena_list);
+	at_params_list_free(&heap_list);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(at_params_arena,
+			 ztest_unit_test(test_arena_init_invalid),
+			 ztest_unit_test_setup_teardown(
+				test_arena_string_slices,
+				test_arena_setup,
+				test_arena_teardown),
+			 ztest_unit_test_setup_teardown(
+				test_arena_array,
+				test_arena_setup,
+				test_arena_teardown),
+			 ztest_unit_test_setup_teardown(
+				test_arena_benchmark,
+				test_arena_benchmark_setup,
+				test_arena_benchmark_teardown)
+			 );
+
+	ztest_run_test_suite(at_params_arena);
+}
@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr.h>
+#include <modem/at_cmd.h>
+
+#include "at_cmd_mock.h"
+
+static at_cmd_handler_t notification_handler;
+
+void at_cmd_set_notification_handler(at_cmd_handler_t handler)
+{
+	notification_handler = handler;
+}
+
+void at_cmd_mock_notif_send(const char *notif)
+{
+	__ASSERT_NO_MSG(notification_handler != NULL);
+	notification_handler(notif);
+}
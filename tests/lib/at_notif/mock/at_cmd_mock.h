@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef AT_CMD_MOCK_H_
+#define AT_CMD_MOCK_H_
+
+#include <zephyr.h>
+
+/**
+ * @file
+ * @brief Mock of the AT command interface.
+ *
+ * The mock passes notifications to the handler set with
+ * `at_cmd_set_notification_handler`.
+ */
+
+/** @brief Pass a notification to the notification handler.
+ *
+ * @param notif Null terminated notification.
+ */
+void at_cmd_mock_notif_send(const char *notif);
+
+#endif /* AT_CMD_MOCK_H_ */
@@ -0,0 +1,208 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <modem/at_notif.h>
+
+#include "at_cmd_mock.h"
+
+#define TEST_STACK_SIZE		1024
+#define TEST_THREAD_PRIO	K_PRIO_PREEMPT(5)
+#define TEST_TIMEOUT		K_SECONDS(2)
+
+/* Time given to the writer thread to start replacing the index */
+#define TEST_WRITER_DELAY	K_MSEC(20)
+
+static K_THREAD_STACK_DEFINE(dispatch_stack, TEST_STACK_SIZE);
+static K_THREAD_STACK_DEFINE(writer_stack, TEST_STACK_SIZE);
+static struct k_thread dispatch_thread;
+static struct k_thread writer_thread;
+
+static K_SEM_DEFINE(handler_entered, 0, 1);
+static K_SEM_DEFINE(writer_started, 0, 1);
+static K_SEM_DEFINE(dispatch_done, 0, 1);
+static K_SEM_DEFINE(writer_done, 0, 1);
+
+static uint32_t any_cnt;
+static uint32_t cereg_cnt;
+static uint32_t cscon_cnt;
+static uint32_t cgev_cnt;
+static uint32_t reentrant_cnt;
+static int reentrant_err;
+static int writer_err;
+
+static void any_handler(void *context, const char *response)
+{
+	any_cnt++;
+}
+
+static void cereg_handler(void *context, const char *response)
+{
+	zassert_equal(strncmp(response, "+CEREG", strlen("+CEREG")), 0,
+		      "Wrong notification");
+	cereg_cnt++;
+}
+
+static void cscon_handler(void *context, const char *response)
+{
+	cscon_cnt++;
+}
+
+static void cgev_handler(void *context, const char *response)
+{
+	cgev_cnt++;
+}
+
+/* Changes registrations while another thread registers a handler */
+static void reentrant_handler(void *context, const char *response)
+{
+	reentrant_cnt++;
+
+	k_sem_give(&handler_entered);
+	k_sem_take(&writer_started, TEST_TIMEOUT);
+	k_sleep(TEST_WRITER_DELAY);
+
+	reentrant_err = at_notif_register_prefix_handler(NULL, "+CSCON",
+							 cscon_handler);
+	if (reentrant_err == 0) {
+		reentrant_err = at_notif_deregister_handler(NULL,
+							    reentrant_handler);
+	}
+}
+
+static void dispatch_fn(void *arg1, void *arg2, void *arg3)
+{
+	at_cmd_mock_notif_send("+CEREG: 1,\"0140\",\"0199F10A\",7");
+	k_sem_give(&dispatch_done);
+}
+
+static void writer_fn(void *arg1, void *arg2, void *arg3)
+{
+	k_sem_give(&writer_started);
+	writer_err = at_notif_register_prefix_handler(NULL, "+CGEV",
+						      cgev_handler);
+	k_sem_give(&writer_done);
+}
+
+static void test_reset(void)
+{
+	at_notif_deregister_handler(NULL, any_handler);
+	at_notif_deregister_handler(NULL, cereg_handler);
+	at_notif_deregister_handler(NULL, cscon_handler);
+	at_notif_deregister_handler(NULL, cgev_handler);
+	at_notif_deregister_handler(NULL, reentrant_handler);
+
+	any_cnt = 0;
+	cereg_cnt = 0;
+	cscon_cnt = 0;
+	cgev_cnt = 0;
+	reentrant_cnt = 0;
+}
+
+static void test_prefix_dispatch(void)
+{
+	uint32_t hits;
+	int err;
+
+	test_reset();
+
+	err = at_notif_register_handler(NULL, any_handler);
+	zassert_equal(err, 0, "Cannot register handler (err %d)", err);
+	err = at_notif_register_prefix_handler(NULL, "+CEREG", cereg_handler);
+	zassert_equal(err, 0, "Cannot register handler (err %d)", err);
+	err = at_notif_register_prefix_handler(NULL, "+CSCON", cscon_handler);
+	zassert_equal(err, 0, "Cannot register handler (err %d)", err);
+
+	at_cmd_mock_notif_send("+CEREG: 1,\"0140\",\"0199F10A\",7");
+	at_cmd_mock_notif_send("+CEREGX: 1");
+	at_cmd_mock_notif_send("%CESQ: 54,2,16,2");
+
+	zassert_equal(any_cnt, 3, "Wrong number of notifications");
+	zassert_equal(cereg_cnt, 1, "Wrong number of notifications");
+	zassert_equal(cscon_cnt, 0, "Wrong number of notifications");
+
+	err = at_notif_prefix_hits_get("+CEREG", &hits);
+	zassert_equal(err, 0, "Cannot get hits (err %d)", err);
+	zassert_equal(hits, 1, "Wrong number of hits");
+
+	err = at_notif_prefix_hits_get("+CGEV", &hits);
+	zassert_equal(err, -ENXIO, "Wrong error (err %d)", err);
+
+	err = at_notif_deregister_handler(NULL, cereg_handler);
+	zassert_equal(err, 0, "Cannot deregister handler (err %d)", err);
+
+	at_cmd_mock_notif_send("+CEREG: 1,\"0140\",\"0199F10A\",7");
+	zassert_equal(cereg_cnt, 1, "Deregistered handler called");
+	zassert_equal(any_cnt, 4, "Wrong number of notifications");
+}
+
+static void test_register_during_dispatch(void)
+{
+	int err;
+
+	test_reset();
+	k_sem_reset(&handler_entered);
+	k_sem_reset(&writer_started);
+	k_sem_reset(&dispatch_done);
+	k_sem_reset(&writer_done);
+	reentrant_err = -EINPROGRESS;
+	writer_err = -EINPROGRESS;
+
+	err = at_notif_register_prefix_handler(NULL, "+CEREG",
+					       reentrant_handler);
+	zassert_equal(err, 0, "Cannot register handler (err %d)", err);
+
+	k_thread_create(&dispatch_thread, dispatch_stack,
+			K_THREAD_STACK_SIZEOF(dispatch_stack), dispatch_fn,
+			NULL, NULL, NULL, TEST_THREAD_PRIO, 0, K_NO_WAIT);
+
+	/* Register a handler from another thread while the dispatch is in
+	 * progress. The handler registers and deregisters handlers at the
+	 * same time.
+	 */
+	err = k_sem_take(&handler_entered, TEST_TIMEOUT);
+	zassert_equal(err, 0, "Handler not called");
+
+	k_thread_create(&writer_thread, writer_stack,
+			K_THREAD_STACK_SIZEOF(writer_stack), writer_fn,
+			NULL, NULL, NULL, TEST_THREAD_PRIO, 0, K_NO_WAIT);
+
+	err = k_sem_take(&dispatch_done, TEST_TIMEOUT);
+	zassert_equal(err, 0, "Dispatch deadlocked");
+	err = k_sem_take(&writer_done, TEST_TIMEOUT);
+	zassert_equal(err, 0, "Registration deadlocked");
+
+	zassert_equal(reentrant_err, 0,
+		      "Registration from handler failed (err %d)",
+		      reentrant_err);
+	zassert_equal(writer_err, 0, "Registration failed (err %d)",
+		      writer_err);
+
+	/* All the changes of registrations are in effect */
+	at_cmd_mock_notif_send("+CEREG: 1,\"0140\",\"0199F10A\",7");
+	at_cmd_mock_notif_send("+CSCON: 1");
+	at_cmd_mock_notif_send("+CGEV: ME PDN ACT 0");
+
+	zassert_equal(reentrant_cnt, 1, "Deregistered handler called");
+	zassert_equal(cscon_cnt, 1, "Handler registered from handler "
+		      "not called");
+	zassert_equal(cgev_cnt, 1, "Handler registered during dispatch "
+		      "not called");
+}
+
+void test_main(void)
+{
+	int err = at_notif_init();
+
+	zassert_equal(err, 0, "Cannot initialize library (err %d)", err);
+
+	ztest_test_suite(at_notif_test,
+			 ztest_unit_test(test_prefix_dispatch),
+			 ztest_unit_test(test_register_during_dispatch));
+
+	ztest_run_test_suite(at_notif_test);
+}
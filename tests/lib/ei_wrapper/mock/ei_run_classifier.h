@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef EI_RUN_CLASSIFIER_MOCK_H_
+#define EI_RUN_CLASSIFIER_MOCK_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+
+/**
+ * @file
+ * @brief Mock of the Edge Impulse classifier API used by the wrapper.
+ *
+ * The mock classifier reads the input window in frame sized slices, like
+ * the DSP blocks of the library do, and stores it for the test. Continuous
+ * classification keeps the features of the previous slices, so that they
+ * always hold the whole input window.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME	3
+#define EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE	\
+	(50 * EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME)
+#define EI_CLASSIFIER_HAS_ANOMALY		0
+#define EI_CLASSIFIER_LABEL_COUNT		1
+
+typedef int EI_IMPULSE_ERROR;
+
+#define EI_IMPULSE_OK				0
+
+typedef struct {
+	int (*get_data)(size_t offset, size_t length, float *out_ptr);
+	size_t total_length;
+} signal_t;
+
+typedef struct {
+	const char *label;
+	float value;
+} ei_impulse_result_classification_t;
+
+typedef struct {
+	int dsp;
+	int classification;
+	int anomaly;
+} ei_impulse_result_timing_t;
+
+typedef struct {
+	ei_impulse_result_classification_t
+		classification[EI_CLASSIFIER_LABEL_COUNT];
+	float anomaly;
+	ei_impulse_result_timing_t timing;
+} ei_impulse_result_t;
+
+EI_IMPULSE_ERROR run_classifier(signal_t *signal, ei_impulse_result_t *result,
+				bool debug);
+
+EI_IMPULSE_ERROR run_classifier_continuous(signal_t *signal,
+					   ei_impulse_result_t *result,
+					   bool debug, bool enable_maf);
+
+void run_classifier_init(void);
+
+/** @brief Set the timing reported by the following classifier runs.
+ *
+ * @param[in] timing Timing to report.
+ */
+void ei_run_classifier_mock_timing_set(
+	const ei_impulse_result_timing_t *timing);
+
+/** @brief Get the number of input values read by all classifier runs.
+ *
+ * @return Number of values.
+ */
+size_t ei_run_classifier_mock_read_cnt(void);
+
+/** @brief Get the input window read by the last classifier run.
+ *
+ * @return Pointer to EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE values.
+ */
+const float *ei_run_classifier_mock_features(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* EI_RUN_CLASSIFIER_MOCK_H_ */
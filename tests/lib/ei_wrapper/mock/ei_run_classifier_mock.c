@@ -0,0 +1,96 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <ei_run_classifier.h>
+
+static float features[EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE];
+static ei_impulse_result_timing_t mock_timing;
+static size_t read_cnt;
+
+static EI_IMPULSE_ERROR features_read(signal_t *signal, float *out)
+{
+	for (size_t offset = 0; offset < signal->total_length;
+	     offset += EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME) {
+		int err = signal->get_data(offset,
+					   EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME,
+					   &out[offset]);
+
+		if (err) {
+			return err;
+		}
+	}
+
+	read_cnt += signal->total_length;
+
+	return EI_IMPULSE_OK;
+}
+
+static void result_set(ei_impulse_result_t *result)
+{
+	float sum = 0.0f;
+
+	for (size_t i = 0; i < ARRAY_SIZE(features); i++) {
+		sum += features[i];
+	}
+
+	result->classification[0].label = "mock";
+	result->classification[0].value = sum;
+	result->anomaly = 0.0f;
+	result->timing = mock_timing;
+}
+
+EI_IMPULSE_ERROR run_classifier(signal_t *signal, ei_impulse_result_t *result,
+				bool debug)
+{
+	EI_IMPULSE_ERROR err = features_read(signal, features);
+
+	if (!err) {
+		result_set(result);
+	}
+
+	return err;
+}
+
+EI_IMPULSE_ERROR run_classifier_continuous(signal_t *signal,
+					   ei_impulse_result_t *result,
+					   bool debug, bool enable_maf)
+{
+	size_t slice_size = signal->total_length;
+	size_t keep_size = ARRAY_SIZE(features) - slice_size;
+
+	memmove(features, &features[slice_size],
+		keep_size * sizeof(features[0]));
+
+	EI_IMPULSE_ERROR err = features_read(signal, &features[keep_size]);
+
+	if (!err) {
+		result_set(result);
+	}
+
+	return err;
+}
+
+void run_classifier_init(void)
+{
+	memset(features, 0, sizeof(features));
+}
+
+void ei_run_classifier_mock_timing_set(const ei_impulse_result_timing_t *timing)
+{
+	mock_timing = *timing;
+}
+
+size_t ei_run_classifier_mock_read_cnt(void)
+{
+	return read_cnt;
+}
+
+const float *ei_run_classifier_mock_features(void)
+{
+	return features;
+}
@@ -0,0 +1,426 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <kernel.h>
+#include <ei_wrapper.h>
+#include <ei_run_classifier.h>
+
+#define DATA_INT16		IS_ENABLED(CONFIG_EI_WRAPPER_DATA_INT16)
+
+#define TEST_PREDICTION_CNT	100
+#define TEST_BENCHMARK_CNT	100
+#define TEST_FRAME_SHIFT_MAX	17
+#define TEST_RESULT_TIMEOUT	K_SECONDS(1)
+#define TEST_STATS_CNT		12
+#define TEST_STATS_WINDOW	CONFIG_EI_WRAPPER_STATS_WINDOW
+
+/* Windows skipped while the callback of continuous prediction is blocked. */
+#define TEST_DROPPED_CNT	3
+
+/* Scale of the 16-bit input data. Exact in binary, so the converted values
+ * can be compared for equality.
+ */
+#define TEST_DATA_SCALE		0.25f
+
+#define TEST_WINDOW_SIZE	EI_CLASSIFIER_DSP_INPUT_FRAME_SIZE
+#define TEST_FRAME_SIZE		EI_CLASSIFIER_RAW_SAMPLES_PER_FRAME
+
+/* Continuous prediction shift, equal to the slice size of DSP reuse. */
+#define TEST_SHIFT_FRAMES	10
+#define TEST_SHIFT_SIZE		(TEST_SHIFT_FRAMES * TEST_FRAME_SIZE)
+
+#ifdef CONFIG_EI_WRAPPER_CONTINUOUS_DSP
+BUILD_ASSERT(TEST_SHIFT_SIZE * CONFIG_EI_WRAPPER_SLICES_PER_WINDOW ==
+	     TEST_WINDOW_SIZE);
+#define TEST_SHIFT_READ_CNT	TEST_SHIFT_SIZE
+#else
+#define TEST_SHIFT_READ_CNT	TEST_WINDOW_SIZE
+#endif
+
+static K_SEM_DEFINE(result_sem, 0, 1);
+static K_SEM_DEFINE(cb_gate_sem, 0, 1);
+static int result_err;
+
+/* If set, the callback waits for cb_gate_sem before it returns. */
+static bool cb_gate;
+
+/* Number of input values added since the data was cleared. */
+static size_t added_cnt;
+
+static void result_ready_cb(int err)
+{
+	bool gate = cb_gate;
+
+	result_err = err;
+	k_sem_give(&result_sem);
+
+	if (gate) {
+		k_sem_take(&cb_gate_sem, K_FOREVER);
+	}
+}
+
+static int16_t sample_value(size_t idx)
+{
+	return (int16_t)((idx * 37) % 20000) - 10000;
+}
+
+static float sample_expected(size_t idx)
+{
+	float value = sample_value(idx);
+
+	return DATA_INT16 ? (value * TEST_DATA_SCALE) : value;
+}
+
+static int data_add(size_t cnt)
+{
+	int err;
+
+	if (DATA_INT16) {
+		int16_t data[TEST_WINDOW_SIZE];
+
+		for (size_t i = 0; i < cnt; i++) {
+			data[i] = sample_value(added_cnt + i);
+		}
+
+		err = ei_wrapper_add_data_int16(data, cnt);
+	} else {
+		float data[TEST_WINDOW_SIZE];
+
+		for (size_t i = 0; i < cnt; i++) {
+			data[i] = sample_value(added_cnt + i);
+		}
+
+		err = ei_wrapper_add_data(data, cnt);
+	}
+
+	if (!err) {
+		added_cnt += cnt;
+	}
+
+	return err;
+}
+
+static void data_clear(void)
+{
+	int err = ei_wrapper_clear_data();
+
+	zassert_equal(err, 0, "Cannot clear data (err %d)", err);
+	added_cnt = 0;
+
+	if (DATA_INT16) {
+		err = ei_wrapper_set_data_scale(TEST_DATA_SCALE);
+		zassert_equal(err, 0, "Cannot set scale (err %d)", err);
+	}
+}
+
+static void result_wait(void)
+{
+	int err = k_sem_take(&result_sem, TEST_RESULT_TIMEOUT);
+
+	zassert_equal(err, 0, "No prediction result");
+	zassert_equal(result_err, 0, "Prediction failed (err %d)", result_err);
+}
+
+static void features_check(size_t window_start)
+{
+	const float *features = ei_run_classifier_mock_features();
+
+	for (size_t i = 0; i < TEST_WINDOW_SIZE; i++) {
+		zassert_equal(features[i], sample_expected(window_start + i),
+			      "Invalid feature %u of window at %u",
+			      (uint32_t)i, (uint32_t)window_start);
+	}
+}
+
+static void test_data_type(void)
+{
+	float float_data[TEST_FRAME_SIZE] = { 0 };
+	int16_t int_data[TEST_FRAME_SIZE] = { 0 };
+	int err;
+
+	data_clear();
+
+	err = ei_wrapper_add_data(float_data, ARRAY_SIZE(float_data));
+	zassert_equal(err, DATA_INT16 ? -ENOTSUP : 0, "Invalid float input");
+
+	err = ei_wrapper_add_data_int16(int_data, ARRAY_SIZE(int_data));
+	zassert_equal(err, DATA_INT16 ? 0 : -ENOTSUP, "Invalid int16 input");
+
+	err = ei_wrapper_set_data_scale(TEST_DATA_SCALE);
+	zassert_equal(err, DATA_INT16 ? 0 : -ENOTSUP, "Invalid scale");
+
+	err = data_add(TEST_FRAME_SIZE + 1);
+	zassert_equal(err, -EINVAL, "Partial frame accepted");
+}
+
+static void test_prediction_windows(void)
+{
+	size_t window_start = 0;
+	int err;
+
+	data_clear();
+
+	err = data_add(TEST_WINDOW_SIZE);
+	zassert_equal(err, 0, "Cannot add data (err %d)", err);
+
+	err = ei_wrapper_start_prediction(0, 0);
+	zassert_equal(err, 0, "Cannot start prediction (err %d)", err);
+
+	result_wait();
+	features_check(window_start);
+
+	/* Shift the window by different numbers of frames, so that it is
+	 * split at every possible position by the end of the buffer.
+	 */
+	for (size_t i = 0; i < TEST_PREDICTION_CNT; i++) {
+		size_t frame_shift = 1 + (i % TEST_FRAME_SHIFT_MAX);
+
+		window_start += frame_shift * TEST_FRAME_SIZE;
+
+		err = ei_wrapper_start_prediction(0, frame_shift);
+		zassert_equal(err, 0, "Cannot start prediction (err %d)", err);
+
+		while (added_cnt < window_start + TEST_WINDOW_SIZE) {
+			err = data_add(TEST_FRAME_SIZE);
+			zassert_equal(err, 0, "Cannot add data (err %d)", err);
+		}
+
+		result_wait();
+		features_check(window_start);
+	}
+}
+
+static void test_continuous(void)
+{
+	size_t window_start = 0;
+	size_t read_cnt;
+	struct ei_wrapper_stats stats;
+	int err;
+
+	data_clear();
+	ei_wrapper_reset_stats();
+
+	err = ei_wrapper_start_continuous(0);
+	zassert_equal(err, -EINVAL, "Zero shift accepted");
+
+	err = ei_wrapper_start_continuous(TEST_WINDOW_SIZE / TEST_FRAME_SIZE +
+					  1);
+	zassert_equal(err, -EINVAL, "Shift bigger than window accepted");
+
+	if (IS_ENABLED(CONFIG_EI_WRAPPER_CONTINUOUS_DSP)) {
+		err = ei_wrapper_start_continuous(TEST_SHIFT_FRAMES + 1);
+		zassert_equal(err, -EINVAL, "Shift other than slice accepted");
+	}
+
+	err = data_add(TEST_WINDOW_SIZE);
+	zassert_equal(err, 0, "Cannot add data (err %d)", err);
+
+	read_cnt = ei_run_classifier_mock_read_cnt();
+
+	err = ei_wrapper_start_continuous(TEST_SHIFT_FRAMES);
+	zassert_equal(err, 0, "Cannot start continuous prediction (err %d)",
+		      err);
+
+	err = ei_wrapper_start_continuous(TEST_SHIFT_FRAMES);
+	zassert_equal(err, -EALREADY, "Continuous prediction started twice");
+
+	err = ei_wrapper_start_prediction(0, 0);
+	zassert_equal(err, -EBUSY, "Single prediction started");
+
+	for (size_t i = 0; i < TEST_PREDICTION_CNT; i++) {
+		result_wait();
+		features_check(window_start);
+
+		/* The first window is always read as a whole. */
+		size_t read = ei_run_classifier_mock_read_cnt() - read_cnt;
+
+		zassert_equal(read, (i == 0) ?
+			      TEST_WINDOW_SIZE : TEST_SHIFT_READ_CNT,
+			      "Invalid number of values read (%u)",
+			      (uint32_t)read);
+		read_cnt += read;
+
+		if (i < (TEST_PREDICTION_CNT - 1)) {
+			window_start += TEST_SHIFT_SIZE;
+
+			err = data_add(TEST_SHIFT_SIZE);
+			zassert_equal(err, 0, "Cannot add data (err %d)", err);
+		}
+	}
+
+	/* The window waiting for data is cancelled. */
+	err = ei_wrapper_stop_continuous();
+	zassert_equal(err, 0, "Cannot stop continuous prediction (err %d)",
+		      err);
+
+	err = ei_wrapper_stop_continuous();
+	zassert_equal(err, -EALREADY, "Continuous prediction stopped twice");
+
+	err = ei_wrapper_get_stats(&stats);
+	zassert_equal(err, 0, "Cannot get stats (err %d)", err);
+	zassert_equal(stats.prediction_cnt, TEST_PREDICTION_CNT,
+		      "Invalid prediction count");
+	zassert_equal(stats.dropped_cnt, 0, "Invalid dropped count");
+}
+
+static void test_continuous_dropped(void)
+{
+	size_t window_start = (TEST_DROPPED_CNT + 1) * TEST_SHIFT_SIZE;
+	size_t read_cnt;
+	struct ei_wrapper_stats stats;
+	int err;
+
+	data_clear();
+	ei_wrapper_reset_stats();
+
+	err = data_add(TEST_WINDOW_SIZE);
+	zassert_equal(err, 0, "Cannot add data (err %d)", err);
+
+	/* Block the first callback, so that the prediction falls behind. */
+	cb_gate = true;
+
+	err = ei_wrapper_start_continuous(TEST_SHIFT_FRAMES);
+	zassert_equal(err, 0, "Cannot start continuous prediction (err %d)",
+		      err);
+
+	result_wait();
+	features_check(0);
+	cb_gate = false;
+
+	err = data_add(window_start);
+	zassert_equal(err, 0, "Cannot add data (err %d)", err);
+
+	read_cnt = ei_run_classifier_mock_read_cnt();
+	k_sem_give(&cb_gate_sem);
+
+	/* The prediction skips to the newest window, which cannot reuse
+	 * results of the previous one.
+	 */
+	result_wait();
+	features_check(window_start);
+	zassert_equal(ei_run_classifier_mock_read_cnt() - read_cnt,
+		      TEST_WINDOW_SIZE, "Dropped windows not restarted");
+
+	err = ei_wrapper_stop_continuous();
+	zassert_equal(err, 0, "Cannot stop continuous prediction (err %d)",
+		      err);
+
+	err = ei_wrapper_get_stats(&stats);
+	zassert_equal(err, 0, "Cannot get stats (err %d)", err);
+	zassert_equal(stats.prediction_cnt, 2, "Invalid prediction count");
+	zassert_equal(stats.dropped_cnt, TEST_DROPPED_CNT,
+		      "Invalid dropped count");
+}
+
+static void test_stats(void)
+{
+	struct ei_wrapper_stats stats;
+	int err;
+
+	data_clear();
+	ei_wrapper_reset_stats();
+
+	err = ei_wrapper_get_stats(&stats);
+	zassert_equal(err, 0, "Cannot get stats (err %d)", err);
+	zassert_equal(stats.prediction_cnt, 0, "Stats not reset");
+	zassert_equal(stats.dsp.max, 0, "Stats not reset");
+
+	err = data_add(TEST_WINDOW_SIZE);
+	zassert_equal(err, 0, "Cannot add data (err %d)", err);
+
+	for (int i = 0; i < TEST_STATS_CNT; i++) {
+		ei_impulse_result_timing_t timing = {
+			.dsp = i,
+			.classification = 2 * i,
+			.anomaly = 0,
+		};
+
+		ei_run_classifier_mock_timing_set(&timing);
+
+		err = ei_wrapper_start_prediction(0, 0);
+		zassert_equal(err, 0, "Cannot start prediction (err %d)", err);
+
+		result_wait();
+	}
+
+	err = ei_wrapper_get_stats(&stats);
+	zassert_equal(err, 0, "Cannot get stats (err %d)", err);
+
+	int last = TEST_STATS_CNT - 1;
+	int first = TEST_STATS_CNT - TEST_STATS_WINDOW;
+	int avg = (first + last) / 2;
+
+	zassert_equal(stats.prediction_cnt, TEST_STATS_CNT,
+		      "Invalid prediction count");
+	zassert_equal(stats.dsp.last, last, "Invalid last DSP time");
+	zassert_equal(stats.dsp.max, last, "Invalid max DSP time");
+	zassert_equal(stats.dsp.avg, avg, "Invalid average DSP time");
+	zassert_equal(stats.classification.last, 2 * last,
+		      "Invalid last classification time");
+	zassert_equal(stats.classification.max, 2 * last,
+		      "Invalid max classification time");
+	zassert_equal(stats.classification.avg, first + last,
+		      "Invalid average classification time");
+	zassert_equal(stats.anomaly.max, -1, "Invalid anomaly time");
+}
+
+static void test_benchmark(void)
+{
+	uint32_t add_cycles = 0;
+	uint32_t predict_cycles = 0;
+	int err;
+
+	data_clear();
+
+	err = data_add(TEST_WINDOW_SIZE);
+	zassert_equal(err, 0, "Cannot add data (err %d)", err);
+
+	for (size_t i = 0; i < TEST_BENCHMARK_CNT; i++) {
+		uint32_t start;
+
+		/* Delay the prediction until the next window is added. */
+		err = ei_wrapper_start_prediction(1, 0);
+		zassert_equal(err, 0, "Cannot start prediction (err %d)", err);
+
+		start = k_cycle_get_32();
+		err = data_add(TEST_WINDOW_SIZE);
+		add_cycles += k_cycle_get_32() - start;
+		zassert_equal(err, 0, "Cannot add data (err %d)", err);
+
+		start = k_cycle_get_32();
+		result_wait();
+		predict_cycles += k_cycle_get_32() - start;
+	}
+
+	TC_PRINT("%s input, window of %u values\n",
+		 DATA_INT16 ? "int16" : "float", TEST_WINDOW_SIZE);
+	TC_PRINT("ei_wrapper_add_data: %u cycles per window\n",
+		 add_cycles / TEST_BENCHMARK_CNT);
+	TC_PRINT("Prediction: %u cycles per window\n",
+		 predict_cycles / TEST_BENCHMARK_CNT);
+}
+
+void test_main(void)
+{
+	int err = ei_wrapper_init(result_ready_cb);
+
+	zassert_equal(err, 0, "Cannot initialize wrapper (err %d)", err);
+	zassert_equal(ei_wrapper_get_window_size(), TEST_WINDOW_SIZE,
+		      "Invalid window size");
+	zassert_equal(ei_wrapper_get_frame_size(), TEST_FRAME_SIZE,
+		      "Invalid frame size");
+
+	ztest_test_suite(ei_wrapper_test,
+			 ztest_unit_test(test_data_type),
+			 ztest_unit_test(test_prediction_windows),
+			 ztest_unit_test(test_continuous),
+			 ztest_unit_test(test_continuous_dropped),
+			 ztest_unit_test(test_stats),
+			 ztest_unit_test(test_benchmark));
+
+	ztest_run_test_suite(ei_wrapper_test);
+}
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <stdlib.h>
+#include <json_writer.h>
+#include <cJSON.h>
+
+#define TEST_ENTRY_CNT		20
+#define TEST_BENCHMARK_CNT	50
+
+static size_t heap_used;
+static size_t heap_peak;
+static size_t heap_total;
+
+/* cJSON allocation hooks that track the heap usage. The size of each block
+ * is stored in front of it.
+ */
+static void *counting_malloc(size_t size)
+{
+	size_t *block = k_malloc(sizeof(size_t) + size);
+
+	if (block == NULL) {
+		return NULL;
+	}
+
+	block[0] = size;
+	heap_used += size;
+	heap_total += size;
+	heap_peak = MAX(heap_peak, heap_used);
+
+	return &block[1];
+}
+
+static void counting_free(void *ptr)
+{
+	size_t *block = ptr;
+
+	if (block == NULL) {
+		return;
+	}
+
+	heap_used -= block[-1];
+	k_free(&block[-1]);
+}
+
+static void heap_stats_reset(void)
+{
+	heap_used = 0;
+	heap_peak = 0;
+	heap_total = 0;
+}
+
+static void writer_check(struct json_writer *writer, const char *expected)
+{
+	zassert_equal(0, json_writer_finish(writer), "Output should fit");
+	zassert_equal(strlen(expected), json_writer_len(writer),
+		      "Invalid length");
+	zassert_equal(0, strcmp(expected, writer->buf), "Got %s, expected %s",
+		      writer->buf, expected);
+}
+
+static void test_containers(void)
+{
+	char buf[64];
+	struct json_writer writer;
+
+	json_writer_init(&writer, buf, sizeof(buf));
+	json_writer_obj_start(&writer);
+	json_writer_key_int(&writer, "a", 1);
+	json_writer_key(&writer, "b");
+	json_writer_arr_start(&writer);
+	json_writer_int(&writer, -2);
+	json_writer_obj_start(&writer);
+	json_writer_obj_end(&writer);
+	json_writer_arr_start(&writer);
+	json_writer_arr_end(&writer);
+	json_writer_bool(&writer, true);
+	json_writer_bool(&writer, false);
+	json_writer_null(&writer);
+	json_writer_arr_end(&writer);
+	json_writer_key_str(&writer, "c", "d");
+	json_writer_obj_end(&writer);
+
+	writer_check(&writer, "{\"a\":1,\"b\":[-2,{},[],true,false,null],"
+			      "\"c\":\"d\"}");
+}
+
+static void test_string_escape(void)
+{
+	char buf[64];
+	struct json_writer writer;
+
+	json_writer_init(&writer, buf, sizeof(buf));
+	json_writer_str(&writer, "q\"b\\n\nt\tc\x01");
+
+	writer_check(&writer, "\"q\\\"b\\\\n\\nt\\tc\\u0001\"");
+
+	json_writer_init(&writer, buf, sizeof(buf));
+	json_writer_str(&writer, NULL);
+
+	writer_check(&writer, "\"\"");
+}
+
+static void test_int_limits(void)
+{
+	char buf[64];
+	struct json_writer writer;
+
+	json_writer_init(&writer, buf, sizeof(buf));
+	json_writer_arr_start(&writer);
+	json_writer_int(&writer, 0);
+	json_writer_int(&writer, INT64_MAX);
+	json_writer_int(&writer, INT64_MIN);
+	json_writer_arr_end(&writer);
+
+	writer_check(&writer, "[0,9223372036854775807,-9223372036854775808]");
+}
+
+static void test_number_matches_cjson(void)
+{
+	static const double values[] = {
+		0.0, -0.5, 1.0, 22.5, 0.1, 1.0 / 3.0, 63.4214729, -9.81,
+		1600000000000.0, 1e300, -1e-300, 4.2f,
+	};
+	char buf[32];
+	struct json_writer writer;
+
+	for (size_t i = 0; i < ARRAY_SIZE(values); i++) {
+		cJSON *number = cJSON_CreateNumber(values[i]);
+		char *expected = cJSON_PrintUnformatted(number);
+
+		zassert_not_null(expected, "cJSON failed");
+
+		json_writer_init(&writer, buf, sizeof(buf));
+		json_writer_number(&writer, values[i]);
+		writer_check(&writer, expected);
+
+		counting_free(expected);
+		cJSON_Delete(number);
+	}
+}
+
+static void test_length_only(void)
+{
+	char buf[8];
+	struct json_writer writer;
+
+	json_writer_init(&writer, NULL, 0);
+	json_writer_obj_start(&writer);
+	json_writer_key_str(&writer, "key", "value");
+	json_writer_obj_end(&writer);
+
+	zassert_equal(strlen("{\"key\":\"value\"}"), json_writer_len(&writer),
+		      "Invalid length");
+	zassert_equal(-ENOMEM, json_writer_finish(&writer),
+		      "No buffer was provided");
+
+	/* The output is truncated, the length is still reported. */
+	memset(buf, 0xAA, sizeof(buf));
+	json_writer_init(&writer, buf, sizeof(buf) - 1);
+	json_writer_obj_start(&writer);
+	json_writer_key_str(&writer, "key", "value");
+	json_writer_obj_end(&writer);
+
+	zassert_equal(strlen("{\"key\":\"value\"}"), json_writer_len(&writer),
+		      "Invalid length");
+	zassert_equal(-ENOMEM, json_writer_finish(&writer),
+		      "Output should not fit");
+	zassert_equal(0, memcmp(buf, "{\"key\":", sizeof(buf) - 1),
+		      "Invalid truncated output");
+	zassert_equal(0xAA, (uint8_t)buf[sizeof(buf) - 1],
+		      "Writer must not write past the buffer");
+}
+
+/* Document shaped like a batch of sensor samples. */
+static void document_write(struct json_writer *writer)
+{
+	json_writer_obj_start(writer);
+	json_writer_key(writer, "env");
+	json_writer_arr_start(writer);
+
+	for (size_t i = 0; i < TEST_ENTRY_CNT; i++) {
+		json_writer_obj_start(writer);
+		json_writer_key(writer, "v");
+		json_writer_obj_start(writer);
+		json_writer_key_number(writer, "temp", 22.5 + i);
+		json_writer_key_number(writer, "hum", 41.75 - i);
+		json_writer_key_str(writer, "id", "sensor");
+		json_writer_obj_end(writer);
+		json_writer_key_int(writer, "ts", 1600000000000LL + i);
+		json_writer_obj_end(writer);
+	}
+
+	json_writer_arr_end(writer);
+	json_writer_obj_end(writer);
+}
+
+static char *document_cjson(void)
+{
+	cJSON *root = cJSON_CreateObject();
+	cJSON *array = cJSON_AddArrayToObject(root, "env");
+	char *out;
+
+	for (size_t i = 0; i < TEST_ENTRY_CNT; i++) {
+		cJSON *entry = cJSON_CreateObject();
+		cJSON *value = cJSON_AddObjectToObject(entry, "v");
+
+		cJSON_AddNumberToObject(value, "temp", 22.5 + i);
+		cJSON_AddNumberToObject(value, "hum", 41.75 - i);
+		cJSON_AddStringToObject(value, "id", "sensor");
+		cJSON_AddNumberToObject(entry, "ts", 1600000000000LL + i);
+		cJSON_AddItemToArray(array, entry);
+	}
+
+	out = cJSON_PrintUnformatted(root);
+	cJSON_Delete(root);
+
+	return out;
+}
+
+static char *document_writer(void)
+{
+	struct json_writer writer;
+	char *out;
+	size_t len;
+
+	json_writer_init(&writer, NULL, 0);
+	document_write(&writer);
+	len = json_writer_len(&writer);
+
+	out = counting_malloc(len + 1);
+	if (out == NULL) {
+		return NULL;
+	}
+
+	json_writer_init(&writer, out, len + 1);
+	document_write(&writer);
+	if (json_writer_finish(&writer)) {
+		counting_free(out);
+		return NULL;
+	}
+
+	return out;
+}
+
+static void test_benchmark(void)
+{
+	char *cjson_out;
+	char *writer_out;
+	size_t len = 0;
+	size_t cjson_peak = 0;
+	size_t cjson_total = 0;
+	size_t writer_peak = 0;
+	size_t writer_total = 0;
+	uint32_t cjson_cycles = 0;
+	uint32_t writer_cycles = 0;
+	uint32_t start;
+
+	for (size_t i = 0; i < TEST_BENCHMARK_CNT; i++) {
+		heap_stats_reset();
+		start = k_cycle_get_32();
+		cjson_out = document_cjson();
+		cjson_cycles += k_cycle_get_32() - start;
+		cjson_peak = heap_peak;
+		cjson_total = heap_total;
+
+		heap_stats_reset();
+		start = k_cycle_get_32();
+		writer_out = document_writer();
+		writer_cycles += k_cycle_get_32() - start;
+		writer_peak = heap_peak;
+		writer_total = heap_total;
+
+		zassert_not_null(cjson_out, "cJSON failed");
+		zassert_not_null(writer_out, "Writer failed");
+		zassert_equal(0, strcmp(cjson_out, writer_out),
+			      "Outputs differ");
+
+		len = strlen(writer_out);
+
+		counting_free(cjson_out);
+		counting_free(writer_out);
+	}
+
+	TC_PRINT("Document of %zu B\n", len);
+	TC_PRINT("cJSON: %zu B allocated, %zu B peak, %u us per encode\n",
+		 cjson_total, cjson_peak,
+		 k_cyc_to_us_floor32(cjson_cycles / TEST_BENCHMARK_CNT));
+	TC_PRINT("Writer: %zu B allocated, %zu B peak, %u us per encode\n",
+		 writer_total, writer_peak,
+		 k_cyc_to_us_floor32(writer_cycles / TEST_BENCHMARK_CNT));
+
+	zassert_equal(len + 1, writer_total,
+		      "Writer should allocate only the output");
+	zassert_true(writer_peak < cjson_peak,
+		     "Writer should use less heap than cJSON");
+}
+
+void test_main(void)
+{
+	cJSON_Hooks hooks = {
+		.malloc_fn = counting_malloc,
+		.free_fn = counting_free,
+	};
+
+	cJSON_InitHooks(&hooks);
+
+	ztest_test_suite(json_writer_tests,
+			 ztest_unit_test(test_containers),
+			 ztest_unit_test(test_string_escape),
+			 ztest_unit_test(test_int_limits),
+			 ztest_unit_test(test_number_matches_cjson),
+			 ztest_unit_test(test_length_only),
+			 ztest_unit_test(test_benchmark)
+			 );
+
+	ztest_run_test_suite(json_writer_tests);
+}
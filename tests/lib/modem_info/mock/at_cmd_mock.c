@@ -0,0 +1,203 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr.h>
+#include <string.h>
+#include <modem/at_cmd.h>
+#include <modem/at_notif.h>
+
+#include "at_cmd_mock.h"
+
+#define NOTIF_HANDLER_MAX	4
+
+struct mock_cmd {
+	const char *cmd;
+	const char *default_rsp;
+	const char *rsp;
+	bool fail;
+};
+
+struct mock_notif_handler {
+	const char *prefix;
+	void *context;
+	at_notif_handler_t handler;
+};
+
+static struct mock_cmd mock_cmds[] = {
+	{ "AT%XCBAND", "%XCBAND: 20\r\n" },
+	{ "AT%XCBAND=?", "%XCBAND: (1,2,3,4,12,13,20)\r\n" },
+	{ "AT+CEMODE?", "+CEMODE: 2\r\n" },
+	{ "AT+COPS?", "+COPS: 0,2,\"24201\",7\r\n" },
+	{ "AT+CEREG?", "+CEREG: 5,1,\"0140\",\"0199F10A\",7\r\n" },
+	{ "AT+CGDCONT?",
+	  "+CGDCONT: 0,\"IP\",\"telenor.smart\",\"10.81.183.99\",0,0\r\n" },
+	{ "AT%XSIM?", "%XSIM: 1\r\n" },
+	{ "AT%XVBAT", "%XVBAT: 3600\r\n" },
+	{ "AT+CGMR", "mfw_nrf9160_1.2.3\r\n" },
+	{ "AT+CRSM=176,12258,0,0,10",
+	  "+CRSM: 144,0,\"89450421180216216095\"\r\n" },
+	{ "AT%XSYSTEMMODE?", "%XSYSTEMMODE: 1,0,1,0\r\n" },
+	{ "AT+CIMI", "242016000000000\r\n" },
+	{ "AT+CGSN", "352656100000000\r\n" },
+	{ "AT+CCLK?", "+CCLK: \"21/03/15,10:20:30+04\"\r\n" },
+	{ "AT%XMONITOR",
+	  "%XMONITOR: 1,\"Telenor\",\"Telenor\",\"24201\",\"0140\",7,20,"
+	  "\"0199F10A\",194,6400,53,24,\"\",\"11100000\",\"11100000\"\r\n" },
+};
+
+static struct mock_notif_handler notif_handlers[NOTIF_HANDLER_MAX];
+static uint32_t cmd_cnt;
+
+static struct mock_cmd *mock_cmd_find(const char *cmd)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(mock_cmds); i++) {
+		if (!strcmp(mock_cmds[i].cmd, cmd)) {
+			return &mock_cmds[i];
+		}
+	}
+
+	return NULL;
+}
+
+static int mock_cmd_exec(const char *cmd, char *buf, size_t buf_len,
+			 enum at_cmd_state *state)
+{
+	struct mock_cmd *mock = mock_cmd_find(cmd);
+
+	cmd_cnt++;
+
+	if (!mock || mock->fail) {
+		if (state) {
+			*state = AT_CMD_ERROR;
+		}
+
+		return -ENOEXEC;
+	}
+
+	if (buf) {
+		const char *rsp = mock->rsp ? mock->rsp : mock->default_rsp;
+
+		if (strlen(rsp) >= buf_len) {
+			return -EMSGSIZE;
+		}
+
+		strcpy(buf, rsp);
+	}
+
+	if (state) {
+		*state = AT_CMD_OK;
+	}
+
+	return 0;
+}
+
+int at_cmd_write(const char *const cmd, char *buf, size_t buf_len,
+		 enum at_cmd_state *state)
+{
+	return mock_cmd_exec(cmd, buf, buf_len, state);
+}
+
+int at_cmd_write_batch(struct at_cmd_batch_item *items, size_t count,
+		       bool stop_on_error, struct at_cmd_batch_stats *stats)
+{
+	int first_err = 0;
+	size_t exec_cnt = 0;
+
+	for (size_t i = 0; i < count; i++) {
+		struct at_cmd_batch_item *item = &items[i];
+
+		item->rtt_us = 0;
+
+		if (first_err && stop_on_error) {
+			item->state = AT_CMD_ERROR_QUEUE;
+			item->code = -ECANCELED;
+			continue;
+		}
+
+		item->code = mock_cmd_exec(item->cmd, item->buf, item->buf_len,
+					   &item->state);
+		exec_cnt++;
+
+		if (item->code && !first_err) {
+			first_err = item->code;
+		}
+	}
+
+	if (stats) {
+		memset(stats, 0, sizeof(*stats));
+		stats->exec_cnt = exec_cnt;
+	}
+
+	return first_err;
+}
+
+int at_notif_register_prefix_handler(void *context, const char *prefix,
+				     at_notif_handler_t handler)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(notif_handlers); i++) {
+		struct mock_notif_handler *h = &notif_handlers[i];
+
+		if ((h->handler == handler) && (h->context == context) &&
+		    !strcmp(h->prefix, prefix)) {
+			return 0;
+		}
+
+		if (!h->handler) {
+			h->prefix = prefix;
+			h->context = context;
+			h->handler = handler;
+			return 0;
+		}
+	}
+
+	return -ENOBUFS;
+}
+
+void at_cmd_mock_rsp_set(const char *cmd, const char *rsp)
+{
+	struct mock_cmd *mock = mock_cmd_find(cmd);
+
+	__ASSERT_NO_MSG(mock);
+	mock->rsp = rsp;
+}
+
+void at_cmd_mock_fail_set(const char *cmd, bool fail)
+{
+	struct mock_cmd *mock = mock_cmd_find(cmd);
+
+	__ASSERT_NO_MSG(mock);
+	mock->fail = fail;
+}
+
+void at_cmd_mock_reset(void)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(mock_cmds); i++) {
+		mock_cmds[i].rsp = NULL;
+		mock_cmds[i].fail = false;
+	}
+}
+
+uint32_t at_cmd_mock_cmd_cnt(void)
+{
+	return cmd_cnt;
+}
+
+void at_cmd_mock_notify(const char *notif)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(notif_handlers); i++) {
+		struct mock_notif_handler *h = &notif_handlers[i];
+		size_t len;
+
+		if (!h->handler) {
+			continue;
+		}
+
+		len = strlen(h->prefix);
+		if (!strncmp(notif, h->prefix, len) && (notif[len] == ':')) {
+			h->handler(h->context, notif);
+		}
+	}
+}
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef AT_CMD_MOCK_H_
+#define AT_CMD_MOCK_H_
+
+#include <zephyr.h>
+
+/**
+ * @file
+ * @brief Mock of the AT command and notification interfaces.
+ *
+ * The mock answers the commands read by the modem information library with
+ * fixed responses, and counts the commands that were sent.
+ */
+
+/** @brief Set the response to a command.
+ *
+ * @param cmd Command.
+ * @param rsp Response, without the final result code. The string must remain
+ *            valid until the response is changed.
+ */
+void at_cmd_mock_rsp_set(const char *cmd, const char *rsp);
+
+/** @brief Make a command fail.
+ *
+ * @param cmd  Command.
+ * @param fail True to make the command fail.
+ */
+void at_cmd_mock_fail_set(const char *cmd, bool fail);
+
+/** @brief Restore the default responses. */
+void at_cmd_mock_reset(void);
+
+/** @brief Get the number of commands that were sent.
+ *
+ * @return Number of commands.
+ */
+uint32_t at_cmd_mock_cmd_cnt(void);
+
+/** @brief Pass a notification to the registered handlers.
+ *
+ * @param notif Notification.
+ */
+void at_cmd_mock_notify(const char *notif);
+
+#endif /* AT_CMD_MOCK_H_ */
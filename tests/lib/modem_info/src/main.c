@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <modem/modem_info.h>
+
+#include "at_cmd_mock.h"
+
+/* Commands sent by a full refresh, a refresh of the network parameters and
+ * a read of the cached parameters.
+ */
+#define TEST_FULL_CMD_CNT	12
+#define TEST_NETWORK_CMD_CNT	4
+#define TEST_READ_CMD_CNT	2
+
+#define TEST_TTL		K_MSEC(CONFIG_MODEM_INFO_CACHE_TTL * 1000 + 100)
+
+#define TEST_CELL_NOTIF		"+CEREG: 1,\"0140\",\"0199F10A\",7"
+#define TEST_NEW_CELL_NOTIF	"+CEREG: 1,\"0140\",\"0199F10B\",7"
+#define TEST_NEW_CELL_XMONITOR						\
+	"%XMONITOR: 1,\"Telenor\",\"Telenor\",\"24201\",\"0140\",7,20,"	\
+	"\"0199F10B\",194,6400,53,24,\"\",\"11100000\",\"11100000\"\r\n"
+/* Response with long operator names and all the optional parameters. */
+#define TEST_LONG_XMONITOR						\
+	"%XMONITOR: 1,\"Telenor Norge AS Mobile\",\"Telenor NO\","	\
+	"\"24201\",\"0140\",7,20,\"0199F10C\",194,6400,53,24,\"\","	\
+	"\"11100000\",\"11100000\",\"01001001\",\"00000101\",-8,"	\
+	"\"00001000\",\"0010\",\"0101\",\"0001\",\"01011111\"\r\n"
+#define TEST_SHORT_XMONITOR	"%XMONITOR: 2\r\n"
+
+static struct modem_param_info modem_param;
+
+static uint32_t params_get(void)
+{
+	uint32_t cmd_cnt = at_cmd_mock_cmd_cnt();
+	int err = modem_info_params_get(&modem_param);
+
+	zassert_equal(err, 0, "Cannot get parameters (err %d)", err);
+
+	return at_cmd_mock_cmd_cnt() - cmd_cnt;
+}
+
+static void cache_reset(void)
+{
+	at_cmd_mock_reset();
+	modem_info_cache_invalidate();
+	zassert_equal(params_get(), TEST_FULL_CMD_CNT, "No full refresh");
+}
+
+static void stats_get(struct modem_info_cache_stats *stats)
+{
+	int err = modem_info_cache_stats_get(stats);
+
+	zassert_equal(err, 0, "Cannot get stats (err %d)", err);
+}
+
+/* Compare a cached parameter with the value read with a separate command. */
+static void param_check(const struct lte_param *param)
+{
+	char buf[MODEM_INFO_MAX_RESPONSE_SIZE];
+	uint16_t value;
+	int ret;
+
+	if (modem_info_type_get(param->type) == AT_PARAM_TYPE_STRING) {
+		ret = modem_info_string_get(param->type, buf, sizeof(buf));
+		zassert_true(ret >= 0, "Cannot read %d (err %d)", param->type,
+			     ret);
+		zassert_true(!strcmp(param->value_string, buf),
+			     "Invalid %d: %s", param->type,
+			     param->value_string);
+	} else {
+		ret = modem_info_short_get(param->type, &value);
+		zassert_true(ret >= 0, "Cannot read %d (err %d)", param->type,
+			     ret);
+		zassert_equal(param->value, value, "Invalid %d: %d",
+			      param->type, param->value);
+	}
+}
+
+static void test_full_refresh(void)
+{
+	struct modem_info_cache_stats stats_before;
+	struct modem_info_cache_stats stats;
+
+	stats_get(&stats_before);
+	cache_reset();
+	stats_get(&stats);
+
+	zassert_equal(stats.full_refresh_cnt,
+		      stats_before.full_refresh_cnt + 1, "Invalid stats");
+	zassert_equal(stats.at_cmd_cnt,
+		      stats_before.at_cmd_cnt + TEST_FULL_CMD_CNT,
+		      "Invalid stats");
+
+	param_check(&modem_param.network.current_band);
+	param_check(&modem_param.network.sup_band);
+	param_check(&modem_param.network.area_code);
+	param_check(&modem_param.network.current_operator);
+	param_check(&modem_param.network.cellid_hex);
+	param_check(&modem_param.network.ip_address);
+	param_check(&modem_param.network.ue_mode);
+	param_check(&modem_param.network.lte_mode);
+	param_check(&modem_param.network.nbiot_mode);
+	param_check(&modem_param.network.gps_mode);
+	param_check(&modem_param.network.date_time);
+	param_check(&modem_param.network.apn);
+	param_check(&modem_param.sim.uicc);
+	param_check(&modem_param.sim.iccid);
+	param_check(&modem_param.sim.imsi);
+	param_check(&modem_param.device.modem_fw);
+	param_check(&modem_param.device.battery);
+	param_check(&modem_param.device.imei);
+
+	zassert_true(!strcmp(modem_param.sim.iccid.value_string,
+			     "98544012812061120659"), "Invalid ICCID");
+	zassert_equal(modem_param.network.mcc.value, 242, "Invalid MCC");
+	zassert_equal(modem_param.network.mnc.value, 1, "Invalid MNC");
+	zassert_equal(modem_param.network.area_code.value, 0x140,
+		      "Invalid area code");
+	zassert_equal(modem_param.network.cellid_dec, 0x0199F10A,
+		      "Invalid cell ID");
+}
+
+static void test_cached_read(void)
+{
+	cache_reset();
+
+	at_cmd_mock_rsp_set("AT+CGSN", "352656100000001\r\n");
+	at_cmd_mock_rsp_set("AT%XVBAT", "%XVBAT: 3500\r\n");
+
+	zassert_equal(params_get(), TEST_READ_CMD_CNT,
+		      "Static parameters read again");
+	zassert_true(!strcmp(modem_param.device.imei.value_string,
+			     "352656100000000"), "Cached IMEI not used");
+	zassert_equal(modem_param.device.battery.value, 3500,
+		      "Battery voltage not read");
+}
+
+static void test_cereg_notification(void)
+{
+	struct modem_info_cache_stats stats_before;
+	struct modem_info_cache_stats stats;
+
+	cache_reset();
+	stats_get(&stats_before);
+
+	/* Registration to the cell the cache was read in. The cache cannot
+	 * know that, so the network parameters are read again.
+	 */
+	at_cmd_mock_notify(TEST_CELL_NOTIF);
+	zassert_equal(params_get(), TEST_NETWORK_CMD_CNT,
+		      "Network parameters not read");
+
+	/* No change. */
+	at_cmd_mock_notify(TEST_CELL_NOTIF);
+	zassert_equal(params_get(), TEST_READ_CMD_CNT,
+		      "Network parameters read without change");
+
+	at_cmd_mock_rsp_set("AT%XMONITOR", TEST_NEW_CELL_XMONITOR);
+	at_cmd_mock_notify(TEST_NEW_CELL_NOTIF);
+	zassert_equal(params_get(), TEST_NETWORK_CMD_CNT,
+		      "Network parameters not read after cell change");
+	zassert_equal(modem_param.network.cellid_dec, 0x0199F10B,
+		      "Cell ID not updated");
+
+	stats_get(&stats);
+	zassert_equal(stats.notif_cnt, stats_before.notif_cnt + 2,
+		      "Invalid notification count");
+	zassert_equal(stats.network_refresh_cnt,
+		      stats_before.network_refresh_cnt + 2,
+		      "Invalid network refresh count");
+	zassert_equal(stats.read_cnt, stats_before.read_cnt + 3,
+		      "Invalid read count");
+}
+
+static void test_ttl(void)
+{
+	cache_reset();
+
+	zassert_equal(params_get(), TEST_READ_CMD_CNT, "Cache not used");
+
+	k_sleep(TEST_TTL);
+
+	zassert_equal(params_get(), TEST_FULL_CMD_CNT,
+		      "Cache did not expire");
+}
+
+static void test_refresh_error(void)
+{
+	int err;
+
+	cache_reset();
+
+	modem_info_cache_invalidate();
+	at_cmd_mock_fail_set("AT+CIMI", true);
+
+	err = modem_info_params_get(&modem_param);
+	zassert_equal(err, -EAGAIN, "Error not reported");
+
+	/* The failed refresh is retried. */
+	at_cmd_mock_fail_set("AT+CIMI", false);
+	zassert_equal(params_get(), TEST_FULL_CMD_CNT, "Refresh not retried");
+	zassert_equal(params_get(), TEST_READ_CMD_CNT, "Cache not used");
+}
+
+static void test_long_xmonitor(void)
+{
+	BUILD_ASSERT(sizeof(TEST_LONG_XMONITOR) >
+		     CONFIG_MODEM_INFO_BUFFER_SIZE);
+
+	cache_reset();
+
+	at_cmd_mock_rsp_set("AT%XMONITOR", TEST_LONG_XMONITOR);
+	modem_info_cache_invalidate();
+
+	zassert_equal(params_get(), TEST_FULL_CMD_CNT, "No full refresh");
+	zassert_equal(modem_param.network.cellid_dec, 0x0199F10C,
+		      "Cell ID not updated");
+	zassert_true(!strcmp(modem_param.network.current_operator.value_string,
+			     "24201"), "Invalid operator");
+}
+
+static void test_short_xmonitor(void)
+{
+	int err;
+
+	cache_reset();
+
+	/* Not registered, the cell is not reported. */
+	at_cmd_mock_rsp_set("AT%XMONITOR", TEST_SHORT_XMONITOR);
+	modem_info_cache_invalidate();
+
+	err = modem_info_params_get(&modem_param);
+	zassert_equal(err, -EAGAIN, "Error not reported");
+
+	at_cmd_mock_reset();
+	zassert_equal(params_get(), TEST_FULL_CMD_CNT, "Refresh not retried");
+}
+
+static void test_benchmark(void)
+{
+	struct modem_info_cache_stats stats;
+
+	cache_reset();
+	stats_get(&stats);
+	TC_PRINT("Full refresh: %u commands, %u us\n", TEST_FULL_CMD_CNT,
+		 stats.last_read_us);
+
+	params_get();
+	stats_get(&stats);
+	TC_PRINT("Cached read: %u commands, %u us\n", TEST_READ_CMD_CNT,
+		 stats.last_read_us);
+}
+
+void test_main(void)
+{
+	int err = modem_info_init();
+
+	zassert_equal(err, 0, "Cannot initialize library (err %d)", err);
+
+	err = modem_info_params_init(&modem_param);
+	zassert_equal(err, 0, "Cannot initialize parameters (err %d)", err);
+
+	ztest_test_suite(modem_info_cache_test,
+			 ztest_unit_test(test_full_refresh),
+			 ztest_unit_test(test_cached_read),
+			 ztest_unit_test(test_cereg_notification),
+			 ztest_unit_test(test_ttl),
+			 ztest_unit_test(test_refresh_error),
+			 ztest_unit_test(test_long_xmonitor),
+			 ztest_unit_test(test_short_xmonitor),
+			 ztest_unit_test(test_benchmark));
+
+	ztest_run_test_suite(modem_info_cache_test);
+}
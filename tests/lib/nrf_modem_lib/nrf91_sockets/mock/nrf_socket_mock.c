@@ -0,0 +1,248 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr.h>
+#include <errno.h>
+#include <string.h>
+#include <nrf_socket.h>
+#include <nrf_gai_errors.h>
+#include <nrf_modem_limits.h>
+
+#include "nrf_socket_mock.h"
+
+#define MOCK_DATA_SIZE 1024
+
+struct mock_socket {
+	bool open;
+	bool blocked;
+	short revents;
+	size_t len;
+	uint8_t data[MOCK_DATA_SIZE];
+};
+
+static struct mock_socket sockets[NRF_MODEM_MAX_SOCKET_COUNT];
+static int last_sd = -1;
+static size_t send_limit;
+static size_t capacity;
+static size_t accepted;
+static atomic_t sendto_cnt;
+static atomic_t poll_cnt;
+
+static K_SEM_DEFINE(blocked_sem, 0, 1);
+static K_SEM_DEFINE(unblock_sem, 0, 1);
+
+void nrf_socket_mock_reset(void)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(sockets); i++) {
+		sockets[i].blocked = false;
+		sockets[i].revents = 0;
+		sockets[i].len = 0;
+	}
+
+	send_limit = 0;
+	capacity = 0;
+	accepted = 0;
+	atomic_clear(&sendto_cnt);
+	atomic_clear(&poll_cnt);
+	k_sem_reset(&blocked_sem);
+	k_sem_reset(&unblock_sem);
+}
+
+void nrf_socket_mock_send_limit_set(size_t len)
+{
+	send_limit = len;
+}
+
+void nrf_socket_mock_capacity_set(size_t len)
+{
+	capacity = len;
+	accepted = 0;
+}
+
+void nrf_socket_mock_block_set(int sd, bool block)
+{
+	sockets[sd].blocked = block;
+
+	if (!block) {
+		k_sem_give(&unblock_sem);
+	}
+}
+
+int nrf_socket_mock_blocked_wait(k_timeout_t timeout)
+{
+	return k_sem_take(&blocked_sem, timeout);
+}
+
+void nrf_socket_mock_revents_set(int sd, short revents)
+{
+	sockets[sd].revents = revents;
+}
+
+int nrf_socket_mock_last_sd(void)
+{
+	return last_sd;
+}
+
+uint32_t nrf_socket_mock_sendto_cnt(void)
+{
+	return atomic_get(&sendto_cnt);
+}
+
+const uint8_t *nrf_socket_mock_data_get(int sd, size_t *len)
+{
+	*len = sockets[sd].len;
+
+	return sockets[sd].data;
+}
+
+uint32_t nrf_socket_mock_poll_cnt(void)
+{
+	return atomic_get(&poll_cnt);
+}
+
+void nrf_modem_os_errno_set(int errno_val)
+{
+	errno = errno_val;
+}
+
+int nrf_socket(int family, int type, int protocol)
+{
+	for (int sd = 0; sd < ARRAY_SIZE(sockets); sd++) {
+		if (!sockets[sd].open) {
+			sockets[sd].open = true;
+			sockets[sd].blocked = false;
+			sockets[sd].revents = 0;
+			sockets[sd].len = 0;
+			last_sd = sd;
+			return sd;
+		}
+	}
+
+	errno = ENOBUFS;
+	return -1;
+}
+
+int nrf_close(int socket)
+{
+	sockets[socket].open = false;
+
+	return 0;
+}
+
+ssize_t nrf_sendto(int socket, const void *message, size_t length, int flags,
+		   const void *dest_addr, nrf_socklen_t dest_len)
+{
+	struct mock_socket *sock = &sockets[socket];
+
+	if (sock->blocked) {
+		k_sem_give(&blocked_sem);
+		k_sem_take(&unblock_sem, K_FOREVER);
+	}
+
+	atomic_inc(&sendto_cnt);
+
+	if (send_limit > 0) {
+		length = MIN(length, send_limit);
+	}
+
+	if (capacity > 0) {
+		if (accepted == capacity) {
+			errno = EAGAIN;
+			return -1;
+		}
+
+		length = MIN(length, capacity - accepted);
+		accepted += length;
+	}
+
+	if (length > sizeof(sock->data) - sock->len) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	memcpy(&sock->data[sock->len], message, length);
+	sock->len += length;
+
+	return length;
+}
+
+ssize_t nrf_recvfrom(int socket, void *buffer, size_t length, int flags,
+		     struct nrf_sockaddr *address,
+		     nrf_socklen_t *address_len)
+{
+	errno = EAGAIN;
+	return -1;
+}
+
+int nrf_accept(int socket, struct nrf_sockaddr *address,
+	       nrf_socklen_t *address_len)
+{
+	errno = EOPNOTSUPP;
+	return -1;
+}
+
+int nrf_bind(int socket, const struct nrf_sockaddr *address,
+	     nrf_socklen_t address_len)
+{
+	return 0;
+}
+
+int nrf_listen(int sock, int backlog)
+{
+	return 0;
+}
+
+int nrf_connect(int socket, const void *address, nrf_socklen_t address_len)
+{
+	return 0;
+}
+
+int nrf_setsockopt(int socket, int level, int option_name,
+		   const void *option_value, nrf_socklen_t option_len)
+{
+	return 0;
+}
+
+int nrf_getsockopt(int socket, int level, int option_name,
+		   void *option_value, nrf_socklen_t *option_len)
+{
+	errno = ENOPROTOOPT;
+	return -1;
+}
+
+int nrf_poll(struct nrf_pollfd *fds, nrf_nfds_t nfds, int timeout)
+{
+	int cnt = 0;
+
+	atomic_inc(&poll_cnt);
+
+	for (nrf_nfds_t i = 0; i < nfds; i++) {
+		fds[i].revents = sockets[fds[i].fd].revents &
+				 (fds[i].events | NRF_POLLERR | NRF_POLLHUP |
+				  NRF_POLLNVAL);
+		if (fds[i].revents) {
+			cnt++;
+		}
+	}
+
+	return cnt;
+}
+
+int nrf_fcntl(int fd, int cmd, int flags)
+{
+	return 0;
+}
+
+int nrf_getaddrinfo(const char *nodename, const char *servname,
+		    const struct nrf_addrinfo *hints,
+		    struct nrf_addrinfo **res)
+{
+	return NRF_EAI_FAIL;
+}
+
+void nrf_freeaddrinfo(struct nrf_addrinfo *ai)
+{
+}
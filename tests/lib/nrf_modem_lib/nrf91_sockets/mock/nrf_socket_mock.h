@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef NRF_SOCKET_MOCK_H_
+#define NRF_SOCKET_MOCK_H_
+
+#include <zephyr.h>
+
+/**
+ * @file
+ * @brief Mock of the Modem library sockets.
+ *
+ * The mock records the data passed to `nrf_sendto`, returns preset events
+ * from `nrf_poll` and counts the calls.
+ */
+
+/** @brief Clear the recorded data and restore the default behavior. */
+void nrf_socket_mock_reset(void);
+
+/** @brief Limit the number of bytes accepted by a single `nrf_sendto` call.
+ *
+ * @param len Maximum number of bytes, 0 for no limit.
+ */
+void nrf_socket_mock_send_limit_set(size_t len);
+
+/** @brief Limit the number of bytes accepted before `nrf_sendto` fails
+ *         with EAGAIN.
+ *
+ * @param len Number of bytes, 0 for no limit.
+ */
+void nrf_socket_mock_capacity_set(size_t len);
+
+/** @brief Block `nrf_sendto` calls on a socket.
+ *
+ * @param sd    nRF socket descriptor.
+ * @param block True to block the calls until they are released.
+ */
+void nrf_socket_mock_block_set(int sd, bool block);
+
+/** @brief Wait until a call of `nrf_sendto` is blocked.
+ *
+ * @param timeout Waiting period.
+ *
+ * @return 0 when a call is blocked, -EAGAIN on timeout.
+ */
+int nrf_socket_mock_blocked_wait(k_timeout_t timeout);
+
+/** @brief Set the events returned by `nrf_poll` for a socket.
+ *
+ * @param sd      nRF socket descriptor.
+ * @param revents Events, NRF_POLLIN, NRF_POLLOUT, NRF_POLLERR or
+ *                NRF_POLLHUP.
+ */
+void nrf_socket_mock_revents_set(int sd, short revents);
+
+/** @brief Get the nRF socket descriptor of the last created socket.
+ *
+ * @return nRF socket descriptor.
+ */
+int nrf_socket_mock_last_sd(void);
+
+/** @brief Get the number of `nrf_sendto` calls.
+ *
+ * @return Number of calls.
+ */
+uint32_t nrf_socket_mock_sendto_cnt(void);
+
+/** @brief Get the data passed to `nrf_sendto` on a socket.
+ *
+ * @param sd  nRF socket descriptor.
+ * @param len Length of the data.
+ *
+ * @return Data.
+ */
+const uint8_t *nrf_socket_mock_data_get(int sd, size_t *len);
+
+/** @brief Get the number of `nrf_poll` calls.
+ *
+ * @return Number of calls.
+ */
+uint32_t nrf_socket_mock_poll_cnt(void);
+
+#endif /* NRF_SOCKET_MOCK_H_ */
@@ -0,0 +1,442 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include <net/socket.h>
+#include <nrf_socket.h>
+#include <nrf_modem_limits.h>
+#include <modem/nrf91_poll_set.h>
+
+#include "nrf91_sockets_internal.h"
+#include "nrf_socket_mock.h"
+
+#define TEST_BUF_SIZE		CONFIG_NRF_MODEM_LIB_SENDMSG_BUF_SIZE
+#define TEST_MAX_PARTS		40
+#define TEST_STACK_SIZE		1024
+#define TEST_THREAD_PRIO	K_PRIO_PREEMPT(0)
+#define TEST_SOCKET_CNT		NRF_MODEM_MAX_SOCKET_COUNT
+/* Time for the poll sets to process a Modem library event. */
+#define TEST_EVENT_DELAY	K_MSEC(10)
+
+static uint8_t payload[512];
+
+static struct sender {
+	int fd;
+	ssize_t ret;
+} sender;
+
+static struct waiter {
+	struct nrf91_poll_set *set;
+	struct zsock_pollfd ready;
+	int ret;
+} waiter;
+
+static K_THREAD_STACK_DEFINE(test_stack, TEST_STACK_SIZE);
+static struct k_thread test_thread;
+static K_SEM_DEFINE(sender_done, 0, 1);
+static K_SEM_DEFINE(waiter_done, 0, 1);
+
+static int sock_open(int *sd)
+{
+	int fd = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+
+	zassert_true(fd >= 0, "Cannot create socket (errno %d)", errno);
+	*sd = nrf_socket_mock_last_sd();
+
+	return fd;
+}
+
+/* Send consecutive parts of the payload as one message. */
+static ssize_t msg_send(int fd, const size_t *lens, size_t cnt, int flags)
+{
+	struct iovec iov[TEST_MAX_PARTS];
+	struct msghdr msg = {
+		.msg_iov = iov,
+		.msg_iovlen = cnt,
+	};
+	size_t offset = 0;
+
+	zassert_true(cnt <= ARRAY_SIZE(iov), "Too many parts");
+
+	for (size_t i = 0; i < cnt; i++) {
+		iov[i].iov_base = &payload[offset];
+		iov[i].iov_len = lens[i];
+		offset += lens[i];
+	}
+
+	return sendmsg(fd, &msg, flags);
+}
+
+/* Check that the modem received the payload in order. */
+static void data_check(int sd, size_t len)
+{
+	size_t data_len;
+	const uint8_t *data = nrf_socket_mock_data_get(sd, &data_len);
+
+	zassert_equal(data_len, len, "Wrong length %u", data_len);
+	zassert_mem_equal(data, payload, len, "Wrong data");
+}
+
+static void sendto_cnt_check(uint32_t expected)
+{
+	uint32_t cnt = nrf_socket_mock_sendto_cnt();
+
+	zassert_equal(cnt, expected, "Expected %u calls, got %u", expected,
+		      cnt);
+}
+
+static void test_sendmsg_coalesce(void)
+{
+	const size_t lens[] = { 8, 16, 0, 4, 20 };
+	int sd;
+	int fd = sock_open(&sd);
+	ssize_t ret;
+
+	nrf_socket_mock_reset();
+
+	ret = msg_send(fd, lens, ARRAY_SIZE(lens), 0);
+	zassert_equal(ret, 48, "Wrong return value %d", ret);
+	sendto_cnt_check(1);
+	data_check(sd, 48);
+
+	close(fd);
+}
+
+static void test_sendmsg_large_part(void)
+{
+	/* The large part is sent without copying after its beginning has
+	 * been coalesced with the preceding part.
+	 */
+	const size_t lens[] = { 10, 300, 10, 10 };
+	int sd;
+	int fd = sock_open(&sd);
+	ssize_t ret;
+
+	nrf_socket_mock_reset();
+
+	ret = msg_send(fd, lens, ARRAY_SIZE(lens), 0);
+	zassert_equal(ret, 330, "Wrong return value %d", ret);
+	sendto_cnt_check(3);
+	data_check(sd, 330);
+
+	close(fd);
+}
+
+static void test_sendmsg_many_parts(void)
+{
+	size_t lens[TEST_MAX_PARTS];
+	int sd;
+	int fd = sock_open(&sd);
+	ssize_t ret;
+
+	for (size_t i = 0; i < ARRAY_SIZE(lens); i++) {
+		lens[i] = 8;
+	}
+
+	nrf_socket_mock_reset();
+
+	ret = msg_send(fd, lens, ARRAY_SIZE(lens), 0);
+	zassert_equal(ret, 320, "Wrong return value %d", ret);
+	sendto_cnt_check(320 / TEST_BUF_SIZE);
+	data_check(sd, 320);
+
+	close(fd);
+}
+
+static void test_sendmsg_partial(void)
+{
+	const size_t lens[] = { 10, 10, 10, 10 };
+	int sd;
+	int fd = sock_open(&sd);
+	ssize_t ret;
+
+	nrf_socket_mock_reset();
+	nrf_socket_mock_send_limit_set(25);
+
+	ret = msg_send(fd, lens, ARRAY_SIZE(lens), 0);
+	zassert_equal(ret, 40, "Wrong return value %d", ret);
+	sendto_cnt_check(2);
+	data_check(sd, 40);
+
+	close(fd);
+}
+
+static void test_sendmsg_dontwait(void)
+{
+	const size_t lens[] = { 40, 40 };
+	int sd;
+	int fd = sock_open(&sd);
+	ssize_t ret;
+
+	nrf_socket_mock_reset();
+	nrf_socket_mock_capacity_set(50);
+
+	/* The data accepted before the modem runs out of space is reported */
+	ret = msg_send(fd, lens, ARRAY_SIZE(lens), MSG_DONTWAIT);
+	zassert_equal(ret, 50, "Wrong return value %d", ret);
+	data_check(sd, 50);
+
+	ret = msg_send(fd, lens, ARRAY_SIZE(lens), MSG_DONTWAIT);
+	zassert_equal(ret, -1, "Wrong return value %d", ret);
+	zassert_equal(errno, EAGAIN, "Wrong errno %d", errno);
+
+	close(fd);
+}
+
+static void sender_fn(void *p1, void *p2, void *p3)
+{
+	const size_t lens[] = { 16, 16 };
+
+	sender.ret = msg_send(sender.fd, lens, ARRAY_SIZE(lens), 0);
+	k_sem_give(&sender_done);
+}
+
+static void test_sendmsg_concurrent(void)
+{
+	const size_t lens[] = { 16, 16 };
+	int blocked_sd;
+	int sd;
+	int blocked_fd = sock_open(&blocked_sd);
+	int fd = sock_open(&sd);
+	ssize_t ret;
+	int err;
+
+	nrf_socket_mock_reset();
+	nrf_socket_mock_block_set(blocked_sd, true);
+
+	sender.fd = blocked_fd;
+	k_thread_create(&test_thread, test_stack,
+			K_THREAD_STACK_SIZEOF(test_stack), sender_fn,
+			NULL, NULL, NULL, TEST_THREAD_PRIO, 0, K_NO_WAIT);
+
+	err = nrf_socket_mock_blocked_wait(K_SECONDS(1));
+	zassert_equal(err, 0, "Sender not blocked");
+
+	/* Another socket is not affected by the blocked sender */
+	ret = msg_send(fd, lens, ARRAY_SIZE(lens), 0);
+	zassert_equal(ret, 32, "Wrong return value %d", ret);
+	sendto_cnt_check(1);
+	data_check(sd, 32);
+
+	/* The blocked socket is busy, and the sender does not wait */
+	ret = msg_send(blocked_fd, lens, ARRAY_SIZE(lens), MSG_DONTWAIT);
+	zassert_equal(ret, -1, "Wrong return value %d", ret);
+	zassert_equal(errno, EAGAIN, "Wrong errno %d", errno);
+	sendto_cnt_check(1);
+
+	nrf_socket_mock_block_set(blocked_sd, false);
+
+	err = k_sem_take(&sender_done, K_SECONDS(1));
+	zassert_equal(err, 0, "Sender not finished");
+	zassert_equal(sender.ret, 32, "Wrong return value %d", sender.ret);
+	sendto_cnt_check(2);
+	data_check(blocked_sd, 32);
+
+	close(fd);
+	close(blocked_fd);
+}
+
+/* Simulate a Modem library event, and let the poll sets process it. */
+static void modem_event(void)
+{
+	nrf91_socket_event_notify();
+	k_sleep(TEST_EVENT_DELAY);
+}
+
+static void stats_get(struct nrf91_poll_set_stats *stats)
+{
+	k_sleep(TEST_EVENT_DELAY);
+	nrf91_poll_set_stats_get(stats);
+}
+
+static void test_poll_set_ready(void)
+{
+	struct nrf91_poll_set set;
+	struct zsock_pollfd ready[2];
+	int sd[2];
+	int fd[2];
+	int64_t start;
+	int ret;
+
+	nrf_socket_mock_reset();
+	nrf91_poll_set_init(&set);
+
+	for (size_t i = 0; i < ARRAY_SIZE(fd); i++) {
+		fd[i] = sock_open(&sd[i]);
+		ret = nrf91_poll_set_add(&set, fd[i], POLLIN);
+		zassert_equal(ret, 0, "Cannot add socket (err %d)", ret);
+	}
+
+	ret = nrf91_poll_set_add(&set, fd[0], POLLIN);
+	zassert_equal(ret, -EEXIST, "Socket added twice");
+
+	start = k_uptime_get();
+	ret = nrf91_poll_set_wait(&set, ready, ARRAY_SIZE(ready), 100);
+	zassert_equal(ret, 0, "Unexpected ready socket");
+	zassert_true(k_uptime_get() - start >= 100, "Timeout too short");
+
+	nrf_socket_mock_revents_set(sd[1], NRF_POLLIN);
+	modem_event();
+
+	ret = nrf91_poll_set_wait(&set, ready, ARRAY_SIZE(ready), 0);
+	zassert_equal(ret, 1, "Wrong number of ready sockets %d", ret);
+	zassert_equal(ready[0].fd, fd[1], "Wrong ready socket");
+	zassert_equal(ready[0].revents, POLLIN, "Wrong events");
+
+	ret = nrf91_poll_set_remove(&set, fd[1]);
+	zassert_equal(ret, 0, "Cannot remove socket (err %d)", ret);
+	ret = nrf91_poll_set_remove(&set, fd[1]);
+	zassert_equal(ret, -ENOENT, "Socket removed twice");
+
+	ret = nrf91_poll_set_wait(&set, ready, ARRAY_SIZE(ready), 0);
+	zassert_equal(ret, 0, "Removed socket reported");
+
+	close(fd[0]);
+	close(fd[1]);
+}
+
+static void waiter_fn(void *p1, void *p2, void *p3)
+{
+	waiter.ret = nrf91_poll_set_wait(waiter.set, &waiter.ready, 1,
+					 SYS_FOREVER_MS);
+	k_sem_give(&waiter_done);
+}
+
+static void test_poll_set_wakeup(void)
+{
+	struct nrf91_poll_set idle_set;
+	struct nrf91_poll_set set;
+	struct nrf91_poll_set_stats before;
+	struct nrf91_poll_set_stats after;
+	int idle_sd;
+	int sd;
+	int idle_fd = sock_open(&idle_sd);
+	int fd = sock_open(&sd);
+	int err;
+
+	nrf_socket_mock_reset();
+	nrf91_poll_set_init(&idle_set);
+	nrf91_poll_set_init(&set);
+
+	err = nrf91_poll_set_add(&idle_set, idle_fd, POLLIN);
+	zassert_equal(err, 0, "Cannot add socket (err %d)", err);
+	err = nrf91_poll_set_add(&set, fd, POLLIN);
+	zassert_equal(err, 0, "Cannot add socket (err %d)", err);
+
+	waiter.set = &idle_set;
+	k_thread_create(&test_thread, test_stack,
+			K_THREAD_STACK_SIZEOF(test_stack), waiter_fn,
+			NULL, NULL, NULL, TEST_THREAD_PRIO, 0, K_NO_WAIT);
+
+	stats_get(&before);
+
+	/* A socket of another poll set does not wake up the waiter */
+	nrf_socket_mock_revents_set(sd, NRF_POLLIN);
+	modem_event();
+	modem_event();
+
+	stats_get(&after);
+	zassert_equal(after.scan_cnt - before.scan_cnt, 2, "Wrong scans");
+	zassert_equal(after.wakeup_cnt - before.wakeup_cnt, 1,
+		      "Wrong wakeups");
+	err = k_sem_take(&waiter_done, K_MSEC(100));
+	zassert_equal(err, -EAGAIN, "Waiter woken up");
+
+	nrf_socket_mock_revents_set(idle_sd, NRF_POLLIN);
+	modem_event();
+
+	err = k_sem_take(&waiter_done, K_SECONDS(1));
+	zassert_equal(err, 0, "Waiter not woken up");
+	zassert_equal(waiter.ret, 1, "Wrong number of ready sockets");
+	zassert_equal(waiter.ready.fd, idle_fd, "Wrong ready socket");
+
+	stats_get(&after);
+	zassert_equal(after.wakeup_cnt - before.wakeup_cnt, 2,
+		      "Wrong wakeups");
+
+	close(fd);
+	close(idle_fd);
+}
+
+static void test_poll_set_all_sockets(void)
+{
+	struct nrf91_poll_set set;
+	struct nrf91_poll_set_stats before;
+	struct nrf91_poll_set_stats after;
+	struct zsock_pollfd ready[TEST_SOCKET_CNT];
+	int sd[TEST_SOCKET_CNT];
+	int fd[TEST_SOCKET_CNT];
+	uint8_t buf[8];
+	int ret;
+
+	nrf_socket_mock_reset();
+	nrf91_poll_set_init(&set);
+
+	for (size_t i = 0; i < ARRAY_SIZE(fd); i++) {
+		fd[i] = sock_open(&sd[i]);
+		ret = nrf91_poll_set_add(&set, fd[i], POLLIN);
+		zassert_equal(ret, 0, "Cannot add socket (err %d)", ret);
+	}
+
+	stats_get(&before);
+
+	for (size_t i = 0; i < ARRAY_SIZE(sd); i++) {
+		nrf_socket_mock_revents_set(sd[i], NRF_POLLIN);
+	}
+
+	/* All sockets are checked with a single call */
+	modem_event();
+
+	ret = nrf91_poll_set_wait(&set, ready, ARRAY_SIZE(ready), 0);
+	zassert_equal(ret, TEST_SOCKET_CNT, "Wrong number of ready sockets");
+
+	stats_get(&after);
+	zassert_equal(after.scan_cnt - before.scan_cnt, 1, "Wrong scans");
+	zassert_equal(after.wakeup_cnt - before.wakeup_cnt, 1,
+		      "Wrong wakeups");
+
+	/* A received socket is checked again, and is still ready */
+	ret = recv(fd[0], buf, sizeof(buf), MSG_DONTWAIT);
+	zassert_equal(ret, -1, "Unexpected data");
+
+	stats_get(&after);
+	zassert_equal(after.scan_cnt - before.scan_cnt, 2, "Wrong scans");
+
+	ret = nrf91_poll_set_wait(&set, ready, ARRAY_SIZE(ready), 0);
+	zassert_equal(ret, TEST_SOCKET_CNT, "Wrong number of ready sockets");
+
+	for (size_t i = 0; i < ARRAY_SIZE(fd); i++) {
+		close(fd[i]);
+	}
+
+	/* Without sockets in poll sets, events are not processed */
+	before = after;
+	modem_event();
+
+	stats_get(&after);
+	zassert_equal(after.scan_cnt, before.scan_cnt, "Unexpected scan");
+}
+
+void test_main(void)
+{
+	for (size_t i = 0; i < sizeof(payload); i++) {
+		payload[i] = i * 7 + 3;
+	}
+
+	ztest_test_suite(nrf91_sockets_test,
+			 ztest_unit_test(test_sendmsg_coalesce),
+			 ztest_unit_test(test_sendmsg_large_part),
+			 ztest_unit_test(test_sendmsg_many_parts),
+			 ztest_unit_test(test_sendmsg_partial),
+			 ztest_unit_test(test_sendmsg_dontwait),
+			 ztest_unit_test(test_sendmsg_concurrent),
+			 ztest_unit_test(test_poll_set_ready),
+			 ztest_unit_test(test_poll_set_wakeup),
+			 ztest_unit_test(test_poll_set_all_sockets));
+
+	ztest_run_test_suite(nrf91_sockets_test);
+}
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <string.h>
+#include "sensor_float.h"
+
+/* Reference implementation, using the float type. Every intermediate result
+ * is stored in a volatile float to round it to single precision, also on
+ * hosts that evaluate float expressions with more precision.
+ */
+static uint32_t float32_encode_ref(const struct sensor_value *val)
+{
+	volatile float int_part = (float)val->val1;
+	volatile float frac_part = (float)val->val2;
+	volatile float fvalue;
+	uint32_t bits;
+
+	frac_part = frac_part / 1000000L;
+	fvalue = int_part + frac_part;
+
+	memcpy(&bits, (const float *)&fvalue, sizeof(bits));
+
+	return bits;
+}
+
+static int float32_decode_ref(uint32_t bits, struct sensor_value *val)
+{
+	volatile float fvalue;
+	volatile float million;
+
+	memcpy((float *)&fvalue, &bits, sizeof(bits));
+
+	if (!(fvalue > -2147483648.0f && fvalue < 2147483648.0f)) {
+		return -ERANGE;
+	}
+
+	million = fvalue * 1000000.0f;
+
+	val->val1 = (int32_t)fvalue;
+	val->val2 = (int64_t)million % 1000000L;
+
+	return 0;
+}
+
+static void encode_check(int32_t val1, int32_t val2)
+{
+	struct sensor_value val = { val1, val2 };
+
+	zassert_equal(float32_encode_ref(&val), sensor_float32_encode(&val),
+		      "Wrong encoding of %d.%06d", val1, val2);
+}
+
+static void encode_fractions_check(int32_t val1)
+{
+	for (int32_t val2 = -999999; val2 <= 999999; val2++) {
+		encode_check(val1, val2);
+	}
+}
+
+static void test_encode_small(void)
+{
+	for (int32_t val1 = -100; val1 <= 100; val1++) {
+		encode_fractions_check(val1);
+	}
+}
+
+static void test_encode_powers_of_two(void)
+{
+	/* Rounding of the integer part and of the sum changes at every power
+	 * of two.
+	 */
+	for (int shift = 7; shift < 31; shift++) {
+		for (int32_t delta = -1; delta <= 1; delta++) {
+			int32_t val1 = BIT(shift) + delta;
+
+			encode_fractions_check(val1);
+			encode_fractions_check(-val1);
+		}
+	}
+
+	encode_fractions_check(INT32_MAX);
+	encode_fractions_check(INT32_MIN);
+}
+
+static void test_encode_out_of_range_fraction(void)
+{
+	static const int32_t values[] = {
+		INT32_MIN, -1000000000, -1000000,
+		1000000,   1000000000,  INT32_MAX,
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(values); i++) {
+		for (size_t j = 0; j < ARRAY_SIZE(values); j++) {
+			encode_check(values[i], values[j]);
+		}
+	}
+}
+
+static void test_decode_all(void)
+{
+	uint32_t bits = 0;
+
+	do {
+		struct sensor_value expected = {};
+		struct sensor_value val = {};
+		int expected_err = float32_decode_ref(bits, &expected);
+		int err = sensor_float32_decode(bits, &val);
+
+		zassert_equal(expected_err, err, "Wrong error for 0x%08x",
+			      bits);
+		zassert_true(err || (expected.val1 == val.val1 &&
+				     expected.val2 == val.val2),
+			     "Wrong decoding of 0x%08x: %d.%06d != %d.%06d",
+			     bits, val.val1, val.val2, expected.val1,
+			     expected.val2);
+	} while (++bits != 0);
+}
+
+void test_main(void)
+{
+	ztest_test_suite(sensor_float_tests,
+			 ztest_unit_test(test_encode_small),
+			 ztest_unit_test(test_encode_powers_of_two),
+			 ztest_unit_test(test_encode_out_of_range_fraction),
+			 ztest_unit_test(test_decode_all)
+			 );
+
+	ztest_run_test_suite(sensor_float_tests);
+}
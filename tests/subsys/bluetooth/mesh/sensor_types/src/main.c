@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <ztest.h>
+#include <kernel.h>
+#include <bluetooth/mesh/sensor.h>
+
+#define TEST_BENCHMARK_CNT 100
+#define TEST_FORMAT_CNT_MAX 64
+
+extern const struct bt_mesh_sensor_type _bt_mesh_sensor_type_list_start[];
+extern const struct bt_mesh_sensor_type _bt_mesh_sensor_type_list_end[];
+
+#define TEST_TYPE_CNT                                                          \
+	(_bt_mesh_sensor_type_list_end - _bt_mesh_sensor_type_list_start)
+
+/* Linear search over the sensor types used as a reference. */
+static const struct bt_mesh_sensor_type *sensor_type_linear(uint16_t id)
+{
+	Z_STRUCT_SECTION_FOREACH(bt_mesh_sensor_type, type) {
+		if (type->id == id) {
+			return type;
+		}
+	}
+
+	return NULL;
+}
+
+static void test_types_sorted(void)
+{
+	zassert_true(TEST_TYPE_CNT > 0, "No sensor types in the build");
+
+	for (size_t i = 1; i < TEST_TYPE_CNT; i++) {
+		zassert_true(_bt_mesh_sensor_type_list_start[i - 1].id <
+				     _bt_mesh_sensor_type_list_start[i].id,
+			     "Sensor type 0x%04x is out of order",
+			     _bt_mesh_sensor_type_list_start[i].id);
+	}
+}
+
+static void test_lookup_all_ids(void)
+{
+	size_t found = 0;
+
+	for (uint32_t id = 0; id <= UINT16_MAX; id++) {
+		const struct bt_mesh_sensor_type *type =
+			bt_mesh_sensor_type_get(id);
+
+		zassert_equal_ptr(sensor_type_linear(id), type,
+				  "Invalid lookup of ID 0x%04x", id);
+		if (type) {
+			zassert_equal(id, type->id, "Wrong sensor type");
+			found++;
+		}
+	}
+
+	zassert_equal(TEST_TYPE_CNT, found,
+		      "Every sensor type should be found");
+}
+
+static void test_lookup_benchmark(void)
+{
+	const struct bt_mesh_sensor_type *types =
+		_bt_mesh_sensor_type_list_start;
+	uint32_t start;
+	uint32_t lookup_cycles;
+	uint32_t linear_cycles;
+	volatile uintptr_t sink = 0;
+
+	start = k_cycle_get_32();
+	for (size_t n = 0; n < TEST_BENCHMARK_CNT; n++) {
+		for (size_t i = 0; i < TEST_TYPE_CNT; i++) {
+			sink += (uintptr_t)bt_mesh_sensor_type_get(types[i].id);
+		}
+	}
+	lookup_cycles = k_cycle_get_32() - start;
+
+	start = k_cycle_get_32();
+	for (size_t n = 0; n < TEST_BENCHMARK_CNT; n++) {
+		for (size_t i = 0; i < TEST_TYPE_CNT; i++) {
+			sink += (uintptr_t)sensor_type_linear(types[i].id);
+		}
+	}
+	linear_cycles = k_cycle_get_32() - start;
+
+	const uint32_t lookup_cnt = TEST_BENCHMARK_CNT * TEST_TYPE_CNT;
+
+	TC_PRINT("%u sensor types\n", (uint32_t)TEST_TYPE_CNT);
+	TC_PRINT("Sorted lookup: %u cycles per type\n",
+		 lookup_cycles / lookup_cnt);
+	TC_PRINT("Linear search: %u cycles per type\n",
+		 linear_cycles / lookup_cnt);
+
+	zassert_true(lookup_cycles <= linear_cycles,
+		     "Sorted lookup should not be slower than linear search");
+}
+
+static void format_benchmark(const struct bt_mesh_sensor_format *format,
+			     const char *name)
+{
+	/* Fits in every format. */
+	const struct sensor_value val = { 0, 500000 };
+	struct sensor_value out;
+	struct net_buf_simple_state state;
+	uint32_t start;
+	uint32_t encode_cycles;
+	uint32_t decode_cycles;
+	int err = 0;
+
+	NET_BUF_SIMPLE_DEFINE(buf,
+			      CONFIG_BT_MESH_SENSOR_CHANNEL_ENCODED_SIZE_MAX);
+
+	start = k_cycle_get_32();
+	for (size_t n = 0; n < TEST_BENCHMARK_CNT; n++) {
+		net_buf_simple_reset(&buf);
+		err = format->encode(format, &val, &buf);
+	}
+	encode_cycles = k_cycle_get_32() - start;
+
+	zassert_equal(err, 0, "Encoding failed for %s (err %d)", name, err);
+
+	net_buf_simple_save(&buf, &state);
+
+	start = k_cycle_get_32();
+	for (size_t n = 0; n < TEST_BENCHMARK_CNT; n++) {
+		net_buf_simple_restore(&buf, &state);
+		err = format->decode(format, &buf, &out);
+	}
+	decode_cycles = k_cycle_get_32() - start;
+
+	zassert_equal(err, 0, "Decoding failed for %s (err %d)", name, err);
+
+	TC_PRINT("%-32s %u B: encode %u, decode %u cycles\n", name,
+		 format->size, encode_cycles / TEST_BENCHMARK_CNT,
+		 decode_cycles / TEST_BENCHMARK_CNT);
+}
+
+static void test_format_benchmark(void)
+{
+	const struct bt_mesh_sensor_format *formats[TEST_FORMAT_CNT_MAX];
+	size_t format_cnt = 0;
+
+	TC_PRINT("Integer float conversion: %s\n",
+		 IS_ENABLED(CONFIG_BT_MESH_SENSOR_INT_FLOAT) ? "yes" : "no");
+
+	Z_STRUCT_SECTION_FOREACH(bt_mesh_sensor_type, type) {
+		for (size_t i = 0; i < type->channel_count; i++) {
+			const struct bt_mesh_sensor_channel *ch =
+				&type->channels[i];
+			size_t j;
+
+			for (j = 0; j < format_cnt; j++) {
+				if (formats[j] == ch->format) {
+					break;
+				}
+			}
+
+			if (j < format_cnt) {
+				continue;
+			}
+
+			zassert_true(format_cnt < ARRAY_SIZE(formats),
+				     "Too many formats");
+			formats[format_cnt++] = ch->format;
+
+			/* Named by the first channel that uses the format. */
+			format_benchmark(ch->format, ch->name);
+		}
+	}
+}
+
+void test_main(void)
+{
+	ztest_test_suite(sensor_types_tests,
+			 ztest_unit_test(test_types_sorted),
+			 ztest_unit_test(test_lookup_all_ids),
+			 ztest_unit_test(test_lookup_benchmark),
+			 ztest_unit_test(test_format_benchmark)
+			 );
+
+	ztest_run_test_suite(sensor_types_tests);
+}
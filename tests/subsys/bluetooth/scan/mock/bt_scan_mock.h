@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef BT_SCAN_MOCK_H_
+#define BT_SCAN_MOCK_H_
+
+#include <bluetooth/bluetooth.h>
+
+/**
+ * @file
+ * @defgroup bt_scan_mock API
+ * @{
+ * @brief Mock of the Bluetooth host scanning API used by the bt_scan module.
+ */
+
+/**
+ * @brief Deliver an advertising report to the registered scan callbacks.
+ *
+ * @param addr      Advertiser address.
+ * @param adv_props Advertising properties, as BT_GAP_ADV_PROP_* flags.
+ * @param data      Advertising data.
+ * @param len       Length of the advertising data.
+ */
+void bt_scan_mock_report(const bt_addr_le_t *addr, uint8_t adv_props,
+			 const uint8_t *data, uint8_t len);
+
+/**
+ * @}
+ */
+
+#endif /* BT_SCAN_MOCK_H_ */
@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+#include <sys/byteorder.h>
+#include <bluetooth/uuid.h>
+
+#include "adv_capture.h"
+
+#define CAPTURE_SEED 0x2545f491
+
+enum adv_profile {
+	PROFILE_IBEACON,
+	PROFILE_PHONE,
+	PROFILE_EDDYSTONE,
+	PROFILE_HRS,
+	PROFILE_LBS,
+	PROFILE_KEYBOARD,
+	PROFILE_THINGY,
+	PROFILE_VENDOR,
+	PROFILE_SENSOR,
+	PROFILE_HRS_128,
+
+	PROFILE_CNT
+};
+
+/* Share of devices using each profile, in sixteenths. Most of the
+ * advertisers around are phones and other devices the filters do not
+ * look for.
+ */
+static const uint8_t profile_weights[PROFILE_CNT] = {
+	[PROFILE_IBEACON] = 1,
+	[PROFILE_PHONE] = 5,
+	[PROFILE_EDDYSTONE] = 1,
+	[PROFILE_HRS] = 1,
+	[PROFILE_LBS] = 1,
+	[PROFILE_KEYBOARD] = 1,
+	[PROFILE_THINGY] = 1,
+	[PROFILE_VENDOR] = 3,
+	[PROFILE_SENSOR] = 1,
+	[PROFILE_HRS_128] = 1,
+};
+
+struct adv_device {
+	bt_addr_le_t addr;
+	enum adv_profile profile;
+};
+
+static struct adv_device devices[ADV_CAPTURE_DEVICE_CNT];
+static uint32_t prng_state;
+
+static uint32_t prng(void)
+{
+	/* xorshift32 */
+	prng_state ^= prng_state << 13;
+	prng_state ^= prng_state >> 17;
+	prng_state ^= prng_state << 5;
+
+	return prng_state;
+}
+
+static void prng_fill(uint8_t *buf, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		buf[i] = prng();
+	}
+}
+
+static void prng_name(uint8_t *buf, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		buf[i] = 'A' + prng() % 26;
+	}
+}
+
+static enum adv_profile profile_pick(void)
+{
+	uint32_t val = prng() % 16;
+
+	for (size_t i = 0; i < ARRAY_SIZE(profile_weights); i++) {
+		if (val < profile_weights[i]) {
+			return i;
+		}
+
+		val -= profile_weights[i];
+	}
+
+	return PROFILE_PHONE;
+}
+
+static uint8_t *ad_add(struct adv_report *report, uint8_t type, uint8_t len)
+{
+	uint8_t *data = &report->data[report->len];
+
+	data[0] = len + 1;
+	data[1] = type;
+	report->len += len + 2;
+
+	return &data[2];
+}
+
+static void ad_add_data(struct adv_report *report, uint8_t type,
+			const void *data, uint8_t len)
+{
+	memcpy(ad_add(report, type, len), data, len);
+}
+
+static void ad_add_flags(struct adv_report *report, uint8_t flags)
+{
+	ad_add_data(report, BT_DATA_FLAGS, &flags, sizeof(flags));
+}
+
+static void ad_add_uuid16(struct adv_report *report, uint8_t type,
+			  uint16_t val)
+{
+	sys_put_le16(val, ad_add(report, type, sizeof(val)));
+}
+
+static void report_build(struct adv_report *report,
+			 const struct adv_device *device)
+{
+	static const uint8_t lbs[] = { ADV_CAPTURE_UUID_LBS_VAL };
+	static const uint8_t hrs_128[] = { BT_UUID_128_ENCODE(
+		BT_UUID_HRS_VAL, 0x0000, 0x1000, 0x8000, 0x00805f9b34fb) };
+	uint8_t *data;
+
+	memset(report, 0, sizeof(*report));
+	bt_addr_le_copy(&report->addr, &device->addr);
+	report->adv_props = BT_GAP_ADV_PROP_CONNECTABLE |
+			    BT_GAP_ADV_PROP_SCANNABLE;
+
+	switch (device->profile) {
+	case PROFILE_IBEACON:
+		report->adv_props = 0;
+		ad_add_flags(report, BT_LE_AD_NO_BREDR);
+		data = ad_add(report, BT_DATA_MANUFACTURER_DATA, 25);
+		sys_put_le16(ADV_CAPTURE_COMPANY_APPLE, data);
+		data[2] = 0x02;
+		data[3] = 0x15;
+		prng_fill(&data[4], 21);
+		break;
+
+	case PROFILE_PHONE:
+		ad_add_flags(report, 0x1a);
+		data = ad_add(report, BT_DATA_MANUFACTURER_DATA, 9);
+		sys_put_le16(ADV_CAPTURE_COMPANY_APPLE, data);
+		data[2] = 0x10;
+		data[3] = 0x05;
+		prng_fill(&data[4], 5);
+		break;
+
+	case PROFILE_EDDYSTONE:
+		report->adv_props = 0;
+		ad_add_flags(report, BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR);
+		ad_add_uuid16(report, BT_DATA_UUID16_ALL, 0xfeaa);
+		data = ad_add(report, BT_DATA_SVC_DATA16, 15);
+		sys_put_le16(0xfeaa, data);
+		data[2] = 0x10;
+		data[3] = 0x00;
+		prng_name(&data[4], 11);
+		break;
+
+	case PROFILE_HRS:
+		ad_add_flags(report, BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR);
+		data = ad_add(report, BT_DATA_UUID16_ALL, 4);
+		sys_put_le16(BT_UUID_HRS_VAL, &data[0]);
+		sys_put_le16(BT_UUID_BAS_VAL, &data[2]);
+		ad_add_data(report, BT_DATA_NAME_COMPLETE, ADV_CAPTURE_NAME_HRS,
+			    strlen(ADV_CAPTURE_NAME_HRS));
+		break;
+
+	case PROFILE_LBS:
+		ad_add_flags(report, BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR);
+		ad_add_data(report, BT_DATA_UUID128_ALL, lbs, sizeof(lbs));
+		prng_name(ad_add(report, BT_DATA_NAME_COMPLETE, 6), 6);
+		break;
+
+	case PROFILE_KEYBOARD:
+		ad_add_flags(report, BT_LE_AD_LIMITED | BT_LE_AD_NO_BREDR);
+		/* Big endian, as bt_scan expects it. */
+		sys_put_be16(ADV_CAPTURE_APPEARANCE_KBD,
+			     ad_add(report, BT_DATA_GAP_APPEARANCE, 2));
+		ad_add_uuid16(report, BT_DATA_UUID16_ALL, BT_UUID_HIDS_VAL);
+		ad_add_data(report, BT_DATA_NAME_SHORTENED,
+			    ADV_CAPTURE_SHORT_NAME_KBD,
+			    strlen(ADV_CAPTURE_SHORT_NAME_KBD));
+		break;
+
+	case PROFILE_THINGY:
+		ad_add_flags(report, BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR);
+		ad_add_data(report, BT_DATA_NAME_COMPLETE,
+			    ADV_CAPTURE_NAME_THINGY,
+			    strlen(ADV_CAPTURE_NAME_THINGY));
+		sys_put_le32(ADV_CAPTURE_UUID_32,
+			     ad_add(report, BT_DATA_UUID32_ALL, 4));
+		data = ad_add(report, BT_DATA_MANUFACTURER_DATA, 6);
+		sys_put_le16(ADV_CAPTURE_COMPANY_NORDIC, data);
+		prng_fill(&data[2], 4);
+		break;
+
+	case PROFILE_VENDOR:
+		report->adv_props = BT_GAP_ADV_PROP_SCANNABLE;
+		ad_add_flags(report, BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR);
+		data = ad_add(report, BT_DATA_MANUFACTURER_DATA, 26);
+		sys_put_le16(0x0006, data);
+		prng_fill(&data[2], 24);
+		break;
+
+	case PROFILE_SENSOR:
+		ad_add_flags(report, BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR);
+		data = ad_add(report, BT_DATA_UUID16_SOME, 4);
+		sys_put_le16(BT_UUID_BAS_VAL, &data[0]);
+		sys_put_le16(BT_UUID_ESS_VAL, &data[2]);
+		sys_put_be16(prng() % 0x0c00,
+			     ad_add(report, BT_DATA_GAP_APPEARANCE, 2));
+		prng_name(ad_add(report, BT_DATA_NAME_COMPLETE, 10), 10);
+		break;
+
+	case PROFILE_HRS_128:
+		ad_add_flags(report, BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR);
+		ad_add_data(report, BT_DATA_UUID128_SOME, hrs_128,
+			    sizeof(hrs_128));
+		/* Short name sharing a prefix with the complete one. */
+		ad_add_data(report, BT_DATA_NAME_SHORTENED, "Nordic", 6);
+		break;
+
+	default:
+		break;
+	}
+}
+
+void adv_capture_build(struct adv_report *reports)
+{
+	prng_state = CAPTURE_SEED;
+
+	for (size_t i = 0; i < ARRAY_SIZE(devices); i++) {
+		struct adv_device *device = &devices[i];
+
+		prng_fill(device->addr.a.val, sizeof(device->addr.a.val));
+
+		if (i % 2) {
+			/* Random static address. */
+			device->addr.type = BT_ADDR_LE_RANDOM;
+			BT_ADDR_SET_STATIC(&device->addr.a);
+		} else {
+			device->addr.type = BT_ADDR_LE_PUBLIC;
+		}
+
+		device->profile = profile_pick();
+	}
+
+	for (size_t i = 0; i < ADV_CAPTURE_REPORT_CNT; i++) {
+		/* A few of the devices advertise much more often than
+		 * the others.
+		 */
+		size_t device = (prng() % 4) ? (prng() % ARRAY_SIZE(devices)) :
+					      (prng() % 8);
+
+		report_build(&reports[i], &devices[device]);
+	}
+}
+
+const bt_addr_le_t *adv_capture_addr(size_t device)
+{
+	return &devices[device].addr;
+}
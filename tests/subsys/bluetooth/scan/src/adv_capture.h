@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef ADV_CAPTURE_H_
+#define ADV_CAPTURE_H_
+
+#include <stddef.h>
+#include <bluetooth/bluetooth.h>
+#include <bluetooth/gap.h>
+
+/* Advertised names and values that the test filters look for. */
+#define ADV_CAPTURE_NAME_HRS "Nordic_HRS"
+#define ADV_CAPTURE_NAME_THINGY "Thingy"
+#define ADV_CAPTURE_SHORT_NAME_KBD "Nordic_Kbd"
+#define ADV_CAPTURE_APPEARANCE_KBD 0x03c1
+#define ADV_CAPTURE_COMPANY_NORDIC 0x0059
+#define ADV_CAPTURE_COMPANY_APPLE 0x004c
+#define ADV_CAPTURE_UUID_32 0x6e400001
+#define ADV_CAPTURE_UUID_LBS_VAL                                               \
+	BT_UUID_128_ENCODE(0x00001523, 0x1212, 0xefde, 0x1523, 0x785feabcd123)
+
+/** Number of different advertisers in the capture. */
+#define ADV_CAPTURE_DEVICE_CNT 128
+
+/** Number of advertising reports in the capture. */
+#define ADV_CAPTURE_REPORT_CNT 2048
+
+/** Recorded advertising report. */
+struct adv_report {
+	/** Advertiser address. */
+	bt_addr_le_t addr;
+
+	/** Advertising properties, as BT_GAP_ADV_PROP_* flags. */
+	uint8_t adv_props;
+
+	/** Length of the advertising data. */
+	uint8_t len;
+
+	/** Advertising data. */
+	uint8_t data[BT_GAP_ADV_MAX_ADV_DATA_LEN];
+};
+
+/** @brief Build the advertising report capture.
+ *
+ *  The capture mimics a busy scanning environment: beacons, phones,
+ *  wearables, sensors and HID devices advertising at different rates. It is
+ *  generated from a fixed seed, so every run replays the same reports.
+ *
+ *  @param reports Array of at least @ref ADV_CAPTURE_REPORT_CNT reports.
+ */
+void adv_capture_build(struct adv_report *reports);
+
+/** @brief Get the address of a device in the capture.
+ *
+ *  @param device Index of the device, less than @ref ADV_CAPTURE_DEVICE_CNT.
+ *
+ *  @return Device address.
+ */
+const bt_addr_le_t *adv_capture_addr(size_t device);
+
+#endif /* ADV_CAPTURE_H_ */
@@ -0,0 +1,639 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <string.h>
+#include <ztest.h>
+#include <kernel.h>
+#include <sys/byteorder.h>
+#include <bluetooth/uuid.h>
+#include <bluetooth/scan.h>
+
+#include "adv_capture.h"
+#include "../mock/bt_scan_mock.h"
+
+#define TEST_BENCHMARK_CNT 10
+
+/* Number of bits in the filter mode mask. */
+#define TEST_FILTER_BITS 8
+
+/* Filter types that are checked against the advertising data. */
+#define TEST_FILTER_TYPES                                                      \
+	(BT_SCAN_NAME_FILTER | BT_SCAN_SHORT_NAME_FILTER |                    \
+	 BT_SCAN_ADDR_FILTER | BT_SCAN_UUID_FILTER |                           \
+	 BT_SCAN_APPEARANCE_FILTER | BT_SCAN_MANUFACTURER_DATA_FILTER)
+
+static const struct bt_scan_short_name test_short_name = {
+	.name = ADV_CAPTURE_SHORT_NAME_KBD,
+	.min_len = 6,
+};
+
+static const struct bt_uuid_16 test_uuid_hrs =
+	BT_UUID_INIT_16(BT_UUID_HRS_VAL);
+/* Battery Service in the 128-bit form. Advertised as a 16-bit UUID. */
+static const struct bt_uuid_128 test_uuid_bas = BT_UUID_INIT_128(
+	BT_UUID_128_ENCODE(BT_UUID_BAS_VAL, 0x0000, 0x1000, 0x8000,
+			   0x00805f9b34fb));
+static const struct bt_uuid_32 test_uuid_32 =
+	BT_UUID_INIT_32(ADV_CAPTURE_UUID_32);
+static const struct bt_uuid_128 test_uuid_lbs =
+	BT_UUID_INIT_128(ADV_CAPTURE_UUID_LBS_VAL);
+
+static const uint16_t test_appearance = ADV_CAPTURE_APPEARANCE_KBD;
+
+static uint8_t test_nordic_data[] = { 0x59, 0x00 };
+static uint8_t test_ibeacon_data[] = { 0x4c, 0x00, 0x02, 0x15 };
+static const struct bt_scan_manufacturer_data test_nordic = {
+	.data = test_nordic_data,
+	.data_len = sizeof(test_nordic_data),
+};
+static const struct bt_scan_manufacturer_data test_ibeacon = {
+	.data = test_ibeacon_data,
+	.data_len = sizeof(test_ibeacon_data),
+};
+
+/* Capture devices used as address filters. */
+static const size_t test_addr_devices[] = { 0, 3, 17, 42, 99, 127 };
+
+static struct adv_report reports[ADV_CAPTURE_REPORT_CNT];
+
+/* Reference copy of the filters added to bt_scan. */
+static struct {
+	const char *name[CONFIG_BT_SCAN_NAME_CNT];
+	size_t name_cnt;
+	const struct bt_scan_short_name
+		*short_name[CONFIG_BT_SCAN_SHORT_NAME_CNT];
+	size_t short_name_cnt;
+	const bt_addr_le_t *addr[CONFIG_BT_SCAN_ADDRESS_CNT];
+	size_t addr_cnt;
+	const struct bt_uuid *uuid[CONFIG_BT_SCAN_UUID_CNT];
+	size_t uuid_cnt;
+	const uint16_t *appearance[CONFIG_BT_SCAN_APPEARANCE_CNT];
+	size_t appearance_cnt;
+	const struct bt_scan_manufacturer_data
+		*manufacturer_data[CONFIG_BT_SCAN_MANUFACTURER_DATA_CNT];
+	size_t manufacturer_data_cnt;
+	uint8_t mode;
+	bool all_mode;
+} ref;
+
+struct ref_result {
+	uint8_t match_mask;
+	uint8_t uuid_cnt;
+};
+
+static struct {
+	uint32_t match_cnt;
+	uint32_t no_match_cnt;
+	uint8_t match_mask;
+	uint8_t uuid_cnt;
+} result;
+
+static uint8_t filter_match_mask(const struct bt_scan_filter_match *match)
+{
+	uint8_t mask = 0;
+
+	mask |= match->name.match ? BT_SCAN_NAME_FILTER : 0;
+	mask |= match->short_name.match ? BT_SCAN_SHORT_NAME_FILTER : 0;
+	mask |= match->addr.match ? BT_SCAN_ADDR_FILTER : 0;
+	mask |= match->uuid.match ? BT_SCAN_UUID_FILTER : 0;
+	mask |= match->appearance.match ? BT_SCAN_APPEARANCE_FILTER : 0;
+	mask |= match->manufacturer_data.match ?
+			BT_SCAN_MANUFACTURER_DATA_FILTER : 0;
+
+	return mask;
+}
+
+static void scan_filter_match(struct bt_scan_device_info *device_info,
+			      struct bt_scan_filter_match *filter_match,
+			      bool connectable)
+{
+	result.match_cnt++;
+	result.match_mask = filter_match_mask(filter_match);
+	result.uuid_cnt = filter_match->uuid.count;
+}
+
+static void scan_filter_no_match(struct bt_scan_device_info *device_info,
+				 bool connectable)
+{
+	result.no_match_cnt++;
+}
+
+BT_SCAN_CB_INIT(scan_cb, scan_filter_match, scan_filter_no_match, NULL, NULL);
+
+static void test_filter_add(enum bt_scan_filter_type type, const void *data)
+{
+	int err = bt_scan_filter_add(type, data);
+
+	zassert_equal(err, 0, "Adding filter of type %d failed (err %d)",
+		      type, err);
+
+	switch (type) {
+	case BT_SCAN_FILTER_TYPE_NAME:
+		ref.name[ref.name_cnt++] = data;
+		break;
+	case BT_SCAN_FILTER_TYPE_SHORT_NAME:
+		ref.short_name[ref.short_name_cnt++] = data;
+		break;
+	case BT_SCAN_FILTER_TYPE_ADDR:
+		ref.addr[ref.addr_cnt++] = data;
+		break;
+	case BT_SCAN_FILTER_TYPE_UUID:
+		ref.uuid[ref.uuid_cnt++] = data;
+		break;
+	case BT_SCAN_FILTER_TYPE_APPEARANCE:
+		ref.appearance[ref.appearance_cnt++] = data;
+		break;
+	case BT_SCAN_FILTER_TYPE_MANUFACTURER_DATA:
+		ref.manufacturer_data[ref.manufacturer_data_cnt++] = data;
+		break;
+	default:
+		zassert_unreachable("Unknown filter type %d", type);
+	}
+}
+
+static void test_filter_enable(uint8_t mode, bool all_mode)
+{
+	int err = bt_scan_filter_enable(mode, all_mode);
+
+	zassert_equal(err, 0, "Enabling filters failed (err %d)", err);
+
+	ref.mode = mode;
+	ref.all_mode = all_mode;
+}
+
+static void test_filters_reset(void)
+{
+	bt_scan_filter_remove_all();
+	bt_scan_filter_disable();
+	bt_scan_filter_stats_reset();
+	memset(&ref, 0, sizeof(ref));
+}
+
+static void test_filters_all_add(void)
+{
+	test_filter_add(BT_SCAN_FILTER_TYPE_NAME, ADV_CAPTURE_NAME_HRS);
+	test_filter_add(BT_SCAN_FILTER_TYPE_NAME, ADV_CAPTURE_NAME_THINGY);
+	test_filter_add(BT_SCAN_FILTER_TYPE_SHORT_NAME, &test_short_name);
+
+	for (size_t i = 0; i < ARRAY_SIZE(test_addr_devices); i++) {
+		test_filter_add(BT_SCAN_FILTER_TYPE_ADDR,
+				adv_capture_addr(test_addr_devices[i]));
+	}
+
+	test_filter_add(BT_SCAN_FILTER_TYPE_UUID, &test_uuid_hrs);
+	test_filter_add(BT_SCAN_FILTER_TYPE_UUID, &test_uuid_bas);
+	test_filter_add(BT_SCAN_FILTER_TYPE_UUID, &test_uuid_32);
+	test_filter_add(BT_SCAN_FILTER_TYPE_UUID, &test_uuid_lbs);
+	test_filter_add(BT_SCAN_FILTER_TYPE_APPEARANCE, &test_appearance);
+	test_filter_add(BT_SCAN_FILTER_TYPE_MANUFACTURER_DATA, &test_nordic);
+	test_filter_add(BT_SCAN_FILTER_TYPE_MANUFACTURER_DATA, &test_ibeacon);
+}
+
+/* Get the next AD structure, with the same rules as bt_data_parse(). */
+static bool ref_ad_next(const struct adv_report *report, size_t *offset,
+			struct bt_data *ad)
+{
+	if (report->len - *offset <= 1) {
+		return false;
+	}
+
+	uint8_t len = report->data[*offset];
+
+	if ((len == 0) || (len > report->len - *offset - 1)) {
+		return false;
+	}
+
+	ad->type = report->data[*offset + 1];
+	ad->data_len = len - 1;
+	ad->data = &report->data[*offset + 2];
+	*offset += len + 1;
+
+	return true;
+}
+
+static bool ref_name_match(const struct adv_report *report)
+{
+	for (size_t i = 0; i < ref.name_cnt; i++) {
+		struct bt_data ad;
+		size_t offset = 0;
+
+		while (ref_ad_next(report, &offset, &ad)) {
+			if ((ad.type == BT_DATA_NAME_COMPLETE) &&
+			    !strncmp(ref.name[i], (const char *)ad.data,
+				     ad.data_len)) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+static bool ref_short_name_match(const struct adv_report *report)
+{
+	for (size_t i = 0; i < ref.short_name_cnt; i++) {
+		const struct bt_scan_short_name *name = ref.short_name[i];
+		struct bt_data ad;
+		size_t offset = 0;
+
+		while (ref_ad_next(report, &offset, &ad)) {
+			if ((ad.type == BT_DATA_NAME_SHORTENED) &&
+			    (ad.data_len >= name->min_len) &&
+			    !strncmp(name->name, (const char *)ad.data,
+				     ad.data_len)) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+static bool ref_addr_match(const struct adv_report *report)
+{
+	for (size_t i = 0; i < ref.addr_cnt; i++) {
+		if (!bt_addr_le_cmp(ref.addr[i], &report->addr)) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static size_t ref_uuid_len(uint8_t type)
+{
+	switch (type) {
+	case BT_DATA_UUID16_SOME:
+	case BT_DATA_UUID16_ALL:
+		return 2;
+	case BT_DATA_UUID32_SOME:
+	case BT_DATA_UUID32_ALL:
+		return 4;
+	case BT_DATA_UUID128_SOME:
+	case BT_DATA_UUID128_ALL:
+		return 16;
+	default:
+		return 0;
+	}
+}
+
+static bool ref_uuid_find(const struct adv_report *report,
+			  const struct bt_uuid *uuid)
+{
+	struct bt_data ad;
+	size_t offset = 0;
+
+	while (ref_ad_next(report, &offset, &ad)) {
+		size_t len = ref_uuid_len(ad.type);
+
+		if (!len) {
+			continue;
+		}
+
+		for (size_t i = 0; (i + len) <= ad.data_len; i += len) {
+			struct bt_uuid_128 adv_uuid;
+
+			zassert_true(bt_uuid_create(&adv_uuid.uuid,
+						    &ad.data[i], len),
+				     "Invalid UUID");
+
+			if (!bt_uuid_cmp(&adv_uuid.uuid, uuid)) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+static uint8_t ref_uuid_count(const struct adv_report *report)
+{
+	uint8_t count = 0;
+
+	for (size_t i = 0; i < ref.uuid_cnt; i++) {
+		if (ref_uuid_find(report, ref.uuid[i])) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static bool ref_appearance_match(const struct adv_report *report)
+{
+	for (size_t i = 0; i < ref.appearance_cnt; i++) {
+		struct bt_data ad;
+		size_t offset = 0;
+
+		while (ref_ad_next(report, &offset, &ad)) {
+			if ((ad.type == BT_DATA_GAP_APPEARANCE) &&
+			    (ad.data_len == sizeof(uint16_t)) &&
+			    (sys_get_be16(ad.data) == *ref.appearance[i])) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+static bool ref_manufacturer_data_match(const struct adv_report *report)
+{
+	for (size_t i = 0; i < ref.manufacturer_data_cnt; i++) {
+		const struct bt_scan_manufacturer_data *md =
+			ref.manufacturer_data[i];
+		struct bt_data ad;
+		size_t offset = 0;
+
+		while (ref_ad_next(report, &offset, &ad)) {
+			if ((ad.type == BT_DATA_MANUFACTURER_DATA) &&
+			    (md->data_len <= ad.data_len) &&
+			    !memcmp(md->data, ad.data, md->data_len)) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+/* Straightforward filter matching, with one pass over the advertising data
+ * for every filter.
+ */
+static struct ref_result ref_match(const struct adv_report *report)
+{
+	struct ref_result res = { 0 };
+
+	if ((ref.mode & BT_SCAN_NAME_FILTER) && ref_name_match(report)) {
+		res.match_mask |= BT_SCAN_NAME_FILTER;
+	}
+
+	if ((ref.mode & BT_SCAN_SHORT_NAME_FILTER) &&
+	    ref_short_name_match(report)) {
+		res.match_mask |= BT_SCAN_SHORT_NAME_FILTER;
+	}
+
+	if ((ref.mode & BT_SCAN_ADDR_FILTER) && ref_addr_match(report)) {
+		res.match_mask |= BT_SCAN_ADDR_FILTER;
+	}
+
+	if (ref.mode & BT_SCAN_UUID_FILTER) {
+		res.uuid_cnt = ref_uuid_count(report);
+
+		if ((res.uuid_cnt > 0) &&
+		    (!ref.all_mode || (res.uuid_cnt == ref.uuid_cnt))) {
+			res.match_mask |= BT_SCAN_UUID_FILTER;
+		}
+	}
+
+	if ((ref.mode & BT_SCAN_APPEARANCE_FILTER) &&
+	    ref_appearance_match(report)) {
+		res.match_mask |= BT_SCAN_APPEARANCE_FILTER;
+	}
+
+	if ((ref.mode & BT_SCAN_MANUFACTURER_DATA_FILTER) &&
+	    ref_manufacturer_data_match(report)) {
+		res.match_mask |= BT_SCAN_MANUFACTURER_DATA_FILTER;
+	}
+
+	return res;
+}
+
+static bool ref_is_match(const struct ref_result *res)
+{
+	if (ref.all_mode) {
+		return res->match_mask == ref.mode;
+	}
+
+	return res->match_mask != 0;
+}
+
+static void report_send(const struct adv_report *report)
+{
+	bt_scan_mock_report(&report->addr, report->adv_props, report->data,
+			    report->len);
+}
+
+static void counters_check(const struct bt_scan_filter_counters *counters,
+			   const uint32_t *hits, uint8_t filter)
+{
+	uint32_t hit = 0;
+
+	if (ref.mode & filter) {
+		hit = hits[find_lsb_set(filter) - 1];
+	}
+
+	zassert_equal(counters->hit, hit, "Filter 0x%02x: %u hits, expected %u",
+		      filter, counters->hit, hit);
+	zassert_equal(counters->hit + counters->miss,
+		      (ref.mode & filter) ? ADV_CAPTURE_REPORT_CNT : 0,
+		      "Filter 0x%02x: invalid report count", filter);
+}
+
+/* Replay the capture and compare every report with the reference. */
+static void capture_replay_check(void)
+{
+	uint32_t hits[TEST_FILTER_BITS] = { 0 };
+	struct bt_scan_filter_stats stats;
+	uint32_t match_cnt = 0;
+	int err;
+
+	memset(&result, 0, sizeof(result));
+
+	for (uint32_t i = 0; i < ARRAY_SIZE(reports); i++) {
+		struct ref_result res = ref_match(&reports[i]);
+		uint32_t prev_match_cnt = result.match_cnt;
+
+		for (size_t j = 0; j < ARRAY_SIZE(hits); j++) {
+			hits[j] += !!(res.match_mask & BIT(j));
+		}
+
+		report_send(&reports[i]);
+
+		zassert_equal(result.match_cnt + result.no_match_cnt, i + 1,
+			      "Report %u: no callback", i);
+
+		if (!ref_is_match(&res)) {
+			zassert_equal(result.match_cnt, prev_match_cnt,
+				      "Report %u: unexpected match", i);
+			continue;
+		}
+
+		zassert_equal(result.match_cnt, prev_match_cnt + 1,
+			      "Report %u: no match", i);
+		zassert_equal(result.match_mask, res.match_mask,
+			      "Report %u: filters 0x%02x, expected 0x%02x", i,
+			      result.match_mask, res.match_mask);
+		zassert_equal(result.uuid_cnt, res.uuid_cnt,
+			      "Report %u: %u UUIDs, expected %u", i,
+			      result.uuid_cnt, res.uuid_cnt);
+		match_cnt++;
+	}
+
+	/* The capture must exercise both outcomes. */
+	zassert_true(match_cnt > 0, "No reports matched");
+	zassert_true(match_cnt < ARRAY_SIZE(reports), "All reports matched");
+
+	err = bt_scan_filter_stats_get(&stats);
+	zassert_equal(err, 0, "Getting statistics failed (err %d)", err);
+
+	zassert_equal(stats.reports, ADV_CAPTURE_REPORT_CNT,
+		      "Invalid report count");
+	counters_check(&stats.name, hits, BT_SCAN_NAME_FILTER);
+	counters_check(&stats.short_name, hits, BT_SCAN_SHORT_NAME_FILTER);
+	counters_check(&stats.addr, hits, BT_SCAN_ADDR_FILTER);
+	counters_check(&stats.uuid, hits, BT_SCAN_UUID_FILTER);
+	counters_check(&stats.appearance, hits, BT_SCAN_APPEARANCE_FILTER);
+	counters_check(&stats.manufacturer_data, hits,
+		       BT_SCAN_MANUFACTURER_DATA_FILTER);
+}
+
+static void test_filter_duplicates(void)
+{
+	const struct bt_uuid_128 uuid_hrs_128 = BT_UUID_INIT_128(
+		BT_UUID_128_ENCODE(BT_UUID_HRS_VAL, 0x0000, 0x1000, 0x8000,
+				   0x00805f9b34fb));
+	const struct bt_uuid_16 uuid_hids = BT_UUID_INIT_16(BT_UUID_HIDS_VAL);
+	bt_addr_le_t addr = { .type = BT_ADDR_LE_RANDOM };
+	int err;
+
+	test_filters_reset();
+
+	/* Duplicates do not take up filter slots. */
+	for (uint32_t i = 0; i < CONFIG_BT_SCAN_ADDRESS_CNT - 1; i++) {
+		addr.a.val[0] = i;
+
+		err = bt_scan_filter_add(BT_SCAN_FILTER_TYPE_ADDR, &addr);
+		zassert_equal(err, 0, "Adding address %u failed", i);
+		err = bt_scan_filter_add(BT_SCAN_FILTER_TYPE_ADDR, &addr);
+		zassert_equal(err, 0, "Adding duplicate %u failed", i);
+	}
+
+	addr.a.val[0] = CONFIG_BT_SCAN_ADDRESS_CNT - 1;
+	err = bt_scan_filter_add(BT_SCAN_FILTER_TYPE_ADDR, &addr);
+	zassert_equal(err, 0, "Adding last address failed");
+
+	addr.a.val[0] = CONFIG_BT_SCAN_ADDRESS_CNT;
+	err = bt_scan_filter_add(BT_SCAN_FILTER_TYPE_ADDR, &addr);
+	zassert_equal(err, -ENOMEM, "Too many addresses added");
+
+	/* A UUID is the same filter in its 16-bit and 128-bit forms. */
+	err = bt_scan_filter_add(BT_SCAN_FILTER_TYPE_UUID, &test_uuid_hrs);
+	zassert_equal(err, 0, "Adding UUID failed");
+	err = bt_scan_filter_add(BT_SCAN_FILTER_TYPE_UUID, &uuid_hrs_128);
+	zassert_equal(err, 0, "Adding 128-bit form of UUID failed");
+
+	err = bt_scan_filter_add(BT_SCAN_FILTER_TYPE_UUID, &test_uuid_bas);
+	zassert_equal(err, 0, "Adding 128-bit UUID failed");
+	err = bt_scan_filter_add(BT_SCAN_FILTER_TYPE_UUID, &test_uuid_32);
+	zassert_equal(err, 0, "Adding 32-bit UUID failed");
+	err = bt_scan_filter_add(BT_SCAN_FILTER_TYPE_UUID, &test_uuid_lbs);
+	zassert_equal(err, 0, "Adding 128-bit UUID failed");
+	err = bt_scan_filter_add(BT_SCAN_FILTER_TYPE_UUID, &uuid_hids);
+	zassert_equal(err, -ENOMEM, "Too many UUIDs added");
+
+	/* Removed filters can be added again. */
+	bt_scan_filter_remove_all();
+
+	err = bt_scan_filter_add(BT_SCAN_FILTER_TYPE_ADDR, &addr);
+	zassert_equal(err, 0, "Adding address after removal failed");
+}
+
+static void test_replay_any_mode(void)
+{
+	test_filters_reset();
+	test_filters_all_add();
+	test_filter_enable(TEST_FILTER_TYPES, false);
+
+	capture_replay_check();
+}
+
+static void test_replay_all_mode(void)
+{
+	test_filters_reset();
+	test_filter_add(BT_SCAN_FILTER_TYPE_NAME, ADV_CAPTURE_NAME_HRS);
+	test_filter_add(BT_SCAN_FILTER_TYPE_UUID, &test_uuid_hrs);
+	test_filter_add(BT_SCAN_FILTER_TYPE_UUID, &test_uuid_bas);
+	test_filter_enable(BT_SCAN_NAME_FILTER | BT_SCAN_UUID_FILTER, true);
+
+	capture_replay_check();
+}
+
+static void test_replay_single_filter(void)
+{
+	/* Without filters on the advertising data, it is not parsed. */
+	test_filters_reset();
+
+	for (size_t i = 0; i < ARRAY_SIZE(test_addr_devices); i++) {
+		test_filter_add(BT_SCAN_FILTER_TYPE_ADDR,
+				adv_capture_addr(test_addr_devices[i]));
+	}
+
+	test_filter_enable(BT_SCAN_ADDR_FILTER, false);
+
+	capture_replay_check();
+}
+
+static void test_benchmark(void)
+{
+	uint32_t start;
+	uint32_t scan_cycles;
+	uint32_t ref_cycles;
+	uint32_t ref_match_cnt = 0;
+	uint32_t report_cnt = TEST_BENCHMARK_CNT * ARRAY_SIZE(reports);
+
+	test_filters_reset();
+	test_filters_all_add();
+	test_filter_enable(TEST_FILTER_TYPES, false);
+
+	memset(&result, 0, sizeof(result));
+
+	start = k_cycle_get_32();
+
+	for (size_t i = 0; i < TEST_BENCHMARK_CNT; i++) {
+		for (size_t j = 0; j < ARRAY_SIZE(reports); j++) {
+			report_send(&reports[j]);
+		}
+	}
+
+	scan_cycles = k_cycle_get_32() - start;
+
+	start = k_cycle_get_32();
+
+	for (size_t i = 0; i < TEST_BENCHMARK_CNT; i++) {
+		for (size_t j = 0; j < ARRAY_SIZE(reports); j++) {
+			struct ref_result res = ref_match(&reports[j]);
+
+			ref_match_cnt += ref_is_match(&res);
+		}
+	}
+
+	ref_cycles = k_cycle_get_32() - start;
+
+	zassert_equal(result.match_cnt, ref_match_cnt, "Wrong match count");
+
+	TC_PRINT("%u reports, %u matched\n", report_cnt, ref_match_cnt);
+	TC_PRINT("bt_scan: %u cycles per report\n", scan_cycles / report_cnt);
+	TC_PRINT("Reference: %u cycles per report\n",
+		 ref_cycles / report_cnt);
+}
+
+void test_main(void)
+{
+	adv_capture_build(reports);
+
+	bt_scan_init(NULL);
+	bt_scan_cb_register(&scan_cb);
+
+	ztest_test_suite(bt_scan_test,
+			 ztest_unit_test(test_filter_duplicates),
+			 ztest_unit_test(test_replay_any_mode),
+			 ztest_unit_test(test_replay_all_mode),
+			 ztest_unit_test(test_replay_single_filter),
+			 ztest_unit_test(test_benchmark));
+
+	ztest_run_test_suite(bt_scan_test);
+}
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef _BENCHMARK_EVENT_H_
+#define _BENCHMARK_EVENT_H_
+
+/**
+ * @brief Benchmark Event
+ * @defgroup benchmark_event Benchmark Event
+ * @{
+ */
+
+#include "event_manager.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct benchmark_event {
+	struct event_header header;
+
+	uint32_t seq;
+};
+
+EVENT_TYPE_DECLARE(benchmark_event);
+
+/* Event type without subscribers, released on submission. */
+struct benchmark_nosubs_event {
+	struct event_header header;
+
+	uint32_t seq;
+};
+
+EVENT_TYPE_DECLARE(benchmark_nosubs_event);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* _BENCHMARK_EVENT_H_ */
@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include "coalesce_event.h"
+
+
+static bool merge_coalesce_event(struct event_header *pending,
+				 const struct event_header *eh)
+{
+	struct coalesce_event *pending_event = cast_coalesce_event(pending);
+	const struct coalesce_event *event = cast_coalesce_event(eh);
+
+	pending_event->val += event->val;
+
+	return true;
+}
+
+EVENT_COALESCE_DEFINE(coalesce_event, merge_coalesce_event);
+
+EVENT_TYPE_DEFINE(coalesce_event,
+		  false,
+		  NULL,
+		  NULL);
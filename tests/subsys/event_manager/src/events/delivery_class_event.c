@@ -0,0 +1,16 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include "delivery_class_event.h"
+
+
+EVENT_DELIVERY_CLASS_DEFINE(delivery_class_event,
+			    EVENT_DELIVERY_CLASS_REALTIME);
+
+EVENT_TYPE_DEFINE(delivery_class_event,
+		  false,
+		  NULL,
+		  NULL);
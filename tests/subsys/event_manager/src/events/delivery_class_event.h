@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef _DELIVERY_CLASS_EVENT_H_
+#define _DELIVERY_CLASS_EVENT_H_
+
+/**
+ * @brief Delivery Class Event
+ * @defgroup delivery_class_event Delivery Class Event
+ * @{
+ */
+
+#include "event_manager.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct delivery_class_event {
+	struct event_header header;
+
+	uint32_t seq;
+};
+
+EVENT_TYPE_DECLARE(delivery_class_event);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* _DELIVERY_CLASS_EVENT_H_ */
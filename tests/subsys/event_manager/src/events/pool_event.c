@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include "pool_event.h"
+
+
+static int log_pool_event(const struct event_header *eh, char *buf,
+			  size_t buf_len)
+{
+	struct pool_event *event = cast_pool_event(eh);
+
+	return snprintf(buf, buf_len, "val:%u", event->val);
+}
+
+EVENT_POOL_DEFINE(pool_event, POOL_EVENT_POOL_SIZE);
+
+EVENT_TYPE_DEFINE(pool_event,
+		  false,
+		  log_pool_event,
+		  NULL);
@@ -0,0 +1,40 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef _POOL_EVENT_H_
+#define _POOL_EVENT_H_
+
+/**
+ * @brief Pool Event
+ * @defgroup pool_event Pool Event
+ * @{
+ */
+
+#include "event_manager.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define POOL_EVENT_POOL_SIZE 8
+
+struct pool_event {
+	struct event_header header;
+
+	uint32_t val;
+};
+
+EVENT_TYPE_DECLARE(pool_event);
+
+#ifdef __cplusplus
+}
+#endif
+
+/**
+ * @}
+ */
+
+#endif /* _POOL_EVENT_H_ */
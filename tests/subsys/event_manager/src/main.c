@@ -68,6 +68,26 @@ static void test_multicontext(void)
 	test_start(TEST_MULTICONTEXT);
 }
 
+static void test_event_pool(void)
+{
+	test_start(TEST_EVENT_POOL);
+}
+
+static void test_dispatch_benchmark(void)
+{
+	test_start(TEST_DISPATCH_BENCHMARK);
+}
+
+static void test_delivery_class(void)
+{
+	test_start(TEST_DELIVERY_CLASS);
+}
+
+static void test_coalescing(void)
+{
+	test_start(TEST_COALESCING);
+}
+
 void test_main(void)
 {
 	ztest_test_suite(event_manager_tests,
@@ -77,7 +97,11 @@ void test_main(void)
 			 ztest_unit_test(test_event_order),
 			 ztest_unit_test(test_subs_order),
 			 ztest_unit_test(test_oom_reset),
-			 ztest_unit_test(test_multicontext)
+			 ztest_unit_test(test_multicontext),
+			 ztest_unit_test(test_event_pool),
+			 ztest_unit_test(test_dispatch_benchmark),
+			 ztest_unit_test(test_delivery_class),
+			 ztest_unit_test(test_coalescing)
 			 );
 
 	ztest_run_test_suite(event_manager_tests);
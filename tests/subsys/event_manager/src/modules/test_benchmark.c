@@ -0,0 +1,152 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+
+#include <test_events.h>
+#include <benchmark_event.h>
+
+#include "test_config.h"
+
+#define MODULE test_benchmark
+
+static uint32_t submitted_cnt;
+static uint32_t received_cnt;
+static uint32_t start_cycles;
+
+
+static void submit_batch(void)
+{
+	for (size_t i = 0; i < TEST_BENCHMARK_BATCH_CNT; i++) {
+		struct benchmark_event *event = new_benchmark_event();
+
+		event->seq = submitted_cnt;
+		submitted_cnt++;
+		EVENT_SUBMIT(event);
+	}
+}
+
+static void print_result(const char *name, uint32_t cnt, uint32_t cycles)
+{
+	uint64_t ns = k_cyc_to_ns_floor64(cycles);
+
+	/* The benchmark only prints the results. The cycle counter may not
+	 * advance during computation on simulated targets.
+	 */
+	if (ns == 0) {
+		printk("%s: %u events, time not measurable\n", name, cnt);
+		return;
+	}
+
+	printk("%s: %u events in %u us, %u events/s\n", name, cnt,
+	       (uint32_t)(ns / NSEC_PER_USEC),
+	       (uint32_t)(((uint64_t)cnt * NSEC_PER_SEC) / ns));
+}
+
+static void end_test(void)
+{
+	uint32_t cycles = k_cycle_get_32() - start_cycles;
+
+	print_result("Event dispatch benchmark", received_cnt, cycles);
+
+	/* Events of a type without subscribers are released on submission.
+	 * Compare with the dispatch of the same number of subscribed events
+	 * above.
+	 */
+	start_cycles = k_cycle_get_32();
+	for (size_t i = 0; i < TEST_BENCHMARK_EVENT_CNT; i++) {
+		struct benchmark_nosubs_event *event =
+			new_benchmark_nosubs_event();
+
+		event->seq = i;
+		EVENT_SUBMIT(event);
+	}
+	cycles = k_cycle_get_32() - start_cycles;
+
+	print_result("Event without subscribers benchmark",
+		     TEST_BENCHMARK_EVENT_CNT, cycles);
+
+	struct test_end_event *et = new_test_end_event();
+
+	et->test_id = TEST_DISPATCH_BENCHMARK;
+	EVENT_SUBMIT(et);
+}
+
+static bool event_handler(const struct event_header *eh)
+{
+	if (is_test_start_event(eh)) {
+		struct test_start_event *st = cast_test_start_event(eh);
+
+		switch (st->test_id) {
+		case TEST_DISPATCH_BENCHMARK:
+			submitted_cnt = 0;
+			received_cnt = 0;
+			start_cycles = k_cycle_get_32();
+			submit_batch();
+			break;
+		default:
+			/* Ignore other test cases, check if proper test_id. */
+			zassert_true(st->test_id < TEST_CNT,
+				     "test_id out of range");
+			break;
+		}
+
+		return false;
+	}
+
+	if (is_benchmark_event(eh)) {
+		return false;
+	}
+
+	zassert_true(false, "Event unhandled");
+
+	return false;
+}
+
+/* Benchmark events are delivered to a listener on every priority level. */
+EVENT_LISTENER(MODULE, event_handler);
+EVENT_SUBSCRIBE(MODULE, test_start_event);
+EVENT_SUBSCRIBE_EARLY(MODULE, benchmark_event);
+
+static bool event_handler_normal(const struct event_header *eh)
+{
+	if (is_benchmark_event(eh)) {
+		return false;
+	}
+
+	zassert_true(false, "Event unhandled");
+
+	return false;
+}
+
+EVENT_LISTENER(test_benchmark_normal, event_handler_normal);
+EVENT_SUBSCRIBE(test_benchmark_normal, benchmark_event);
+
+static bool event_handler_final(const struct event_header *eh)
+{
+	if (is_benchmark_event(eh)) {
+		struct benchmark_event *event = cast_benchmark_event(eh);
+
+		zassert_equal(event->seq, received_cnt, "Wrong event order");
+		received_cnt++;
+
+		if (received_cnt == TEST_BENCHMARK_EVENT_CNT) {
+			end_test();
+		} else if (received_cnt == submitted_cnt) {
+			submit_batch();
+		}
+
+		return false;
+	}
+
+	zassert_true(false, "Event unhandled");
+
+	return false;
+}
+
+EVENT_LISTENER(test_benchmark_final, event_handler_final);
+EVENT_SUBSCRIBE_FINAL(test_benchmark_final, benchmark_event);
@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+
+#include <test_events.h>
+#include <coalesce_event.h>
+
+#include "test_config.h"
+
+#define MODULE test_coalescing
+
+static struct event_coalesce *const coalesce = &__event_coalesce_coalesce_event;
+
+
+static void start_test(void)
+{
+	/* Events are submitted from the listener, so none of them can be
+	 * processed before all of them are submitted.
+	 */
+	for (size_t i = 0; i < TEST_COALESCING_EVENT_CNT; i++) {
+		struct coalesce_event *event = new_coalesce_event();
+
+		event->val = 1;
+		EVENT_SUBMIT(event);
+	}
+
+	zassert_equal(atomic_get(&coalesce->merged_cnt),
+		      TEST_COALESCING_EVENT_CNT - 1,
+		      "Events not merged");
+}
+
+static bool event_handler(const struct event_header *eh)
+{
+	if (is_test_start_event(eh)) {
+		struct test_start_event *st = cast_test_start_event(eh);
+
+		switch (st->test_id) {
+		case TEST_COALESCING:
+			start_test();
+			break;
+		default:
+			/* Ignore other test cases, check if proper test_id. */
+			zassert_true(st->test_id < TEST_CNT,
+				     "test_id out of range");
+			break;
+		}
+
+		return false;
+	}
+
+	if (is_coalesce_event(eh)) {
+		struct coalesce_event *event = cast_coalesce_event(eh);
+
+		zassert_equal(event->val, TEST_COALESCING_EVENT_CNT,
+			      "Invalid merged value");
+		zassert_equal(atomic_get(&coalesce->delivered_cnt), 1,
+			      "Invalid number of delivered events");
+
+		struct test_end_event *et = new_test_end_event();
+
+		et->test_id = TEST_COALESCING;
+		EVENT_SUBMIT(et);
+
+		return false;
+	}
+
+	zassert_true(false, "Event unhandled");
+
+	return false;
+}
+
+EVENT_LISTENER(MODULE, event_handler);
+EVENT_SUBSCRIBE(MODULE, test_start_event);
+EVENT_SUBSCRIBE(MODULE, coalesce_event);
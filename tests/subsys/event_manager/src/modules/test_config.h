@@ -19,3 +19,16 @@
 
 /* TEST_EVENT_ORDER */
 #define TEST_EVENT_ORDER_CNT 20
+
+
+/* TEST_DISPATCH_BENCHMARK */
+#define TEST_BENCHMARK_EVENT_CNT 2000
+#define TEST_BENCHMARK_BATCH_CNT 20
+
+
+/* TEST_DELIVERY_CLASS */
+#define TEST_DELIVERY_CLASS_EVENT_CNT 10
+
+
+/* TEST_COALESCING */
+#define TEST_COALESCING_EVENT_CNT 10
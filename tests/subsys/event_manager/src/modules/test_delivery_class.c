@@ -0,0 +1,86 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+
+#include <test_events.h>
+#include <delivery_class_event.h>
+
+#include "test_config.h"
+
+#define MODULE test_delivery_class
+
+static uint32_t received_cnt;
+
+
+static void start_test(void)
+{
+	received_cnt = 0;
+
+	for (size_t i = 0; i < TEST_DELIVERY_CLASS_EVENT_CNT; i++) {
+		struct delivery_class_event *event =
+			new_delivery_class_event();
+
+		event->seq = i;
+		EVENT_SUBMIT(event);
+	}
+}
+
+static void end_test(void)
+{
+	struct test_end_event *et = new_test_end_event();
+
+	et->test_id = TEST_DELIVERY_CLASS;
+	EVENT_SUBMIT(et);
+}
+
+static bool event_handler(const struct event_header *eh)
+{
+	if (is_test_start_event(eh)) {
+		struct test_start_event *st = cast_test_start_event(eh);
+
+		zassert_equal(k_current_get(), &k_sys_work_q.thread,
+			      "Normal class event not processed by workqueue");
+
+		switch (st->test_id) {
+		case TEST_DELIVERY_CLASS:
+			start_test();
+			break;
+		default:
+			/* Ignore other test cases, check if proper test_id. */
+			zassert_true(st->test_id < TEST_CNT,
+				     "test_id out of range");
+			break;
+		}
+
+		return false;
+	}
+
+	if (is_delivery_class_event(eh)) {
+		struct delivery_class_event *event =
+			cast_delivery_class_event(eh);
+
+		zassert_not_equal(k_current_get(), &k_sys_work_q.thread,
+				  "Realtime event processed by workqueue");
+		zassert_equal(event->seq, received_cnt, "Wrong event order");
+		received_cnt++;
+
+		if (received_cnt == TEST_DELIVERY_CLASS_EVENT_CNT) {
+			end_test();
+		}
+
+		return false;
+	}
+
+	zassert_true(false, "Event unhandled");
+
+	return false;
+}
+
+EVENT_LISTENER(MODULE, event_handler);
+EVENT_SUBSCRIBE(MODULE, test_start_event);
+EVENT_SUBSCRIBE(MODULE, delivery_class_event);
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+
+#include <test_events.h>
+#include <pool_event.h>
+
+#define MODULE test_pool
+
+static struct event_pool *const pool = &__event_pool_pool_event;
+static uint32_t received_cnt;
+
+
+static void start_test(enum test_id test_id)
+{
+	struct pool_event *events[POOL_EVENT_POOL_SIZE];
+
+	zassert_equal(k_mem_slab_num_used_get(pool->slab), 0,
+		      "Pool not empty before the test");
+
+	for (size_t i = 0; i < ARRAY_SIZE(events); i++) {
+		events[i] = new_pool_event();
+		zassert_not_null(events[i], "Cannot allocate from pool");
+		events[i]->val = i;
+	}
+
+	zassert_equal(atomic_get(&pool->max_used), POOL_EVENT_POOL_SIZE,
+		      "Invalid pool high-water mark");
+
+	/* Pool is exhausted - allocation fails without the OOM handling. */
+	zassert_is_null(new_pool_event(), "Pool exhaustion not detected");
+	zassert_equal(atomic_get(&pool->alloc_failures), 1,
+		      "Pool exhaustion not counted");
+
+	received_cnt = 0;
+	for (size_t i = 0; i < ARRAY_SIZE(events); i++) {
+		EVENT_SUBMIT(events[i]);
+	}
+}
+
+static void end_test(void)
+{
+	struct test_end_event *et = new_test_end_event();
+
+	et->test_id = TEST_EVENT_POOL;
+	EVENT_SUBMIT(et);
+}
+
+static bool event_handler(const struct event_header *eh)
+{
+	if (is_test_start_event(eh)) {
+		struct test_start_event *st = cast_test_start_event(eh);
+
+		switch (st->test_id) {
+		case TEST_EVENT_POOL:
+			start_test(st->test_id);
+			break;
+		default:
+			/* Ignore other test cases, check if proper test_id. */
+			zassert_true(st->test_id < TEST_CNT,
+				     "test_id out of range");
+			break;
+		}
+
+		return false;
+	}
+
+	if (is_pool_event(eh)) {
+		struct pool_event *event = cast_pool_event(eh);
+
+		zassert_equal(event->val, received_cnt, "Wrong event order");
+		received_cnt++;
+
+		/* Events are released after processing, so only the
+		 * currently processed events remain allocated.
+		 */
+		zassert_equal(k_mem_slab_num_used_get(pool->slab),
+			      POOL_EVENT_POOL_SIZE - received_cnt + 1,
+			      "Event not released to the pool");
+
+		if (received_cnt == POOL_EVENT_POOL_SIZE) {
+			end_test();
+		}
+
+		return false;
+	}
+
+	zassert_true(false, "Event unhandled");
+
+	return false;
+}
+
+EVENT_LISTENER(MODULE, event_handler);
+EVENT_SUBSCRIBE(MODULE, test_start_event);
+EVENT_SUBSCRIBE(MODULE, pool_event);
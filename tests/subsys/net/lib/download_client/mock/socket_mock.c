@@ -0,0 +1,223 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <net/socket.h>
+
+#include "socket_mock.h"
+
+#define MOCK_FD			1
+#define MOCK_MAX_INFLIGHT	8
+#define MOCK_REQ_MAX_LEN	256
+#define MOCK_RESP_MAX_LEN	(CONFIG_DOWNLOAD_CLIENT_HTTP_FRAG_SIZE + 128)
+
+#define RESPONSE_TEMPLATE						\
+	"HTTP/1.1 206 Partial Content\r\n"				\
+	"Content-Range: bytes %u-%u/%u\r\n"				\
+	"Content-Length: %u\r\n"					\
+	"\r\n"
+
+static struct {
+	struct {
+		int64_t ready;
+		size_t first;
+		size_t last;
+	} queue[MOCK_MAX_INFLIGHT];
+	size_t queued;
+	size_t max_inflight;
+	/* Response being read */
+	char resp[MOCK_RESP_MAX_LEN];
+	size_t resp_len;
+	size_t resp_off;
+	/* Offset to add to the range of the next response */
+	size_t skew;
+	size_t recv_limit;
+} server;
+
+static struct sockaddr_in server_addr = {
+	.sin_family = AF_INET,
+};
+
+static struct zsock_addrinfo server_ai = {
+	.ai_family = AF_INET,
+	.ai_socktype = SOCK_STREAM,
+	.ai_addr = (struct sockaddr *)&server_addr,
+	.ai_addrlen = sizeof(server_addr),
+};
+
+void socket_mock_reset(size_t recv_limit)
+{
+	memset(&server, 0, sizeof(server));
+	server.recv_limit = recv_limit;
+}
+
+void socket_mock_range_skew_set(size_t skew)
+{
+	server.skew = skew;
+}
+
+size_t socket_mock_max_inflight(void)
+{
+	return server.max_inflight;
+}
+
+uint8_t socket_mock_file_byte(size_t off)
+{
+	return (uint8_t)(off * 31 + (off >> 8));
+}
+
+static void server_request(const char *req)
+{
+	const char *p = strstr(req, "Range: bytes=");
+
+	__ASSERT(strstr(req, "GET /file.bin HTTP/1.1\r\n") != NULL,
+		 "Bad request line");
+	__ASSERT(strstr(req, "Host: example.com\r\n") != NULL, "Bad host");
+	__ASSERT(strstr(req, "Connection: keep-alive\r\n\r\n") != NULL,
+		 "Connection should be persistent");
+	__ASSERT(p != NULL, "Not a range request");
+	__ASSERT(server.queued < MOCK_MAX_INFLIGHT, "Too many requests");
+
+	server.queue[server.queued].first = strtoul(p + 13, (char **)&p, 10);
+	server.queue[server.queued].last = strtoul(p + 1, NULL, 10);
+	server.queue[server.queued].ready = k_uptime_get() +
+					    SOCKET_MOCK_RTT_MS;
+	server.queued++;
+
+	/* Include the response being read, if any */
+	server.max_inflight = MAX(server.max_inflight, server.queued +
+				  (server.resp_off < server.resp_len));
+}
+
+static void server_respond(void)
+{
+	size_t first = server.queue[0].first + server.skew;
+	size_t last = MIN(server.queue[0].last + server.skew,
+			  SOCKET_MOCK_FILE_SIZE - 1);
+	int64_t wait = server.queue[0].ready - k_uptime_get();
+
+	if (wait > 0) {
+		k_sleep(K_MSEC(wait));
+	}
+
+	server.resp_len = snprintf(server.resp, sizeof(server.resp),
+				   RESPONSE_TEMPLATE, first, last,
+				   SOCKET_MOCK_FILE_SIZE, last - first + 1);
+	for (size_t off = first; off <= last; off++) {
+		server.resp[server.resp_len++] = socket_mock_file_byte(off);
+	}
+	server.resp_off = 0;
+	server.skew = 0;
+
+	server.queued--;
+	memmove(server.queue, server.queue + 1,
+		server.queued * sizeof(server.queue[0]));
+}
+
+/* Return up to `len` bytes of the response stream, which may span
+ * the end of a response and the beginning of the next one.
+ */
+static size_t server_recv(char *buf, size_t len)
+{
+	size_t recvd = 0;
+	size_t n;
+
+	len = MIN(len, server.recv_limit);
+
+	while (recvd < len) {
+		if (server.resp_off == server.resp_len) {
+			if (server.queued == 0 || (recvd &&
+			    server.queue[0].ready > k_uptime_get())) {
+				break;
+			}
+			server_respond();
+		}
+
+		n = MIN(len - recvd, server.resp_len - server.resp_off);
+		memcpy(buf + recvd, server.resp + server.resp_off, n);
+		server.resp_off += n;
+		recvd += n;
+	}
+
+	return recvd;
+}
+
+int zsock_getaddrinfo(const char *host, const char *service,
+		      const struct zsock_addrinfo *hints,
+		      struct zsock_addrinfo **res)
+{
+	*res = &server_ai;
+
+	return 0;
+}
+
+void zsock_freeaddrinfo(struct zsock_addrinfo *ai)
+{
+}
+
+int z_impl_zsock_socket(int family, int type, int proto)
+{
+	return MOCK_FD;
+}
+
+int z_impl_zsock_close(int sock)
+{
+	return 0;
+}
+
+int z_impl_zsock_connect(int sock, const struct sockaddr *addr,
+			 socklen_t addrlen)
+{
+	return 0;
+}
+
+int z_impl_zsock_setsockopt(int sock, int level, int optname,
+			    const void *optval, socklen_t optlen)
+{
+	return 0;
+}
+
+ssize_t z_impl_zsock_sendto(int sock, const void *buf, size_t len, int flags,
+			    const struct sockaddr *dest_addr, socklen_t addrlen)
+{
+	char req[MOCK_REQ_MAX_LEN];
+
+	__ASSERT(len < sizeof(req), "Request too long");
+
+	memcpy(req, buf, len);
+	req[len] = '\0';
+	server_request(req);
+
+	return len;
+}
+
+ssize_t z_impl_zsock_sendmsg(int sock, const struct msghdr *msg, int flags)
+{
+	char req[MOCK_REQ_MAX_LEN];
+	size_t len = 0;
+
+	for (size_t i = 0; i < msg->msg_iovlen; i++) {
+		__ASSERT(len + msg->msg_iov[i].iov_len < sizeof(req),
+			 "Request too long");
+		memcpy(req + len, msg->msg_iov[i].iov_base,
+		       msg->msg_iov[i].iov_len);
+		len += msg->msg_iov[i].iov_len;
+	}
+	req[len] = '\0';
+	server_request(req);
+
+	return len;
+}
+
+ssize_t z_impl_zsock_recvfrom(int sock, void *buf, size_t max_len, int flags,
+			      struct sockaddr *src_addr, socklen_t *addrlen)
+{
+	/* The server closes the connection if it has nothing to send */
+	return server_recv(buf, max_len);
+}
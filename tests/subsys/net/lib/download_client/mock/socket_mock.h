@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#ifndef SOCKET_MOCK_H_
+#define SOCKET_MOCK_H_
+
+#include <zephyr.h>
+
+/**
+ * @file
+ * @brief Mock of the sockets, connected to a local HTTP server.
+ *
+ * The server answers the range requests sent on the socket, in order, each
+ * one round trip time after it was sent. The responses are read from the
+ * socket as one stream of bytes.
+ */
+
+/** @brief Size of the file served by the mock. */
+#define SOCKET_MOCK_FILE_SIZE	(20 * 1024 + 123)
+
+/** @brief Round trip time of a request, in milliseconds. */
+#define SOCKET_MOCK_RTT_MS	20
+
+/** @brief Reset the server.
+ *
+ * @param recv_limit Maximum number of bytes returned by one `recv` call,
+ *                   or SIZE_MAX for no limit.
+ */
+void socket_mock_reset(size_t recv_limit);
+
+/** @brief Shift the range of the next response.
+ *
+ * @param skew Number of bytes to add to the requested range.
+ */
+void socket_mock_range_skew_set(size_t skew);
+
+/** @brief Get the largest number of requests in flight.
+ *
+ * A response that is being read counts as a request in flight.
+ *
+ * @return Number of requests.
+ */
+size_t socket_mock_max_inflight(void);
+
+/** @brief Get a byte of the served file.
+ *
+ * @param off Offset of the byte in the file.
+ *
+ * @return Byte.
+ */
+uint8_t socket_mock_file_byte(size_t off);
+
+#endif /* SOCKET_MOCK_H_ */
@@ -0,0 +1,185 @@
+/*
+ * Copyright (c) 2021 Nordic Semiconductor ASA
+ *
+ * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
+ */
+
+#include <zephyr.h>
+#include <ztest.h>
+#include <string.h>
+#include <net/download_client.h>
+
+#include "socket_mock.h"
+
+#define TEST_HOST	"https://example.com"
+#define TEST_FILE	"file.bin"
+#define TEST_SEC_TAG	1
+#define TEST_TIMEOUT	K_SECONDS(30)
+
+static struct download_client client;
+static K_SEM_DEFINE(download_done, 0, 1);
+
+static size_t received;
+static size_t bad_byte_cnt;
+static int download_err;
+
+static int download_client_callback(const struct download_client_evt *event)
+{
+	switch (event->id) {
+	case DOWNLOAD_CLIENT_EVT_FRAGMENT:
+		for (size_t i = 0; i < event->fragment.len; i++) {
+			const uint8_t *buf = event->fragment.buf;
+
+			if (buf[i] != socket_mock_file_byte(received + i)) {
+				bad_byte_cnt++;
+			}
+		}
+		received += event->fragment.len;
+		return 0;
+	case DOWNLOAD_CLIENT_EVT_DONE:
+		download_err = 0;
+		k_sem_give(&download_done);
+		return 0;
+	case DOWNLOAD_CLIENT_EVT_ERROR:
+		download_err = event->error;
+		k_sem_give(&download_done);
+		/* Stop the download */
+		return 1;
+	default:
+		return 0;
+	}
+}
+
+/* Download the file with the download thread of the client */
+static int download(uint8_t depth, uint32_t *throughput)
+{
+	struct download_client_cfg config = {
+		.sec_tag = TEST_SEC_TAG,
+		.pipeline_depth = depth,
+	};
+	int err;
+
+	received = 0;
+	bad_byte_cnt = 0;
+	download_err = -EINPROGRESS;
+	k_sem_reset(&download_done);
+
+	err = download_client_connect(&client, TEST_HOST, &config);
+	zassert_equal(err, 0, "Cannot connect (err %d)", err);
+
+	err = download_client_start(&client, TEST_FILE, 0);
+	zassert_equal(err, 0, "Cannot start download (err %d)", err);
+
+	err = k_sem_take(&download_done, TEST_TIMEOUT);
+	zassert_equal(err, 0, "Download timed out");
+
+	/* Let the download thread suspend itself before the next download */
+	k_sleep(K_MSEC(1));
+
+	if (throughput) {
+		download_client_throughput_get(&client, throughput);
+	}
+
+	err = download_client_disconnect(&client);
+	zassert_equal(err, 0, "Cannot disconnect (err %d)", err);
+
+	return download_err;
+}
+
+static void download_check(void)
+{
+	size_t file_size;
+
+	download_client_file_size_get(&client, &file_size);
+
+	zassert_equal(file_size, SOCKET_MOCK_FILE_SIZE, "Bad file size");
+	zassert_equal(received, SOCKET_MOCK_FILE_SIZE,
+		      "Bad number of bytes received");
+	zassert_equal(bad_byte_cnt, 0, "Bad payload");
+	zassert_equal(client.http.pending, 0, "No request should be pending");
+	zassert_equal(client.http.carry, 0, "No data should be left");
+}
+
+static void test_single_request(void)
+{
+	socket_mock_reset(SIZE_MAX);
+
+	zassert_equal(download(1, NULL), 0,
+		      "Download should succeed");
+	download_check();
+	zassert_equal(socket_mock_max_inflight(), 1,
+		      "Only one request should be in flight");
+}
+
+static void test_pipelined_requests(void)
+{
+	socket_mock_reset(SIZE_MAX);
+
+	zassert_equal(download(4, NULL), 0,
+		      "Download should succeed");
+	download_check();
+	zassert_equal(socket_mock_max_inflight(), 4,
+		      "Four requests should be in flight");
+}
+
+static void test_pipelined_small_reads(void)
+{
+	/* Headers and payloads are split across reads */
+	for (size_t limit = 1; limit < 64; limit += 7) {
+		socket_mock_reset(limit);
+
+		zassert_equal(download(3, NULL), 0,
+			      "Download should succeed in %u byte reads",
+			      limit);
+		download_check();
+	}
+}
+
+static void test_unexpected_range(void)
+{
+	socket_mock_reset(SIZE_MAX);
+	socket_mock_range_skew_set(CONFIG_DOWNLOAD_CLIENT_HTTP_FRAG_SIZE);
+
+	zassert_equal(download(1, NULL), -EBADMSG,
+		      "Misplaced fragment should be rejected");
+	zassert_equal(received, 0, "No data should be delivered");
+}
+
+static void test_benchmark(void)
+{
+	uint32_t sequential;
+	uint32_t pipelined;
+
+	socket_mock_reset(SIZE_MAX);
+	download(1, &sequential);
+	socket_mock_reset(SIZE_MAX);
+	download(4, &pipelined);
+
+	TC_PRINT("%u bytes, %u ms RTT: %u bytes/s sequential, "
+		 "%u bytes/s with 4 requests in flight\n",
+		 SOCKET_MOCK_FILE_SIZE, SOCKET_MOCK_RTT_MS, sequential,
+		 pipelined);
+
+	/* The round trip time is simulated with sleeps, so the uptime
+	 * reflects the number of round trips.
+	 */
+	zassert_true(pipelined > 2 * sequential,
+		     "Pipelining should hide the round trip time");
+}
+
+void test_main(void)
+{
+	int err = download_client_init(&client, download_client_callback);
+
+	zassert_equal(err, 0, "Cannot initialize client (err %d)", err);
+
+	ztest_test_suite(download_client,
+			 ztest_unit_test(test_single_request),
+			 ztest_unit_test(test_pipelined_requests),
+			 ztest_unit_test(test_pipelined_small_reads),
+			 ztest_unit_test(test_unexpected_range),
+			 ztest_unit_test(test_benchmark)
+			 );
+
+	ztest_run_test_suite(download_client);
+}